@@ -26,7 +26,14 @@
 #ifndef CMNCS_COMPUTATIONALGEOMETRY_MESH3D_HPP__
 #define CMNCS_COMPUTATIONALGEOMETRY_MESH3D_HPP__
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <limits>       // std::numeric_limits
+#include <sstream>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <map>
 
@@ -451,53 +458,190 @@ class Mesh3D
 	  return true;
   }
 
-  /** @brief Save in ply format
+  /** @brief Save in ply format.
+
+	  Save in ply format. The vertexes shared by the triangles are welded
+	  with a hash table: the vertexes with the same position (and texture
+	  coordinates, if saved) are written once. The triangles with a wrong
+	  number of vertexes are not saved.
+	  @param[in] filename Name of the file to save the data.
+	  @param[in] binary Write the binary_little_endian format (smaller and
+	                    faster). The ascii format otherwise.
+	  @param[in] texture Write the texture coordinates (s, t) of the
+	                     vertexes.
+	  @return Return TRUE in case of success. FALSE otherwise.
   */
-  bool save_ply(const std::string &filename)
+  bool save_ply(const std::string &filename, bool binary = false,
+	  bool texture = false)
   {
-	  std::vector< _Ty3 > v_points;
-	  if (!get(v_points)) return false;
+	  std::vector< float > v_vertex;
+	  std::vector< int32_t > v_face;
+	  weld(texture, v_vertex, v_face);
+	  if (v_vertex.empty()) return false;
+	  const size_t kElems = texture ? 5 : 3;
 
-	  std::ofstream myfile(filename);
+	  std::ofstream myfile(filename, std::ios::binary);
 	  if (!myfile.is_open()) return false;
-	  myfile << "ply" << std::endl;
-	  myfile << "format ascii 1.0" << std::endl;
-	  myfile << "element vertex " << v_points.size() << std::endl;
-	  myfile << "property float32 x" << std::endl;
-	  myfile << "property float32 y" << std::endl;
-	  myfile << "property float32 z" << std::endl;
-	  myfile << "element face " << size() << std::endl;
-	  myfile << "property list uint8 int32 vertex_indices" << std::endl;
-	  myfile << "end_header" << std::endl;
-
-	  // copy the vertex
-	  std::map< std::pair<float, std::pair< float, float > >, int > m_vertex;
-	  int index = 0;
-	  for (auto it = v_points.begin(); it != v_points.end(); it++)
-	  {
-		  myfile << it->x << " " << it->y << " " << it->z << std::endl;
-		  m_vertex[ std::make_pair(it->x, std::make_pair(it->y, it->z) ) ] = index;
-		  ++index;
+	  myfile << "ply\n";
+	  myfile << (binary ? "format binary_little_endian 1.0\n" :
+		  "format ascii 1.0\n");
+	  myfile << "element vertex " << v_vertex.size() / kElems << "\n";
+	  myfile << "property float32 x\n";
+	  myfile << "property float32 y\n";
+	  myfile << "property float32 z\n";
+	  if (texture) {
+		  myfile << "property float32 s\n";
+		  myfile << "property float32 t\n";
 	  }
-	  // copy the faces
-	  for (auto it = m_triangle_.begin(); it != m_triangle_.end(); it++)
+	  myfile << "element face " << v_face.size() / 3 << "\n";
+	  myfile << "property list uint8 int32 vertex_indices\n";
+	  myfile << "end_header\n";
+
+	  if (binary) {
+		  // the faces are streamed in blocks with the byte layout of the file
+		  PlyWriteBuffer buffer(myfile);
+		  for (size_t i = 0; i < v_vertex.size(); i++)
+		  {
+			  buffer.put(v_vertex[i]);
+		  }
+		  for (size_t i = 0; i < v_face.size(); i += 3)
+		  {
+			  buffer.put(static_cast<uint8_t>(3));
+			  buffer.put(v_face[i]);
+			  buffer.put(v_face[i + 1]);
+			  buffer.put(v_face[i + 2]);
+		  }
+		  buffer.flush();
+	  } else {
+		  for (size_t i = 0; i < v_vertex.size(); i += kElems)
+		  {
+			  myfile << v_vertex[i];
+			  for (size_t j = 1; j < kElems; j++)
+			  {
+				  myfile << " " << v_vertex[i + j];
+			  }
+			  myfile << "\n";
+		  }
+		  for (size_t i = 0; i < v_face.size(); i += 3)
+		  {
+			  myfile << "3 " << v_face[i] << " " << v_face[i + 1] << " " <<
+				  v_face[i + 2] << "\n";
+		  }
+	  }
+	  myfile.close();
+	  return !myfile.fail();
+  }
+
+
+  /** @brief Load a ply file in binary_little_endian format.
+
+	  Load a ply file in binary_little_endian format. The vertexes are read
+	  from the properties x, y, z and the texture coordinates (if any) from
+	  s, t (or u, v, texture_u, texture_v) of any numeric type. The faces
+	  with more than 3 vertexes are split in a fan of triangles. The other
+	  elements and properties are skipped.
+	  @param[in] filename Name of the file to load.
+	  @return Return TRUE in case of success. FALSE otherwise (the mesh is
+	          not changed).
+  */
+  bool load_ply(const std::string &filename)
+  {
+	  std::ifstream myfile(filename, std::ios::binary);
+	  if (!myfile.is_open()) return false;
+	  std::vector< PlyElement > v_element;
+	  if (!read_ply_header(myfile, v_element)) return false;
+	  // the body is decoded from memory
+	  std::streampos begin = myfile.tellg();
+	  myfile.seekg(0, std::ios::end);
+	  std::streamoff size = myfile.tellg() - begin;
+	  myfile.seekg(begin);
+	  std::vector< char > data(static_cast<size_t>(size));
+	  if (size > 0 && !myfile.read(&data[0], size)) return false;
+	  const char *p = data.data(), *end = data.data() + data.size();
+
+	  std::vector< _Ty3 > v_p3d;
+	  std::vector< _Ty2 > v_p2d;
+	  std::vector< int64_t > v_face;
+	  for (auto it = v_element.begin(); it != v_element.end(); it++)
 	  {
-		  // scan the vertex and find the index
-		  std::vector< _Ty3 > point_structure;
-		  std::vector< _Ty2 > point_texture;
-		  it->second.get(point_structure, point_texture);
-		  // search for the vertex
-		  myfile << "3 ";
-		  if (point_structure.size() != 3) system("pause");
-		  for (auto it2 = point_structure.begin(); it2 != point_structure.end(); it2++)
+		  bool is_vertex = it->name == "vertex";
+		  bool is_face = it->name == "face";
+		  // the count of the header is checked with the bytes left
+		  size_t min_size = ply_min_record_size(*it);
+		  if (it->count > 0 && (min_size == 0 ||
+			  it->count > static_cast<size_t>(end - p) / min_size)) {
+			  return false;
+		  }
+		  if (is_vertex) {
+			  v_p3d.reserve(it->count);
+			  v_p2d.reserve(it->count);
+		  }
+		  for (size_t i = 0; i < it->count; i++)
 		  {
-			  myfile << m_vertex[ std::make_pair(it2->x, std::make_pair(it2->y, it2->z) ) ] << " ";
+			  double v[5] = { 0, 0, 0, 0, 0 };
+			  for (auto prop = it->properties.begin();
+				   prop != it->properties.end(); prop++)
+			  {
+				  double value = 0;
+				  if (prop->list) {
+					  if (!read_ply_value(p, end, prop->count_type, value) ||
+						  !(value >= 0) ||
+						  value > static_cast<double>(end - p)) return false;
+					  size_t n = static_cast<size_t>(value);
+					  bool indices = is_face && (prop->name == "vertex_indices" ||
+						  prop->name == "vertex_index");
+					  int64_t first = 0, last = 0;
+					  for (size_t j = 0; j < n; j++)
+					  {
+						  if (!read_ply_value(p, end, prop->type, value)) {
+							  return false;
+						  }
+						  if (!indices) continue;
+						  if (!(value >= 0 && value < 9.0e18)) return false;
+						  int64_t index = static_cast<int64_t>(value);
+						  if (j == 0) first = index;
+						  // fan of triangles
+						  if (j >= 2) {
+							  v_face.push_back(first);
+							  v_face.push_back(last);
+							  v_face.push_back(index);
+						  }
+						  last = index;
+					  }
+				  } else {
+					  if (!read_ply_value(p, end, prop->type, value)) {
+						  return false;
+					  }
+					  if (is_vertex && prop->slot >= 0) v[prop->slot] = value;
+				  }
+			  }
+			  if (is_vertex) {
+				  v_p3d.push_back(_Ty3(static_cast<float>(v[0]),
+					  static_cast<float>(v[1]), static_cast<float>(v[2])));
+				  v_p2d.push_back(_Ty2(static_cast<float>(v[3]),
+					  static_cast<float>(v[4])));
+			  }
+		  }
+	  }
+	  for (auto it = v_face.begin(); it != v_face.end(); it++)
+	  {
+		  if (*it < 0 || *it >= static_cast<int64_t>(v_p3d.size())) {
+			  return false;
 		  }
-		  myfile << std::endl;
 	  }
 
-	  myfile.close(); 
-	  myfile.clear();
+	  clear();
+	  std::vector< _Ty3 > v_structure(3);
+	  std::vector< _Ty2 > v_texture(3);
+	  for (size_t i = 0; i < v_face.size(); i += 3)
+	  {
+		  for (int j = 0; j < 3; j++)
+		  {
+			  v_structure[j] = v_p3d[v_face[i + j]];
+			  v_texture[j] = v_p2d[v_face[i + j]];
+		  }
+		  add(v_structure, v_texture);
+	  }
 	  return true;
   }
 
@@ -579,6 +723,261 @@ class Mesh3D
 
  private:
 
+  /** @brief Key of the welded vertexes: the bits of x, y, z, s, t.
+  */
+  struct WeldKey
+  {
+	  uint32_t bits[5];
+
+	  bool operator==(const WeldKey &other) const {
+		  return memcmp(bits, other.bits, sizeof(bits)) == 0;
+	  }
+  };
+
+  struct WeldKeyHash
+  {
+	  size_t operator()(const WeldKey &key) const {
+		  // FNV-1a on the words
+		  uint64_t h = 14695981039346656037ull;
+		  for (int i = 0; i < 5; i++)
+		  {
+			  h = (h ^ key.bits[i]) * 1099511628211ull;
+		  }
+		  return static_cast<size_t>(h ^ (h >> 32));
+	  }
+  };
+
+  /** @brief Weld the vertexes of the triangles.
+
+	  Weld the vertexes of the triangles with a hash table. The vertexes
+	  with the same position (and texture coordinates if texture) take the
+	  same index, in the order they are found.
+	  @param[in] texture Weld and return the texture coordinates too.
+	  @param[out] v_vertex x, y, z (s, t) of the vertexes.
+	  @param[out] v_face Three vertex indexes for each valid triangle.
+  */
+  void weld(bool texture, std::vector< float > &v_vertex,
+	  std::vector< int32_t > &v_face) {
+	  const size_t kElems = texture ? 5 : 3;
+	  v_vertex.clear();
+	  v_face.clear();
+	  v_face.reserve(m_triangle_.size() * 3);
+	  std::unordered_map< WeldKey, int32_t, WeldKeyHash > m_vertex;
+	  m_vertex.reserve(m_triangle_.size() * 2);
+	  std::vector< _Ty3 > point_structure;
+	  std::vector< _Ty2 > point_texture;
+	  for (auto it = m_triangle_.begin(); it != m_triangle_.end(); it++)
+	  {
+		  it->second.get(point_structure, point_texture);
+		  if (point_structure.size() != 3 ||
+			  point_texture.size() != 3) continue;
+		  for (int i = 0; i < 3; i++)
+		  {
+			  // + 0.0f: -0 and 0 are the same vertex
+			  float v[5] = { point_structure[i].x + 0.0f,
+				  point_structure[i].y + 0.0f, point_structure[i].z + 0.0f,
+				  point_texture[i].x + 0.0f, point_texture[i].y + 0.0f };
+			  WeldKey key;
+			  memset(key.bits, 0, sizeof(key.bits));
+			  memcpy(key.bits, v, kElems * sizeof(float));
+			  auto res = m_vertex.insert(std::make_pair(key,
+				  static_cast<int32_t>(v_vertex.size() / kElems)));
+			  if (res.second) v_vertex.insert(v_vertex.end(), v, v + kElems);
+			  v_face.push_back(res.first->second);
+		  }
+	  }
+  }
+
+  static bool is_little_endian() {
+	  const uint16_t one = 1;
+	  return *reinterpret_cast<const uint8_t*>(&one) == 1;
+  }
+
+  /** @brief Buffer of the binary ply data, written in blocks.
+  */
+  class PlyWriteBuffer
+  {
+   public:
+
+	  explicit PlyWriteBuffer(std::ofstream &file)
+		  : file_(file), data_(1 << 20), pos_(0),
+		  swap_(!is_little_endian()) {}
+
+	  template <typename T>
+	  void put(T value) {
+		  if (pos_ + sizeof(T) > data_.size()) flush();
+		  char *p = &data_[pos_];
+		  memcpy(p, &value, sizeof(T));
+		  if (swap_) std::reverse(p, p + sizeof(T));
+		  pos_ += sizeof(T);
+	  }
+
+	  void flush() {
+		  file_.write(data_.data(), pos_);
+		  pos_ = 0;
+	  }
+
+   private:
+
+	  std::ofstream &file_;
+	  std::vector< char > data_;
+	  size_t pos_;
+	  bool swap_;
+  };
+
+  /** @brief Types of the ply properties.
+  */
+  enum PlyType {
+	  kPlyInt8, kPlyUint8, kPlyInt16, kPlyUint16, kPlyInt32, kPlyUint32,
+	  kPlyFloat32, kPlyFloat64, kPlyInvalid
+  };
+
+  struct PlyProperty
+  {
+	  std::string name;
+	  bool list;
+	  PlyType count_type;
+	  PlyType type;
+	  // position in x, y, z, s, t or -1
+	  int slot;
+  };
+
+  struct PlyElement
+  {
+	  std::string name;
+	  size_t count;
+	  std::vector< PlyProperty > properties;
+  };
+
+  static PlyType ply_type(const std::string &name) {
+	  if (name == "char" || name == "int8") return kPlyInt8;
+	  if (name == "uchar" || name == "uint8") return kPlyUint8;
+	  if (name == "short" || name == "int16") return kPlyInt16;
+	  if (name == "ushort" || name == "uint16") return kPlyUint16;
+	  if (name == "int" || name == "int32") return kPlyInt32;
+	  if (name == "uint" || name == "uint32") return kPlyUint32;
+	  if (name == "float" || name == "float32") return kPlyFloat32;
+	  if (name == "double" || name == "float64") return kPlyFloat64;
+	  return kPlyInvalid;
+  }
+
+  static int ply_slot(const std::string &name) {
+	  if (name == "x") return 0;
+	  if (name == "y") return 1;
+	  if (name == "z") return 2;
+	  if (name == "s" || name == "u" || name == "texture_u") return 3;
+	  if (name == "t" || name == "v" || name == "texture_v") return 4;
+	  return -1;
+  }
+
+  /** @brief Read the header of a binary_little_endian ply file.
+
+	  Read the header of a binary_little_endian ply file, until the line
+	  end_header (the stream is left on the first byte of the data).
+	  @return Return TRUE in case of success. FALSE otherwise.
+  */
+  static bool read_ply_header(std::istream &myfile,
+	  std::vector< PlyElement > &v_element) {
+	  std::string line;
+	  if (!std::getline(myfile, line) || line.compare(0, 3, "ply") != 0) {
+		  return false;
+	  }
+	  bool format = false;
+	  while (std::getline(myfile, line))
+	  {
+		  if (!line.empty() && line.back() == '\r') line.pop_back();
+		  std::istringstream ss(line);
+		  std::string keyword;
+		  ss >> keyword;
+		  if (keyword == "format") {
+			  std::string type;
+			  ss >> type;
+			  if (type != "binary_little_endian") return false;
+			  format = true;
+		  } else if (keyword == "element") {
+			  PlyElement element;
+			  if (!(ss >> element.name >> element.count)) return false;
+			  v_element.push_back(element);
+		  } else if (keyword == "property") {
+			  if (v_element.empty()) return false;
+			  PlyProperty prop;
+			  std::string type;
+			  ss >> type;
+			  prop.list = type == "list";
+			  prop.count_type = kPlyInvalid;
+			  if (prop.list) {
+				  std::string count_type;
+				  ss >> count_type >> type;
+				  prop.count_type = ply_type(count_type);
+				  if (prop.count_type == kPlyInvalid) return false;
+			  }
+			  prop.type = ply_type(type);
+			  if (prop.type == kPlyInvalid || !(ss >> prop.name)) return false;
+			  prop.slot = ply_slot(prop.name);
+			  v_element.back().properties.push_back(prop);
+		  } else if (keyword == "end_header") {
+			  return format;
+		  }
+		  // comment, obj_info
+	  }
+	  return false;
+  }
+
+  static size_t ply_type_size(PlyType type) {
+	  switch (type) {
+	  case kPlyInt8: case kPlyUint8: return 1;
+	  case kPlyInt16: case kPlyUint16: return 2;
+	  case kPlyInt32: case kPlyUint32: case kPlyFloat32: return 4;
+	  case kPlyFloat64: return 8;
+	  default: return 0;
+	  }
+  }
+
+  /** @brief Bytes of a record of the element with empty lists.
+  */
+  static size_t ply_min_record_size(const PlyElement &element) {
+	  size_t size = 0;
+	  for (auto it = element.properties.begin();
+		   it != element.properties.end(); it++)
+	  {
+		  size += ply_type_size(it->list ? it->count_type : it->type);
+	  }
+	  return size;
+  }
+
+  template <typename T>
+  static bool read_ply_value(const char* &p, const char *end, double &value) {
+	  if (static_cast<size_t>(end - p) < sizeof(T)) return false;
+	  T v;
+	  if (is_little_endian()) {
+		  memcpy(&v, p, sizeof(T));
+	  } else {
+		  char b[sizeof(T)];
+		  std::reverse_copy(p, p + sizeof(T), b);
+		  memcpy(&v, b, sizeof(T));
+	  }
+	  p += sizeof(T);
+	  value = static_cast<double>(v);
+	  return true;
+  }
+
+  /** @brief Read a value of the ply data and move p after it.
+  */
+  static bool read_ply_value(const char* &p, const char *end, PlyType type,
+	  double &value) {
+	  switch (type) {
+	  case kPlyInt8: return read_ply_value<int8_t>(p, end, value);
+	  case kPlyUint8: return read_ply_value<uint8_t>(p, end, value);
+	  case kPlyInt16: return read_ply_value<int16_t>(p, end, value);
+	  case kPlyUint16: return read_ply_value<uint16_t>(p, end, value);
+	  case kPlyInt32: return read_ply_value<int32_t>(p, end, value);
+	  case kPlyUint32: return read_ply_value<uint32_t>(p, end, value);
+	  case kPlyFloat32: return read_ply_value<float>(p, end, value);
+	  case kPlyFloat64: return read_ply_value<double>(p, end, value);
+	  default: return false;
+	  }
+  }
+
   /** @brief It contains the set of triangles that defines the mesh.
 			 A better container can be a multimap with the std::pair<int,int>
 			 as key, where the points are 2D bin position.
@@ -28,6 +28,7 @@
 #include <limits>       // std::numeric_limits
 #include <vector>
 #include <map>
+#include <memory>
 
 #include "cmnmathworld/inc/cmnmathworld/cmnmathworld_headers.hpp"
 
@@ -42,14 +43,24 @@ namespace computationalgeometry
 /** @brief Class to manage N dimension vertex.
 
 	Class to manage N dimension vertex.
+	The map allocator can be replaced, i.e. with
+	CmnLib::core::Allocator< std::pair<const INDEX, _Ty> > to take the nodes
+	from a CmnLib::core::MonotonicArena or NodePool reset at every frame.
 */
-template <typename _Ty>
+template <typename _Ty,
+	typename _Alloc = std::allocator< std::pair<const INDEX, _Ty> > >
 class VertexN
 {
 public:
 
+	typedef std::map< INDEX, _Ty, std::less<INDEX>, _Alloc > container_type;
+
 	VertexN() {}
 
+	/** @brief Construct with the allocator used by the container.
+	*/
+	explicit VertexN(const _Alloc &alloc) : data_(std::less<INDEX>(), alloc) {}
+
 	/** @brief Clear all the data.
 
 	Clear all the data.
@@ -94,7 +105,7 @@ public:
 
 	Get the structure.
 	*/
-	std::map< INDEX, _Ty >& data() {
+	container_type& data() {
 		return data_;
 	}
 
@@ -102,7 +113,7 @@ public:
 
 	Get the structure pointer.
 	*/
-	std::map< INDEX, _Ty >* pt_data() {
+	container_type* pt_data() {
 		return &data_;
 	}
 
@@ -110,7 +121,7 @@ public:
 
 	Get the structure pointer.
 	*/
-	const std::map< INDEX, _Ty >* pt_data() const{
+	const container_type* pt_data() const{
 		return &data_;
 	}
 
@@ -119,7 +130,7 @@ public:
 
 	Set the structure.
 	*/
-	void set_data(const std::map< INDEX, _Ty > &data) {
+	void set_data(const container_type &data) {
 		data_ = data;
 	}
 
@@ -213,7 +224,7 @@ private:
 	first_second_second: z coordinate
 	second: univoque index name
 	*/
-	std::map< INDEX, _Ty > data_;
+	container_type data_;
 };
 
 
@@ -32,6 +32,8 @@
 #include "GteHyperplane.h"
 #include "GtePrimalQuery3.h"
 #include "GteETManifoldMesh.h"
+#include "system/inc/system/thread_pool.hpp"
+#include <algorithm>
 #include <functional>
 #include <set>
 #include <thread>
@@ -328,37 +330,20 @@ void ConvexHull3<InputType, ComputeType>::Update(int i)
     std::vector<int> queryResult(numFaces);
     if (mNumThreads > 1 && numFaces >= mNumThreads)
     {
-        // Partition the data for multiple threads.
-        unsigned int numFacesPerThread = numFaces / mNumThreads;
-        std::vector<unsigned int> jmin(mNumThreads), jmax(mNumThreads);
-        for (unsigned int t = 0; t < mNumThreads; ++t)
+        // Execute the point-plane queries in the shared thread pool.  The
+        // faces are split in more ranges than threads so that the idle
+        // workers can steal the remaining ones.
+        size_t grain = std::max<size_t>(1, numFaces / (4 * mNumThreads));
+        CmnLib::system::parallel_for(0, numFaces, grain,
+            [this, i, &queryResult](size_t jmin, size_t jmax)
         {
-            jmin[t] = t * numFacesPerThread;
-            jmax[t] = jmin[t] + numFacesPerThread - 1;
-        }
-        jmax[mNumThreads - 1] = numFaces - 1;
-
-        // Execute the point-plane queries in multiple threads.
-        std::vector<std::thread> process(mNumThreads);
-        for (unsigned int t = 0; t < mNumThreads; ++t)
-        {
-            process[t] = std::thread([this, i, t, &jmin, &jmax, 
-                &queryResult]()
+            for (size_t j = jmin; j < jmax; ++j)
             {
-                for (unsigned int j = jmin[t]; j <= jmax[t]; ++j)
-                {
-                    TriangleKey<true> const& tri = mHullUnordered[j];
-                    queryResult[j] =
-                        mQuery.ToPlane(i, tri.V[0], tri.V[1], tri.V[2]);
-                }
-            });
-        }
-
-        // Wait for all threads to finish.
-        for (unsigned int t = 0; t < mNumThreads; ++t)
-        {
-            process[t].join();
-        }
+                TriangleKey<true> const& tri = mHullUnordered[j];
+                queryResult[j] =
+                    mQuery.ToPlane(i, tri.V[0], tri.V[1], tri.V[2]);
+            }
+        });
     }
     else
     {
@@ -11,6 +11,8 @@
 #include "GteConvexHull3.h"
 #include "GteMinimumAreaBox2.h"
 #include "GteEdgeKey.h"
+#include "system/inc/system/thread_pool.hpp"
+#include <algorithm>
 #include <thread>
 #include <type_traits>
 
@@ -440,45 +442,41 @@ void MinimumVolumeBox3<InputType, ComputeType>::ProcessFaces(
             triangles.push_back(element.second);
         }
 
-        // Partition the data for multiple threads.
-        unsigned int numFacesPerThread = numFaces / mNumThreads;
-        std::vector<unsigned int> imin(mNumThreads), imax(mNumThreads);
-        std::vector<Box> localMinBox(mNumThreads);
-        for (unsigned int t = 0; t < mNumThreads; ++t)
+        // Process the faces in the shared thread pool, each range of faces
+        // computes its own candidate.  The candidates are merged in the
+        // order of the ranges, so the result does not depend on the
+        // scheduling.
+        Box identity;
+        identity.volume = mNegOne;
+        size_t grain = std::max<size_t>(1, numFaces / (4 * mNumThreads));
+        Box localMinBox = CmnLib::system::parallel_reduce(0, numFaces, grain,
+            identity,
+            [this, &triangles, &normal, &triNormalMap, &emap](size_t imin,
+                size_t imax, Box box)
         {
-            imin[t] = t * numFacesPerThread;
-            imax[t] = imin[t] + numFacesPerThread - 1;
-            localMinBox[t].volume = mNegOne;
-        }
-        imax[mNumThreads - 1] = numFaces - 1;
-
-        // Execute the face processing in multiple threads.
-        std::vector<std::thread> process(mNumThreads);
-        for (unsigned int t = 0; t < mNumThreads; ++t)
-        {
-            process[t] = std::thread([this, t, &imin, &imax, &triangles,
-                &normal, &triNormalMap, &emap, &localMinBox]()
+            for (size_t i = imin; i < imax; ++i)
             {
-                for (unsigned int i = imin[t]; i <= imax[t]; ++i)
-                {
-                    auto const* supportTri = triangles[i];
-                    ProcessFace(supportTri, normal, triNormalMap, emap,
-                        localMinBox[t]);
-                }
-            });
-        }
-
-        // Wait for all threads to finish.
-        for (unsigned int t = 0; t < mNumThreads; ++t)
+                auto const* supportTri = triangles[i];
+                ProcessFace(supportTri, normal, triNormalMap, emap, box);
+            }
+            return box;
+        },
+            [this](Box const& box0, Box const& box1)
         {
-            process[t].join();
-
-            // Update the minimum-volume box candidate.
-            if (mMinBox.volume == mNegOne
-                || localMinBox[t].volume < mMinBox.volume)
+            if (box0.volume == mNegOne
+                || (box1.volume != mNegOne && box1.volume < box0.volume))
             {
-                mMinBox = localMinBox[t];
+                return box1;
             }
+            return box0;
+        });
+
+        // Update the minimum-volume box candidate.
+        if (localMinBox.volume != mNegOne
+            && (mMinBox.volume == mNegOne
+            || localMinBox.volume < mMinBox.volume))
+        {
+            mMinBox = localMinBox;
         }
     }
     else
@@ -10,27 +10,39 @@
 #include "GTEngineDEF.h"
 #include "GteEdgeKey.h"
 #include "GteTriangleKey.h"
+#include "GteLogger.h"
+#include <fstream>
 #include <map>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace gte
 {
 
-class GTE_IMPEXP ETManifoldMesh
+// The Allocator of the edge and triangle maps can be replaced, for example
+// with CmnLib::core::Allocator to take the map nodes from a
+// CmnLib::core::MonotonicArena or NodePool reset at every frame.  The
+// ETManifoldMesh typedef uses std::allocator.
+template <template <typename> class Allocator = std::allocator>
+class ETManifoldMeshT
 {
 public:
     // Edge data types.
     class Edge;
     typedef Edge* (*ECreator)(int, int);
-    typedef std::map<EdgeKey<false>, Edge*> EMap;
+    typedef std::map<EdgeKey<false>, Edge*, std::less<EdgeKey<false>>,
+        Allocator<std::pair<EdgeKey<false> const, Edge*>>> EMap;
 
     // Triangle data types.
     class Triangle;
     typedef Triangle* (*TCreator)(int, int, int);
-    typedef std::map<TriangleKey<true>, Triangle*> TMap;
+    typedef std::map<TriangleKey<true>, Triangle*,
+        std::less<TriangleKey<true>>,
+        Allocator<std::pair<TriangleKey<true> const, Triangle*>>> TMap;
 
     // Edge object.
-    class GTE_IMPEXP Edge
+    class Edge
     {
     public:
         virtual ~Edge();
@@ -44,7 +56,7 @@ public:
     };
 
     // Triangle object.
-    class GTE_IMPEXP Triangle
+    class Triangle
     {
     public:
         virtual ~Triangle();
@@ -62,17 +74,19 @@ public:
     };
 
 
-    // Construction and destruction.
-    virtual ~ETManifoldMesh();
-    ETManifoldMesh(ECreator eCreator = nullptr, TCreator tCreator = nullptr);
+    // Construction and destruction.  The maps use a copy of 'allocator',
+    // whose memory must outlive the mesh.
+    virtual ~ETManifoldMeshT();
+    ETManifoldMeshT(ECreator eCreator = nullptr, TCreator tCreator = nullptr,
+        Allocator<char> const& allocator = Allocator<char>());
 
     // Support for a deep copy of the mesh.  The mEMap and mTMap objects have
     // dynamically allocated memory for edges and triangles.  A shallow copy
     // of the pointers to this memory is problematic.  Allowing sharing, say,
     // via std::shared_ptr, is an option but not really the intent of copying
-    // the mesh graph.
-    ETManifoldMesh(ETManifoldMesh const& mesh);
-    ETManifoldMesh& operator=(ETManifoldMesh const& mesh);
+    // the mesh graph.  The copy uses the allocator of 'mesh'.
+    ETManifoldMeshT(ETManifoldMeshT const& mesh);
+    ETManifoldMeshT& operator=(ETManifoldMeshT const& mesh);
 
     // Member access.
     EMap const& GetEdges() const;
@@ -147,4 +161,535 @@ protected:
         std::vector<Triangle const*>& component) const;
 };
 
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+ETManifoldMeshT<Allocator>::~ETManifoldMeshT()
+{
+    for (auto& element : mEMap)
+    {
+        delete element.second;
+    }
+
+    for (auto& element : mTMap)
+    {
+        delete element.second;
+    }
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+ETManifoldMeshT<Allocator>::ETManifoldMeshT(ECreator eCreator,
+    TCreator tCreator, Allocator<char> const& allocator)
+    :
+    mECreator(eCreator ? eCreator : CreateEdge),
+    mEMap(std::less<EdgeKey<false>>(), allocator),
+    mTCreator(tCreator ? tCreator : CreateTriangle),
+    mTMap(std::less<TriangleKey<true>>(), allocator),
+    mAssertOnNonmanifoldInsertion(true)
+{
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+ETManifoldMeshT<Allocator>::ETManifoldMeshT(
+    ETManifoldMeshT<Allocator> const& mesh)
+    :
+    mEMap(std::less<EdgeKey<false>>(), mesh.mEMap.get_allocator()),
+    mTMap(std::less<TriangleKey<true>>(), mesh.mTMap.get_allocator())
+{
+    *this = mesh;
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+ETManifoldMeshT<Allocator>& ETManifoldMeshT<Allocator>::operator=(
+    ETManifoldMeshT<Allocator> const& mesh)
+{
+    Clear();
+
+    mECreator = mesh.mECreator;
+    mTCreator = mesh.mTCreator;
+    mAssertOnNonmanifoldInsertion = mesh.mAssertOnNonmanifoldInsertion;
+    for (auto const& element : mesh.mTMap)
+    {
+        Insert(element.first.V[0], element.first.V[1], element.first.V[2]);
+    }
+
+    return *this;
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+typename ETManifoldMeshT<Allocator>::EMap const&
+ETManifoldMeshT<Allocator>::GetEdges() const
+{
+    return mEMap;
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+typename ETManifoldMeshT<Allocator>::TMap const&
+ETManifoldMeshT<Allocator>::GetTriangles() const
+{
+    return mTMap;
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+typename ETManifoldMeshT<Allocator>::Edge*
+ETManifoldMeshT<Allocator>::CreateEdge(int v0, int v1)
+{
+    return new Edge(v0, v1);
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+typename ETManifoldMeshT<Allocator>::Triangle*
+ETManifoldMeshT<Allocator>::CreateTriangle(int v0, int v1, int v2)
+{
+    return new Triangle(v0, v1, v2);
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+void ETManifoldMeshT<Allocator>::AssertOnNonmanifoldInsertion(bool doAssert)
+{
+    mAssertOnNonmanifoldInsertion = doAssert;
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+typename ETManifoldMeshT<Allocator>::Triangle*
+ETManifoldMeshT<Allocator>::Insert(int v0, int v1, int v2)
+{
+    TriangleKey<true> tkey(v0, v1, v2);
+    if (mTMap.find(tkey) != mTMap.end())
+    {
+        // The triangle already exists.  Return a null pointer as a signal to
+        // the caller that the insertion failed.
+        return nullptr;
+    }
+
+    // Add the new triangle.
+    Triangle* tri = mTCreator(v0, v1, v2);
+    mTMap[tkey] = tri;
+
+    // Add the edges to the mesh if they do not already exist.
+    for (int i0 = 2, i1 = 0; i1 < 3; i0 = i1++)
+    {
+        EdgeKey<false> ekey(tri->V[i0], tri->V[i1]);
+        Edge* edge;
+        auto eiter = mEMap.find(ekey);
+        if (eiter == mEMap.end())
+        {
+            // This is the first time the edge is encountered.
+            edge = mECreator(tri->V[i0], tri->V[i1]);
+            mEMap[ekey] = edge;
+
+            // Update the edge and triangle.
+            edge->T[0] = tri;
+            tri->E[i0] = edge;
+        }
+        else
+        {
+            // This is the second time the edge is encountered.
+            edge = eiter->second;
+            if (!edge)
+            {
+                LogError("Unexpected condition.");
+                return nullptr;
+            }
+
+            // Update the edge.
+            if (edge->T[1])
+            {
+                if (mAssertOnNonmanifoldInsertion)
+                {
+                    LogInformation("The mesh must be manifold.");
+                }
+                return nullptr;
+            }
+            edge->T[1] = tri;
+
+            // Update the adjacent triangles.
+            Triangle* adjacent = edge->T[0];
+            if (!adjacent)
+            {
+                LogError("Unexpected condition.");
+                return nullptr;
+            }
+            for (int j = 0; j < 3; ++j)
+            {
+                if (adjacent->E[j] == edge)
+                {
+                    adjacent->T[j] = tri;
+                    break;
+                }
+            }
+
+            // Update the triangle.
+            tri->E[i0] = edge;
+            tri->T[i0] = adjacent;
+        }
+    }
+
+    return tri;
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+bool ETManifoldMeshT<Allocator>::Remove(int v0, int v1, int v2)
+{
+    TriangleKey<true> tkey(v0, v1, v2);
+    auto titer = mTMap.find(tkey);
+    if (titer == mTMap.end())
+    {
+        // The triangle does not exist.
+        return false;
+    }
+
+    // Get the triangle.
+    Triangle* tri = titer->second;
+
+    // Remove the edges and update adjacent triangles if necessary.
+    for (int i = 0; i < 3; ++i)
+    {
+        // Inform the edges the triangle is being deleted.
+        Edge* edge = tri->E[i];
+        if (!edge)
+        {
+            // The triangle edge should be nonnull.
+            LogError("Unexpected condition.");
+            return false;
+        }
+
+        if (edge->T[0] == tri)
+        {
+            // One-triangle edges always have pointer at index zero.
+            edge->T[0] = edge->T[1];
+            edge->T[1] = nullptr;
+        }
+        else if (edge->T[1] == tri)
+        {
+            edge->T[1] = nullptr;
+        }
+        else
+        {
+            LogError("Unexpected condition.");
+            return false;
+        }
+
+        // Remove the edge if you have the last reference to it.
+        if (!edge->T[0] && !edge->T[1])
+        {
+            EdgeKey<false> ekey(edge->V[0], edge->V[1]);
+            mEMap.erase(ekey);
+            delete edge;
+        }
+
+        // Inform adjacent triangles the triangle is being deleted.
+        Triangle* adjacent = tri->T[i];
+        if (adjacent)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                if (adjacent->T[j] == tri)
+                {
+                    adjacent->T[j] = nullptr;
+                    break;
+                }
+            }
+        }
+    }
+
+    mTMap.erase(tkey);
+    delete tri;
+    return true;
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+void ETManifoldMeshT<Allocator>::Clear()
+{
+    for (auto& element : mEMap)
+    {
+        delete element.second;
+    }
+
+    for (auto& element : mTMap)
+    {
+        delete element.second;
+    }
+
+    mEMap.clear();
+    mTMap.clear();
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+bool ETManifoldMeshT<Allocator>::IsClosed() const
+{
+    for (auto const& element : mEMap)
+    {
+        Edge const* edge = element.second;
+        if (!edge->T[0] || !edge->T[1])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+bool ETManifoldMeshT<Allocator>::IsOriented() const
+{
+    for (auto const& element : mEMap)
+    {
+        Edge const* edge = element.second;
+        if (edge->T[0] && edge->T[1])
+        {
+            // In each triangle, find the ordered edge that corresponds to the
+            // unordered edge element.first.  Also find the vertex opposite
+            // that edge.
+            bool edgePositive[2] = { false, false };
+            int vOpposite[2] = { -1, -1 };
+            for (int j = 0; j < 2; ++j)
+            {
+                for (int i = 0; i < 3; ++i)
+                {
+                    if (edge->T[j]->V[i] == element.first.V[0])
+                    {
+                        int vNext = edge->T[j]->V[(i + 1) % 3];
+                        if (vNext == element.first.V[1])
+                        {
+                            edgePositive[j] = true;
+                            vOpposite[j] = edge->T[j]->V[(i + 2) % 3];
+                        }
+                        else
+                        {
+                            edgePositive[j] = false;
+                            vOpposite[j] = vNext;
+                        }
+                        break;
+                    }
+                }
+            }
+
+            // To be oriented consistently, the edges must have reversed
+            // ordering and the oppositive vertices cannot match.
+            if (edgePositive[0] == edgePositive[1]
+                || vOpposite[0] == vOpposite[1])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+void ETManifoldMeshT<Allocator>::GetComponents(
+    std::vector<std::vector<Triangle const*>>& components) const
+{
+    // visited: 0 (unvisited), 1 (discovered), 2 (finished)
+    std::map<Triangle const*, int> visited;
+    for (auto const& element : mTMap)
+    {
+        visited.insert(std::make_pair(element.second, 0));
+    }
+
+    for (auto& element : mTMap)
+    {
+        Triangle const* tri = element.second;
+        if (visited[tri] == 0)
+        {
+            std::vector<Triangle const*> component;
+            DepthFirstSearch(tri, visited, component);
+            components.push_back(component);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+void ETManifoldMeshT<Allocator>::GetComponents(
+    std::vector<std::vector<TriangleKey<true>>>& components) const
+{
+    // visited: 0 (unvisited), 1 (discovered), 2 (finished)
+    std::map<Triangle const*, int> visited;
+    for (auto const& element : mTMap)
+    {
+        visited.insert(std::make_pair(element.second, 0));
+    }
+
+    for (auto& element : mTMap)
+    {
+        Triangle const* tri = element.second;
+        if (visited[tri] == 0)
+        {
+            std::vector<Triangle const*> component;
+            DepthFirstSearch(tri, visited, component);
+
+            std::vector<TriangleKey<true>> keyComponent;
+            keyComponent.reserve(component.size());
+            for (auto const* tri : component)
+            {
+                keyComponent.push_back(
+                    TriangleKey<true>(tri->V[0], tri->V[1], tri->V[2]));
+            }
+            components.push_back(keyComponent);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+bool ETManifoldMeshT<Allocator>::Print(std::string const& filename)
+{
+    std::ofstream outFile(filename);
+    if (!outFile)
+    {
+        return false;
+    }
+
+    // Assign unique indices to the edges.
+    std::map<Edge*,int> edgeIndex;
+    edgeIndex[nullptr] = 0;
+    int i = 1;
+    for (auto const& element : mEMap)
+    {
+        if (element.second)
+        {
+            edgeIndex[element.second] = i++;
+        }
+    }
+
+    // Assign unique indices to the triangles.
+    std::map<Triangle*,int> triIndex;
+    triIndex[nullptr] = 0;
+    i = 1;
+    for (auto const& element : mTMap)
+    {
+        if (element.second)
+        {
+            triIndex[element.second] = i++;
+        }
+    }
+
+    // Print the edges.
+    outFile << "edge quantity = " << mEMap.size() << std::endl;
+    for (auto const& element : mEMap)
+    {
+        Edge const& edge = *element.second;
+        outFile << 'e' << edgeIndex[element.second] << " <"
+              << 'v' << edge.V[0] << ",v" << edge.V[1] << "; ";
+        for (int j = 0; j < 2; ++j)
+        {
+            if (edge.T[j])
+            {
+                outFile << 't' << triIndex[edge.T[0]];
+            }
+            else
+            {
+                outFile << '*';
+            }
+            outFile << (j == 0 ? ',' : '>');
+        }
+        outFile << std::endl;
+    }
+    outFile << std::endl;
+
+    // Print the triangles.
+    outFile << "triangle quantity = " << mTMap.size() << std::endl;
+    for (auto const& element : mTMap)
+    {
+        Triangle const& tri = *element.second;
+        outFile << 't' << triIndex[element.second] << " <"
+              << 'v' << tri.V[0] << ",v" << tri.V[1] << ",v"
+              << tri.V[2] << "; ";
+        for (int j = 0; j < 3; ++j)
+        {
+            if (tri.E[j])
+            {
+                outFile << 'e' << edgeIndex[tri.E[j]];
+            }
+            else
+            {
+                outFile << '*';
+            }
+            outFile << (j < 2 ? "," : "; ");
+        }
+
+        for (int j = 0; j < 3; ++j)
+        {
+            if (tri.T[j])
+            {
+                outFile << 't' << triIndex[tri.T[j]];
+            }
+            else
+            {
+                outFile << '*';
+            }
+            outFile << (j < 2 ? ',' : '>');
+        }
+        outFile << std::endl;
+    }
+    outFile << std::endl;
+    return true;
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+void ETManifoldMeshT<Allocator>::DepthFirstSearch(Triangle const* tInitial,
+    std::map<Triangle const*, int>& visited,
+    std::vector<Triangle const*>& component) const
+{
+    // Allocate the maximum-size stack that can occur in the depth-first
+    // search.  The stack is empty when the index top is -1.
+    std::vector<Triangle const*> tStack(mTMap.size());
+    int top = -1;
+    tStack[++top] = tInitial;
+    while (top >= 0)
+    {
+        Triangle const* tri = tStack[top];
+        visited[tri] = 1;
+        int i;
+        for (i = 0; i < 3; ++i)
+        {
+            Triangle const* adj = tri->T[i];
+            if (adj && visited[adj] == 0)
+            {
+                tStack[++top] = adj;
+                break;
+            }
+        }
+        if (i == 3)
+        {
+            visited[tri] = 2;
+            component.push_back(tri);
+            --top;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+ETManifoldMeshT<Allocator>::Edge::~Edge()
+{
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+ETManifoldMeshT<Allocator>::Edge::Edge(int v0, int v1)
+{
+    V[0] = v0;
+    V[1] = v1;
+    T[0] = nullptr;
+    T[1] = nullptr;
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+ETManifoldMeshT<Allocator>::Triangle::~Triangle()
+{
+}
+//----------------------------------------------------------------------------
+template <template <typename> class Allocator> inline
+ETManifoldMeshT<Allocator>::Triangle::Triangle(int v0, int v1, int v2)
+{
+    V[0] = v0;
+    V[1] = v1;
+    V[2] = v2;
+    for (int i = 0; i < 3; ++i)
+    {
+        E[i] = nullptr;
+        T[i] = nullptr;
+    }
+}
+//----------------------------------------------------------------------------
+
+typedef ETManifoldMeshT<> ETManifoldMesh;
+
 }
@@ -21,8 +21,12 @@
 *
 */
 
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <string>
+#include <vector>
 
 #include "computationalgeometry/inc/computationalgeometry/computationalgeometry_headers.hpp"
 
@@ -94,6 +98,61 @@ void test()
 	}
 }
 
+/** @brief Save a textured mesh in binary ply, load it and save it again.
+*/
+void test_mesh3d_ply()
+{
+	typedef CmnCS::computationalgeometry::Mesh3D<cv::Point2f, cv::Point3f>
+		Mesh3D;
+	const int kSize = 50;
+	Mesh3D mesh3d;
+	for (int y = 0; y < kSize; y++)
+	{
+		for (int x = 0; x < kSize; x++)
+		{
+			std::vector<cv::Point3f> v_structure = {
+				cv::Point3f(x * 0.1f, y * 0.1f, -1.0f - x * 0.01f),
+				cv::Point3f((x + 1) * 0.1f, y * 0.1f, -1.0f - (x + 1) * 0.01f),
+				cv::Point3f(x * 0.1f, (y + 1) * 0.1f, -1.0f - x * 0.01f) };
+			std::vector<cv::Point2f> v_texture = {
+				cv::Point2f(x / (float)kSize, y / (float)kSize),
+				cv::Point2f((x + 1) / (float)kSize, y / (float)kSize),
+				cv::Point2f(x / (float)kSize, (y + 1) / (float)kSize) };
+			mesh3d.add(v_structure, v_texture);
+		}
+	}
+	Mesh3D loaded;
+	bool ok = mesh3d.save_ply("mesh3d.ply", true, true) &&
+		loaded.load_ply("mesh3d.ply") &&
+		loaded.save_ply("mesh3d_loaded.ply", true, true);
+	std::ifstream f0("mesh3d.ply", std::ios::binary),
+		f1("mesh3d_loaded.ply", std::ios::binary);
+	std::string s0((std::istreambuf_iterator<char>(f0)),
+		std::istreambuf_iterator<char>());
+	std::string s1((std::istreambuf_iterator<char>(f1)),
+		std::istreambuf_iterator<char>());
+	f0.close();
+	f1.close();
+	std::cout << "Mesh3D ply triangles: " << loaded.size() << "/" <<
+		mesh3d.size() << " same file: " << (ok && s0 == s1) << std::endl;
+
+	// a header with a count larger than the file is rejected
+	std::ofstream bad("mesh3d_bad.ply", std::ios::binary);
+	bad << "ply\nformat binary_little_endian 1.0\n"
+		"element vertex 4000000000000000000\nproperty float32 x\n"
+		"property float32 y\nproperty float32 z\nelement face 1\n"
+		"property list uint8 int32 vertex_indices\nend_header\n";
+	bad.write("\0\0\0\0\0\0\0\0\0\0\0\0", 12);
+	bad.close();
+	bool rejected = !loaded.load_ply("mesh3d_bad.ply");
+	std::cout << "Mesh3D ply malformed rejected: " << rejected <<
+		" triangles kept: " << loaded.size() << std::endl;
+
+	std::remove("mesh3d.ply");
+	std::remove("mesh3d_loaded.ply");
+	std::remove("mesh3d_bad.ply");
+}
+
 } // namespace anonymous
 
 // ############################################################################
@@ -101,6 +160,7 @@ void test()
 int main(int argc, char* argv[])
 {
 	std::cout << "Sample ComputationalGeometry" << std::endl;
+	test_mesh3d_ply();
 	test();
 	
 	return 0;
@@ -0,0 +1,287 @@
+/**
+* @file ChunkedTextParser.hpp
+* @brief Parallel parser of the line based text files.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @original author Alessandro Moro
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef CMNIO_FILESIO_CHUNKEDTEXTPARSER_HPP__
+#define CMNIO_FILESIO_CHUNKEDTEXTPARSER_HPP__
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "string/inc/string/NumberConversion.hpp"
+#include "system/inc/system/mapped_file.hpp"
+#include "system/inc/system/thread_pool.hpp"
+
+namespace CmnIO
+{
+namespace filesio
+{
+
+
+/** @brief Parse the lines of a text file in parallel.
+
+	The file is mapped and, after the header lines, split in chunks of
+	about chunk_size bytes which end at a new line. The chunks are parsed
+	by the shared thread pool, a batch at a time, and the records are
+	given back in the order of the file.
+	@code
+		std::vector<std::pair<int, float> > values;
+		CmnIO::filesio::ChunkedTextParser::parse(filename, 2,
+			[](const char* first, const char* last,
+				std::pair<int, float> &r) {
+			double v[2];
+			if (CmnIO::filesio::ChunkedTextParser::parse_values(first, last,
+				v, 2) != 2) return false;
+			r = std::make_pair((int)v[0], (float)v[1]);
+			return true;
+		}, values);
+	@endcode
+*/
+class ChunkedTextParser
+{
+  public:
+
+	  static size_t kDefaultChunkSize() { return (size_t)1 << 20; }
+
+	  /** @brief Parse the lines of a file and pass the records in order.
+
+	  @param[in] filename The text file.
+	  @param[in] skip_lines Number of header lines, not parsed.
+	  @param[in] parse_line bool(const char* first, const char* last,
+	    Record &record): parse a not empty line (without the end of line)
+	    and return true if the record is valid. It is called by several
+	    threads at the same time.
+	  @param[in] consume void(Record &record): called for every valid
+	    record in the order of the file, by the calling thread.
+	  @param[out] header If not null, the header lines.
+	  @param[in] chunk_size Bytes of text parsed by a task.
+	  @param[in] pool The threads which parse the chunks.
+	  @return False if the file cannot be opened.
+	  */
+	  template <typename Record, typename ParseLine, typename Consume>
+	  static bool for_each(const std::string &filename, size_t skip_lines,
+		  const ParseLine &parse_line, const Consume &consume,
+		  std::vector<std::string>* header = nullptr,
+		  size_t chunk_size = kDefaultChunkSize(),
+		  CmnLib::system::ThreadPool &pool =
+		  CmnLib::system::ThreadPool::Instance())
+	  {
+		  CmnLib::system::MappedFile f;
+		  if (!f.open(filename)) return false;
+		  const char* first = f.data();
+		  const char* last = first + f.size();
+		  for (size_t i = 0; i < skip_lines && first < last; ++i)
+		  {
+			  const char* e = end_of_line(first, last);
+			  if (header) header->push_back(std::string(first,
+				  trim_cr(first, e)));
+			  first = e < last ? e + 1 : last;
+		  }
+
+		  // Chunks which end after a new line
+		  chunk_size = std::max<size_t>(chunk_size, 1);
+		  std::vector<const char*> bounds(1, first);
+		  while (bounds.back() < last)
+		  {
+			  const char* p = bounds.back();
+			  if ((size_t)(last - p) <= chunk_size)
+			  {
+				  bounds.push_back(last);
+				  break;
+			  }
+			  const char* e = end_of_line(p + chunk_size - 1, last);
+			  bounds.push_back(e < last ? e + 1 : last);
+		  }
+		  size_t num_chunks = bounds.size() - 1;
+
+		  // The records of a batch of chunks are kept in memory
+		  size_t batch = 4 * (pool.size() + 1);
+		  std::vector<std::vector<Record> > records(std::min(batch,
+			  num_chunks));
+		  for (size_t b = 0; b < num_chunks; b += batch)
+		  {
+			  size_t n = std::min(batch, num_chunks - b);
+			  CmnLib::system::parallel_for(0, n, 1,
+				  [&](size_t begin, size_t end) {
+				  for (size_t c = begin; c < end; ++c)
+				  {
+					  records[c].clear();
+					  parse_chunk(bounds[b + c], bounds[b + c + 1],
+						  parse_line, records[c]);
+				  }
+			  }, pool);
+			  for (size_t c = 0; c < n; ++c)
+			  {
+				  for (auto &r : records[c]) consume(r);
+			  }
+		  }
+		  return true;
+	  }
+
+	  /** @brief Parse the lines of a file and append the records in order.
+
+	  @see for_each
+	  */
+	  template <typename Record, typename ParseLine>
+	  static bool parse(const std::string &filename, size_t skip_lines,
+		  const ParseLine &parse_line, std::vector<Record> &records,
+		  std::vector<std::string>* header = nullptr,
+		  size_t chunk_size = kDefaultChunkSize(),
+		  CmnLib::system::ThreadPool &pool =
+		  CmnLib::system::ThreadPool::Instance())
+	  {
+		  return for_each<Record>(filename, skip_lines, parse_line,
+			  [&records](Record &r) { records.push_back(std::move(r)); },
+			  header, chunk_size, pool);
+	  }
+
+	  /** @brief Parse up to n numbers separated by spaces or tabs at the
+	  beginning of [first, last).
+
+	  @return The number of values parsed: the parsing stops at the first
+	    token which is not a number.
+	  */
+	  template <typename T>
+	  static int parse_values(const char* first, const char* last, T* values,
+		  int n)
+	  {
+		  const char* p = first;
+		  for (int i = 0; i < n; ++i)
+		  {
+			  while (p < last && (*p == ' ' || *p == '\t')) ++p;
+			  CmnLib::text::NumberConversion::ParseResult r =
+				  CmnLib::text::NumberConversion::parse(p, last, values[i]);
+			  if (r.error != CmnLib::text::NumberConversion::CONVERSION_OK)
+			  {
+				  return i;
+			  }
+			  p = r.ptr;
+		  }
+		  return n;
+	  }
+
+	  /** @brief Parse a line as sscanf(line, "%i .. %i %f .. %f") with
+	  num_ids integers and num_values floats, the format of the readers.
+
+	  The lines of at most 3 chars are skipped, as the readers did. The
+	  integers are read as %i (base 16 with 0x, base 8 with a leading 0)
+	  and the floats directly as float. The fields after the first token
+	  which is not a number are not changed.
+	  @return False for a short line or if the first field is not a number.
+	  */
+	  static bool parse_fields(const char* first, const char* last, int* ids,
+		  int num_ids, float* values, int num_values)
+	  {
+		  if (last - first <= 3) return false;
+		  const char* p = first;
+		  for (int i = 0; i < num_ids; ++i)
+		  {
+			  while (p < last && (*p == ' ' || *p == '\t')) ++p;
+			  if (!parse_int(p, last, ids[i])) return i > 0;
+		  }
+		  return parse_values(p, last, values, num_values) > 0 ||
+			  num_ids > 0;
+	  }
+
+	  /** @brief Parse an integer as %i: [sign] digits in base 10, 0x hex
+	  digits in base 16, 0 octal digits in base 8.
+
+	  @param[in,out] p The first char, moved after the integer.
+	  @return False (p not moved) if there is no integer.
+	  */
+	  static bool parse_int(const char* &p, const char* last, int &value)
+	  {
+		  const char* q = p;
+		  bool negative = false;
+		  if (q < last && (*q == '-' || *q == '+')) negative = *q++ == '-';
+		  unsigned int base = 10;
+		  if (q < last && *q == '0')
+		  {
+			  base = 8;
+			  if (last - q > 2 && (q[1] == 'x' || q[1] == 'X') &&
+				  digit(q[2], 16) < 16)
+			  {
+				  base = 16;
+				  q += 2;
+			  }
+		  }
+		  if (q == last || digit(*q, base) >= base) return false;
+		  // modulo 2^32 as the int stored by sscanf
+		  unsigned int v = 0;
+		  for (; q < last && digit(*q, base) < base; ++q)
+		  {
+			  v = v * base + digit(*q, base);
+		  }
+		  value = (int)(negative ? 0 - v : v);
+		  p = q;
+		  return true;
+	  }
+
+  private:
+
+	  /** @brief Value of the digit c, or base if it is not a digit.
+	  */
+	  static unsigned int digit(char c, unsigned int base)
+	  {
+		  unsigned int d = base;
+		  if (c >= '0' && c <= '9') d = (unsigned int)(c - '0');
+		  else if (c >= 'a' && c <= 'f') d = (unsigned int)(c - 'a' + 10);
+		  else if (c >= 'A' && c <= 'F') d = (unsigned int)(c - 'A' + 10);
+		  return d < base ? d : base;
+	  }
+
+	  static const char* end_of_line(const char* p, const char* last)
+	  {
+		  const char* e = (const char*)memchr(p, '\n', last - p);
+		  return e ? e : last;
+	  }
+
+	  static const char* trim_cr(const char* first, const char* e)
+	  {
+		  return e > first && e[-1] == '\r' ? e - 1 : e;
+	  }
+
+	  template <typename Record, typename ParseLine>
+	  static void parse_chunk(const char* first, const char* last,
+		  const ParseLine &parse_line, std::vector<Record> &records)
+	  {
+		  Record r;
+		  while (first < last)
+		  {
+			  const char* e = end_of_line(first, last);
+			  const char* line_end = trim_cr(first, e);
+			  if (line_end > first && parse_line(first, line_end, r))
+			  {
+				  records.push_back(r);
+			  }
+			  first = e < last ? e + 1 : last;
+		  }
+	  }
+};
+
+} // namespace filesio
+} // namespace CmnIO
+
+
+#endif // CMNIO_FILESIO_CHUNKEDTEXTPARSER_HPP__
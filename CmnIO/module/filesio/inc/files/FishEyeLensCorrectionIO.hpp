@@ -3,6 +3,10 @@
 
 #include <fstream>
 #include <iostream>
+#include <utility>
+
+#include "ChunkedTextParser.hpp"
+#include "TextWriter.hpp"
 
 namespace CmnIO
 {
@@ -29,21 +33,19 @@ public:
 	static bool save_cam_keys_correction(const std::string &filename,
 		std::vector< std::map< int, std::pair<float, float> > >  &corrections)
 	{
-		std::ofstream f(filename);
-		if (!f.is_open()) return false;
+		TextWriter f;
+		if (!f.open(filename)) return false;
 
-		f << "FishEye AzimuthCorrection v001" << std::endl;
-		f << "id angle_on_lens correction_value" << std::endl;
+		f << "FishEye AzimuthCorrection v001" << '\n';
+		f << "id angle_on_lens correction_value" << '\n';
 		for (auto it : corrections)
 		{
 			for (auto it2 : it)
 			{
-				f << it2.first << " " << it2.second.first << " " << it2.second.second << std::endl;
+				f << it2.first << " " << it2.second.first << " " << it2.second.second << '\n';
 			}
 		}
-		f.close();
-		f.clear();
-		return true;
+		return f.close();
 	}
 
 
@@ -56,28 +58,22 @@ public:
 	static bool load_cam_keys_correction(const std::string &filename,
 		std::map<int, std::map<float, float> > &cam_correction)
 	{
-		std::ifstream f(filename);
-		if (!f.is_open()) return false;
-		char buf[1024];
+		typedef std::pair<int, std::pair<float, float> > Record;
 		// Skip the first two lines which describes the file
-		f.getline(buf, 1024);
-		f.getline(buf, 1024);
-		//std::map<int, std::map<float, float> > cam_correction;
-		while (!f.eof())
-		{
-			f.getline(buf, 1024);
+		return ChunkedTextParser::for_each<Record>(filename, 2,
+			[](const char* first, const char* last, Record &r) {
 			int idx = 0;
-			float key = 0, value = 0;
-			if (strlen(buf) > 3)
+			float v[2] = { 0 };
+			if (!ChunkedTextParser::parse_fields(first, last, &idx, 1, v, 2))
 			{
-				sscanf(buf, "%i %f %f", &idx, &key, &value);
-				cam_correction[idx][key] = value;
+				return false;
 			}
-		}
-		f.close();
-		f.clear();
-		return true;
-
+			r.first = idx;
+			r.second = std::make_pair(v[0], v[1]);
+			return true;
+		}, [&cam_correction](Record &r) {
+			cam_correction[r.first][r.second.first] = r.second.second;
+		});
 	}
 };
 
@@ -26,6 +26,9 @@
 #include <fstream>
 #include <iostream>
 
+#include "ChunkedTextParser.hpp"
+#include "TextWriter.hpp"
+
 namespace CmnIO
 {
 namespace filesio
@@ -42,48 +45,45 @@ class LineDirectionIO
 	  static bool save_dir(const std::string &filename,
 		  std::map<int, std::vector< std::pair<_Ty3, _Ty2> > > &dir)
 	  {
-		  std::ofstream f(filename);
-		  if (!f.is_open()) return false;
-		  f << "LineDirectionXYZXYIO v0.0.1" << std::endl;
-		  f << "#desc id XYZ.X XYZ.Y XYZ.Z XY.X XY.Y" << std::endl;
+		  TextWriter f;
+		  if (!f.open(filename)) return false;
+		  f << "LineDirectionXYZXYIO v0.0.1" << '\n';
+		  f << "#desc id XYZ.X XYZ.Y XYZ.Z XY.X XY.Y" << '\n';
 		  for (auto it : dir)
 		  {
 			  for (auto it2 : it.second)
 			  {
 				  f << it.first << " " << it2.first.x << " " << it2.first.y << " " <<
 					  it2.first.z << " " << it2.second.x << " " << it2.second.y <<
-					  std::endl;
+					  '\n';
 			  }
 		  }
-		  f.close();
-		  f.clear();
-		  return true;
+		  return f.close();
 	  }
 
 	  template <typename _Ty2, typename _Ty3>
 	  static  bool load_dir(const std::string &filename,
 		  std::map<int, std::vector< std::pair<cv::Point3f, cv::Point2f> > > &dir)
 	  {
-		  std::ifstream f(filename);
-		  if (!f.is_open()) return false;
-		  char buf[512];
-		  f.getline(buf, 512); // header
-		  f.getline(buf, 512); // descriptor
-		  // content
-		  while (!f.eof())
-		  {
-			  f.getline(buf, 512);
-			  if (strlen(buf) > 3) {
-				  int id = 0;
-				  _Ty3 xyz;
-				  _Ty2 xy;
-				  sscanf(buf, "%i %f %f %f %f %f", &id,
-					  &xyz.x, &xyz.y, &xyz.z, &xy.x, &xy.y);
-				  dir[id].push_back(std::make_pair(xyz, xy));
+		  typedef std::pair<int, std::pair<_Ty3, _Ty2> > Record;
+		  // header, descriptor
+		  return ChunkedTextParser::for_each<Record>(filename, 2,
+			  [](const char* first, const char* last, Record &r) {
+			  float v[5] = { 0 };
+			  r.first = 0;
+			  if (!ChunkedTextParser::parse_fields(first, last, &r.first, 1, v, 5))
+			  {
+				  return false;
 			  }
-		  }
-		  f.close();
-		  f.clear();
+			  r.second.first.x = v[0];
+			  r.second.first.y = v[1];
+			  r.second.first.z = v[2];
+			  r.second.second.x = v[3];
+			  r.second.second.y = v[4];
+			  return true;
+		  }, [&dir](Record &r) {
+			  dir[r.first].push_back(r.second);
+		  });
 	  }
 
 
@@ -91,46 +91,42 @@ class LineDirectionIO
 	  static bool save_dir(const std::string &filename,
 		  std::map<int, std::vector< _Ty3 > > &dir)
 	  {
-		  std::ofstream f(filename);
-		  if (!f.is_open()) return false;
-		  f << "LineDirectionXYZIO v0.0.1" << std::endl;
-		  f << "#desc id XYZ.X XYZ.Y XYZ.Z" << std::endl;
+		  TextWriter f;
+		  if (!f.open(filename)) return false;
+		  f << "LineDirectionXYZIO v0.0.1" << '\n';
+		  f << "#desc id XYZ.X XYZ.Y XYZ.Z" << '\n';
 		  for (auto it : dir)
 		  {
 			  for (auto it2 : it.second)
 			  {
 				  f << it.first << " " << it2.x << " " << it2.y << " " << 
-					  it2.z << std::endl;
+					  it2.z << '\n';
 			  }
 		  }
-		  f.close();
-		  f.clear();
-		  return true;
+		  return f.close();
 	  }
 
 	  template <typename _Ty3>
 	  static  bool load_dir(const std::string &filename,
 		  std::map<int, std::vector< cv::Point3f > > &dir)
 	  {
-		  std::ifstream f(filename);
-		  if (!f.is_open()) return false;
-		  char buf[512];
-		  f.getline(buf, 512); // header
-		  f.getline(buf, 512); // descriptor
-		  // content
-		  while (!f.eof())
-		  {
-			  f.getline(buf, 512);
-			  if (strlen(buf) > 3) {
-				  int id = 0;
-				  _Ty3 xyz;
-				  sscanf(buf, "%i %f %f %f", &id,
-					  &xyz.x, &xyz.y, &xyz.z);
-				  dir[id].push_back(xyz);
+		  typedef std::pair<int, _Ty3> Record;
+		  // header, descriptor
+		  return ChunkedTextParser::for_each<Record>(filename, 2,
+			  [](const char* first, const char* last, Record &r) {
+			  float v[3] = { 0 };
+			  r.first = 0;
+			  if (!ChunkedTextParser::parse_fields(first, last, &r.first, 1, v, 3))
+			  {
+				  return false;
 			  }
-		  }
-		  f.close();
-		  f.clear();
+			  r.second.x = v[0];
+			  r.second.y = v[1];
+			  r.second.z = v[2];
+			  return true;
+		  }, [&dir](Record &r) {
+			  dir[r.first].push_back(r.second);
+		  });
 	  }
 
 
@@ -28,6 +28,8 @@
 #include <iostream>
 #include <string>
 
+#include "ChunkedTextParser.hpp"
+#include "TextWriter.hpp"
 #include "cmnlibworld/inc/cmnlibworld/cmnlibworld_headers.hpp"
 
 namespace CmnIO
@@ -60,10 +62,10 @@ class Mesh3DXYZXY
 		  // Container with the 3D points in the space and 2D points in the source data.
 		  // XYZ point, XY image coordinate
 
-		  std::ofstream f(filename);
-		  if (!f.is_open()) return false;
-		  f << "SourceXYZXY_naive_v001" << std::endl;
-		  f << "id x y z x(u) y(v)" << std::endl;
+		  TextWriter f;
+		  if (!f.open(filename)) return false;
+		  f << "SourceXYZXY_naive_v001" << '\n';
+		  f << "id x y z x(u) y(v)" << '\n';
 		  size_t s = containerxyzxy.size();
 		  for (size_t i = 0; i < s; ++i)
 		  {
@@ -72,12 +74,9 @@ class Mesh3DXYZXY
 				  containerxyzxy[i].first.y << " " <<
 				  containerxyzxy[i].first.z << " " <<
 				  containerxyzxy[i].second.x << " " <<
-				  containerxyzxy[i].second.y << std::endl;
+				  containerxyzxy[i].second.y << '\n';
 		  }
-		  f.close();
-		  f.clear();
-
-		  return true;
+		  return f.close();
 	  }
 
 	  /** @brief Function to load a set of XYZXY points for further purposes.
@@ -98,27 +97,22 @@ class Mesh3DXYZXY
 		  // Container with the 3D points in the space and 2D points in the source data.
 		  // XYZ point, XY image coordinate
 
-		  std::ifstream f(filename);
-		  if (!f.is_open()) return false;
-		  char buf[1024];
-		  f.getline(buf, 1024);
-		  f.getline(buf, 1024);
-		  while (!f.eof())
-		  {
-			  f.getline(buf, 1024);
-			  _Ty3 xyz;
-			  _Ty2 xy;
-			  int id;
-			  if (strlen(buf) > 3)
+		  typedef std::pair<_Ty3, _Ty2> Record;
+		  return ChunkedTextParser::parse(filename, 2,
+			  [](const char* first, const char* last, Record &r) {
+			  int id = 0;
+			  float v[5] = { 0 };
+			  if (!ChunkedTextParser::parse_fields(first, last, &id, 1, v, 5))
 			  {
-				  sscanf(buf, "%i %f %f %f %f %f", &id, &xyz.x, &xyz.y, &xyz.z, &xy.x, &xy.y);
-				  containerxyzxy.push_back(std::make_pair(xyz, xy));
+				  return false;
 			  }
-		  }
-		  f.close();
-		  f.clear();
-
-		  return true;
+			  r.first.x = v[0];
+			  r.first.y = v[1];
+			  r.first.z = v[2];
+			  r.second.x = v[3];
+			  r.second.y = v[4];
+			  return true;
+		  }, containerxyzxy);
 	  }
 
 
@@ -140,10 +134,10 @@ class Mesh3DXYZXY
 		  // Container with the 3D points in the space and 2D points in the source data.
 		  // XYZ point, XY image coordinate
 
-		  std::ofstream f(filename);
-		  if (!f.is_open()) return false;
-		  f << "SourceXYZXY_naive_v002" << std::endl;
-		  f << "id x(u) y(v) x y z " << std::endl;
+		  TextWriter f;
+		  if (!f.open(filename)) return false;
+		  f << "SourceXYZXY_naive_v002" << '\n';
+		  f << "id x(u) y(v) x y z " << '\n';
 		  for (auto it : containerxyxyz)
 		  {
 			  for (auto it2 : it.second)
@@ -151,13 +145,10 @@ class Mesh3DXYZXY
 				  f << it.first << " " <<
 					  it2.first.x << " " << it2.first.y << " " <<
 					  it2.second.x << " " << it2.second.y << " " << 
-					  it2.second.z << std::endl;
+					  it2.second.z << '\n';
 			  }
 		  }
-		  f.close();
-		  f.clear();
-
-		  return true;
+		  return f.close();
 	  }
 
 	  /** @brief Function to load a set of XYZXY points for further purposes.
@@ -178,27 +169,24 @@ class Mesh3DXYZXY
 		  // Container with the 3D points in the space and 2D points in the source data.
 		  // XYZ point, XY image coordinate
 
-		  std::ifstream f(filename);
-		  if (!f.is_open()) return false;
-		  char buf[1024];
-		  f.getline(buf, 1024);
-		  f.getline(buf, 1024);
-		  while (!f.eof())
-		  {
-			  f.getline(buf, 1024);
-			  _Ty3 xyz;
-			  _Ty2 xy;
-			  int id;
-			  if (strlen(buf) > 3)
+		  typedef std::pair<int, std::pair<_Ty2, _Ty3> > Record;
+		  return ChunkedTextParser::for_each<Record>(filename, 2,
+			  [](const char* first, const char* last, Record &r) {
+			  float v[5] = { 0 };
+			  r.first = 0;
+			  if (!ChunkedTextParser::parse_fields(first, last, &r.first, 1, v, 5))
 			  {
-				  sscanf(buf, "%i %f %f %f %f %f", &id, &xy.x, &xy.y, &xyz.x, &xyz.y, &xyz.z);
-				  containerxyxyz[id].push_back(std::make_pair(xy, xyz));
+				  return false;
 			  }
-		  }
-		  f.close();
-		  f.clear();
-
-		  return true;
+			  r.second.first.x = v[0];
+			  r.second.first.y = v[1];
+			  r.second.second.x = v[2];
+			  r.second.second.y = v[3];
+			  r.second.second.z = v[4];
+			  return true;
+		  }, [&containerxyxyz](Record &r) {
+			  containerxyxyz[r.first].push_back(r.second);
+		  });
 	  }
 
 
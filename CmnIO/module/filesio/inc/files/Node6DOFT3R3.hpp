@@ -4,6 +4,10 @@
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <utility>
+
+#include "ChunkedTextParser.hpp"
+#include "TextWriter.hpp"
 
 namespace CmnIO
 {
@@ -29,51 +33,42 @@ class Node6DOFT3R3
 	  static bool save(const std::string &filename,
 		  std::map<int, _Ty3> &m_origin, std::map<int, _Ty3> &m_angle)
 	  {
-		  std::ofstream f;
-		  f.open(filename);
-		  if (!f.is_open()) return false;
-		  f << "Node6DOFXYZPTR Ver 0.1" << std::endl;
-		  f << "#id x y z p t r" << std::endl;
+		  TextWriter f;
+		  if (!f.open(filename)) return false;
+		  f << "Node6DOFXYZPTR Ver 0.1" << '\n';
+		  f << "#id x y z p t r" << '\n';
 		  for (auto it : m_origin)
 		  {
 			  int idx = it.first;
 			  if (m_angle.find(idx) != m_angle.end())
 			  {
 				  f << it.first << " " << it.second.x << " " << it.second.y << " " << it.second.z << " " <<
-					  m_angle[idx].x << " " << m_angle[idx].y << " " << m_angle[idx].z << std::endl;
+					  m_angle[idx].x << " " << m_angle[idx].y << " " << m_angle[idx].z << '\n';
 			  }
 		  }
-		  f.close();
-		  f.clear();
-		  return true;
+		  return f.close();
 	  }
 
 	  template <typename _Ty3>
 	  static bool load(const std::string &filename,
 		  std::map<int, _Ty3> &m_origin, std::map<int, _Ty3> &m_angle)
 	  {
-		  std::ifstream f;
-		  f.open(filename);
-		  if (!f.is_open()) return false;
-		  char buf[1024];
-		  f.getline(buf, 1024);
-		  f.getline(buf, 1024);
-		  while (!f.eof())
-		  {
-			  f.getline(buf, 1024);
-			  if (strlen(buf) > 3) {
-				  int id = 0;
-				  float x = 0, y = 0, z = 0;
-				  float r_x = 0, r_y = 0, r_z = 0;
-				  sscanf(buf, "%i %f %f %f %f %f %f", &id, &x, &y, &z, 
-					  &r_x, &r_y, &r_z);
-				  m_origin[id] = _Ty3(x, y, z);
-				  m_angle[id] = _Ty3(r_x, r_y, r_z);
+		  typedef std::pair<int, std::pair<_Ty3, _Ty3> > Record;
+		  return ChunkedTextParser::for_each<Record>(filename, 2,
+			  [](const char* first, const char* last, Record &r) {
+			  float v[6] = { 0 };
+			  r.first = 0;
+			  if (!ChunkedTextParser::parse_fields(first, last, &r.first, 1, v, 6))
+			  {
+				  return false;
 			  }
-		  }
-		  f.close();
-		  f.clear();
-		  return true;
+			  r.second.first = _Ty3(v[0], v[1], v[2]);
+			  r.second.second = _Ty3(v[3], v[4], v[5]);
+			  return true;
+		  }, [&m_origin, &m_angle](Record &r) {
+			  m_origin[r.first] = r.second.first;
+			  m_angle[r.first] = r.second.second;
+		  });
 	  }
 
 };
@@ -5,6 +5,9 @@
 #include <iostream>
 #include <map>
 
+#include "ChunkedTextParser.hpp"
+#include "TextWriter.hpp"
+
 namespace CmnIO
 {
 namespace filesio
@@ -27,12 +30,11 @@ class Pairs2DIO
 	  static bool save_pairs(const std::string &filename,
 		  std::map< std::pair<int, int>, std::map<int, std::pair<_Ty, _Ty> > > &m_m_points)
 	  {
-		  std::ofstream myfile;
-		  myfile.open(filename);
-		  if (!myfile.is_open()) return false;
+		  TextWriter myfile;
+		  if (!myfile.open(filename)) return false;
 
-		  myfile << "SelectPair_v002" << std::endl;
-		  myfile << "#idA idB xA yA xB yB" << std::endl;
+		  myfile << "SelectPair_v002" << '\n';
+		  myfile << "#idA idB xA yA xB yB" << '\n';
 		  for (auto it = m_m_points.begin(); it != m_m_points.end(); it++)
 		  {
 			  for (auto it2 = it->second.begin(); it2 != it->second.end(); it2++)
@@ -42,13 +44,10 @@ class Pairs2DIO
 					  it2->second.first.x << " " <<
 					  it2->second.first.y << " " <<
 					  it2->second.second.x << " " <<
-					  it2->second.second.y << std::endl;
+					  it2->second.second.y << '\n';
 			  }
 		  }
-		  myfile.close();
-		  myfile.clear();
-
-		  return true;
+		  return myfile.close();
 	  }
 
 
@@ -63,12 +62,11 @@ class Pairs2DIO
 		  float xscale1, float yscale1,
 		  std::map< std::pair<int, int>, std::map<int, std::pair<_Ty, _Ty> > > &m_m_points)
 	  {
-		  std::ofstream myfile;
-		  myfile.open(filename);
-		  if (!myfile.is_open()) return false;
+		  TextWriter myfile;
+		  if (!myfile.open(filename)) return false;
 
-		  myfile << "SelectPair_v002" << std::endl;
-		  myfile << "#idA idB xA yA xB yB" << std::endl;
+		  myfile << "SelectPair_v002" << '\n';
+		  myfile << "#idA idB xA yA xB yB" << '\n';
 		  for (auto it = m_m_points.begin(); it != m_m_points.end(); it++)
 		  {
 			  for (auto it2 = it->second.begin(); it2 != it->second.end(); it2++)
@@ -78,13 +76,10 @@ class Pairs2DIO
 					  it2->second.first.x / xscale0 << " " <<
 					  it2->second.first.y / yscale0 << " " <<
 					  (it2->second.second.x - offset_dest.x) / xscale1 << " " <<
-					  (it2->second.second.y - offset_dest.y) / yscale1 << std::endl;
+					  (it2->second.second.y - offset_dest.y) / yscale1 << '\n';
 			  }
 		  }
-		  myfile.close();
-		  myfile.clear();
-
-		  return true;
+		  return myfile.close();
 	  }
 
 
@@ -95,36 +90,28 @@ class Pairs2DIO
 	  static bool load_pairs(const std::string &filename,
 		  std::map< std::pair<int, int>, std::map<int, std::pair<_Ty, _Ty> > > &m_m_points)
 	  {
-		  std::ifstream f;
-		  f.open(filename);
-		  if (!f.is_open()) return false;
-		  char buf[1024];
-		  f.getline(buf, 1024);
-		  f.getline(buf, 1024);
-		  // Information
-		  while (!f.eof())
+		  struct Record
 		  {
-			  f.getline(buf, 1024);
-			  if (std::strlen(buf) > 3) {
-				  int idx[2];
-				  float val[4];
-				  int s = 0;
-				  sscanf(buf, "%i %i %i %f %f %f %f", &idx[0], &idx[1], &s,
-					  &val[0], &val[1], &val[2], &val[3]);
-				  //if (m_m_points.find(std::make_pair(idx[0], idx[1])) !=
-					 // m_m_points.end()) {
-					 // s = m_m_points[std::make_pair(idx[0], idx[1])].size();
-				  //}
-				  m_m_points[std::make_pair(idx[0], idx[1])][s].first =
-					  cv::Point2f(val[0], val[1]);
-				  m_m_points[std::make_pair(idx[0], idx[1])][s].second =
-					  cv::Point2f(val[2], val[3]);
+			  int idx[3];
+			  _Ty a, b;
+		  };
+		  return ChunkedTextParser::for_each<Record>(filename, 2,
+			  [](const char* first, const char* last, Record &r) {
+			  float v[4] = { 0 };
+			  r.idx[0] = r.idx[1] = r.idx[2] = 0;
+			  if (!ChunkedTextParser::parse_fields(first, last, r.idx, 3, v, 4))
+			  {
+				  return false;
 			  }
-		  }
-		  f.close();
-		  f.clear();
-
-		  return true;
+			  r.a = _Ty(v[0], v[1]);
+			  r.b = _Ty(v[2], v[3]);
+			  return true;
+		  }, [&m_m_points](Record &r) {
+			  std::pair<_Ty, _Ty> &p =
+				  m_m_points[std::make_pair(r.idx[0], r.idx[1])][r.idx[2]];
+			  p.first = r.a;
+			  p.second = r.b;
+		  });
 	  }
 
 };
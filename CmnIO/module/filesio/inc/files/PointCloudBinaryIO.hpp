@@ -0,0 +1,389 @@
+/**
+* @file PointCloudBinaryIO.hpp
+* @brief Binary point cloud format, readable with a memory mapping.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @original author Alessandro Moro
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef CMNIO_FILESIO_POINTCLOUDBINARYIO_HPP__
+#define CMNIO_FILESIO_POINTCLOUDBINARYIO_HPP__
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "system/inc/system/mapped_file.hpp"
+
+namespace CmnIO
+{
+namespace filesio
+{
+
+
+/** @brief Header of the binary point cloud (128 bytes).
+
+	The header is followed by the columns (structure of arrays), each one
+	starting at a multiple of 64 bytes:
+	x[n], y[n], z[n] float, id[n] int32_t (optional), r[n], g[n], b[n]
+	uint8_t (optional). The values are in the byte order of the writer,
+	recorded in byte_order: a reader with a different one rejects the file.
+*/
+struct PointCloudBinaryHeader
+{
+	enum Flags
+	{
+		PCB_ID = 1,
+		PCB_RGB = 2
+	};
+	enum Columns
+	{
+		COLUMN_X = 0,
+		COLUMN_Y,
+		COLUMN_Z,
+		COLUMN_ID,
+		COLUMN_R,
+		COLUMN_G,
+		COLUMN_B,
+		NUM_COLUMNS
+	};
+
+	char magic[8];			// "CMNPC3D"
+	uint32_t version;		// 1
+	uint32_t byte_order;	// 0x01020304
+	uint64_t num_points;
+	uint32_t flags;			// PCB_ID | PCB_RGB
+	uint32_t reserved0;
+	uint64_t offset[NUM_COLUMNS];	// 0 if the column is not stored
+	uint8_t reserved[40];
+
+	static const char* kMagic() { return "CMNPC3D"; }
+	static uint32_t kVersion() { return 1; }
+	static uint32_t kByteOrder() { return 0x01020304; }
+	static uint64_t kAlignment() { return 64; }
+
+	/** @brief Size in bytes of a value of the column.
+	*/
+	static uint64_t column_size(int column) {
+		return column < COLUMN_R ? 4 : 1;
+	}
+};
+static_assert(sizeof(PointCloudBinaryHeader) == 128,
+	"PointCloudBinaryHeader must be 128 bytes");
+
+
+/** @brief Array of a column of a mapped point cloud, without copies.
+*/
+template <typename T>
+struct PointCloudColumn
+{
+	const T* data;
+	size_t size;
+
+	PointCloudColumn() : data(nullptr), size(0) {}
+	PointCloudColumn(const T* data, size_t size) : data(data), size(size) {}
+	bool empty() const { return size == 0; }
+	const T* begin() const { return data; }
+	const T* end() const { return data + size; }
+	const T& operator[](size_t i) const { return data[i]; }
+};
+
+
+/** @brief Write a binary point cloud, streaming the points in chunks.
+
+	The number of points and the optional columns are given when the file
+	is opened, so the position of every column is known: the points added
+	with add are buffered and written column by column every chunk.
+	@code
+		CmnIO::filesio::PointCloudBinaryWriter w;
+		w.open("cloud.pcb", n, CmnIO::filesio::PointCloudBinaryHeader::PCB_ID);
+		for (...) w.add(x, y, z, id);
+		w.close();
+	@endcode
+*/
+class PointCloudBinaryWriter
+{
+  public:
+
+	  PointCloudBinaryWriter(size_t chunk_size = 1 << 16)
+		  : f_(nullptr), num_points_(0), written_(0),
+		  chunk_size_(chunk_size > 0 ? chunk_size : 1) {
+		  memset(&header_, 0, sizeof(header_));
+	  }
+
+	  ~PointCloudBinaryWriter() {
+		  close();
+	  }
+
+	  /** @brief Create the file and write the header.
+
+		  @param[in] filename Destination file.
+		  @param[in] num_points Number of points that will be added.
+		  @param[in] flags PointCloudBinaryHeader::PCB_ID and/or PCB_RGB.
+		  @return Return TRUE if the file has been created.
+	  */
+	  bool open(const std::string &filename, uint64_t num_points,
+		  uint32_t flags) {
+		  close();
+		  f_ = fopen(filename.c_str(), "wb");
+		  if (!f_) return false;
+		  memset(&header_, 0, sizeof(header_));
+		  memcpy(header_.magic, PointCloudBinaryHeader::kMagic(), 8);
+		  header_.version = PointCloudBinaryHeader::kVersion();
+		  header_.byte_order = PointCloudBinaryHeader::kByteOrder();
+		  header_.num_points = num_points;
+		  header_.flags = flags;
+		  uint64_t offset = sizeof(PointCloudBinaryHeader);
+		  for (int c = 0; c < PointCloudBinaryHeader::NUM_COLUMNS; ++c) {
+			  if (!has_column(c)) continue;
+			  header_.offset[c] = offset;
+			  offset = align(offset + num_points *
+				  PointCloudBinaryHeader::column_size(c));
+		  }
+		  num_points_ = num_points;
+		  written_ = 0;
+		  for (int c = 0; c < PointCloudBinaryHeader::NUM_COLUMNS; ++c) {
+			  chunk_[c].clear();
+			  chunk_[c].reserve(chunk_size_ *
+				  PointCloudBinaryHeader::column_size(c));
+		  }
+		  bool ok = fwrite(&header_, sizeof(header_), 1, f_) == 1;
+		  // The last column is padded too: the file size is the end offset
+		  if (ok && offset > sizeof(header_)) {
+			  const char zero = 0;
+			  ok = seek(offset - 1) && fwrite(&zero, 1, 1, f_) == 1;
+		  }
+		  if (!ok) close();
+		  return ok;
+	  }
+
+	  /** @brief Add a point. The absent columns are ignored.
+		  @return False if more than num_points are added or on write error.
+	  */
+	  bool add(float x, float y, float z, int32_t id = 0, uint8_t r = 0,
+		  uint8_t g = 0, uint8_t b = 0) {
+		  if (!f_ || written_ + pending() >= num_points_) return false;
+		  push(PointCloudBinaryHeader::COLUMN_X, &x);
+		  push(PointCloudBinaryHeader::COLUMN_Y, &y);
+		  push(PointCloudBinaryHeader::COLUMN_Z, &z);
+		  push(PointCloudBinaryHeader::COLUMN_ID, &id);
+		  push(PointCloudBinaryHeader::COLUMN_R, &r);
+		  push(PointCloudBinaryHeader::COLUMN_G, &g);
+		  push(PointCloudBinaryHeader::COLUMN_B, &b);
+		  return pending() < chunk_size_ || flush();
+	  }
+
+	  /** @brief Write the buffered points and close the file.
+		  @return False if not all the num_points have been written.
+	  */
+	  bool close() {
+		  if (!f_) return false;
+		  bool ok = flush() && written_ == num_points_;
+		  ok = fclose(f_) == 0 && ok;
+		  f_ = nullptr;
+		  return ok;
+	  }
+
+	  bool is_open() const { return f_ != nullptr; }
+
+  private:
+
+	  bool has_column(int c) const {
+		  if (c == PointCloudBinaryHeader::COLUMN_ID) {
+			  return (header_.flags & PointCloudBinaryHeader::PCB_ID) != 0;
+		  }
+		  if (c >= PointCloudBinaryHeader::COLUMN_R) {
+			  return (header_.flags & PointCloudBinaryHeader::PCB_RGB) != 0;
+		  }
+		  return true;
+	  }
+
+	  static uint64_t align(uint64_t offset) {
+		  uint64_t a = PointCloudBinaryHeader::kAlignment();
+		  return (offset + a - 1) / a * a;
+	  }
+
+	  size_t pending() const {
+		  return chunk_[PointCloudBinaryHeader::COLUMN_X].size() / 4;
+	  }
+
+	  void push(int c, const void* value) {
+		  if (!has_column(c)) return;
+		  const char* p = (const char*)value;
+		  chunk_[c].insert(chunk_[c].end(), p,
+			  p + PointCloudBinaryHeader::column_size(c));
+	  }
+
+	  bool seek(uint64_t offset) {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+		  return _fseeki64(f_, (__int64)offset, SEEK_SET) == 0;
+#else
+		  return fseeko(f_, (off_t)offset, SEEK_SET) == 0;
+#endif
+	  }
+
+	  /** @brief Write the buffered values of every column at its position.
+	  */
+	  bool flush() {
+		  size_t n = pending();
+		  if (n == 0) return true;
+		  for (int c = 0; c < PointCloudBinaryHeader::NUM_COLUMNS; ++c) {
+			  if (!has_column(c)) continue;
+			  uint64_t s = PointCloudBinaryHeader::column_size(c);
+			  if (!seek(header_.offset[c] + written_ * s) ||
+				  fwrite(chunk_[c].data(), 1, chunk_[c].size(), f_) !=
+				  chunk_[c].size()) {
+				  return false;
+			  }
+			  chunk_[c].clear();
+		  }
+		  written_ += n;
+		  return true;
+	  }
+
+	  FILE* f_;
+	  PointCloudBinaryHeader header_;
+	  uint64_t num_points_;
+	  uint64_t written_;
+	  size_t chunk_size_;
+	  std::vector<char> chunk_[PointCloudBinaryHeader::NUM_COLUMNS];
+
+	  // No copying allowed
+	  PointCloudBinaryWriter(const PointCloudBinaryWriter&);
+	  void operator=(const PointCloudBinaryWriter&);
+};
+
+
+/** @brief Read a binary point cloud in place, with a memory mapping.
+
+	The columns point inside the mapping and are valid until the reader is
+	closed or destroyed.
+*/
+class PointCloudBinaryReader
+{
+  public:
+
+	  PointCloudBinaryReader() : header_(nullptr) {}
+
+	  /** @brief Map the file and check the header and the columns.
+		  @return Return TRUE if the file is a valid binary point cloud.
+	  */
+	  bool open(const std::string &filename) {
+		  close();
+		  if (!file_.open(filename, false)) return false;
+		  if (file_.size() < sizeof(PointCloudBinaryHeader)) {
+			  close();
+			  return false;
+		  }
+		  const PointCloudBinaryHeader* h =
+			  (const PointCloudBinaryHeader*)file_.data();
+		  bool ok = memcmp(h->magic, PointCloudBinaryHeader::kMagic(), 8) == 0 &&
+			  h->version == PointCloudBinaryHeader::kVersion() &&
+			  h->byte_order == PointCloudBinaryHeader::kByteOrder();
+		  for (int c = 0; ok && c < PointCloudBinaryHeader::NUM_COLUMNS; ++c) {
+			  if (h->offset[c] == 0) {
+				  // x, y and z are required
+				  ok = c >= PointCloudBinaryHeader::COLUMN_ID;
+				  continue;
+			  }
+			  uint64_t s = PointCloudBinaryHeader::column_size(c);
+			  ok = h->offset[c] % PointCloudBinaryHeader::kAlignment() == 0 &&
+				  h->offset[c] <= file_.size() &&
+				  h->num_points <= (file_.size() - h->offset[c]) / s;
+		  }
+		  // the colors are all three or none
+		  int num_rgb = (h->offset[PointCloudBinaryHeader::COLUMN_R] != 0) +
+			  (h->offset[PointCloudBinaryHeader::COLUMN_G] != 0) +
+			  (h->offset[PointCloudBinaryHeader::COLUMN_B] != 0);
+		  ok = ok && (num_rgb == 0 || num_rgb == 3);
+		  if (!ok) {
+			  close();
+			  return false;
+		  }
+		  header_ = h;
+		  return true;
+	  }
+
+	  void close() {
+		  file_.close();
+		  header_ = nullptr;
+	  }
+
+	  bool is_open() const { return header_ != nullptr; }
+
+	  size_t size() const {
+		  return header_ ? (size_t)header_->num_points : 0;
+	  }
+
+	  bool has_id() const {
+		  return header_ && header_->offset[PointCloudBinaryHeader::COLUMN_ID];
+	  }
+
+	  bool has_rgb() const {
+		  return header_ && header_->offset[PointCloudBinaryHeader::COLUMN_R] &&
+			  header_->offset[PointCloudBinaryHeader::COLUMN_G] &&
+			  header_->offset[PointCloudBinaryHeader::COLUMN_B];
+	  }
+
+	  PointCloudColumn<float> x() const {
+		  return column<float>(PointCloudBinaryHeader::COLUMN_X);
+	  }
+	  PointCloudColumn<float> y() const {
+		  return column<float>(PointCloudBinaryHeader::COLUMN_Y);
+	  }
+	  PointCloudColumn<float> z() const {
+		  return column<float>(PointCloudBinaryHeader::COLUMN_Z);
+	  }
+	  /** @brief The ids, empty if not stored.
+	  */
+	  PointCloudColumn<int32_t> id() const {
+		  return column<int32_t>(PointCloudBinaryHeader::COLUMN_ID);
+	  }
+	  /** @brief The colors, empty if not stored.
+	  */
+	  PointCloudColumn<uint8_t> r() const {
+		  return column<uint8_t>(PointCloudBinaryHeader::COLUMN_R);
+	  }
+	  PointCloudColumn<uint8_t> g() const {
+		  return column<uint8_t>(PointCloudBinaryHeader::COLUMN_G);
+	  }
+	  PointCloudColumn<uint8_t> b() const {
+		  return column<uint8_t>(PointCloudBinaryHeader::COLUMN_B);
+	  }
+
+  private:
+
+	  template <typename T>
+	  PointCloudColumn<T> column(int c) const {
+		  if (!header_ || header_->offset[c] == 0) return PointCloudColumn<T>();
+		  return PointCloudColumn<T>(
+			  (const T*)(file_.data() + header_->offset[c]), size());
+	  }
+
+	  CmnLib::system::MappedFile file_;
+	  const PointCloudBinaryHeader* header_;
+};
+
+
+} // namespace filesio
+} // namespace CmnIO
+
+
+#endif // CMNIO_FILESIO_POINTCLOUDBINARYIO_HPP__
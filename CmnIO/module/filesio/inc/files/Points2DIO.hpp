@@ -5,6 +5,8 @@
 #include <iostream>
 #include <map>
 
+#include "TextWriter.hpp"
+
 namespace CmnIO
 {
 namespace filesio
@@ -22,21 +24,18 @@ class Points2DIO
 		  int x, int y, int width, int height,
 		  std::map<int, _Ty> &m_points)
 	  {
-		  std::ofstream myfile;
-		  myfile.open(filename_mesh);
-		  if (!myfile.is_open()) return false;
-		  myfile << "Mesh2D Ver 0.1" << std::endl;
+		  TextWriter myfile;
+		  if (!myfile.open(filename_mesh)) return false;
+		  myfile << "Mesh2D Ver 0.1" << '\n';
 		  myfile << "Rectangle " << x << " " << y << " " << width << " " << 
-			  height << std::endl;
-		  myfile << "NumPoints " << m_points.size() << std::endl;
+			  height << '\n';
+		  myfile << "NumPoints " << m_points.size() << '\n';
 		  for (auto it = m_points.begin(); it != m_points.end(); it++)
 		  {
 			  myfile << it->first << " " << it->second.x << " " << 
-				  it->second.y << std::endl;
+				  it->second.y << '\n';
 		  }
-		  myfile.close();
-		  myfile.clear();
-		  return true;
+		  return myfile.close();
 	  }
 };
 
@@ -24,9 +24,18 @@
 #ifndef CMNIO_FILESIO_POINTS3DIO_HPP__
 #define CMNIO_FILESIO_POINTS3DIO_HPP__
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <string>
+#include <vector>
+
+#include "system/inc/system/mapped_file.hpp"
+#include "ChunkedTextParser.hpp"
+#include "TextWriter.hpp"
+#include "PointCloudBinaryIO.hpp"
 
 namespace CmnIO
 {
@@ -52,47 +61,38 @@ class Points3DIO
 	  static bool save_collection(const std::string &filename,
 		  std::map<int, _Ty3> &m_points)
 	  {
-		  std::ofstream f;
-		  f.open(filename);
-		  if (!f.is_open()) return false;
-		  f << "Points3D Ver 0.1" << std::endl;
-		  f << "#NumPoints #" << std::endl;
-		  f << "#id x y z" << std::endl;
-		  f << "NumPoints " << m_points.size() << std::endl;
+		  TextWriter f;
+		  if (!f.open(filename)) return false;
+		  f << "Points3D Ver 0.1" << '\n';
+		  f << "#NumPoints #" << '\n';
+		  f << "#id x y z" << '\n';
+		  f << "NumPoints " << m_points.size() << '\n';
 		  for (auto it = m_points.begin(); it != m_points.end(); it++)
 		  {
 			  f << it->first << " " << it->second.x << " " << 
-				  it->second.y << " " << it->second.z << std::endl;
+				  it->second.y << " " << it->second.z << '\n';
 		  }
-		  f.close();
-		  f.clear();
-		  return true;
+		  return f.close();
 	  }
 
 	  template <typename _Ty3>
 	  static bool load_collection(const std::string &filename,
 		  std::map<int, _Ty3> &m_points)
 	  {
-		  std::ifstream f;
-		  f.open(filename);
-		  if (!f.is_open()) return false;
-		  char buf[1024];
-		  f.getline(buf, 1024);
-		  f.getline(buf, 1024);
-		  f.getline(buf, 1024);
-		  while (!f.eof())
-		  {
-			  f.getline(buf, 1024);
-			  if (strlen(buf) > 3) {
-				  int id = 0;
-				  float x = 0, y = 0, z = 0;
-				  sscanf(buf, "%i %f %f %f", &id, &x, &y, &z);
-				  m_points[id] = _Ty3(x, y, z);
+		  typedef std::pair<int, _Ty3> Record;
+		  return ChunkedTextParser::for_each<Record>(filename, 3,
+			  [](const char* first, const char* last, Record &r) {
+			  float v[3] = { 0 };
+			  r.first = 0;
+			  if (!ChunkedTextParser::parse_fields(first, last, &r.first, 1, v, 3))
+			  {
+				  return false;
 			  }
-		  }
-		  f.close();
-		  f.clear();
-		  return true;
+			  r.second = _Ty3(v[0], v[1], v[2]);
+			  return true;
+		  }, [&m_points](Record &r) {
+			  m_points[r.first] = r.second;
+		  });
 	  }
 
 	  /** @brief It saves a collection of points in a raw form.
@@ -107,48 +107,174 @@ class Points3DIO
 	  static bool save_collection(const std::string &filename,
 		  std::vector<std::pair<_Txyz, _Trgb> > &v_points)
 	  {
-		  std::ofstream f;
-		  f.open(filename);
-		  if (!f.is_open()) return false;
-		  f << "PointsXYZRGB Ver 0.1" << std::endl;
-		  f << "x y z r g b" << std::endl;
+		  TextWriter f;
+		  if (!f.open(filename)) return false;
+		  f << "PointsXYZRGB Ver 0.1" << '\n';
+		  f << "x y z r g b" << '\n';
 		  for (auto it : v_points)
 		  {
 			  f << it.first.x << " " << it.first.y << " " << it.first.z << " " <<
 				   it.second.x << " " << it.second.y << " " << it.second.z << 
-				   std::endl;
+				   '\n';
 		  }
-		  f.close();
-		  f.clear();
-		  return true;
+		  return f.close();
 	  }
 
 	  template <typename _Txyz, typename _Trgb>
 	  static bool load_collection(const std::string &filename,
 		  std::vector<std::pair<_Txyz, _Trgb> > &v_points)
 	  {
-		  std::ifstream f;
-		  f.open(filename);
-		  if (!f.is_open()) return false;
-		  char buf[1024];
-		  f.getline(buf, 1024);
-		  f.getline(buf, 1024);
-		  while (!f.eof())
-		  {
-			  f.getline(buf, 1024);
-			  if (strlen(buf) > 3) {
-				  float x = 0, y = 0, z = 0;
-				  float r = 0, g = 0, b = 0;
-				  sscanf(buf, "%f %f %f", &x, &y, &z, &r, &g, &b);
-				  v_points.push_back(std::make_pair(_Txyz(x, y, z), _Trgb(r, g, b)));
+		  typedef std::pair<_Txyz, _Trgb> Record;
+		  return ChunkedTextParser::parse(filename, 2,
+			  [](const char* first, const char* last, Record &r) {
+			  float v[6] = { 0 };
+			  if (!ChunkedTextParser::parse_fields(first, last, nullptr, 0, v, 6))
+			  {
+				  return false;
 			  }
+			  r = std::make_pair(_Txyz(v[0], v[1], v[2]),
+				  _Trgb(v[3], v[4], v[5]));
+			  return true;
+		  }, v_points);
+	  }
+
+	  /** @brief It saves a collection of points in the binary format.
+
+	  It saves a collection of points in the binary format
+	  (PointCloudBinaryIO.hpp), with the ids.
+	  */
+	  template <typename _Ty3>
+	  static bool save_collection_binary(const std::string &filename,
+		  const std::map<int, _Ty3> &m_points)
+	  {
+		  PointCloudBinaryWriter w;
+		  if (!w.open(filename, m_points.size(),
+			  PointCloudBinaryHeader::PCB_ID)) return false;
+		  for (auto it = m_points.begin(); it != m_points.end(); it++)
+		  {
+			  w.add((float)it->second.x, (float)it->second.y,
+				  (float)it->second.z, it->first);
+		  }
+		  return w.close();
+	  }
+
+	  template <typename _Ty3>
+	  static bool load_collection_binary(const std::string &filename,
+		  std::map<int, _Ty3> &m_points)
+	  {
+		  PointCloudBinaryReader r;
+		  if (!r.open(filename) || !r.has_id()) return false;
+		  PointCloudColumn<float> x = r.x(), y = r.y(), z = r.z();
+		  PointCloudColumn<int32_t> id = r.id();
+		  for (size_t i = 0; i < r.size(); ++i)
+		  {
+			  m_points[id[i]] = _Ty3(x[i], y[i], z[i]);
+		  }
+		  return true;
+	  }
+
+	  /** @brief It saves a collection of colored points in the binary
+	  format.
+
+	  It saves a collection of colored points in the binary format
+	  (PointCloudBinaryIO.hpp). The color channels are in [0, 255].
+	  */
+	  template <typename _Txyz, typename _Trgb>
+	  static bool save_collection_binary(const std::string &filename,
+		  const std::vector<std::pair<_Txyz, _Trgb> > &v_points)
+	  {
+		  PointCloudBinaryWriter w;
+		  if (!w.open(filename, v_points.size(),
+			  PointCloudBinaryHeader::PCB_RGB)) return false;
+		  for (const auto &it : v_points)
+		  {
+			  w.add((float)it.first.x, (float)it.first.y, (float)it.first.z,
+				  0, to_channel(it.second.x), to_channel(it.second.y),
+				  to_channel(it.second.z));
+		  }
+		  return w.close();
+	  }
+
+	  template <typename _Txyz, typename _Trgb>
+	  static bool load_collection_binary(const std::string &filename,
+		  std::vector<std::pair<_Txyz, _Trgb> > &v_points)
+	  {
+		  PointCloudBinaryReader r;
+		  if (!r.open(filename) || !r.has_rgb()) return false;
+		  PointCloudColumn<float> x = r.x(), y = r.y(), z = r.z();
+		  PointCloudColumn<uint8_t> cr = r.r(), cg = r.g(), cb = r.b();
+		  v_points.reserve(v_points.size() + r.size());
+		  for (size_t i = 0; i < r.size(); ++i)
+		  {
+			  v_points.push_back(std::make_pair(_Txyz(x[i], y[i], z[i]),
+				  _Trgb(cr[i], cg[i], cb[i])));
 		  }
-		  f.close();
-		  f.clear();
 		  return true;
 	  }
 
+	  /** @brief It converts a text collection to the binary format.
+
+	  It converts a file written by save_collection (Points3D with the ids
+	  or PointsXYZRGB) to the binary format, streaming the points: the
+	  text file is mapped and read twice (count, then convert), the
+	  points are never all in memory.
+	  */
+	  static bool convert_text_to_binary(const std::string &text_filename,
+		  const std::string &binary_filename)
+	  {
+		  CmnLib::system::MappedFile f;
+		  if (!f.open(text_filename)) return false;
+		  const char* first = f.data();
+		  const char* last = first + f.size();
+		  bool rgb;
+		  if (starts_with(first, last, "PointsXYZRGB")) rgb = true;
+		  else if (starts_with(first, last, "Points3D")) rgb = false;
+		  else return false;
+		  const int num_values = rgb ? 6 : 4;
+		  double v[6];
+
+		  // The header lines do not start with a number
+		  uint64_t num_points = 0;
+		  for (const char* p = first; p < last; p = next_line(p, last))
+		  {
+			  if (ChunkedTextParser::parse_values(p, last, v, num_values) ==
+				  num_values) ++num_points;
+		  }
+		  PointCloudBinaryWriter w;
+		  if (!w.open(binary_filename, num_points, rgb ?
+			  PointCloudBinaryHeader::PCB_RGB :
+			  PointCloudBinaryHeader::PCB_ID)) return false;
+		  for (const char* p = first; p < last; p = next_line(p, last))
+		  {
+			  if (ChunkedTextParser::parse_values(p, last, v, num_values) !=
+				  num_values) continue;
+			  if (rgb) w.add((float)v[0], (float)v[1], (float)v[2], 0,
+				  to_channel(v[3]), to_channel(v[4]), to_channel(v[5]));
+			  else w.add((float)v[1], (float)v[2], (float)v[3], (int32_t)v[0]);
+		  }
+		  return w.close();
+	  }
+
+  private:
+
+	  template <typename T>
+	  static uint8_t to_channel(T c)
+	  {
+		  return (uint8_t)std::min(std::max((double)c + 0.5, 0.0), 255.0);
+	  }
+
+	  static bool starts_with(const char* first, const char* last,
+		  const char* prefix)
+	  {
+		  size_t n = strlen(prefix);
+		  return (size_t)(last - first) >= n && memcmp(first, prefix, n) == 0;
+	  }
 
+	  static const char* next_line(const char* p, const char* last)
+	  {
+		  const char* e = (const char*)memchr(p, '\n', last - p);
+		  return e ? e + 1 : last;
+	  }
 };
 
 
@@ -0,0 +1,273 @@
+/**
+* @file RemapBinaryIO.hpp
+* @brief Binary remap tables, readable with a memory mapping.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @original author Alessandro Moro
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef CMNIO_FILESIO_REMAPBINARYIO_HPP__
+#define CMNIO_FILESIO_REMAPBINARYIO_HPP__
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "system/inc/system/buffered_file.hpp"
+#include "system/inc/system/mapped_file.hpp"
+
+namespace CmnIO
+{
+namespace filesio
+{
+
+
+/** @brief Header of the binary remap tables (256 bytes).
+
+	The header is followed by the maps (at most kMaxMaps), each one
+	starting at a multiple of 64 bytes, with the rows padded to a multiple
+	of 64 bytes (step). The values are in the byte order of the writer,
+	recorded in byte_order: a reader with a different one rejects the file.
+	The checksum of a map covers its rows without the padding.
+*/
+struct RemapBinaryHeader
+{
+	enum { kMaxMaps = 4 };
+
+	struct Map
+	{
+		int32_t rows;
+		int32_t cols;
+		int32_t type;		// OpenCV type: CV_32FC1, CV_16SC2, ...
+		int32_t reserved;
+		uint64_t step;		// bytes of a padded row
+		uint64_t offset;	// of the first row
+		uint64_t checksum;
+	};
+
+	char magic[8];			// "CMNREMP"
+	uint32_t version;		// 1
+	uint32_t byte_order;	// 0x01020304
+	uint32_t num_maps;
+	uint32_t reserved0;
+	Map maps[kMaxMaps];
+	uint8_t reserved[72];
+
+	static const char* kMagic() { return "CMNREMP"; }
+	static uint32_t kVersion() { return 1; }
+	static uint32_t kByteOrder() { return 0x01020304; }
+	static uint64_t kAlignment() { return 64; }
+	static uint64_t kChecksumSeed() { return 14695981039346656037ull; }
+
+	/** @brief FNV-1a on 64 bit words (the last bytes one by one), to
+		continue from the checksum h of the previous rows.
+	*/
+	static uint64_t checksum(const char* data, size_t size, uint64_t h) {
+		const uint64_t prime = 1099511628211ull;
+		size_t i = 0;
+		for (; i + 8 <= size; i += 8) {
+			uint64_t w;
+			memcpy(&w, data + i, 8);
+			h = (h ^ w) * prime;
+		}
+		for (; i < size; ++i) h = (h ^ (uint8_t)data[i]) * prime;
+		return h;
+	}
+};
+static_assert(sizeof(RemapBinaryHeader) == 256,
+	"RemapBinaryHeader must be 256 bytes");
+
+
+/** @brief Write remap tables in the binary format.
+*/
+class RemapBinaryWriter
+{
+  public:
+
+	  /** @brief Write the maps (1 to kMaxMaps, any type) in a file.
+
+		  @param[in] filename Destination file.
+		  @param[in] maps The remap tables, i.e. mapx and mapy (CV_32FC1)
+		  or map1 and map2 of cv::convertMaps (CV_16SC2 and CV_16UC1).
+		  @return Return TRUE if the file has been written.
+	  */
+	  static bool save(const std::string &filename,
+		  const std::vector<cv::Mat> &maps) {
+		  if (maps.empty() || maps.size() > RemapBinaryHeader::kMaxMaps) {
+			  return false;
+		  }
+		  RemapBinaryHeader header;
+		  memset(&header, 0, sizeof(header));
+		  memcpy(header.magic, RemapBinaryHeader::kMagic(), 8);
+		  header.version = RemapBinaryHeader::kVersion();
+		  header.byte_order = RemapBinaryHeader::kByteOrder();
+		  header.num_maps = (uint32_t)maps.size();
+		  uint64_t offset = sizeof(RemapBinaryHeader);
+		  for (size_t i = 0; i < maps.size(); ++i) {
+			  const cv::Mat &m = maps[i];
+			  if (m.empty() || m.dims != 2) return false;
+			  RemapBinaryHeader::Map &h = header.maps[i];
+			  h.rows = m.rows;
+			  h.cols = m.cols;
+			  h.type = m.type();
+			  h.step = align((uint64_t)m.cols * m.elemSize());
+			  h.offset = offset;
+			  h.checksum = RemapBinaryHeader::kChecksumSeed();
+			  for (int y = 0; y < m.rows; ++y) {
+				  h.checksum = RemapBinaryHeader::checksum(m.ptr<char>(y),
+					  m.cols * m.elemSize(), h.checksum);
+			  }
+			  offset += h.step * h.rows;
+		  }
+
+		  CmnLib::system::BufferedFile f;
+		  if (!f.open(filename)) return false;
+		  f.write((const char*)&header, sizeof(header));
+		  std::vector<char> padding(RemapBinaryHeader::kAlignment(), 0);
+		  for (size_t i = 0; i < maps.size(); ++i) {
+			  const cv::Mat &m = maps[i];
+			  size_t row_size = m.cols * m.elemSize();
+			  size_t row_padding = (size_t)header.maps[i].step - row_size;
+			  for (int y = 0; y < m.rows; ++y) {
+				  f.write(m.ptr<char>(y), row_size);
+				  f.write(padding.data(), row_padding);
+			  }
+		  }
+		  return f.close();
+	  }
+
+  private:
+
+	  static uint64_t align(uint64_t offset) {
+		  uint64_t a = RemapBinaryHeader::kAlignment();
+		  return (offset + a - 1) / a * a;
+	  }
+};
+
+
+/** @brief Read binary remap tables in place, with a memory mapping.
+
+	The maps are cv::Mat headers on the mapping, without copies: they are
+	read only (the pages are not writable) and valid until the reader is
+	closed or destroyed. They can be passed to cv::remap as they are.
+	@code
+		CmnIO::filesio::RemapBinaryReader r;
+		if (r.open("fisheye.remap")) {
+			cv::remap(src, dst, r.map(0), r.map(1), cv::INTER_LINEAR);
+		}
+	@endcode
+*/
+class RemapBinaryReader
+{
+  public:
+
+	  RemapBinaryReader() : header_(nullptr) {}
+
+	  /** @brief Map the file and check the header and the maps.
+
+		  @param[in] verify Check the checksums (it reads all the file).
+		  @return Return TRUE if the file is a valid remap table.
+	  */
+	  bool open(const std::string &filename, bool verify = true) {
+		  close();
+		  if (!file_.open(filename, false)) return false;
+		  if (file_.size() < sizeof(RemapBinaryHeader)) {
+			  close();
+			  return false;
+		  }
+		  const RemapBinaryHeader* h = (const RemapBinaryHeader*)file_.data();
+		  bool ok = memcmp(h->magic, RemapBinaryHeader::kMagic(), 8) == 0 &&
+			  h->version == RemapBinaryHeader::kVersion() &&
+			  h->byte_order == RemapBinaryHeader::kByteOrder() &&
+			  h->num_maps > 0 && h->num_maps <= RemapBinaryHeader::kMaxMaps;
+		  for (uint32_t i = 0; ok && i < h->num_maps; ++i) {
+			  const RemapBinaryHeader::Map &m = h->maps[i];
+			  ok = valid(m, file_.size());
+			  if (ok) {
+				  maps_.push_back(cv::Mat(m.rows, m.cols, m.type,
+					  (void*)(file_.data() + m.offset), (size_t)m.step));
+			  }
+			  if (ok && verify) {
+				  uint64_t checksum = RemapBinaryHeader::kChecksumSeed();
+				  for (int y = 0; y < m.rows; ++y) {
+					  checksum = RemapBinaryHeader::checksum(
+						  maps_.back().ptr<char>(y),
+						  m.cols * maps_.back().elemSize(), checksum);
+				  }
+				  ok = checksum == m.checksum;
+			  }
+		  }
+		  if (!ok) {
+			  close();
+			  return false;
+		  }
+		  header_ = h;
+		  return true;
+	  }
+
+	  void close() {
+		  maps_.clear();
+		  file_.close();
+		  header_ = nullptr;
+	  }
+
+	  bool is_open() const { return header_ != nullptr; }
+
+	  /** @brief Number of maps.
+	  */
+	  size_t size() const { return maps_.size(); }
+
+	  /** @brief The map i, on the mapping (read only).
+	  */
+	  const cv::Mat& map(size_t i) const { return maps_[i]; }
+
+  private:
+
+	  /** @brief The map is a 2D OpenCV matrix inside the file.
+	  */
+	  static bool valid(const RemapBinaryHeader::Map &m, size_t file_size) {
+		  if (m.rows <= 0 || m.cols <= 0 || CV_MAT_TYPE(m.type) != m.type ||
+			  CV_MAT_DEPTH(m.type) > CV_64F) {
+			  return false;
+		  }
+		  uint64_t a = RemapBinaryHeader::kAlignment();
+		  uint64_t row_size = (uint64_t)m.cols * CV_ELEM_SIZE(m.type);
+		  return m.step % a == 0 && m.offset % a == 0 &&
+			  row_size <= m.step && m.offset <= file_size &&
+			  m.step <= file_size &&
+			  (uint64_t)m.rows <= (file_size - m.offset) / m.step;
+	  }
+
+	  CmnLib::system::MappedFile file_;
+	  const RemapBinaryHeader* header_;
+	  std::vector<cv::Mat> maps_;
+
+	  // No copying allowed
+	  RemapBinaryReader(const RemapBinaryReader&);
+	  void operator=(const RemapBinaryReader&);
+};
+
+
+} // namespace filesio
+} // namespace CmnIO
+
+
+#endif // CMNIO_FILESIO_REMAPBINARYIO_HPP__
@@ -8,6 +8,9 @@
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
+#include "RemapBinaryIO.hpp"
+#include "TextWriter.hpp"
+
 
 namespace CmnIO
 {
@@ -23,18 +26,17 @@ class RemapIO
 
 	  static int save(const std::string &filename, cv::Mat &src)
 	  {
-		  std::ofstream f(filename);
-		  f << src.cols << " " << src.rows << std::endl;
+		  TextWriter f;
+		  if (!f.open(filename)) return 0;
+		  f << src.cols << " " << src.rows << '\n';
 		  for (int y = 0; y < src.rows; ++y)
 		  {
 			  for (int x = 0; x < src.cols; ++x)
 			  {
-				  f << src.at<float>(y, x) << std::endl;
+				  f << src.at<float>(y, x) << '\n';
 			  }
 		  }
-		  f.close();
-		  f.clear();
-		  return 1;
+		  return f.close() ? 1 : 0;
 	  }
 
 	  static int load(const std::string &filename, cv::Mat &src)
@@ -130,6 +132,47 @@ class RemapIO
 		  fs2.release();
 		  return 1;
 	  }
+
+	  /** @brief Save two map remap in the binary format (RemapBinaryIO).
+
+		  @param[in] fixed_point Store the maps converted by cv::convertMaps
+		  (CV_16SC2 and CV_16UC1): half the size of two CV_32FC1 maps and
+		  faster with cv::remap, at 1/32 pixel of precision.
+		  @return Return TRUE if the file has been written.
+	  */
+	  static bool save_binary(const std::string &filename, const cv::Mat &mapx,
+		  const cv::Mat &mapy, bool fixed_point = false)
+	  {
+		  std::vector<cv::Mat> maps;
+		  if (fixed_point)
+		  {
+			  cv::Mat map1, map2;
+			  cv::convertMaps(mapx, mapy, map1, map2, CV_16SC2);
+			  maps.push_back(map1);
+			  maps.push_back(map2);
+		  }
+		  else
+		  {
+			  maps.push_back(mapx);
+			  if (!mapy.empty()) maps.push_back(mapy);
+		  }
+		  return RemapBinaryWriter::save(filename, maps);
+	  }
+
+	  /** @brief Load two map remap in the binary format, as copies.
+
+		  To use the maps in place, without copies, see RemapBinaryReader.
+		  @return Return TRUE if the file is a valid remap table.
+	  */
+	  static bool load_binary(const std::string &filename, cv::Mat &map1,
+		  cv::Mat &map2)
+	  {
+		  RemapBinaryReader reader;
+		  if (!reader.open(filename)) return false;
+		  map1 = reader.map(0).clone();
+		  map2 = reader.size() > 1 ? reader.map(1).clone() : cv::Mat();
+		  return true;
+	  }
 };
 
 } // namespace filesio
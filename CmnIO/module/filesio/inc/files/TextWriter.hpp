@@ -0,0 +1,158 @@
+/**
+* @file TextWriter.hpp
+* @brief Buffered text output of the filesio savers.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @original author Alessandro Moro
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef CMNIO_FILESIO_TEXTWRITER_HPP__
+#define CMNIO_FILESIO_TEXTWRITER_HPP__
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "string/inc/string/NumberConversion.hpp"
+#include "system/inc/system/buffered_file.hpp"
+
+namespace CmnIO
+{
+namespace filesio
+{
+
+
+/** @brief Text file written like a stream, without flushes.
+
+	The text is collected in a large buffer (CmnLib::system::BufferedFile),
+	the numbers are formatted in place by NumberConversion: the floating
+	point numbers with the shortest text which is read back as the same
+	value. Nothing is flushed at the end of the lines: write '\n', not
+	std::endl.
+	@code
+		CmnIO::filesio::TextWriter f;
+		if (!f.open(filename)) return false;
+		f << "Points3D Ver 0.1" << '\n';
+		f << id << " " << p.x << " " << p.y << '\n';
+		return f.close();
+	@endcode
+*/
+class TextWriter
+{
+  public:
+
+	  /** @brief Create (or append to) the file.
+
+	  @param[in] background Write the full buffers in a thread.
+	  @param[in] sync Wait for the disk at close.
+	  */
+	  bool open(const std::string &filename, bool append = false,
+		  bool background = false, bool sync = false,
+		  size_t buffer_size = (size_t)4 << 20)
+	  {
+		  return file_.open(filename, append, buffer_size, background, sync);
+	  }
+
+	  /** @brief Write the buffered text and close the file.
+
+	  @return False if the file was not open or a write failed.
+	  */
+	  bool close()
+	  {
+		  return file_.close();
+	  }
+
+	  bool is_open() const
+	  {
+		  return file_.is_open();
+	  }
+
+	  TextWriter& operator<<(const char* s)
+	  {
+		  file_.write(s, strlen(s));
+		  return *this;
+	  }
+
+	  TextWriter& operator<<(const std::string &s)
+	  {
+		  file_.write(s.data(), s.size());
+		  return *this;
+	  }
+
+	  /** @brief The chars are written as chars, like the streams.
+	  */
+	  TextWriter& operator<<(char c)
+	  {
+		  file_.put(c);
+		  return *this;
+	  }
+
+	  TextWriter& operator<<(signed char c)
+	  {
+		  file_.put((char)c);
+		  return *this;
+	  }
+
+	  TextWriter& operator<<(unsigned char c)
+	  {
+		  file_.put((char)c);
+		  return *this;
+	  }
+
+	  template <typename T>
+	  typename std::enable_if<std::is_integral<T>::value, TextWriter&>::type
+	  operator<<(T value)
+	  {
+		  char* p = file_.reserve(kMaxNumberSize);
+		  CmnLib::text::NumberConversion::FormatResult r =
+			  CmnLib::text::NumberConversion::format(p, p + kMaxNumberSize,
+			  value);
+		  if (r.error == CmnLib::text::NumberConversion::CONVERSION_OK)
+		  {
+			  file_.commit(r.ptr);
+		  }
+		  return *this;
+	  }
+
+	  template <typename T>
+	  typename std::enable_if<std::is_floating_point<T>::value, TextWriter&>::type
+	  operator<<(T value)
+	  {
+		  char* p = file_.reserve(kMaxNumberSize);
+		  CmnLib::text::NumberConversion::FormatResult r =
+			  CmnLib::text::NumberConversion::format_shortest(p,
+			  p + kMaxNumberSize, value);
+		  if (r.error == CmnLib::text::NumberConversion::CONVERSION_OK)
+		  {
+			  file_.commit(r.ptr);
+		  }
+		  return *this;
+	  }
+
+  private:
+
+	  static const size_t kMaxNumberSize = 64;
+
+	  CmnLib::system::BufferedFile file_;
+};
+
+} // namespace filesio
+} // namespace CmnIO
+
+
+#endif // CMNIO_FILESIO_TEXTWRITER_HPP__
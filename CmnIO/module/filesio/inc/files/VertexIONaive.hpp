@@ -29,6 +29,9 @@
 #include <vector>
 #include <string>
 
+#include "ChunkedTextParser.hpp"
+#include "TextWriter.hpp"
+
 namespace CmnIO
 {
 namespace filesio
@@ -47,29 +50,20 @@ public:
 	static bool read(const std::string &fname,
 		std::string &header,
 		std::vector<std::pair<_Ty2, _Ty3> > &v_xyxyz) {
-		std::ifstream f(fname);
-		if (!f.is_open()) return false;
-
-		// Skip the main header
-		std::string line;
-		std::getline(f, line);
-		std::getline(f, line);
-		// get the user header
-		std::getline(f, header);
-
-		// Get the points information
-		while (!f.eof()) {
-			std::string line;
-			std::getline(f, line);
-			if (line.size() > 0) {
-				float x = 0, y = 0, X = 0, Y = 0, Z = 0;
-				sscanf(line.c_str(), "%f %f %f %f %f", &x, &y, &X, &Y, &Z);
-				v_xyxyz.push_back(std::make_pair(_Ty2(x, y), _Ty3(X, Y, Z)));
+		typedef std::pair<_Ty2, _Ty3> Record;
+		// The main header and the user header
+		std::vector<std::string> lines;
+		if (!ChunkedTextParser::parse(fname, 3,
+			[](const char* first, const char* last, Record &r) {
+			float v[5] = { 0 };
+			if (ChunkedTextParser::parse_values(first, last, v, 5) == 0)
+			{
+				return false;
 			}
-		}
-		f.close();
-		f.clear();
-
+			r = std::make_pair(_Ty2(v[0], v[1]), _Ty3(v[2], v[3], v[4]));
+			return true;
+		}, v_xyxyz, &lines)) return false;
+		header = lines.size() > 2 ? lines[2] : std::string();
 		return true;
 	}
 
@@ -79,20 +73,18 @@ public:
 	static bool write(const std::string &fname,
 		const std::string &header,
 		std::vector<std::pair<_Ty2, _Ty3> > &v_xyxyz) {
-		std::ofstream f(fname);
-		if (!f.is_open()) return false;
+		TextWriter f;
+		if (!f.open(fname)) return false;
 
 		// Main header
-		f << "VertexIONaive v 0.1.0" << std::endl;
-		f << "x(px) y(px) X Y Z" << std::endl;
-		f << header << std::endl;
+		f << "VertexIONaive v 0.1.0" << '\n';
+		f << "x(px) y(px) X Y Z" << '\n';
+		f << header << '\n';
 		for (auto &it : v_xyxyz) {
 			f << it.first.x << " " << it.first.y << " " << it.second.x << " "
-				<< it.second.y << " " << it.second.z << std::endl;
+				<< it.second.y << " " << it.second.z << '\n';
 		}
-		f.close();
-		f.clear();
-		return true;
+		return f.close();
 	}
 
 };
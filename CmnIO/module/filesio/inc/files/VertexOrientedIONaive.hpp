@@ -28,6 +28,9 @@
 #include <vector>
 #include <string>
 
+#include "ChunkedTextParser.hpp"
+#include "TextWriter.hpp"
+
 namespace CmnIO
 {
 namespace filesio
@@ -46,29 +49,21 @@ public:
 	static bool read(const std::string &fname,
 		std::string &header,
 		std::vector<std::pair<_Ty2, std::pair<_Ty3, _Ty3>> > &v_xyxyz) {
-		std::ifstream f(fname);
-		if (!f.is_open()) return false;
-
-		// Skip the main header
-		std::string line;
-		std::getline(f, line);
-		std::getline(f, line);
-		// get the user header
-		std::getline(f, header);
-
-		// Get the points information
-		while (!f.eof()) {
-			std::string line;
-			std::getline(f, line);
-			if (line.size() > 0) {
-				float x = 0, y = 0, X = 0, Y = 0, Z = 0, Xr = 0, Yr = 0, Zr = 0;
-				sscanf(line.c_str(), "%f %f %f %f %f %f %f %f", &x, &y, &X, &Y, &Z, &Xr, &Yr, &Zr);
-				v_xyxyz.push_back(std::make_pair(_Ty2(x, y), std::make_pair(_Ty3(X, Y, Z), _Ty3(Xr, Yr, Zr))));
+		typedef std::pair<_Ty2, std::pair<_Ty3, _Ty3> > Record;
+		// The main header and the user header
+		std::vector<std::string> lines;
+		if (!ChunkedTextParser::parse(fname, 3,
+			[](const char* first, const char* last, Record &r) {
+			float v[8] = { 0 };
+			if (ChunkedTextParser::parse_values(first, last, v, 8) == 0)
+			{
+				return false;
 			}
-		}
-		f.close();
-		f.clear();
-
+			r = std::make_pair(_Ty2(v[0], v[1]), std::make_pair(
+				_Ty3(v[2], v[3], v[4]), _Ty3(v[5], v[6], v[7])));
+			return true;
+		}, v_xyxyz, &lines)) return false;
+		header = lines.size() > 2 ? lines[2] : std::string();
 		return true;
 	}
 
@@ -78,29 +73,22 @@ public:
 	static bool write(const std::string &fname, bool append,
 		const std::string &header,
 		std::vector<std::pair<_Ty2, std::pair<_Ty3, _Ty3>> > &v_xyxyz) {
-		std::ofstream f;
-		if (!append) {
-			f.open(fname);
-		} else {
-			f.open(fname, std::ios::app);
-		}
-		if (!f.is_open()) return false;
+		TextWriter f;
+		if (!f.open(fname, append)) return false;
 
 		// Main header
 		if (!append) {
-			f << "VertexOrientedIONaive v 0.1.0" << std::endl;
-			f << "x(px) y(px) X Y Z Xr Yr Zr" << std::endl;
-			f << header << std::endl;
+			f << "VertexOrientedIONaive v 0.1.0" << '\n';
+			f << "x(px) y(px) X Y Z Xr Yr Zr" << '\n';
+			f << header << '\n';
 		}
 		for (auto &it : v_xyxyz) {
 			f << it.first.x << " " << it.first.y << " " << it.second.first.x << " "
 				<< it.second.first.y << " " << it.second.first.z << " "
 				<< it.second.second.x << " " << it.second.second.y << " "
-				<< it.second.second.z << std::endl;
+				<< it.second.second.z << '\n';
 		}
-		f.close();
-		f.clear();
-		return true;
+		return f.close();
 	}
 
 };
@@ -24,12 +24,16 @@
 #ifndef CMNIO_FILESIO_HEADERS_HPP__
 #define CMNIO_FILESIO_HEADERS_HPP__
 
+#include "ChunkedTextParser.hpp"
+#include "TextWriter.hpp"
 #include "ConfigLineIO.hpp"
 #include "FishEyeLensCorrectionIO.hpp"
 #include "LineDirectionIO.hpp"
 #include "Mesh3DxyzxyIO.hpp"
+#include "RemapBinaryIO.hpp"
 #include "RemapIO.hpp"
 #include "Points2DIO.hpp"
+#include "PointCloudBinaryIO.hpp"
 #include "Points3DIO.hpp"
 #include "Pairs2DIO.hpp"
 #include "Node6DOFT3R3.hpp"
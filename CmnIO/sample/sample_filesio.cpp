@@ -21,8 +21,11 @@
 *
 */
 
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <string>
+#include <vector>
 
 #include <opencv2/opencv.hpp>
 
@@ -49,11 +52,137 @@ void test_vertexIO() {
 	}
 }
 
+/** @brief Test the parallel text parser
+*/
+void test_chunked_parser() {
+
+	std::string fname = "test_chunked_parser.txt";
+	std::vector<std::pair<int, float> > expected, values;
+	{
+		std::ofstream f(fname);
+		f << "ChunkedTextParser test" << std::endl;
+		f << "#id value" << std::endl;
+		for (int i = 0; i < 10000; ++i) {
+			f << i << " " << i * 0.5f << std::endl;
+			expected.push_back(std::make_pair(i, i * 0.5f));
+		}
+	}
+	// small chunks: many tasks, the records must stay in order
+	std::vector<std::string> header;
+	bool parsed = CmnIO::filesio::ChunkedTextParser::parse(fname, 2,
+		[](const char* first, const char* last, std::pair<int, float> &r) {
+		double v[2];
+		if (CmnIO::filesio::ChunkedTextParser::parse_values(first, last,
+			v, 2) != 2) return false;
+		r = std::make_pair((int)v[0], (float)v[1]);
+		return true;
+	}, values, &header, 1000);
+	std::cout << "parsed: " << parsed << " header: " << header.size() <<
+		" same values: " << (values == expected) << std::endl;
+	remove(fname.c_str());
+}
+
+/** @brief Test the buffered text output
+*/
+void test_text_writer() {
+
+	std::string fname = "test_text_writer.txt";
+	std::vector<std::pair<int, float> > expected, values;
+	CmnIO::filesio::TextWriter f;
+	f.open(fname, false, true);
+	f << "TextWriter test" << '\n';
+	for (int i = 0; i < 10000; ++i) {
+		float v = 1.0f / (i + 1);
+		f << i << " " << v << '\n';
+		expected.push_back(std::make_pair(i, v));
+	}
+	bool closed = f.close();
+	// the shortest text is read back as the same float
+	CmnIO::filesio::ChunkedTextParser::parse(fname, 1,
+		[](const char* first, const char* last, std::pair<int, float> &r) {
+		double v[2];
+		if (CmnIO::filesio::ChunkedTextParser::parse_values(first, last,
+			v, 2) != 2) return false;
+		r = std::make_pair((int)v[0], (float)v[1]);
+		return true;
+	}, values);
+	std::cout << "closed: " << closed << " same values: " <<
+		(values == expected) << std::endl;
+	remove(fname.c_str());
+}
+
+/** @brief Test the binary point cloud format
+*/
+void test_points3d_binary() {
+
+	std::map<int, cv::Point3f> m_points, m_text, m_binary;
+	for (int i = 0; i < 1000; ++i) {
+		m_points[i * 3] = cv::Point3f(i * 0.5f, -i * 0.25f, i * 0.125f);
+	}
+	std::string fname_text = "test_points3d.txt",
+		fname_binary = "test_points3d.pcb";
+	CmnIO::filesio::Points3DIO::save_collection(fname_text, m_points);
+	// convert the text file and read the columns without copies
+	bool converted = CmnIO::filesio::Points3DIO::convert_text_to_binary(
+		fname_text, fname_binary);
+	CmnIO::filesio::Points3DIO::load_collection(fname_text, m_text);
+	CmnIO::filesio::Points3DIO::load_collection_binary(fname_binary,
+		m_binary);
+	std::cout << "converted: " << converted << " same points: " <<
+		(m_text == m_binary) << std::endl;
+
+	CmnIO::filesio::PointCloudBinaryReader r;
+	if (r.open(fname_binary)) {
+		double sum = 0;
+		for (float x : r.x()) sum += x;
+		std::cout << "points: " << r.size() << " sum x: " << sum << std::endl;
+	}
+	r.close();
+	remove(fname_text.c_str());
+	remove(fname_binary.c_str());
+}
+
+void test_remap_binary() {
+
+	cv::Mat mapx(480, 641, CV_32FC1), mapy(480, 641, CV_32FC1);
+	for (int y = 0; y < mapx.rows; ++y) {
+		for (int x = 0; x < mapx.cols; ++x) {
+			mapx.at<float>(y, x) = x * 0.75f + y * 0.01f;
+			mapy.at<float>(y, x) = y * 0.75f - x * 0.01f;
+		}
+	}
+	std::string fname = "test_remap.bin", fname_fixed = "test_remap16.bin";
+	bool saved = CmnIO::filesio::RemapIO::save_binary(fname, mapx, mapy) &&
+		CmnIO::filesio::RemapIO::save_binary(fname_fixed, mapx, mapy, true);
+	cv::Mat map1, map2;
+	CmnIO::filesio::RemapIO::load_binary(fname, map1, map2);
+	std::cout << "saved: " << saved << " same maps: " <<
+		(cv::norm(map1, mapx, cv::NORM_INF) == 0 &&
+		cv::norm(map2, mapy, cv::NORM_INF) == 0) << std::endl;
+
+	// the fixed point maps, used in place
+	CmnIO::filesio::RemapBinaryReader r;
+	if (r.open(fname_fixed)) {
+		std::cout << "maps: " << r.size() << " type: " <<
+			(r.map(0).type() == CV_16SC2) << " " <<
+			(r.map(1).type() == CV_16UC1) << std::endl;
+		cv::Mat src(480, 640, CV_8UC1, cv::Scalar(128)), dst;
+		cv::remap(src, dst, r.map(0), r.map(1), cv::INTER_LINEAR);
+	}
+	r.close();
+	remove(fname.c_str());
+	remove(fname_fixed.c_str());
+}
+
 // ############################################################################
 
 int main(int argc, char* argv[])
 {
 	test_vertexIO();
+	test_chunked_parser();
+	test_text_writer();
+	test_points3d_binary();
+	test_remap_binary();
 	
 	return 0;
 }
@@ -17,6 +17,8 @@ COST OF ALL NECESSARY SERVICING, REPAIR OR CORRECTION.
 
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <memory>
 
 #include "opencv2/highgui/highgui.hpp"
 #include "opencv2/imgproc/imgproc.hpp"
@@ -31,12 +33,31 @@ namespace cmnipcontainer
 {
 
 /** Container of the image of points
+	The map allocator can be replaced, i.e. with
+	CmnLib::core::Allocator< std::pair<const int, MatchPositionPoints> > to
+	take the nodes from a CmnLib::core::MonotonicArena or NodePool reset at
+	every frame.
 */
-class MatchPositionPointsManager
+template <typename _Alloc =
+	std::allocator< std::pair<const int, MatchPositionPoints> > >
+class MatchPositionPointsManagerT
 {
 public:
 
-	MatchPositionPointsManager() {}
+	/** Container of the image points.
+	*/
+	typedef std::map<int, MatchPositionPoints, std::less<int>, _Alloc>
+		ImagePointMap;
+
+	MatchPositionPointsManagerT() {}
+
+	/** @brief Construct with the allocator used by the container.
+		@param[in] alloc Allocator whose memory must outlive the manager.
+		           A per-frame arena must be reset only after clear() is
+		           called.
+	*/
+	explicit MatchPositionPointsManagerT(const _Alloc &alloc) :
+		m_image_point(std::less<int>(), alloc) {}
 
 	/** @brief Clear the memory
 	*/
@@ -132,7 +153,7 @@ public:
 	*/
 	void display()	{
 
-		for (std::map<int, MatchPositionPoints>::iterator it = m_image_point.begin(); it != m_image_point.end(); it++)
+		for (typename ImagePointMap::iterator it = m_image_point.begin(); it != m_image_point.end(); it++)
 		{
 			std::cout << "Image: " << it->first << std::endl;
 
@@ -168,7 +189,7 @@ public:
 
 		myfile << "MatchPositionPointsManager version 1" << std::endl;
 		myfile << "iNumImages " << (int)m_image_point.size() << std::endl;
-		for (std::map<int, MatchPositionPoints>::iterator it = m_image_point.begin(); it != m_image_point.end(); it++)
+		for (typename ImagePointMap::iterator it = m_image_point.begin(); it != m_image_point.end(); it++)
 		{
 			std::vector<int> v_id = it->second.getIDList();
 			myfile << "iImageID " << it->first << std::endl;
@@ -556,9 +577,11 @@ private:
 		first:  image id
 		second: image point match position
 	*/
-	std::map<int, MatchPositionPoints > m_image_point;
+	ImagePointMap m_image_point;
 };
 
+typedef MatchPositionPointsManagerT<> MatchPositionPointsManager;
+
 
 /** Utilities class to increase the information of the ImagePointMatchPositionContainer
 */
@@ -568,7 +591,9 @@ public:
 			
 	/** Create an image with the point 
 	*/
-	static cv::Mat toImage(MatchPositionPointsManager &manager, cv::Size &size, int id)
+	template <typename _Alloc>
+	static cv::Mat toImage(MatchPositionPointsManagerT<_Alloc> &manager,
+		cv::Size &size, int id)
 	{
 		cv::Mat out(size, CV_8UC3);
 		//out = cv::Scalar(255, 255, 255);
@@ -35,4 +35,22 @@ COST OF ALL NECESSARY SERVICING, REPAIR OR CORRECTION.
 #define USE_MEMORYMANAGER
 #endif
 
+/*
+	use the thread-caching allocator in fastMalloc/fastFree
+*/
+#define DO_USE_FASTMALLOC 0
+
+#if DO_USE_FASTMALLOC == 1
+#define USE_FASTMALLOC
+#endif
+
+/*
+	collect the fastMalloc/fastFree statistics (CmnLib::core::MemoryStats)
+*/
+#define DO_USE_MEMORYSTATS 1
+
+#if DO_USE_MEMORYSTATS == 1
+#define USE_MEMORYSTATS
+#endif
+
 #endif /* CMNLIB_CMNLIB_LIBDEFINE_HPP__ */
@@ -24,74 +24,1022 @@
 
 #include "../inc/cmnlibcore/foundations_memory.hpp"
 
-#ifndef CL_MEMORY_MANAGER
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sys/mman.h>
+#endif
+
+namespace CmnLib
+{
+namespace core
+{
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Thread-caching small-object allocator (binned)
+//
+// Memory is requested to the system in super-blocks of BIG_BLOCK_SIZE bytes,
+// split in blocks of MEM_BLOCK_SIZE bytes. Every block serves objects of a
+// single size class and belongs to one thread. The owner allocates from the
+// bump pointer or the private free list without locking; the other threads
+// push released objects on the public free list, protected by the block lock.
+//----------------------------------------------------------------------------
+
+const size_t MEM_BLOCK_SIGNATURE = 0x01234567;
+const int MEM_BLOCK_SHIFT = 14;
+const size_t MEM_BLOCK_SIZE = (size_t)1 << MEM_BLOCK_SHIFT;
+const size_t HDR_SIZE = 128;
+const size_t MAX_BLOCK_SIZE = MEM_BLOCK_SIZE - HDR_SIZE;
+const size_t BIG_BLOCK_SIZE = (size_t)1 << 20;
+const int MAX_BIN = 28;
+
+// All the sizes are multiple of CL_MALLOC_ALIGN, and the block header is
+// HDR_SIZE bytes, so every object is aligned as the system fastMalloc.
+const int binSizeTab[MAX_BIN+1] =
+{ 16, 32, 48, 64, 80, 96, 112, 128, 144, 160, 192, 224, 256, 320, 384, 480,
+544, 672, 768, 896, 1056, 1328, 1600, 2048, 2688, 4048, 5408, 8128, 16256 };
+
+struct MallocTables
+{
+	MallocTables() : binIdx()
+	{
+		int i, j = 0, n;
+		for( i = 0; i <= MAX_BIN; i++ )
+		{
+			n = binSizeTab[i]>>3;
+			for( ; j <= n; j++ )
+				binIdx[j] = (uchar)i;
+		}
+	}
+
+	int bin(size_t size) const
+	{
+		assert( size <= MAX_BLOCK_SIZE );
+		return binIdx[(size + 7)>>3];
+	}
+
+	uchar binIdx[MAX_BLOCK_SIZE/8+1];
+};
+
+const MallocTables& mallocTables()
+{
+	static const MallocTables tables;
+	return tables;
+}
+
+void* SystemAlloc(size_t size)
+{
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+	void* ptr = VirtualAlloc(0, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	return ptr ? ptr : MemoryFoundations::OutOfMemoryError(size);
+#else
+	#ifndef MAP_ANONYMOUS
+	#define MAP_ANONYMOUS MAP_ANON
+	#endif
+	void* ptr = mmap(0, size, (PROT_READ | PROT_WRITE), MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+	return ptr != MAP_FAILED ? ptr : MemoryFoundations::OutOfMemoryError(size);
+#endif
+}
+
+void SystemFree(void* ptr, size_t size)
+{
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+	(void)size;
+	VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+	munmap(ptr, size);
+#endif
+}
+
+struct Node
+{
+	Node* next;
+};
+
+struct ThreadData;
+
+struct Block
+{
+	Block(Block* _next)
+	{
+		signature = MEM_BLOCK_SIGNATURE;
+		prev = 0;
+		next = _next;
+		privateFreeList = 0;
+		publicFreeList = 0;
+		bumpPtr = endPtr = 0;
+		objSize = 0;
+		threadData = 0;
+		data = (uchar*)this + HDR_SIZE;
+	}
+
+	void init(Block* _prev, Block* _next, int _objSize, ThreadData* _threadData)
+	{
+		prev = _prev;
+		if(prev)
+			prev->next = this;
+		next = _next;
+		if(next)
+			next->prev = this;
+		objSize = _objSize;
+		binIdx = mallocTables().bin(objSize);
+		threadData = _threadData;
+		privateFreeList = 0;
+		publicFreeList = 0;
+		bumpPtr = data;
+		int nobjects = (int)(MAX_BLOCK_SIZE/objSize);
+		endPtr = bumpPtr + nobjects*objSize;
+		almostEmptyThreshold = (nobjects + 1)/2;
+		allocated = 0;
+	}
+
+	bool isFilled() const { return allocated > almostEmptyThreshold; }
+
+	size_t signature;
+	Block* prev;
+	Block* next;
+	Node* privateFreeList;
+	// Written under the block lock, peeked without lock by the owner.
+	std::atomic<Node*> publicFreeList;
+	uchar* bumpPtr;
+	uchar* endPtr;
+	uchar* data;
+	// Read without lock by the releasing thread to decide if it is the owner.
+	std::atomic<ThreadData*> threadData;
+	int objSize;
+	int binIdx;
+	int allocated;
+	int almostEmptyThreshold;
+	std::mutex cs;
+};
+
+static_assert(sizeof(Block) <= HDR_SIZE, "Block header does not fit HDR_SIZE");
+
+struct BigBlock
+{
+	BigBlock(size_t bigBlockSize, BigBlock* _next)
+	{
+		first = alignPtr((Block*)(this+1), (int)MEM_BLOCK_SIZE);
+		next = _next;
+		nblocks = (int)(((char*)this + bigBlockSize - (char*)first)/MEM_BLOCK_SIZE);
+		Block* p = 0;
+		for( int i = nblocks-1; i >= 0; i-- )
+			p = ::new((uchar*)first + i*MEM_BLOCK_SIZE) Block(p);
+	}
+
+	BigBlock* next;
+	Block* first;
+	int nblocks;
+};
+
+// The super-blocks are recycled but never returned to the system: threads
+// may release memory after the static objects have been destroyed, so the
+// pool has no destructor.
+struct BlockPool
+{
+	BlockPool() : freeBlocks(0), pool(0)
+	{
+	}
+
+	Block* alloc()
+	{
+		std::lock_guard<std::mutex> lock(cs);
+		Block* block;
+		if( !freeBlocks )
+		{
+			BigBlock* bblock = ::new(SystemAlloc(BIG_BLOCK_SIZE)) BigBlock(BIG_BLOCK_SIZE, pool);
+			freeBlocks = bblock->first;
+			pool = bblock;
+		}
+		block = freeBlocks;
+		freeBlocks = freeBlocks->next;
+		if( freeBlocks )
+			freeBlocks->prev = 0;
+		return block;
+	}
+
+	void free(Block* block)
+	{
+		std::lock_guard<std::mutex> lock(cs);
+		block->prev = 0;
+		block->next = freeBlocks;
+		freeBlocks = block;
+	}
+
+	std::mutex cs;
+	Block* freeBlocks;
+	BigBlock* pool;
+};
+
+BlockPool& mallocPool()
+{
+	// Constructed once and intentionally leaked (see BlockPool).
+	static BlockPool* pool = ::new BlockPool();
+	return *pool;
+}
+
+enum { START=0, FREE=1, GC=2 };
+
+struct ThreadData
+{
+	ThreadData() { for(int i = 0; i <= MAX_BIN; i++) bins[i][START] = bins[i][FREE] = bins[i][GC] = 0; }
+	~ThreadData()
+	{
+		// mark all the thread blocks as abandoned or even release them
+		for( int i = 0; i <= MAX_BIN; i++ )
+		{
+			Block *bin = bins[i][START], *block = bin;
+			bins[i][START] = bins[i][FREE] = bins[i][GC] = 0;
+			if( block )
+			{
+				do
+				{
+					Block* next = block->next;
+					int allocated;
+					{
+					std::lock_guard<std::mutex> lock(block->cs);
+					block->next = block->prev = 0;
+					block->threadData = 0;
+					// collect the public list so that the thread adopting
+					// the block inherits an exact count
+					Node* node = block->publicFreeList.exchange(0);
+					while( node )
+					{
+						Node* nextNode = node->next;
+						node->next = block->privateFreeList;
+						block->privateFreeList = node;
+						--block->allocated;
+						node = nextNode;
+					}
+					allocated = block->allocated;
+					}
+					if( allocated == 0 )
+						mallocPool().free(block);
+					block = next;
+				}
+				while( block != bin );
+			}
+		}
+	}
+
+	void moveBlockToFreeList( Block* block )
+	{
+		int i = block->binIdx;
+		Block*& freePtr = bins[i][FREE];
+		assert( block->next->prev == block && block->prev->next == block );
+		if( block != freePtr )
+		{
+			Block*& gcPtr = bins[i][GC];
+			if( gcPtr == block )
+				gcPtr = block->next;
+			if( block->next != block )
+			{
+				block->prev->next = block->next;
+				block->next->prev = block->prev;
+			}
+			block->next = freePtr->next;
+			block->prev = freePtr;
+			freePtr = block->next->prev = block->prev->next = block;
+		}
+	}
+
+	Block* bins[MAX_BIN+1][3];
 
+	static ThreadData* get();
+	static void release();
+};
+
+// Fast access to the thread cache. The TLS key is only used to be notified
+// when a thread exits.
+thread_local ThreadData* tlsData = 0;
+
+// The thread cache is taken from the system allocator: operator new can be
+// routed back to binnedMalloc (CL_MEMORY_MANAGER with USE_FASTMALLOC), which
+// would ask again for the cache of the thread.
+ThreadData* createData()
+{
+	void* p = ::malloc( sizeof(ThreadData) );
+	if( !p )
+		throw std::bad_alloc();
+	return new (p) ThreadData;
+}
+
+void destroyData(ThreadData* data)
+{
+	data->~ThreadData();
+	::free( data );
+}
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+
+ThreadData* ThreadData::get()
+{
+	if( !tlsData )
+		tlsData = createData();
+	return tlsData;
+}
 
 #else
 
+pthread_key_t tlsKey;
+pthread_once_t tlsKeyOnce = PTHREAD_ONCE_INIT;
+
+void deleteData(void* data)
+{
+	tlsData = 0;
+	destroyData( (ThreadData*)data );
+}
+
+void createKey()
+{
+	pthread_key_create(&tlsKey, deleteData);
+}
+
+ThreadData* ThreadData::get()
+{
+	if( !tlsData )
+	{
+		pthread_once(&tlsKeyOnce, createKey);
+		tlsData = createData();
+		pthread_setspecific(tlsKey, tlsData);
+	}
+	return tlsData;
+}
+
+#endif
+
+void ThreadData::release()
+{
+	ThreadData* data = tlsData;
+	if( data )
+	{
+		tlsData = 0;
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64))
+		pthread_setspecific(tlsKey, 0);
+#endif
+		destroyData( data );
+	}
+}
+
+}	// namespace
 
 //----------------------------------------------------------------------------
-void* operator new (size_t uiSize)
+void* MemoryFoundations::binnedMalloc( size_t size )
 {
-	return Memory::getSingletonPtr()->Allocate(uiSize, 0, 0, false);
+	if( size > MAX_BLOCK_SIZE )
+	{
+		// The returned pointer is aligned to MEM_BLOCK_SIZE, which never
+		// happens for the objects stored in a block.
+		size_t size1 = size + sizeof(uchar*)*2 + MEM_BLOCK_SIZE;
+		uchar* udata = (uchar*)SystemAlloc(size1);
+		if( !udata )
+			return 0;
+		uchar** adata = alignPtr((uchar**)udata + 2, (int)MEM_BLOCK_SIZE);
+		adata[-1] = udata;
+		adata[-2] = (uchar*)size1;
+		return adata;
+	}
+
+	ThreadData* tls = ThreadData::get();
+	int idx = mallocTables().bin(size);
+	Block*& startPtr = tls->bins[idx][START];
+	Block*& gcPtr = tls->bins[idx][GC];
+	Block*& freePtr = tls->bins[idx][FREE], *block = freePtr;
+	size = binSizeTab[idx];
+	uchar* data = 0;
+
+	for(;;)
+	{
+		if( block )
+		{
+			// try to find non-full block
+			for(;;)
+			{
+				assert( block->next->prev == block && block->prev->next == block );
+				if( block->bumpPtr )
+				{
+					data = block->bumpPtr;
+					if( (block->bumpPtr += size) >= block->endPtr )
+						block->bumpPtr = 0;
+					break;
+				}
+
+				if( block->privateFreeList )
+				{
+					data = (uchar*)block->privateFreeList;
+					block->privateFreeList = block->privateFreeList->next;
+					break;
+				}
+
+				if( block == startPtr )
+					break;
+				block = block->next;
+			}
+
+			freePtr = block;
+			if( !data )
+			{
+				// collect the objects released by the other threads
+				block = gcPtr; 
+				for( int k = 0; k < 2; k++ )
+				{
+					assert( block->signature == MEM_BLOCK_SIGNATURE );
+					if( block->publicFreeList.load(std::memory_order_relaxed) )
+					{
+						{
+						std::lock_guard<std::mutex> lock(block->cs);
+						block->privateFreeList = block->publicFreeList.exchange(0);
+						}
+						Node* node = block->privateFreeList;
+						for(;node != 0; node = node->next)
+							--block->allocated;
+						data = (uchar*)block->privateFreeList;
+						block->privateFreeList = block->privateFreeList->next;
+						gcPtr = block->next;
+						if( block->allocated+1 <= block->almostEmptyThreshold )
+							tls->moveBlockToFreeList(block);
+						break;
+					}
+					block = block->next;
+				}
+				if( !data )
+					gcPtr = block;
+			}
+		}
+
+		if( data )
+			break;
+		block = mallocPool().alloc();
+		block->init(startPtr ? startPtr->prev : block, startPtr ? startPtr : block, (int)size, tls);
+		if( !startPtr )
+			startPtr = gcPtr = freePtr = block;
+	}
+
+	++block->allocated;
+	return data;
 }
 //----------------------------------------------------------------------------
-void* operator new[](size_t uiSize)
+void MemoryFoundations::binnedFree( void* ptr )
+{
+	if( ((size_t)ptr & (MEM_BLOCK_SIZE-1)) == 0 )
+	{
+		if( ptr != 0 )
+		{
+			void* origPtr = ((void**)ptr)[-1];
+			size_t sz = (size_t)((void**)ptr)[-2];
+			SystemFree( origPtr, sz );
+		}
+		return;
+	}
+
+	ThreadData* tls = ThreadData::get();
+	Node* node = (Node*)ptr;
+	Block* block = (Block*)((size_t)ptr & ~(MEM_BLOCK_SIZE-1));
+	assert( block->signature == MEM_BLOCK_SIGNATURE );
+
+	if( block->threadData.load(std::memory_order_relaxed) == tls )
+	{
+		bool prevFilled = block->isFilled();
+		--block->allocated;
+		if( !block->isFilled() && (block->allocated == 0 || prevFilled) )
+		{
+			if( block->allocated == 0 )
+			{
+				int idx = block->binIdx;
+				Block*& startPtr = tls->bins[idx][START];
+				Block*& freePtr = tls->bins[idx][FREE];
+				Block*& gcPtr = tls->bins[idx][GC];
+	                
+				if( block == block->next )
+				{
+					assert( startPtr == block && freePtr == block && gcPtr == block );
+					startPtr = freePtr = gcPtr = 0;
+				}
+				else
+				{
+					if( freePtr == block )
+						freePtr = block->next;
+					if( gcPtr == block )
+						gcPtr = block->next;
+					if( startPtr == block )
+						startPtr = block->next;
+					block->prev->next = block->next;
+					block->next->prev = block->prev;
+				}
+				mallocPool().free(block);
+				return;
+			}
+
+			tls->moveBlockToFreeList(block);
+		}
+		node->next = block->privateFreeList;
+		block->privateFreeList = node;
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lock(block->cs);
+
+		node->next = block->publicFreeList.load(std::memory_order_relaxed);
+		block->publicFreeList.store(node, std::memory_order_relaxed);
+		if( block->threadData.load(std::memory_order_relaxed) == 0 )
+		{
+			// take ownership of the abandoned block. The owner marks the
+			// block abandoned under the same lock, so only one thread can
+			// adopt it.
+			int idx = block->binIdx;
+			block->threadData = tls;
+			Block*& startPtr = tls->bins[idx][START];
+
+			if( startPtr )
+			{
+				block->next = startPtr;
+				block->prev = startPtr->prev;
+				block->next->prev = block->prev->next = block;
+			}
+			else
+			{
+				block->next = block->prev = block;
+				startPtr = tls->bins[idx][FREE] = tls->bins[idx][GC] = block;
+			}
+		}
+	}
+}
+//----------------------------------------------------------------------------
+void MemoryFoundations::binnedReleaseThreadData()
+{
+	ThreadData::release();
+}
+//----------------------------------------------------------------------------
+size_t MemoryFoundations::binnedSize( void* ptr )
+{
+	if( ((size_t)ptr & (MEM_BLOCK_SIZE-1)) == 0 )
+	{
+		uchar* origPtr = ((uchar**)ptr)[-1];
+		size_t sz = (size_t)((void**)ptr)[-2];
+		return sz - ((uchar*)ptr - origPtr);
+	}
+	Block* block = (Block*)((size_t)ptr & ~(MEM_BLOCK_SIZE-1));
+	assert( block->signature == MEM_BLOCK_SIGNATURE );
+	return (size_t)block->objSize;
+}
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Allocation statistics
+//
+// Every thread owns a ThreadStats slot, written only by the owner with
+// relaxed load/store pairs (no read-modify-write on the fast path) and read
+// by MemoryStats::snapshot. The slots are never released: when a thread
+// terminates its slot is marked free and reused by the next thread, so the
+// counters of the terminated threads are still summed. The allocations made
+// after the slot is released (by the destructors of the other thread_local
+// objects) are recorded in a slot shared by the terminating threads.
+//----------------------------------------------------------------------------
+
+const int NUM_SITES = 4096;
+const int MAX_SITE_PROBES = 16;
+
+inline void add(std::atomic<uint64_t> &counter, uint64_t value)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + value,
+		std::memory_order_relaxed);
+}
+
+inline void add(std::atomic<int64_t> &counter, int64_t value)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + value,
+		std::memory_order_relaxed);
+}
+
+struct ThreadStats
+{
+	ThreadStats() : allocCalls(0), freeCalls(0), totalBytes(0), liveBlocks(0),
+		liveBytes(0), maxBlockSize(0), inUse(true), next(0), pendingBytes(0),
+		countdown(0)
+	{
+		for( int i = 0; i < MemoryStats::NUM_BUCKETS; i++ )
+			histogram[i] = 0;
+	}
+
+	std::atomic<uint64_t> allocCalls;
+	std::atomic<uint64_t> freeCalls;
+	std::atomic<uint64_t> totalBytes;
+	// Blocks released by another thread make these negative.
+	std::atomic<int64_t> liveBlocks;
+	std::atomic<int64_t> liveBytes;
+	std::atomic<uint64_t> maxBlockSize;
+	std::atomic<uint64_t> histogram[MemoryStats::NUM_BUCKETS];
+	std::atomic<bool> inUse;
+	ThreadStats* next;
+	// Owner only.
+	int64_t pendingBytes;
+	unsigned int countdown;
+};
+
+struct SiteStats
+{
+	std::atomic<const void*> address;
+	std::atomic<uint64_t> numCalls;
+	std::atomic<uint64_t> numBytes;
+};
+
+// Constant initialized, usable by the allocations made by the constructors
+// of the static objects.
+std::atomic<ThreadStats*> statsHead(0);
+std::atomic<int64_t> flushedBytes(0);
+std::atomic<int64_t> peakBytes(0);
+std::atomic<unsigned int> statsSampleRate(1024);
+SiteStats sites[NUM_SITES];
+SiteStats otherSites;
+
+void flushPeak(int64_t bytes)
+{
+	int64_t now = flushedBytes.fetch_add(bytes, std::memory_order_relaxed) +
+		bytes;
+	int64_t peak = peakBytes.load(std::memory_order_relaxed);
+	while( now > peak &&
+		!peakBytes.compare_exchange_weak(peak, now, std::memory_order_relaxed) )
+	{
+	}
+}
+
+void flushPeak(ThreadStats* stats)
+{
+	flushPeak(stats->pendingBytes);
+	stats->pendingBytes = 0;
+}
+
+ThreadStats* acquireStats()
+{
+	for( ThreadStats* stats = statsHead.load(std::memory_order_acquire);
+		stats != 0; stats = stats->next )
+	{
+		bool expected = false;
+		if( !stats->inUse.load(std::memory_order_relaxed) &&
+			stats->inUse.compare_exchange_strong(expected, true,
+			std::memory_order_acquire) )
+			return stats;
+	}
+	// The slot cannot come from fastMalloc, which is being recorded.
+	void* memory = malloc(sizeof(ThreadStats));
+	if( !memory )
+		return 0;
+	ThreadStats* stats = ::new(memory) ThreadStats();
+	ThreadStats* head = statsHead.load(std::memory_order_relaxed);
+	do
+	{
+		stats->next = head;
+	}
+	while( !statsHead.compare_exchange_weak(head, stats,
+		std::memory_order_release, std::memory_order_relaxed) );
+	return stats;
+}
+
+// Never released, written with read-modify-write operations.
+std::atomic<ThreadStats*> exitStats(0);
+
+ThreadStats* acquireExitStats()
+{
+	ThreadStats* stats = exitStats.load(std::memory_order_acquire);
+	if( stats )
+		return stats;
+	stats = acquireStats();
+	if( !stats )
+		return 0;
+	ThreadStats* current = 0;
+	if( !exitStats.compare_exchange_strong(current, stats,
+		std::memory_order_acq_rel) )
+	{
+		stats->inUse.store(false, std::memory_order_release);
+		stats = current;
+	}
+	return stats;
+}
+
+struct ThreadStatsOwner
+{
+	constexpr ThreadStatsOwner() : stats(0), destroyed(false) {}
+	~ThreadStatsOwner()
+	{
+		if( stats )
+		{
+			flushPeak(stats);
+			stats->inUse.store(false, std::memory_order_release);
+			stats = 0;
+		}
+		destroyed = true;
+	}
+
+	/** The slot of the thread, 0 after the destructor (the updates go to
+		the shared slot) or if it cannot be allocated.
+	*/
+	ThreadStats* get()
+	{
+		if( !stats && !destroyed )
+			stats = acquireStats();
+		return stats;
+	}
+
+	ThreadStats* stats;
+	bool destroyed;
+};
+
+thread_local ThreadStatsOwner tlsStats;
+
+void recordExit(size_t size, bool alloc)
+{
+	ThreadStats* stats = acquireExitStats();
+	if( !stats )
+		return;
+	if( alloc )
+	{
+		stats->allocCalls.fetch_add(1, std::memory_order_relaxed);
+		stats->totalBytes.fetch_add(size, std::memory_order_relaxed);
+		stats->histogram[MemoryStats::bucket(size)].fetch_add(1,
+			std::memory_order_relaxed);
+		uint64_t maxSize = stats->maxBlockSize.load(std::memory_order_relaxed);
+		while( size > maxSize &&
+			!stats->maxBlockSize.compare_exchange_weak(maxSize, size,
+			std::memory_order_relaxed) )
+		{
+		}
+	}
+	else
+	{
+		stats->freeCalls.fetch_add(1, std::memory_order_relaxed);
+	}
+	int64_t bytes = alloc ? (int64_t)size : -(int64_t)size;
+	stats->liveBlocks.fetch_add(alloc ? 1 : -1, std::memory_order_relaxed);
+	stats->liveBytes.fetch_add(bytes, std::memory_order_relaxed);
+	flushPeak(bytes);
+}
+
+void recordSite(const void* address, uint64_t numCalls, uint64_t numBytes)
+{
+	size_t h = ((size_t)address >> 4) * 2654435761u;
+	for( int i = 0; i < MAX_SITE_PROBES; i++ )
+	{
+		SiteStats& site = sites[(h + i) & (NUM_SITES - 1)];
+		const void* current = site.address.load(std::memory_order_relaxed);
+		if( current == 0 &&
+			site.address.compare_exchange_strong(current, address,
+			std::memory_order_relaxed) )
+			current = address;
+		if( current == address )
+		{
+			site.numCalls.fetch_add(numCalls, std::memory_order_relaxed);
+			site.numBytes.fetch_add(numBytes, std::memory_order_relaxed);
+			return;
+		}
+	}
+	otherSites.numCalls.fetch_add(numCalls, std::memory_order_relaxed);
+	otherSites.numBytes.fetch_add(numBytes, std::memory_order_relaxed);
+}
+
+}	// namespace
+
+//----------------------------------------------------------------------------
+void MemoryStats::recordAlloc( size_t size, const void* site )
 {
-	return Memory::getSingletonPtr()->Allocate(uiSize, 0, 0, true);
+	ThreadStats* stats = tlsStats.get();
+	if( !stats )
+	{
+		if( tlsStats.destroyed )
+			recordExit(size, true);
+		return;
+	}
+	add(stats->allocCalls, 1);
+	add(stats->totalBytes, size);
+	add(stats->liveBlocks, 1);
+	add(stats->liveBytes, (int64_t)size);
+	add(stats->histogram[bucket(size)], 1);
+	if( size > stats->maxBlockSize.load(std::memory_order_relaxed) )
+		stats->maxBlockSize.store(size, std::memory_order_relaxed);
+
+	stats->pendingBytes += (int64_t)size;
+	if( stats->pendingBytes >= PEAK_GRANULARITY )
+		flushPeak(stats);
+
+	if( stats->countdown <= 1 )
+	{
+		unsigned int rate = statsSampleRate.load(std::memory_order_relaxed);
+		if( rate > 0 && stats->countdown == 1 )
+			recordSite(site, rate, (uint64_t)size * rate);
+		stats->countdown = rate;
+	}
+	else
+	{
+		--stats->countdown;
+	}
 }
 //----------------------------------------------------------------------------
-void* operator new (size_t uiSize, const char* acFile, unsigned int uiLine)
+void MemoryStats::recordFree( size_t size )
 {
-	return Memory::getSingletonPtr()->Allocate(uiSize, acFile, uiLine, false);
+	ThreadStats* stats = tlsStats.get();
+	if( !stats )
+	{
+		if( tlsStats.destroyed )
+			recordExit(size, false);
+		return;
+	}
+	add(stats->freeCalls, 1);
+	add(stats->liveBlocks, -1);
+	add(stats->liveBytes, -(int64_t)size);
+
+	stats->pendingBytes -= (int64_t)size;
+	if( stats->pendingBytes <= -PEAK_GRANULARITY )
+		flushPeak(stats);
 }
 //----------------------------------------------------------------------------
-void* operator new[](size_t uiSize, const char* acFile, unsigned int uiLine)
+MemoryStats::Snapshot MemoryStats::snapshot()
 {
-	return Memory::getSingletonPtr()->Allocate(uiSize, acFile, uiLine, true);
+	Snapshot result = Snapshot();
+	for( ThreadStats* stats = statsHead.load(std::memory_order_acquire);
+		stats != 0; stats = stats->next )
+	{
+		result.numAllocCalls += stats->allocCalls.load(std::memory_order_relaxed);
+		result.numFreeCalls += stats->freeCalls.load(std::memory_order_relaxed);
+		result.totalBytes += stats->totalBytes.load(std::memory_order_relaxed);
+		result.numBlocks += stats->liveBlocks.load(std::memory_order_relaxed);
+		result.numBytes += stats->liveBytes.load(std::memory_order_relaxed);
+		result.maxBlockSize = std::max(result.maxBlockSize,
+			(uint64_t)stats->maxBlockSize.load(std::memory_order_relaxed));
+		for( int i = 0; i < NUM_BUCKETS; i++ )
+			result.histogram[i] += stats->histogram[i].load(std::memory_order_relaxed);
+	}
+	result.maxAllocatedBytes = std::max(result.numBytes,
+		peakBytes.load(std::memory_order_relaxed));
+	return result;
 }
 //----------------------------------------------------------------------------
-void operator delete (void* pvAddr)
+std::vector<MemoryStats::CallSite> MemoryStats::callSites()
 {
-	Memory::getSingletonPtr()->Deallocate((char*)pvAddr, false);
+	std::vector<CallSite> result;
+	for( int i = 0; i < NUM_SITES; i++ )
+	{
+		const void* address = sites[i].address.load(std::memory_order_relaxed);
+		if( address )
+		{
+			CallSite site = { address,
+				sites[i].numCalls.load(std::memory_order_relaxed),
+				sites[i].numBytes.load(std::memory_order_relaxed) };
+			result.push_back(site);
+		}
+	}
+	std::sort(result.begin(), result.end(),
+		[](const CallSite &a, const CallSite &b) { return a.numBytes > b.numBytes; });
+	uint64_t otherCalls = otherSites.numCalls.load(std::memory_order_relaxed);
+	if( otherCalls > 0 )
+	{
+		CallSite site = { 0, otherCalls,
+			otherSites.numBytes.load(std::memory_order_relaxed) };
+		result.push_back(site);
+	}
+	return result;
 }
 //----------------------------------------------------------------------------
-void operator delete[](void* pvAddr)
+void MemoryStats::setSampleRate( unsigned int rate )
 {
-	Memory::getSingletonPtr()->Deallocate((char*)pvAddr, true);
+	statsSampleRate.store(rate, std::memory_order_relaxed);
 }
 //----------------------------------------------------------------------------
-void operator delete (void* pvAddr, char*, unsigned int)
+unsigned int MemoryStats::sampleRate()
 {
-	Memory::getSingletonPtr()->Deallocate((char*)pvAddr, false);
+	return statsSampleRate.load(std::memory_order_relaxed);
 }
 //----------------------------------------------------------------------------
-void operator delete[](void* pvAddr, char*, unsigned int)
+int MemoryStats::bucket( size_t size )
 {
-	Memory::getSingletonPtr()->Deallocate((char*)pvAddr, true);
+	if( size <= 1 )
+		return 0;
+	if( size > ((size_t)1 << 30) )
+		return NUM_BUCKETS - 1;
+	// ceil(log2(size))
+	unsigned long v = (unsigned long)(size - 1);
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse(&index, v);
+	return (int)index + 1;
+#elif defined(__GNUC__) || defined(__clang__)
+	return (int)(sizeof(unsigned long)*8) - __builtin_clzl(v);
+#else
+	int i = 0;
+	while( v ) { v >>= 1; i++; }
+	return i;
+#endif
 }
 //----------------------------------------------------------------------------
+void MemoryStats::generateReport( std::ostream &out )
+{
+	Snapshot s = snapshot();
+	out << "Total number of allocation calls = " << s.numAllocCalls << std::endl;
+	out << "Total number of release calls = " << s.numFreeCalls << std::endl;
+	out << "Total number of allocated bytes = " << s.totalBytes << std::endl;
+	out << "Maximum number of allocated bytes = " << s.maxAllocatedBytes <<
+		" (+/- " << PEAK_GRANULARITY << " per thread)" << std::endl;
+	out << "Maximum block size = " << s.maxBlockSize << std::endl << std::endl;
+
+	out << "Remaining number of blocks = " << s.numBlocks << std::endl;
+	out << "Remaining number of bytes  = " << s.numBytes << std::endl << std::endl;
+
+	out << "Block size histogram" << std::endl;
+	for( int i = 0; i < NUM_BUCKETS; i++ )
+	{
+		if( s.histogram[i] == 0 )
+			continue;
+		if( i < NUM_BUCKETS - 1 )
+			out << "size <= " << ((uint64_t)1 << i);
+		else
+			out << "size >  " << ((uint64_t)1 << (NUM_BUCKETS - 2));
+		out << " : " << s.histogram[i] << std::endl;
+	}
+	out << std::endl;
+
+	unsigned int rate = sampleRate();
+	out << "Sampled call sites (1 every " << rate << " allocations)" << std::endl;
+	std::vector<CallSite> v = callSites();
+	char address[32];
+	for( size_t i = 0; i < v.size(); i++ )
+	{
+		if( v[i].address )
+			sprintf(address, "%p", v[i].address);
+		else
+			sprintf(address, "other");
+		out << "site = " << address << " calls ~ " << v[i].numCalls <<
+			" bytes ~ " << v[i].numBytes << std::endl;
+	}
+}
+//----------------------------------------------------------------------------
+bool MemoryStats::generateReport( const char* filename )
+{
+	std::ofstream out(filename);
+	if( !out )
+		return false;
+	generateReport(out);
+	return true;
+}
+
+}	// namespace core
+}	// namespace CmnLib
+
+
+#ifndef CL_MEMORY_MANAGER
+
+
+#else
 
 
-//--------------------------------------------------------------------------
-Memory* Memory::getSingletonPtr(void)
+//----------------------------------------------------------------------------
+void* operator new (size_t uiSize)
 {
-	return ms_Singleton;
+	return CmnLib::core::MemoryFoundations::fastMalloc(uiSize);
 }
-//--------------------------------------------------------------------------
-Memory& Memory::getSingleton(void)
-{  
-	return *ms_Singleton;
+//----------------------------------------------------------------------------
+void* operator new[](size_t uiSize)
+{
+	return CmnLib::core::MemoryFoundations::fastMalloc(uiSize);
 }
-//--------------------------------------------------------------------------
-MemoryLeakTrackerC* MemoryLeakTrackerC::getSingletonPtr(void)
+//----------------------------------------------------------------------------
+void* operator new (size_t uiSize, const char*, unsigned int)
 {
-	return ms_Singleton;
+	return CmnLib::core::MemoryFoundations::fastMalloc(uiSize);
 }
-//--------------------------------------------------------------------------
-MemoryLeakTrackerC& MemoryLeakTrackerC::getSingleton(void)
-{  
-	return *ms_Singleton;
+//----------------------------------------------------------------------------
+void* operator new[](size_t uiSize, const char*, unsigned int)
+{
+	return CmnLib::core::MemoryFoundations::fastMalloc(uiSize);
 }
+//----------------------------------------------------------------------------
+void operator delete (void* pvAddr) noexcept
+{
+	CmnLib::core::MemoryFoundations::fastFree(pvAddr);
+}
+//----------------------------------------------------------------------------
+void operator delete[](void* pvAddr) noexcept
+{
+	CmnLib::core::MemoryFoundations::fastFree(pvAddr);
+}
+//----------------------------------------------------------------------------
+void operator delete (void* pvAddr, const char*, unsigned int)
+{
+	CmnLib::core::MemoryFoundations::fastFree(pvAddr);
+}
+//----------------------------------------------------------------------------
+void operator delete[](void* pvAddr, const char*, unsigned int)
+{
+	CmnLib::core::MemoryFoundations::fastFree(pvAddr);
+}
+//----------------------------------------------------------------------------
 
 #endif	// endif #define CL_MEMORY_MANAGER
@@ -0,0 +1,225 @@
+/**
+* @file ContainerFlatMap.hpp
+* @brief Sorted vector map with a branchless nearest key lookup.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.0.0
+*
+*/
+
+#ifndef CMNLIB_CONTAINER_CONTAINERFLATMAP_HPP__
+#define CMNLIB_CONTAINER_CONTAINERFLATMAP_HPP__
+
+#include <vector>
+#include <algorithm>
+
+namespace CmnLib
+{
+namespace container
+{
+
+/** @brief Map stored as two sorted vectors (keys and values).
+
+	Map stored as two sorted vectors. The keys are contiguous, so the
+	binary search touches only the keys and it is done without branches.
+	It is meant for histories (e.g. timestamps) which are mostly appended in
+	order: insert at the end is O(1), in the middle it is O(n).
+*/
+template< typename T0, typename T1>
+class ContainerFlatMap
+{
+public:
+
+	/** @brief Number of elements.
+	*/
+	size_t size() const { return keys_.size(); }
+	bool empty() const { return keys_.empty(); }
+
+	/** @brief Remove all the elements.
+	*/
+	void clear() {
+		keys_.clear();
+		values_.clear();
+	}
+
+	/** @brief Reserve the memory for n elements.
+	*/
+	void reserve(size_t n) {
+		keys_.reserve(n);
+		values_.reserve(n);
+	}
+
+	/** @brief Insert or replace the value associated to a key.
+	*/
+	void insert(const T0 &key, const T1 &value) {
+		if (keys_.empty() || keys_.back() < key) {
+			keys_.push_back(key);
+			values_.push_back(value);
+			return;
+		}
+		size_t idx = lower_bound(key);
+		if (!(key < keys_[idx])) {
+			values_[idx] = value;
+			return;
+		}
+		keys_.insert(keys_.begin() + idx, key);
+		values_.insert(values_.begin() + idx, value);
+	}
+
+	/** @brief Remove the elements with a key lower than key (e.g. the old
+		part of a history).
+	*/
+	void erase_before(const T0 &key) {
+		size_t idx = lower_bound(key);
+		keys_.erase(keys_.begin(), keys_.begin() + idx);
+		values_.erase(values_.begin(), values_.begin() + idx);
+	}
+
+	/** @brief Index of the first key not lower than key (size() if none).
+	*/
+	size_t lower_bound(const T0 &key) const {
+		return lower_bound_index(keys_.data(), keys_.size(), key);
+	}
+
+	/** @brief Sorted keys and associated values.
+	*/
+	const std::vector<T0>& keys() const { return keys_; }
+	const std::vector<T1>& values() const { return values_; }
+	const T0& key_at(size_t idx) const { return keys_[idx]; }
+	const T1& value_at(size_t idx) const { return values_[idx]; }
+
+	/** @brief Branchless binary search of the first element not lower than
+		key in a sorted sequence.
+
+		The loop has a fixed number of iterations for a given n and the
+		selection compiles to a conditional move.
+		@param[in] first The sorted sequence.
+		@param[in] n The number of elements.
+		@param[in] key The key to search.
+		@param[in] key_of Function which returns the key of an element.
+		@return The index of the element, n if all the elements are lower.
+	*/
+	template <typename _Elem, typename _KeyOf>
+	static size_t lower_bound_index(const _Elem* first, size_t n,
+		const T0 &key, _KeyOf key_of)
+	{
+		if (n == 0) return 0;
+		const _Elem* base = first;
+		while (n > 1) {
+			size_t half = n / 2;
+			base = (key_of(base[half]) < key) ? base + half : base;
+			n -= half;
+		}
+		return (base - first) + (key_of(*base) < key);
+	}
+	static size_t lower_bound_index(const T0* first, size_t n, const T0 &key) {
+		return lower_bound_index(first, n, key, [](const T0 &k) { return k; });
+	}
+
+	/** @brief Select the nearest between the predecessor and the successor
+		of a key.
+
+		@param[in] prev The greatest key lower than key_in (nullptr if none).
+		@param[in] next The smallest key not lower than key_in (nullptr if 
+		           none).
+		@param[in] key_in The key to search.
+		@param[in] tolerance The acceptable distance to find an element.
+		@return -1 if none is within the tolerance, 0 for prev, 1 for next.
+		        In case of tie the lower key is selected.
+	*/
+	static int select_nearest(const T0* prev, const T0* next, const T0 &key_in,
+		const T0 &tolerance)
+	{
+		// the differences are computed in the positive direction, so they
+		// are valid for the unsigned keys too
+		int selected = -1;
+		T0 min_diff = tolerance;
+		if (prev) {
+			T0 diff = key_in - *prev;
+			if (diff < min_diff) {
+				min_diff = diff;
+				selected = 0;
+			}
+		}
+		if (next) {
+			T0 diff = *next - key_in;
+			if (diff < min_diff) selected = 1;
+		}
+		return selected;
+	}
+
+	/** @brief Get the associated value to the nearest key.
+
+		@param[in] key_in The key to search.
+		@param[in] tolerance The acceptable distance to find an element.
+		@param[out] out Value associated to the nearest key.
+		@return Return TRUE in case an element has been found.
+	*/
+	bool get_value(const T0 &key_in, const T0 &tolerance, T1 &out) const
+	{
+		size_t idx = lower_bound(key_in);
+		int s = select_nearest(idx > 0 ? &keys_[idx - 1] : nullptr,
+			idx < keys_.size() ? &keys_[idx] : nullptr, key_in, tolerance);
+		if (s < 0) return false;
+		out = values_[idx - 1 + s];
+		return true;
+	}
+
+	/** @brief Get the associated values to the nearest keys of a sorted
+		list of keys, with a single merge pass.
+
+		@param[in] keys_in The keys to search, in increasing order.
+		@param[in] tolerance The acceptable distance to find an element.
+		@param[out] out Values associated to the nearest keys (same size of
+		            keys_in).
+		@param[out] found TRUE if the corresponding value has been found.
+		@return Return the number of values found.
+	*/
+	int get_values(const std::vector<T0> &keys_in, const T0 &tolerance,
+		std::vector<T1> &out, std::vector<bool> &found) const
+	{
+		out.resize(keys_in.size());
+		found.assign(keys_in.size(), false);
+		int num_found = 0;
+		size_t idx = 0;
+		for (size_t i = 0; i < keys_in.size(); ++i) {
+			const T0 &key_in = keys_in[i];
+			while (idx < keys_.size() && keys_[idx] < key_in) ++idx;
+			int s = select_nearest(idx > 0 ? &keys_[idx - 1] : nullptr,
+				idx < keys_.size() ? &keys_[idx] : nullptr, key_in, tolerance);
+			if (s < 0) continue;
+			out[i] = values_[idx - 1 + s];
+			found[i] = true;
+			++num_found;
+		}
+		return num_found;
+	}
+
+private:
+
+	/** @brief Sorted keys.
+	*/
+	std::vector<T0> keys_;
+	/** @brief Values associated to the keys.
+	*/
+	std::vector<T1> values_;
+};
+
+}  // namespace container
+}  // namespace CmnLib
+
+#endif /* CMNLIB_CONTAINER_CONTAINERFLATMAP_HPP__ */
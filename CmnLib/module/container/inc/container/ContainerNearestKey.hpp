@@ -27,6 +27,11 @@
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+
+#include "ContainerFlatMap.hpp"
 
 namespace CmnLib
 {
@@ -44,50 +49,160 @@ public:
 
 	/** @brief Get the associated value to the nearest key.
 
-		Get the associated value to the nearest key.
+		Get the associated value to the nearest key. The map is ordered, so
+		only the neighbours of lower_bound are compared: O(log n).
 		@param[in] container The container to analyze.
 		@param[in] key_in The key to search.
 		@param[in] tolerance The acceptable distance to find an element.
 		@param[out] out Value associated to the nearest key.
 		@return Return TRUE in case an element has been found.
 	*/
-	static bool get_value(std::map<T0, T1> &container,
+	static bool get_value(const std::map<T0, T1> &container,
 		T0 key_in, T0 tolerance, T1 &out)
 	{
-		if (container.size() > 0)
-		{
-			T0 key = container.begin()->first;
-//#if _MSC_VER && !__INTEL_COMPILER && (_MSC_VER > 1600)
-//			T0 min_diff = std::numeric_limits<T0>::max();
-//#else
-//			T0 min_diff = 1000000;
-//#endif
-			T0 min_diff = std::numeric_limits<T0>::max();
-			bool bFound = false;
-//#if _MSC_VER && !__INTEL_COMPILER && (_MSC_VER > 1600)
-//			for (auto it = container.begin(); it != container.end(); it++) {
-//#else
-//			//for (std::map<T0, T1>::const_iterator it = container.begin(); it != container.end(); it++) {
-//			for (auto &it : container) {
-//#endif
-			for (auto &it : container) {
-				T0 diff = std::abs(it.first - key_in);
-				if (diff < tolerance && diff < min_diff) {
-					min_diff = diff;
-					key = it.first;
-					bFound = true;
-				}
+		auto it = container.lower_bound(key_in);
+		auto prev = it;
+		if (it != container.begin()) --prev;
+		int s = ContainerFlatMap<T0, T1>::select_nearest(
+			it != container.begin() ? &prev->first : nullptr,
+			it != container.end() ? &it->first : nullptr, key_in, tolerance);
+		if (s < 0) return false;
+		out = s == 0 ? prev->second : it->second;
+		return true;
+	}
+
+	/** @brief Get the associated values to the nearest keys of a sorted
+	           list of keys.
+
+	Get the associated values to the nearest keys. The keys are resolved
+	with a single merge pass over the map.
+	@param[in] container The container to analyze.
+	@param[in] keys_in The keys to search, in increasing order.
+	@param[in] tolerance The acceptable distance to find an element.
+	@param[out] out Values associated to the nearest keys (same size of
+	            keys_in).
+	@param[out] found TRUE if the corresponding value has been found.
+	@return Return the number of values found.
+	*/
+	static int get_values(const std::map<T0, T1> &container,
+		const std::vector<T0> &keys_in, T0 tolerance,
+		std::vector<T1> &out, std::vector<bool> &found)
+	{
+		out.resize(keys_in.size());
+		found.assign(keys_in.size(), false);
+		int num_found = 0;
+		auto it = container.begin();
+		auto prev = container.end();
+		for (size_t i = 0; i < keys_in.size(); ++i) {
+			while (it != container.end() && it->first < keys_in[i]) {
+				prev = it;
+				++it;
 			}
+			int s = ContainerFlatMap<T0, T1>::select_nearest(
+				prev != container.end() ? &prev->first : nullptr,
+				it != container.end() ? &it->first : nullptr, keys_in[i],
+				tolerance);
+			if (s < 0) continue;
+			out[i] = s == 0 ? prev->second : it->second;
+			found[i] = true;
+			++num_found;
+		}
+		return num_found;
+	}
+
+	/** @brief Get the associated value to the nearest key.
+
+	Get the associated value to the nearest key, with a branchless binary
+	search: O(log n).
+	@param[in] container The container to analyze.
+	@param[in] key_in The key to search.
+	@param[in] tolerance The acceptable distance to find an element.
+	@param[out] out Value associated to the nearest key.
+	@return Return TRUE in case an element has been found.
+	*/
+	static bool get_value(const ContainerFlatMap<T0, T1> &container,
+		T0 key_in, T0 tolerance, T1 &out)
+	{
+		return container.get_value(key_in, tolerance, out);
+	}
+
+	/** @brief Get the associated values to the nearest keys of a sorted
+	           list of keys, with a single merge pass.
+	*/
+	static int get_values(const ContainerFlatMap<T0, T1> &container,
+		const std::vector<T0> &keys_in, T0 tolerance,
+		std::vector<T1> &out, std::vector<bool> &found)
+	{
+		return container.get_values(keys_in, tolerance, out, found);
+	}
+
+	/** @brief Get the associated value to the nearest key in a vector sorted
+	           by key.
+
+	Get the associated value to the nearest key, with a branchless binary
+	search: O(log n).
+	@param[in] container The container to analyze, sorted by key.
+	@param[in] key_in The key to search.
+	@param[in] tolerance The acceptable distance to find an element.
+	@param[out] out Value associated to the nearest key.
+	@return Return TRUE in case an element has been found.
+	*/
+	static bool get_value_sorted(
+		const std::vector< std::pair<T0, T1> > &container,
+		T0 key_in, T0 tolerance, T1 &out)
+	{
+		size_t idx = ContainerFlatMap<T0, T1>::lower_bound_index(
+			container.data(), container.size(), key_in,
+			[](const std::pair<T0, T1> &p) { return p.first; });
+		int s = ContainerFlatMap<T0, T1>::select_nearest(
+			idx > 0 ? &container[idx - 1].first : nullptr,
+			idx < container.size() ? &container[idx].first : nullptr,
+			key_in, tolerance);
+		if (s < 0) return false;
+		out = container[idx - 1 + s].second;
+		return true;
+	}
 
-			out = container[key];
-			return bFound;
+	/** @brief Get the associated values to the nearest keys of a sorted
+	           list of keys in a vector sorted by key.
+
+	Get the associated values to the nearest keys, with a single merge pass.
+	@param[in] container The container to analyze, sorted by key.
+	@param[in] keys_in The keys to search, in increasing order.
+	@param[in] tolerance The acceptable distance to find an element.
+	@param[out] out Values associated to the nearest keys (same size of
+	            keys_in).
+	@param[out] found TRUE if the corresponding value has been found.
+	@return Return the number of values found.
+	*/
+	static int get_values_sorted(
+		const std::vector< std::pair<T0, T1> > &container,
+		const std::vector<T0> &keys_in, T0 tolerance,
+		std::vector<T1> &out, std::vector<bool> &found)
+	{
+		out.resize(keys_in.size());
+		found.assign(keys_in.size(), false);
+		int num_found = 0;
+		size_t idx = 0;
+		for (size_t i = 0; i < keys_in.size(); ++i) {
+			while (idx < container.size() && container[idx].first < keys_in[i])
+				++idx;
+			int s = ContainerFlatMap<T0, T1>::select_nearest(
+				idx > 0 ? &container[idx - 1].first : nullptr,
+				idx < container.size() ? &container[idx].first : nullptr,
+				keys_in[i], tolerance);
+			if (s < 0) continue;
+			out[i] = container[idx - 1 + s].second;
+			found[i] = true;
+			++num_found;
 		}
-		return false;
+		return num_found;
 	}
 
 	/** @brief Get the associated value to the nearest key.
 
-	Get the associated value to the nearest key.
+	Get the associated value to the nearest key. The container is not
+	required to be sorted (linear scan); see get_value_sorted otherwise.
 	@param[in] container The container to analyze.
 	@param[in] key_in The key to search.
 	@param[in] tolerance The acceptable distance to find an element.
@@ -150,12 +265,7 @@ public:
 			int idx_selected[2] = {-1, -1};
 			T0 min_diff[2] = {std::numeric_limits<T0>::max(), std::numeric_limits<T0>::max()};
 
-#if _MSC_VER && !__INTEL_COMPILER && (_MSC_VER > 1600)
 			for (auto it = container.begin(); it != container.end(); it++)
-#else
-			//for (std::vector< std::pair<T0, T1> >::const_iterator it = container.begin(); it != container.end(); it++)
-			for (auto &it : container) 
-#endif
 			{
 				T0 diff = it->first - key_in;
 				int item = 0;
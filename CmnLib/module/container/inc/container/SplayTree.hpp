@@ -0,0 +1,475 @@
+/**
+* @file SplayTree.hpp
+* @brief Generic splay tree map with pooled nodes.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.0.0
+*
+*/
+
+#ifndef CMNLIB_CONTAINER_SPLAYTREE_HPP__
+#define CMNLIB_CONTAINER_SPLAYTREE_HPP__
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace CmnLib
+{
+namespace container
+{
+
+/** @brief Ordered map implemented as a top-down splay tree.
+
+	Every access (find, insert, erase, lower_bound) moves the accessed key
+	to the root, so the keys which are accessed repeatedly (e.g. the recent
+	frames or IDs) are found in a few steps. The operations are O(log n)
+	amortized.
+	@par
+	The nodes are linked in key order too, so the iteration is O(1) per
+	step and does not modify the tree. The nodes are taken from chunks
+	allocated with Alloc (rebound to the node type) and recycled on erase;
+	the memory is released by the destructor. The iterators are valid until
+	the element is erased.
+*/
+template <typename Key, typename Value, typename Compare = std::less<Key>,
+	typename Alloc = std::allocator< std::pair<const Key, Value> > >
+class SplayTree
+{
+public:
+
+	typedef Key key_type;
+	typedef Value mapped_type;
+	typedef std::pair<const Key, Value> value_type;
+	typedef Compare key_compare;
+	typedef Alloc allocator_type;
+	typedef size_t size_type;
+
+private:
+
+	struct Node;
+
+	/** @brief Children of a node (and of the temporary header of splay).
+	*/
+	struct Links
+	{
+		Node* left;
+		Node* right;
+	};
+
+	struct Node : Links
+	{
+		Node* prev;
+		Node* next;
+		value_type value;
+
+		explicit Node(const value_type &v) : value(v) {}
+	};
+
+	/** @brief Node in the free list.
+	*/
+	struct FreeNode
+	{
+		FreeNode* next;
+	};
+
+	typedef typename std::allocator_traits<Alloc>::template
+		rebind_alloc<Node> NodeAlloc;
+	typedef std::allocator_traits<NodeAlloc> NodeTraits;
+
+public:
+
+	/** @brief Bidirectional iterator in key order.
+	*/
+	template <typename _Ref, typename _Ptr>
+	class Iterator
+	{
+	public:
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef typename SplayTree::value_type value_type;
+		typedef ptrdiff_t difference_type;
+		typedef _Ptr pointer;
+		typedef _Ref reference;
+
+		Iterator() : node_(nullptr), tree_(nullptr) {}
+		template <typename _R, typename _P>
+		Iterator(const Iterator<_R, _P> &it) :
+			node_(it.node_), tree_(it.tree_) {}
+
+		reference operator*() const { return node_->value; }
+		pointer operator->() const { return &node_->value; }
+
+		Iterator& operator++() {
+			node_ = node_->next;
+			return *this;
+		}
+		Iterator operator++(int) {
+			Iterator it(*this);
+			node_ = node_->next;
+			return it;
+		}
+		Iterator& operator--() {
+			node_ = node_ ? node_->prev : tree_->tail_;
+			return *this;
+		}
+		Iterator operator--(int) {
+			Iterator it(*this);
+			--(*this);
+			return it;
+		}
+
+		bool operator==(const Iterator &it) const { return node_ == it.node_; }
+		bool operator!=(const Iterator &it) const { return node_ != it.node_; }
+
+	private:
+		friend class SplayTree;
+		template <typename, typename> friend class Iterator;
+
+		Iterator(Node* node, const SplayTree* tree) :
+			node_(node), tree_(tree) {}
+
+		Node* node_;
+		const SplayTree* tree_;
+	};
+
+	typedef Iterator<value_type&, value_type*> iterator;
+	typedef Iterator<const value_type&, const value_type*> const_iterator;
+
+	explicit SplayTree(const Compare &comp = Compare(),
+		const Alloc &alloc = Alloc()) :
+		root_(nullptr), head_(nullptr), tail_(nullptr), size_(0),
+		comp_(comp), node_alloc_(alloc), free_(nullptr),
+		chunk_size_(kMinChunk) {}
+
+	SplayTree(const SplayTree &other) :
+		root_(nullptr), head_(nullptr), tail_(nullptr), size_(0),
+		comp_(other.comp_), node_alloc_(NodeTraits::
+		select_on_container_copy_construction(other.node_alloc_)),
+		free_(nullptr), chunk_size_(kMinChunk)
+	{
+		for (Node* n = other.head_; n; n = n->next) insert(n->value);
+	}
+
+	SplayTree(SplayTree &&other) :
+		root_(nullptr), head_(nullptr), tail_(nullptr), size_(0),
+		comp_(other.comp_), node_alloc_(other.node_alloc_), free_(nullptr),
+		chunk_size_(kMinChunk)
+	{
+		swap(other);
+	}
+
+	SplayTree& operator=(SplayTree other) {
+		swap(other);
+		return *this;
+	}
+
+	~SplayTree() {
+		clear();
+		for (size_t i = 0; i < chunks_.size(); ++i) {
+			NodeTraits::deallocate(node_alloc_, chunks_[i].first,
+				chunks_[i].second);
+		}
+	}
+
+	/** @brief Exchange the content with another tree.
+	*/
+	void swap(SplayTree &other) {
+		std::swap(root_, other.root_);
+		std::swap(head_, other.head_);
+		std::swap(tail_, other.tail_);
+		std::swap(size_, other.size_);
+		std::swap(comp_, other.comp_);
+		std::swap(node_alloc_, other.node_alloc_);
+		std::swap(free_, other.free_);
+		std::swap(chunk_size_, other.chunk_size_);
+		chunks_.swap(other.chunks_);
+	}
+
+	size_type size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+	key_compare key_comp() const { return comp_; }
+	allocator_type get_allocator() const { return allocator_type(node_alloc_); }
+
+	iterator begin() { return iterator(head_, this); }
+	iterator end() { return iterator(nullptr, this); }
+	const_iterator begin() const { return const_iterator(head_, this); }
+	const_iterator end() const { return const_iterator(nullptr, this); }
+
+	/** @brief Remove all the elements. The nodes are kept for reuse.
+	*/
+	void clear() {
+		Node* n = head_;
+		while (n) {
+			Node* next = n->next;
+			destroy_node(n);
+			n = next;
+		}
+		root_ = head_ = tail_ = nullptr;
+		size_ = 0;
+	}
+
+	/** @brief Insert an element if its key is not in the tree.
+		@return The iterator to the element with the key and TRUE if it has
+		        been inserted.
+	*/
+	std::pair<iterator, bool> insert(const value_type &value) {
+		if (splay_equal(value.first)) {
+			return std::make_pair(iterator(root_, this), false);
+		}
+		link_root(create_node(value));
+		return std::make_pair(iterator(root_, this), true);
+	}
+
+	/** @brief Access the value associated to key, inserting a default value
+		if the key is not in the tree.
+	*/
+	Value& operator[](const Key &key) {
+		if (!splay_equal(key)) link_root(create_node(value_type(key, Value())));
+		return root_->value.second;
+	}
+
+	/** @brief Find the element with key, end() if not found.
+	*/
+	iterator find(const Key &key) {
+		return splay_equal(key) ? iterator(root_, this) : end();
+	}
+
+	/** @brief Return 1 if the key is in the tree, 0 otherwise.
+	*/
+	size_type count(const Key &key) {
+		return splay_equal(key) ? 1 : 0;
+	}
+
+	/** @brief First element with a key not lower than key.
+	*/
+	iterator lower_bound(const Key &key) {
+		root_ = splay(root_, key);
+		if (!root_) return end();
+		return iterator(comp_(root_->value.first, key) ? root_->next : root_,
+			this);
+	}
+
+	/** @brief First element with a key greater than key.
+	*/
+	iterator upper_bound(const Key &key) {
+		root_ = splay(root_, key);
+		if (!root_) return end();
+		return iterator(comp_(key, root_->value.first) ? root_ : root_->next,
+			this);
+	}
+
+	/** @brief Elements with a key in [first, last).
+	*/
+	std::pair<iterator, iterator> range(const Key &first, const Key &last) {
+		iterator it_first = lower_bound(first);
+		iterator it_last = lower_bound(last);
+		return std::make_pair(it_first, it_last);
+	}
+
+	/** @brief Remove the element with key.
+		@return The number of removed elements.
+	*/
+	size_type erase(const Key &key) {
+		if (!splay_equal(key)) return 0;
+		unlink_root();
+		return 1;
+	}
+
+	/** @brief Remove the element pointed by it.
+		@return The iterator to the next element.
+	*/
+	iterator erase(iterator it) {
+		Node* next = it.node_->next;
+		erase(it.node_->value.first);
+		return iterator(next, this);
+	}
+
+private:
+
+	static const size_t kMinChunk = 16;
+	static const size_t kMaxChunk = 4096;
+
+	/** @brief Top-down splay: move the node with key (or the last node of
+		the search path, predecessor or successor of key) to the root.
+	*/
+	Node* splay(Node* t, const Key &key) {
+		if (!t) return nullptr;
+		Links header;
+		header.left = header.right = nullptr;
+		// header.right is the left tree, header.left the right tree
+		Links* left_max = &header;
+		Links* right_min = &header;
+		for (;;) {
+			if (comp_(key, t->value.first)) {
+				if (!t->left) break;
+				if (comp_(key, t->left->value.first)) {
+					// rotate right
+					Node* y = t->left;
+					t->left = y->right;
+					y->right = t;
+					t = y;
+					if (!t->left) break;
+				}
+				// link to the right tree
+				right_min->left = t;
+				right_min = t;
+				t = t->left;
+			} else if (comp_(t->value.first, key)) {
+				if (!t->right) break;
+				if (comp_(t->right->value.first, key)) {
+					// rotate left
+					Node* y = t->right;
+					t->right = y->left;
+					y->left = t;
+					t = y;
+					if (!t->right) break;
+				}
+				// link to the left tree
+				left_max->right = t;
+				left_max = t;
+				t = t->right;
+			} else {
+				break;
+			}
+		}
+		// assemble the left, middle and right trees
+		left_max->right = t->left;
+		right_min->left = t->right;
+		t->left = header.right;
+		t->right = header.left;
+		return t;
+	}
+
+	/** @brief Splay key and return TRUE if the root has key.
+	*/
+	bool splay_equal(const Key &key) {
+		root_ = splay(root_, key);
+		return root_ && !comp_(key, root_->value.first) &&
+			!comp_(root_->value.first, key);
+	}
+
+	/** @brief Make n the root. The tree has been splayed on the key of n,
+		which is not in the tree.
+	*/
+	void link_root(Node* n) {
+		if (!root_) {
+			n->left = n->right = nullptr;
+			n->prev = n->next = nullptr;
+			head_ = tail_ = n;
+		} else if (comp_(n->value.first, root_->value.first)) {
+			// the root is the successor of n
+			n->left = root_->left;
+			n->right = root_;
+			root_->left = nullptr;
+			n->next = root_;
+			n->prev = root_->prev;
+			if (root_->prev) root_->prev->next = n;
+			else head_ = n;
+			root_->prev = n;
+		} else {
+			// the root is the predecessor of n
+			n->right = root_->right;
+			n->left = root_;
+			root_->right = nullptr;
+			n->prev = root_;
+			n->next = root_->next;
+			if (root_->next) root_->next->prev = n;
+			else tail_ = n;
+			root_->next = n;
+		}
+		root_ = n;
+		++size_;
+	}
+
+	/** @brief Remove the root.
+	*/
+	void unlink_root() {
+		Node* t = root_;
+		if (!t->left) {
+			root_ = t->right;
+		} else {
+			// the maximum of the left subtree has no right child
+			root_ = splay(t->left, t->value.first);
+			root_->right = t->right;
+		}
+		if (t->prev) t->prev->next = t->next;
+		else head_ = t->next;
+		if (t->next) t->next->prev = t->prev;
+		else tail_ = t->prev;
+		destroy_node(t);
+		--size_;
+	}
+
+	Node* create_node(const value_type &value) {
+		if (!free_) grow();
+		FreeNode* f = free_;
+		free_ = f->next;
+		Node* n = reinterpret_cast<Node*>(f);
+		try {
+			new (n) Node(value);
+		} catch (...) {
+			release_node(n);
+			throw;
+		}
+		return n;
+	}
+
+	void destroy_node(Node* n) {
+		n->~Node();
+		release_node(n);
+	}
+
+	void release_node(Node* n) {
+		FreeNode* f = new (n) FreeNode;
+		f->next = free_;
+		free_ = f;
+	}
+
+	/** @brief Add a chunk of nodes to the free list.
+	*/
+	void grow() {
+		Node* chunk = NodeTraits::allocate(node_alloc_, chunk_size_);
+		chunks_.push_back(std::make_pair(chunk, chunk_size_));
+		for (size_t i = chunk_size_; i-- > 0;) release_node(chunk + i);
+		if (chunk_size_ < kMaxChunk) chunk_size_ *= 2;
+	}
+
+	Node* root_;
+	/** @brief First and last node in key order.
+	*/
+	Node* head_;
+	Node* tail_;
+	size_t size_;
+	Compare comp_;
+	NodeAlloc node_alloc_;
+	/** @brief Recycled nodes.
+	*/
+	FreeNode* free_;
+	/** @brief Chunks of nodes and size of the next chunk.
+	*/
+	std::vector< std::pair<Node*, size_t> > chunks_;
+	size_t chunk_size_;
+};
+
+}  // namespace container
+}  // namespace CmnLib
+
+#endif /* CMNLIB_CONTAINER_SPLAYTREE_HPP__ */
@@ -24,9 +24,9 @@
 #ifndef CMNLIB_CONTAINER_CONTAINERHEADERS_HPP__
 #define CMNLIB_CONTAINER_CONTAINERHEADERS_HPP__
 
+#include "ContainerFlatMap.hpp"
 #include "ContainerNearestKey.hpp"
 #include "ContainerCoreOperations.hpp"
-#include "SplayTreeNaive.hpp"
-#include "SplayTreeWiki.hpp"
+#include "SplayTree.hpp"
 
 #endif /* CMNLIB_CONTAINER_CONTAINERHEADERS_HPP__ */
@@ -0,0 +1,302 @@
+/**
+* @file BinaryLog.hpp
+* @brief Header of the binary log sink and of its decoder.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#ifndef CMNLIB_CONTROL_BINARYLOG_HPP__
+#define CMNLIB_CONTROL_BINARYLOG_HPP__
+
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "log.hpp"
+
+namespace CmnLib
+{
+namespace control
+{
+
+/** Binary log sink.
+	@remarks
+		A message is stored as a record with the timestamp (ns since the
+		epoch), the level, the id of its format string and the raw
+		arguments; the text is rendered offline by BinaryLogDecoder. The
+		format strings are registered once per process (see CL_BINLOG) and
+		written once per file, so every file can be decoded alone.
+	@par
+		The records are copied in a memory-mapped file of file_size bytes.
+		When a record does not fit, the file is truncated to the used size
+		and the next one (basename.N.clog) is created; if max_files is not
+		zero only the last max_files files are kept. The data is written by
+		the operating system, no flush is done per message.
+	@par
+		The arguments can be integers, floating point numbers, pointers,
+		const char* and std::string. The numbers are stored in the byte
+		order of the writing machine.
+*/
+class BinaryLog
+{
+public:
+
+	/** File signature.
+	*/
+	static const char* MAGIC;
+
+	/** Record types.
+	*/
+	enum RecordType
+	{
+		RECORD_END = 0,
+		RECORD_FORMAT = 1,
+		RECORD_MESSAGE = 2
+	};
+
+	/** Argument tags.
+	*/
+	enum ArgTag
+	{
+		ARG_INT = 'i',
+		ARG_UINT = 'u',
+		ARG_DOUBLE = 'd',
+		ARG_STRING = 's',
+		ARG_POINTER = 'p'
+	};
+
+	/** Header of every record, followed by the format string (format
+		records) or by the tagged arguments (message records).
+	*/
+	struct RecordHeader
+	{
+		uint32_t size;		// record size, header included
+		uint16_t type;		// RecordType
+		uint16_t level;		// LogLevel
+		uint32_t format_id;
+		uint32_t reserved;
+		uint64_t timestamp;	// ns since the epoch
+	};
+
+	/** @brief Create the first file basename.0.clog.
+	*/
+	explicit BinaryLog(const std::string &basename,
+		size_t file_size = (size_t)1 << 24, int max_files = 0);
+	~BinaryLog();
+
+	/** @brief Return true if the current file is open.
+	*/
+	bool is_open() const;
+
+	/** @brief Number of messages dropped because the file could not be
+		created (reported with LogMS::Error when it happens).
+	*/
+	size_t dropped() const { return dropped_.load(); }
+
+	/** @brief Minimal level written (Info by default).
+	*/
+	void set_level(LogLevel level) { level_ = (int)level; }
+	LogLevel level() const { return (LogLevel)level_.load(); }
+
+	/** @brief Register a format string with static storage and return its id.
+		The same pointer always returns the same id.
+	*/
+	static uint32_t RegisterFormat(const char* format);
+
+	/** @brief Write a message. The format id is returned by RegisterFormat.
+	*/
+	template <typename... Args>
+	void Write(LogLevel level, uint32_t format_id, const Args&... args) {
+		if ((int)level < level_.load(std::memory_order_relaxed)) return;
+		size_t size = sizeof(RecordHeader) + ArgsSize(args...);
+		uint8_t buffer[512];
+		std::vector<uint8_t> big;
+		uint8_t* record = buffer;
+		if (size > sizeof(buffer)) {
+			big.resize(size);
+			record = &big[0];
+		}
+		RecordHeader header;
+		header.size = (uint32_t)size;
+		header.type = RECORD_MESSAGE;
+		header.level = (uint16_t)level;
+		header.format_id = format_id;
+		header.reserved = 0;
+		header.timestamp = (uint64_t)
+			std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+		memcpy(record, &header, sizeof(header));
+		PutArgs(record + sizeof(header), args...);
+		Append(record, size, format_id);
+	}
+
+	/** @brief Make the written records durable (msync).
+	*/
+	void Sync();
+
+	/** @brief Name of the file number index.
+	*/
+	static std::string FileName(const std::string &basename, int index);
+
+private:
+
+	// Size of the encoded arguments
+	static size_t ArgsSize() { return 0; }
+	template <typename T, typename... Args>
+	static size_t ArgsSize(const T &arg, const Args&... args) {
+		return ArgSize(arg) + ArgsSize(args...);
+	}
+	template <typename T>
+	static size_t ArgSize(const T &) {
+		static_assert(std::is_arithmetic<T>::value || std::is_pointer<T>::value,
+			"BinaryLog: unsupported argument type");
+		return 1 + 8;
+	}
+	static size_t ArgSize(const char* s) { return 1 + 4 + strlen(s); }
+	static size_t ArgSize(char* s) { return 1 + 4 + strlen(s); }
+	static size_t ArgSize(const std::string &s) { return 1 + 4 + s.size(); }
+
+	// Encode the arguments
+	static uint8_t* PutArgs(uint8_t* p) { return p; }
+	template <typename T, typename... Args>
+	static uint8_t* PutArgs(uint8_t* p, const T &arg, const Args&... args) {
+		return PutArgs(PutArg(p, arg), args...);
+	}
+	template <typename T>
+	static uint8_t* PutArg(uint8_t* p, const T &arg) {
+		return PutValue(p, arg, std::is_floating_point<T>(),
+			std::is_signed<T>());
+	}
+	template <typename T>
+	static uint8_t* PutArg(uint8_t* p, T* arg) {
+		uint64_t v = (uint64_t)(size_t)arg;
+		*p = ARG_POINTER;
+		memcpy(p + 1, &v, 8);
+		return p + 9;
+	}
+	static uint8_t* PutArg(uint8_t* p, const char* s) {
+		return PutString(p, s, strlen(s));
+	}
+	static uint8_t* PutArg(uint8_t* p, char* s) {
+		return PutString(p, s, strlen(s));
+	}
+	static uint8_t* PutArg(uint8_t* p, const std::string &s) {
+		return PutString(p, s.data(), s.size());
+	}
+	template <typename T, typename _Signed>
+	static uint8_t* PutValue(uint8_t* p, const T &arg, std::true_type, _Signed) {
+		double v = (double)arg;
+		*p = ARG_DOUBLE;
+		memcpy(p + 1, &v, 8);
+		return p + 9;
+	}
+	template <typename T>
+	static uint8_t* PutValue(uint8_t* p, const T &arg, std::false_type,
+		std::true_type) {
+		int64_t v = (int64_t)arg;
+		*p = ARG_INT;
+		memcpy(p + 1, &v, 8);
+		return p + 9;
+	}
+	template <typename T>
+	static uint8_t* PutValue(uint8_t* p, const T &arg, std::false_type,
+		std::false_type) {
+		uint64_t v = (uint64_t)arg;
+		*p = ARG_UINT;
+		memcpy(p + 1, &v, 8);
+		return p + 9;
+	}
+	static uint8_t* PutString(uint8_t* p, const char* s, size_t length) {
+		uint32_t n = (uint32_t)length;
+		*p = ARG_STRING;
+		memcpy(p + 1, &n, 4);
+		memcpy(p + 5, s, length);
+		return p + 5 + length;
+	}
+
+	/** @brief Copy a record in the file, writing its format first if needed.
+	*/
+	void Append(const uint8_t* record, size_t size, uint32_t format_id);
+	bool Reserve(size_t size);
+	bool OpenFile();
+	void ReportOpenError();
+	void CloseFile();
+
+	std::string basename_;
+	size_t file_size_;
+	int max_files_;
+	int index_;
+	std::atomic<int> level_;
+	std::atomic<size_t> dropped_;
+
+	mutable std::mutex mutex_;
+	uint8_t* data_;
+	size_t used_;
+	// Formats already written in the current file
+	std::vector<bool> written_;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+	void* file_;
+	void* mapping_;
+#else
+	int fd_;
+#endif
+
+	// No copying allowed
+	BinaryLog(const BinaryLog&);
+	void operator=(const BinaryLog&);
+};
+
+/** Render the binary log files as text.
+*/
+class BinaryLogDecoder
+{
+public:
+
+	/** @brief Write the messages of a file, one per line, as
+		[LEVEL] [YYYY-MM-DD HH:MM:SS.nnnnnnnnn] message.
+		@return The number of messages, -1 if the file is not a binary log.
+	*/
+	static int Decode(const std::string &filename, std::ostream &out);
+
+	/** @brief Format a message from its format string and encoded arguments.
+	*/
+	static std::string Format(const std::string &format, const uint8_t* args,
+		size_t size);
+};
+
+}  // namespace control
+}  // namespace CmnLib
+
+/** Write a message in a BinaryLog. The format string is registered once per
+	call site.
+*/
+#define CL_BINLOG(log, level, format, ...) \
+	do { \
+		static const uint32_t cl_binlog_id__ = \
+			CmnLib::control::BinaryLog::RegisterFormat(format); \
+		(log).Write(level, cl_binlog_id__, ##__VA_ARGS__); \
+	} while (0)
+
+#endif /* CMNLIB_CONTROL_BINARYLOG_HPP__ */
@@ -22,10 +22,16 @@ class CL_EXPORTS LogToFile : public Logger::Listener
 public:
     LogToFile(std::string const& filename, int flags);
 
+    // The file is kept open.  The messages of a batch (asynchronous mode)
+    // are flushed together at its end, the others one at a time.
+    virtual void BeginBatch();
+    virtual void EndBatch();
+
 private:
     virtual void Report(std::string const& message);
 
-    std::string mFilename;
+    std::ofstream mFile;
+    bool mInBatch;
 };
 
 }  // namespace control
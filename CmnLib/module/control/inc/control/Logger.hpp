@@ -8,6 +8,8 @@
 #ifndef CMNLIB_CONTROL_LOGGER_HPP__ 
 #define CMNLIB_CONTROL_LOGGER_HPP__ 
 
+#include <atomic>
+#include <cstddef>
 #include <mutex>
 #include <set>
 #include <string>
@@ -27,12 +29,14 @@ class CL_EXPORTS Logger
 {
 public:
     // Construction.  The Logger object is designed to exist only for a
-    // single-line call.  A string is generated from the input parameters and
-    // is used for reporting.
+    // single-line call.  The report string is generated from the input
+    // parameters only when the listeners are notified.
     Logger(char const* file, char const* function, int line,
         std::string const& message);
 
-    // Notify current listeners about the logged information.
+    // Notify current listeners about the logged information.  In
+    // asynchronous mode the message is queued and delivered by the drain
+    // thread; an assertion also waits for its delivery.
     void Assertion();
     void Error();
     void Warning();
@@ -65,6 +69,12 @@ public:
         void Warning(std::string const& message);
         void Information(std::string const& message);
 
+        // In asynchronous mode the messages are delivered in batches,
+        // enclosed by BeginBatch and EndBatch.  A listener can override
+        // them to keep its output open for the whole batch.
+        virtual void BeginBatch();
+        virtual void EndBatch();
+
     private:
         virtual void Report(std::string const& message);
 
@@ -74,11 +84,66 @@ public:
     static void Subscribe(Listener* listener);
     static void Unsubscribe(Listener* listener);
 
+    // Asynchronous mode.  Every logging thread writes fixed-size records
+    // (file, function and line pointers plus the message, truncated to
+    // MAX_PAYLOAD characters) in its own lock-free ring buffer of
+    // recordsPerThread entries.  A single background thread drains the
+    // rings and reports the records to the listeners in batches, so a slow
+    // listener no longer stalls the logging threads.  When a ring is full
+    // the record is dropped (and counted) or the thread waits for the
+    // drain, depending on the policy.  The file and function strings must
+    // have static storage (as __FILE__ and __FUNCTION__ in the macros).
+    // StopAsync drains the pending records and returns to the synchronous
+    // mode; no thread should log while it is called.
+    enum OverflowPolicy
+    {
+        OVERFLOW_DROP,
+        OVERFLOW_BLOCK
+    };
+
+    enum { MAX_PAYLOAD = 440 };
+
+    static void StartAsync(OverflowPolicy policy = OVERFLOW_BLOCK,
+        size_t recordsPerThread = 512);
+    static void StopAsync();
+    static bool IsAsync();
+
+    // Wait until the records queued so far have been reported.
+    static void Flush();
+
+    // Number of records dropped because a ring was full.
+    static size_t GetNumDropped();
+
+    // Report the pending records when the program crashes, before the
+    // previous handlers run.  On SIGSEGV, SIGABRT, SIGFPE and SIGILL the
+    // records are written as they are (file, function, line and message)
+    // to fd, already open (stderr by default), with async-signal-safe
+    // calls only; the listeners are not called.  On std::terminate they
+    // are reported to the listeners from the terminating thread.
+    static void InstallCrashHandler(int fd = 2);
+
 private:
+    // Report the message to the listeners now (synchronous mode).
+    void Notify(int type);
+
+    // Queue the message, return false if the logger is synchronous.
+    bool Post(int type);
+
+    // Drain thread.
+    static void DrainLoop();
+    static bool DrainRings(bool wait);
+    static void FlushOnCrash();
+
+    char const* mFile;
+    char const* mFunction;
+    int mLine;
     std::string mMessage;
 
     static std::mutex msMutex;
     static std::set<Listener*> msListeners;
+
+    static std::atomic<bool> msAsync;
+    static std::atomic<size_t> msDropped;
 };
 
 }  // namespace control
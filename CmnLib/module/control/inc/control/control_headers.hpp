@@ -24,6 +24,7 @@
 #ifndef CMNLIB_CONTROL_CONTROLHEADERS_HPP__
 #define CMNLIB_CONTROL_CONTROLHEADERS_HPP__
 
+#include "BinaryLog.hpp"
 #include "FileLog.hpp"
 #include "LogReporter.hpp"
 #include "log.hpp"
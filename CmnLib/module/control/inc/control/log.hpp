@@ -25,11 +25,28 @@
 #ifndef CMNLIB_CONTROL_LOG_HPP__
 #define CMNLIB_CONTROL_LOG_HPP__
 
+#include <atomic>
 #include <fstream>
 #include <string>
 #include <ctime>
 #include <cstdarg>
 
+/*!
+    * \brief Minimal log level compiled in the program (0 Debug, 1 Info,
+    *        2 Error, 3 Fatal). The messages below it are removed at compile
+    *        time, so LogMS::Debug does not format in release builds (its
+    *        arguments are still evaluated: use CMNLIB_LOG_DEBUG to skip
+    *        them). Define it before including this header to override the
+    *        default.
+    */
+#ifndef CMNLIB_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define CMNLIB_LOG_MIN_LEVEL 1
+#else
+#define CMNLIB_LOG_MIN_LEVEL 0
+#endif
+#endif
+
 namespace CmnLib
 {
 namespace control
@@ -87,36 +104,64 @@ public:
         * \brief Resets the log level.
         * \param level The new log level.
         */
-    void ResetLogLevel(LogLevel level) { level_ = level; }
+    void ResetLogLevel(LogLevel level) {
+        level_.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
     /*!
         * \brief Resets the option of whether kill the process when fatal 
         *        error occurs. By defualt the option is false.
         */
     void ResetKillFatal(bool is_kill_fatal) { is_kill_fatal_ = is_kill_fatal; }
 
+    /*!
+        * \brief Returns true if a message of the level would be written. It
+        *        is a single relaxed atomic load.
+        */
+    bool IsEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+
     /*!
         * \brief C style formatted method for writing log messages. A message
         *        is with the following format: [LEVEL] [TIME] message
+        *        The level is checked before any formatting.
         * \param level The log level of this message.
         * \param format The C format string.
         * \param ... Output items.
         */
     void Write(LogLevel level, const char *format, ...);
-    void Debug(const char *format, ...);
-    void Info(const char *format, ...);
-    void Error(const char *format, ...);
-    void Fatal(const char *format, ...);
+
+    template <typename... Args>
+    void Debug(const char *format, Args... args) {
+        if (CMNLIB_LOG_MIN_LEVEL <= 0 && IsEnabled(LogLevel::Debug))
+            Write(LogLevel::Debug, format, args...);
+    }
+    template <typename... Args>
+    void Info(const char *format, Args... args) {
+        if (CMNLIB_LOG_MIN_LEVEL <= 1 && IsEnabled(LogLevel::Info))
+            Write(LogLevel::Info, format, args...);
+    }
+    template <typename... Args>
+    void Error(const char *format, Args... args) {
+        if (CMNLIB_LOG_MIN_LEVEL <= 2 && IsEnabled(LogLevel::Error))
+            Write(LogLevel::Error, format, args...);
+    }
+    template <typename... Args>
+    void Fatal(const char *format, Args... args) {
+        Write(LogLevel::Fatal, format, args...);
+    }
 
 private:
     void Write(LogLevel level, const char *format, va_list &val);
     void CloseLogFile();
-    // Returns current system time as a string.
-    std::string GetSystemTime();
+    // Returns current system time as a string. The string is formatted
+    // once per second and per thread.
+    const char* GetSystemTime();
     // Returns the string of a log level.
-    std::string GetLevelStr(LogLevel level);
+    const char* GetLevelStr(LogLevel level);
 
     std::FILE *file_; // A file pointer to the log file.
-    LogLevel level_;  // Only the message not less than level_ will be outputed.
+    std::atomic<int> level_;  // Only the message not less than level_ will be outputed.
     bool is_kill_fatal_; // If kill the process when fatal error occurs.
 
     // No copying allowed
@@ -152,14 +197,39 @@ public:
     */
     static void ResetKillFatal(bool is_kill_fatal);
 
-	/*! \brief The C formatted methods of writing the messages. */
+	/*!
+	    * \brief Returns true if a message of the level would be written.
+	    */
+	static bool IsEnabled(LogLevel level) {
+		return static_cast<int>(level) >= CMNLIB_LOG_MIN_LEVEL &&
+			logger_.IsEnabled(level);
+	}
+
+	/*! \brief The C formatted methods of writing the messages. The
+	    *        messages below CMNLIB_LOG_MIN_LEVEL are removed at compile
+	    *        time, the others are formatted only if the level is enabled.
+	    *        The arguments are always evaluated by the caller: the
+	    *        CMNLIB_LOG_* macros evaluate them only for an enabled level.
+	    */
 	static void Write(LogLevel level, const char *format, ...);
-	static void Debug(const char *format, ...);
-	static void Info(const char *format, ...);
+	template <typename... Args>
+	static void Debug(const char *format, Args... args) {
+		logger_.Debug(format, args...);
+	}
+	template <typename... Args>
+	static void Info(const char *format, Args... args) {
+		logger_.Info(format, args...);
+	}
 	static void Info(const std::string &s);
-	static void Error(const char *format, ...);
+	template <typename... Args>
+	static void Error(const char *format, Args... args) {
+		logger_.Error(format, args...);
+	}
 	static void Error(const std::string &s);
-	static void Fatal(const char *format, ...);
+	template <typename... Args>
+	static void Fatal(const char *format, Args... args) {
+		logger_.Fatal(format, args...);
+	}
 	static void Fatal(const std::string &s);
 
 private:
@@ -169,5 +239,37 @@ private:
 }  // namespace control
 }  // namespace CmnLib
 
+/*!
+    * \brief Write a message with LogMS (CMNLIB_LOG_*) or with a LoggerMS
+    *        (CMNLIB_LOGGER_*). The arguments are evaluated only if the level
+    *        is enabled, i.e.
+    *        CMNLIB_LOG_DEBUG("state %s\n", state.ToString().c_str());
+    *        does not call ToString when Debug is filtered out.
+    */
+#define CMNLIB_LOG_LEVEL(level, ...) \
+    do { \
+        if (::CmnLib::control::LogMS::IsEnabled(level)) \
+            ::CmnLib::control::LogMS::Write(level, __VA_ARGS__); \
+    } while (0)
+#define CMNLIB_LOG_DEBUG(...) \
+    CMNLIB_LOG_LEVEL(::CmnLib::control::LogLevel::Debug, __VA_ARGS__)
+#define CMNLIB_LOG_INFO(...) \
+    CMNLIB_LOG_LEVEL(::CmnLib::control::LogLevel::Info, __VA_ARGS__)
+#define CMNLIB_LOG_ERROR(...) \
+    CMNLIB_LOG_LEVEL(::CmnLib::control::LogLevel::Error, __VA_ARGS__)
+
+#define CMNLIB_LOGGER_LEVEL(logger, level, ...) \
+    do { \
+        if (static_cast<int>(level) >= CMNLIB_LOG_MIN_LEVEL && \
+            (logger).IsEnabled(level)) \
+            (logger).Write(level, __VA_ARGS__); \
+    } while (0)
+#define CMNLIB_LOGGER_DEBUG(logger, ...) CMNLIB_LOGGER_LEVEL(logger, \
+    ::CmnLib::control::LogLevel::Debug, __VA_ARGS__)
+#define CMNLIB_LOGGER_INFO(logger, ...) CMNLIB_LOGGER_LEVEL(logger, \
+    ::CmnLib::control::LogLevel::Info, __VA_ARGS__)
+#define CMNLIB_LOGGER_ERROR(logger, ...) CMNLIB_LOGGER_LEVEL(logger, \
+    ::CmnLib::control::LogLevel::Error, __VA_ARGS__)
+
 
 #endif /* CMNLIB_CONTROL_LOG_HPP__ */
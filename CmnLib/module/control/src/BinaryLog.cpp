@@ -0,0 +1,494 @@
+/**
+* @file BinaryLog.cpp
+* @brief Body of the binary log sink and of its decoder.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include "control/inc/control/BinaryLog.hpp"
+#include "control/inc/control/log.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <map>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace CmnLib
+{
+namespace control
+{
+
+namespace
+{
+
+// Size of the file signature (MAGIC without the terminator).
+const size_t MAGIC_SIZE = 8;
+
+/** Format strings registered by the process.
+*/
+struct FormatRegistry
+{
+	std::mutex mutex;
+	std::map<const char*, uint32_t> ids;
+	std::vector<const char*> formats;
+};
+
+FormatRegistry& registry()
+{
+	static FormatRegistry r;
+	return r;
+}
+
+const char* level_string(int level)
+{
+	switch (level)
+	{
+	case 0: return "DEBUG";
+	case 1: return "INFO";
+	case 2: return "ERROR";
+	case 3: return "FATAL";
+	default: return "UNKNOW";
+	}
+}
+
+/** Read the next argument. Return false at the end of the arguments.
+*/
+bool read_arg(const uint8_t* &p, const uint8_t* end, char &tag,
+	int64_t &i, uint64_t &u, double &d, std::string &s)
+{
+	if (p + 1 > end) return false;
+	tag = (char)*p++;
+	switch (tag)
+	{
+	case BinaryLog::ARG_INT:
+		if (p + 8 > end) return false;
+		memcpy(&i, p, 8); p += 8;
+		return true;
+	case BinaryLog::ARG_UINT:
+	case BinaryLog::ARG_POINTER:
+		if (p + 8 > end) return false;
+		memcpy(&u, p, 8); p += 8;
+		return true;
+	case BinaryLog::ARG_DOUBLE:
+		if (p + 8 > end) return false;
+		memcpy(&d, p, 8); p += 8;
+		return true;
+	case BinaryLog::ARG_STRING:
+	{
+		uint32_t n;
+		if (p + 4 > end) return false;
+		memcpy(&n, p, 4); p += 4;
+		if (p + n > end) return false;
+		s.assign((const char*)p, n); p += n;
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+}	// namespace
+
+const char* BinaryLog::MAGIC = "CLBLOG01";
+
+//-----------------------------------------------------------------------------
+BinaryLog::BinaryLog(const std::string &basename, size_t file_size,
+	int max_files) :
+	basename_(basename), file_size_(file_size), max_files_(max_files),
+	index_(0), level_((int)LogLevel::Info), dropped_(0), data_(nullptr),
+	used_(0)
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+	, file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+#else
+	, fd_(-1)
+#endif
+{
+	if (!OpenFile()) ReportOpenError();
+}
+//-----------------------------------------------------------------------------
+BinaryLog::~BinaryLog()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	CloseFile();
+}
+//-----------------------------------------------------------------------------
+bool BinaryLog::is_open() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return data_ != nullptr;
+}
+//-----------------------------------------------------------------------------
+uint32_t BinaryLog::RegisterFormat(const char* format)
+{
+	FormatRegistry &r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	auto it = r.ids.find(format);
+	if (it != r.ids.end()) return it->second;
+	uint32_t id = (uint32_t)r.formats.size();
+	r.formats.push_back(format);
+	r.ids[format] = id;
+	return id;
+}
+//-----------------------------------------------------------------------------
+std::string BinaryLog::FileName(const std::string &basename, int index)
+{
+	return basename + "." + std::to_string(index) + ".clog";
+}
+//-----------------------------------------------------------------------------
+void BinaryLog::Append(const uint8_t* record, size_t size, uint32_t format_id)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (int attempt = 0; attempt < 2; ++attempt)
+	{
+		if (!data_)
+		{
+			dropped_.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		bool known = format_id < written_.size() && written_[format_id];
+		const char* format = nullptr;
+		size_t format_size = 0;
+		if (!known)
+		{
+			FormatRegistry &r = registry();
+			std::lock_guard<std::mutex> rlock(r.mutex);
+			if (format_id >= r.formats.size()) return;
+			format = r.formats[format_id];
+			format_size = (sizeof(RecordHeader) + strlen(format) + 7) & ~(size_t)7;
+		}
+		size_t record_size = (size + 7) & ~(size_t)7;
+		if (!Reserve(format_size + record_size))
+		{
+			// larger than an empty file: drop it
+			if (used_ == MAGIC_SIZE) return;
+			// the record does not fit: continue in a new file
+			CloseFile();
+			++index_;
+			if (!OpenFile()) ReportOpenError();
+			continue;
+		}
+		if (format)
+		{
+			RecordHeader header;
+			memset(&header, 0, sizeof(header));
+			header.size = (uint32_t)format_size;
+			header.type = RECORD_FORMAT;
+			header.format_id = format_id;
+			memcpy(data_ + used_, &header, sizeof(header));
+			memcpy(data_ + used_ + sizeof(header), format, strlen(format));
+			used_ += format_size;
+			if (written_.size() <= format_id) written_.resize(format_id + 1);
+			written_[format_id] = true;
+		}
+		memcpy(data_ + used_, record, size);
+		// the record size covers the padding
+		uint32_t padded = (uint32_t)record_size;
+		memcpy(data_ + used_, &padded, sizeof(padded));
+		used_ += record_size;
+		return;
+	}
+}
+//-----------------------------------------------------------------------------
+void BinaryLog::ReportOpenError()
+{
+	LogMS::Error("BinaryLog: cannot create %s, the next messages are "
+		"dropped\n", FileName(basename_, index_).c_str());
+}
+//-----------------------------------------------------------------------------
+bool BinaryLog::Reserve(size_t size)
+{
+	// keep room for the end marker
+	return used_ + size + sizeof(uint32_t) <= file_size_;
+}
+//-----------------------------------------------------------------------------
+bool BinaryLog::OpenFile()
+{
+	if (max_files_ > 0 && index_ >= max_files_)
+	{
+		std::remove(FileName(basename_, index_ - max_files_).c_str());
+	}
+	std::string filename = FileName(basename_, index_);
+	written_.clear();
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ | GENERIC_WRITE,
+		FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER li;
+	li.QuadPart = (LONGLONG)file_size_;
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE,
+		li.HighPart, li.LowPart, NULL);
+	if (!mapping)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	void* data = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, file_size_);
+	if (!data)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	file_ = file;
+	mapping_ = mapping;
+#else
+	int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) return false;
+	if (ftruncate(fd, (off_t)file_size_) != 0)
+	{
+		close(fd);
+		return false;
+	}
+	void* data = mmap(0, file_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (data == MAP_FAILED)
+	{
+		close(fd);
+		return false;
+	}
+	fd_ = fd;
+#endif
+	data_ = (uint8_t*)data;
+	memcpy(data_, MAGIC, MAGIC_SIZE);
+	used_ = MAGIC_SIZE;
+	return true;
+}
+//-----------------------------------------------------------------------------
+void BinaryLog::CloseFile()
+{
+	if (!data_) return;
+	// The mapping is zero filled: the record after the last one has size 0
+	// (RECORD_END). The file is truncated after it.
+	size_t size = used_ + sizeof(uint32_t);
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+	UnmapViewOfFile(data_);
+	CloseHandle((HANDLE)mapping_);
+	LARGE_INTEGER li;
+	li.QuadPart = (LONGLONG)size;
+	SetFilePointerEx((HANDLE)file_, li, NULL, FILE_BEGIN);
+	SetEndOfFile((HANDLE)file_);
+	CloseHandle((HANDLE)file_);
+	file_ = INVALID_HANDLE_VALUE;
+	mapping_ = nullptr;
+#else
+	munmap(data_, file_size_);
+	if (ftruncate(fd_, (off_t)size) != 0)
+	{
+		// the file keeps its mapped size, the end marker is still there
+	}
+	close(fd_);
+	fd_ = -1;
+#endif
+	data_ = nullptr;
+	used_ = 0;
+}
+//-----------------------------------------------------------------------------
+void BinaryLog::Sync()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (!data_) return;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+	FlushViewOfFile(data_, used_);
+#else
+	msync(data_, used_, MS_SYNC);
+#endif
+}
+//-----------------------------------------------------------------------------
+int BinaryLogDecoder::Decode(const std::string &filename, std::ostream &out)
+{
+	std::ifstream in(filename.c_str(), std::ios::binary);
+	if (!in) return -1;
+	std::vector<char> buffer((std::istreambuf_iterator<char>(in)),
+		std::istreambuf_iterator<char>());
+	if (buffer.size() < MAGIC_SIZE ||
+		memcmp(&buffer[0], BinaryLog::MAGIC, MAGIC_SIZE) != 0)
+		return -1;
+
+	std::map<uint32_t, std::string> formats;
+	const uint8_t* p = (const uint8_t*)&buffer[0] + MAGIC_SIZE;
+	const uint8_t* end = (const uint8_t*)&buffer[0] + buffer.size();
+	int num_messages = 0;
+	while (p + sizeof(BinaryLog::RecordHeader) <= end)
+	{
+		BinaryLog::RecordHeader header;
+		memcpy(&header, p, sizeof(header));
+		if (header.size < sizeof(header) || p + header.size > end) break;
+		const uint8_t* body = p + sizeof(header);
+		size_t body_size = header.size - sizeof(header);
+		if (header.type == BinaryLog::RECORD_FORMAT)
+		{
+			size_t n = strnlen((const char*)body, body_size);
+			formats[header.format_id].assign((const char*)body, n);
+		}
+		else if (header.type == BinaryLog::RECORD_MESSAGE)
+		{
+			time_t seconds = (time_t)(header.timestamp / 1000000000ull);
+			unsigned long ns = (unsigned long)(header.timestamp % 1000000000ull);
+			struct tm tm_time;
+#if defined(_MSC_VER)
+			localtime_s(&tm_time, &seconds);
+#else
+			localtime_r(&seconds, &tm_time);
+#endif
+			char time_str[64];
+			strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &tm_time);
+			out << "[" << level_string(header.level) << "] [" << time_str <<
+				"." << std::string(9 - std::to_string(ns).size(), '0') << ns <<
+				"] ";
+			auto it = formats.find(header.format_id);
+			if (it != formats.end())
+				out << Format(it->second, body, body_size);
+			else
+				out << "<unknown format " << header.format_id << ">";
+			out << std::endl;
+			++num_messages;
+		}
+		p += header.size;
+	}
+	return num_messages;
+}
+//-----------------------------------------------------------------------------
+std::string BinaryLogDecoder::Format(const std::string &format,
+	const uint8_t* args, size_t size)
+{
+	std::string result;
+	const uint8_t* p = args;
+	const uint8_t* end = args + size;
+	char buffer[512];
+	for (size_t k = 0; k < format.size(); ++k)
+	{
+		if (format[k] != '%')
+		{
+			result += format[k];
+			continue;
+		}
+		if (k + 1 < format.size() && format[k + 1] == '%')
+		{
+			result += '%';
+			++k;
+			continue;
+		}
+		// flags, width and precision are kept, the length modifiers are
+		// replaced by the ones of the stored type
+		std::string spec = "%";
+		size_t j = k + 1;
+		bool missing = false;
+		while (j < format.size() && strchr("-+ #0123456789.*", format[j]))
+		{
+			if (format[j] != '*')
+			{
+				spec += format[j++];
+				continue;
+			}
+			// the width (or precision) is the next recorded argument
+			++j;
+			char tag;
+			int64_t i = 0;
+			uint64_t u = 0;
+			double d = 0;
+			std::string s;
+			if (!read_arg(p, end, tag, i, u, d, s))
+			{
+				missing = true;
+				continue;
+			}
+			long long v = tag == BinaryLog::ARG_INT ? (long long)i :
+				tag == BinaryLog::ARG_UINT ? (long long)u : 0;
+			v = std::max(std::min(v, 4096LL), -4096LL);
+			if (!spec.empty() && spec.back() == '.')
+			{
+				// a negative precision is taken as if it were omitted
+				if (v < 0) spec.pop_back();
+				else spec += std::to_string(v);
+			}
+			else
+			{
+				spec += std::to_string(v);
+			}
+		}
+		while (j < format.size() && strchr("hlLqjzt", format[j]))
+			++j;
+		if (j >= format.size()) break;
+		char conversion = format[j];
+		k = j;
+
+		char tag;
+		int64_t i = 0;
+		uint64_t u = 0;
+		double d = 0;
+		std::string s;
+		if (missing || !read_arg(p, end, tag, i, u, d, s))
+		{
+			result += "<missing>";
+			continue;
+		}
+		bool is_float = strchr("eEfFgGaA", conversion) != nullptr;
+		if (conversion == 's')
+		{
+			if (tag == BinaryLog::ARG_STRING)
+				snprintf(buffer, sizeof(buffer), (spec + "s").c_str(), s.c_str());
+			else if (tag == BinaryLog::ARG_DOUBLE)
+				snprintf(buffer, sizeof(buffer), "%g", d);
+			else if (tag == BinaryLog::ARG_INT)
+				snprintf(buffer, sizeof(buffer), "%lld", (long long)i);
+			else
+				snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)u);
+		}
+		else if (tag == BinaryLog::ARG_STRING)
+		{
+			snprintf(buffer, sizeof(buffer), "%s", s.c_str());
+		}
+		else if (conversion == 'p')
+		{
+			snprintf(buffer, sizeof(buffer), "%p", (void*)(size_t)u);
+		}
+		else if (is_float)
+		{
+			double v = tag == BinaryLog::ARG_DOUBLE ? d :
+				tag == BinaryLog::ARG_INT ? (double)i : (double)u;
+			snprintf(buffer, sizeof(buffer), (spec + conversion).c_str(), v);
+		}
+		else
+		{
+			long long v = tag == BinaryLog::ARG_DOUBLE ? (long long)d :
+				tag == BinaryLog::ARG_INT ? (long long)i : (long long)u;
+			if (strchr("diuxXo", conversion))
+				snprintf(buffer, sizeof(buffer), (spec + "ll" + conversion).c_str(), v);
+			else if (conversion == 'c')
+				snprintf(buffer, sizeof(buffer), (spec + "c").c_str(), (int)v);
+			else
+				snprintf(buffer, sizeof(buffer), "%lld", v);
+		}
+		result += buffer;
+	}
+	return result;
+}
+//-----------------------------------------------------------------------------
+
+}  // namespace control
+}  // namespace CmnLib
@@ -16,39 +16,36 @@ namespace control
 LogToFile::LogToFile(std::string const& filename, int flags)
     :
     Logger::Listener(flags),
-    mFilename(filename)
+    mFile(filename),
+    mInBatch(false)
 {
-    std::ofstream logFile(filename);
-    if (logFile)
-    {
-        // This clears the file contents from any previous runs.
-        logFile.close();
-    }
-    else
+    // The file is cleared from any previous runs and kept open.  If it
+    // cannot be opened, Report writes nothing.
+}
+//----------------------------------------------------------------------------
+void LogToFile::BeginBatch()
+{
+    mInBatch = true;
+}
+//----------------------------------------------------------------------------
+void LogToFile::EndBatch()
+{
+    mInBatch = false;
+    if (mFile.is_open())
     {
-        // The file cannot be opened.  Use a null string for Report to know
-        // not to attempt opening the file for append.
-        mFilename = "";
+        mFile.flush();
     }
 }
 //----------------------------------------------------------------------------
 void LogToFile::Report(std::string const& message)
 {
-    if (mFilename != "")
+    if (mFile.is_open())
     {
-        // Open for append.
-        std::ofstream logFile(mFilename,
-            std::ios_base::out | std::ios_base::app);
-        if (logFile)
-        {
-            logFile << message.c_str();
-            logFile.close();
-        }
-        else
+        mFile << message.c_str();
+        if (!mInBatch)
         {
-            // The file cannot be opened.  Use a null string for Report not
-            // to attempt opening the file for append on the next call.
-            mFilename = "";
+            // A single message is on the disk when the call returns.
+            mFile.flush();
         }
     }
 }
@@ -7,72 +7,692 @@
 
 #include "control/inc/control/Logger.hpp"
 
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
 namespace CmnLib
 {
 namespace control
 {
 
+namespace
+{
+
+enum
+{
+    TYPE_ASSERTION,
+    TYPE_ERROR,
+    TYPE_WARNING,
+    TYPE_INFORMATION
+};
+
+int const gListenFlags[] =
+{
+    Logger::Listener::LISTEN_FOR_ASSERTION,
+    Logger::Listener::LISTEN_FOR_ERROR,
+    Logger::Listener::LISTEN_FOR_WARNING,
+    Logger::Listener::LISTEN_FOR_INFORMATION
+};
+
+// The report string, the same in synchronous and asynchronous mode.
+void FormatMessage(std::string& output, char const* file,
+    char const* function, int line, char const* message, size_t length)
+{
+    output.clear();
+    output.append("File: ").append(file).append("\n");
+    output.append("Func: ").append(function).append("\n");
+    output.append("Line: ").append(std::to_string(line)).append("\n");
+    output.append(message, length).append("\n\n");
+}
+
+void Dispatch(Logger::Listener* listener, int type, std::string const& message)
+{
+    switch (type)
+    {
+    case TYPE_ASSERTION:    listener->Assertion(message);   break;
+    case TYPE_ERROR:        listener->Error(message);       break;
+    case TYPE_WARNING:      listener->Warning(message);     break;
+    default:                listener->Information(message); break;
+    }
+}
+
+// A queued message.  The size is fixed so that the rings never allocate.
+struct Record
+{
+    uint64_t sequence;
+    char const* file;
+    char const* function;
+    int line;
+    int type;
+    size_t length;
+    char payload[Logger::MAX_PAYLOAD];
+};
+
+// Single-producer (the logging thread) single-consumer (the drain thread)
+// ring.  The indices grow without wrapping; the capacity is a power of 2.
+struct Ring
+{
+    explicit Ring(size_t capacity)
+        :
+        records(capacity),
+        mask(capacity - 1),
+        head(0),
+        tail(0),
+        retired(false)
+    {
+    }
+
+    std::vector<Record> records;
+    size_t mask;
+    std::atomic<size_t> head;  // written by the consumer
+    char padding[64];
+    std::atomic<size_t> tail;  // written by the producer
+    std::atomic<bool> retired; // the producer thread has terminated
+};
+
+std::mutex gRingMutex;
+std::vector<Ring*> gRings;
+
+// The rings read by the crash handler, which cannot take gRingMutex.
+size_t const MAX_CRASH_RINGS = 256;
+std::atomic<Ring*> gCrashRings[MAX_CRASH_RINGS];
+size_t gRingCapacity = 512;
+Logger::OverflowPolicy gPolicy = Logger::OVERFLOW_BLOCK;
+std::atomic<uint64_t> gSequence(0);
+
+// Serialize the drains of the background thread and of the crash handler.
+std::mutex gDrainMutex;
+
+// Drain thread control.
+std::mutex gControlMutex;
+std::condition_variable gControlCondition;
+std::thread gDrainThread;
+// Read by the logging threads (Flush), set by the drain thread itself.
+std::atomic<std::thread::id> gDrainThreadId;
+bool gStop = false;
+uint64_t gFlushRequested = 0;
+uint64_t gFlushCompleted = 0;
+
+struct RingOwner
+{
+    constexpr RingOwner() : ring(nullptr), destroyed(false) {}
+
+    // The drain thread frees the ring once it is retired and drained, so
+    // the owner forgets it.
+    ~RingOwner()
+    {
+        if (ring)
+        {
+            ring->retired.store(true, std::memory_order_release);
+            ring = nullptr;
+        }
+        destroyed = true;
+    }
+
+    // The ring of the thread, null after the destructor (the messages of
+    // the later thread_local destructors are reported synchronously).
+    Ring* Get()
+    {
+        if (!ring && !destroyed)
+        {
+            ring = new Ring(gRingCapacity);
+            std::lock_guard<std::mutex> lock(gRingMutex);
+            gRings.push_back(ring);
+            for (size_t i = 0; i < MAX_CRASH_RINGS; ++i)
+            {
+                Ring* empty = nullptr;
+                if (gCrashRings[i].compare_exchange_strong(empty, ring))
+                {
+                    break;
+                }
+            }
+        }
+        return ring;
+    }
+
+    Ring* ring;
+    bool destroyed;
+};
+
+thread_local RingOwner tlsRing;
+
+void WakeDrain()
+{
+    std::lock_guard<std::mutex> lock(gControlMutex);
+    ++gFlushRequested;
+    gControlCondition.notify_all();
+}
+
+std::terminate_handler gPreviousTerminate = nullptr;
+
+//----------------------------------------------------------------------------
+// Crash handler.  Only async-signal-safe calls: the records are written
+// with write(2) to a descriptor opened before the crash, without locks nor
+// allocations.
+//----------------------------------------------------------------------------
+int gCrashFd = 2;
+int const gCrashSignals[] = { SIGSEGV, SIGABRT, SIGFPE, SIGILL };
+int const NUM_CRASH_SIGNALS = 4;
+#if defined(_WIN32)
+typedef void (*SignalHandler)(int);
+SignalHandler gPreviousSignals[NUM_CRASH_SIGNALS];
+#else
+struct sigaction gPreviousSignals[NUM_CRASH_SIGNALS];
+#endif
+
+char const* const gCrashHeaders[] =
+{
+    "\nCMNLIB ASSERTION:\n",
+    "\nCMNLIB ERROR:\n",
+    "\nCMNLIB WARNING:\n",
+    "\nCMNLIB INFORMATION:\n"
+};
+
+void CrashWrite(char const* data, size_t size)
+{
+    while (size > 0)
+    {
+#if defined(_WIN32)
+        int n = _write(gCrashFd, data, (unsigned int)size);
+#else
+        ssize_t n = write(gCrashFd, data, size);
+#endif
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return;
+        }
+        data += n;
+        size -= (size_t)n;
+    }
+}
+
+void CrashWrite(char const* text)
+{
+    CrashWrite(text, std::strlen(text));
+}
+
+void CrashWrite(int value)
+{
+    char buffer[16];
+    char* p = buffer + sizeof(buffer);
+    unsigned int u = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    do
+    {
+        *--p = (char)('0' + u % 10);
+        u /= 10;
+    }
+    while (u != 0);
+    if (value < 0)
+    {
+        *--p = '-';
+    }
+    CrashWrite(p, (size_t)(buffer + sizeof(buffer) - p));
+}
+
+// Write the pending records of all the rings in logging order, as
+// FormatMessage and the default listener headers.  The heads are not
+// moved: the drain thread may be running.
+void WriteRingsOnCrash()
+{
+    size_t cursors[MAX_CRASH_RINGS];
+    size_t tails[MAX_CRASH_RINGS];
+    Ring* rings[MAX_CRASH_RINGS];
+    for (size_t i = 0; i < MAX_CRASH_RINGS; ++i)
+    {
+        rings[i] = gCrashRings[i].load(std::memory_order_acquire);
+        if (rings[i])
+        {
+            cursors[i] = rings[i]->head.load(std::memory_order_acquire);
+            tails[i] = rings[i]->tail.load(std::memory_order_acquire);
+        }
+    }
+    for (;;)
+    {
+        Record const* next = nullptr;
+        size_t nextRing = 0;
+        for (size_t i = 0; i < MAX_CRASH_RINGS; ++i)
+        {
+            if (rings[i] && cursors[i] != tails[i])
+            {
+                Record const* record =
+                    &rings[i]->records[cursors[i] & rings[i]->mask];
+                if (!next || record->sequence < next->sequence)
+                {
+                    next = record;
+                    nextRing = i;
+                }
+            }
+        }
+        if (!next)
+        {
+            return;
+        }
+        ++cursors[nextRing];
+        CrashWrite(gCrashHeaders[next->type]);
+        CrashWrite("File: ");
+        CrashWrite(next->file);
+        CrashWrite("\nFunc: ");
+        CrashWrite(next->function);
+        CrashWrite("\nLine: ");
+        CrashWrite(next->line);
+        CrashWrite("\n");
+        CrashWrite(next->payload, next->length);
+        CrashWrite("\n\n");
+    }
+}
+
+// Write the records, then give the signal to the previous handler.
+#if defined(_WIN32)
+void OnCrashSignal(int sig)
+{
+    WriteRingsOnCrash();
+    for (int i = 0; i < NUM_CRASH_SIGNALS; ++i)
+    {
+        if (gCrashSignals[i] == sig)
+        {
+            std::signal(sig, gPreviousSignals[i]);
+        }
+    }
+    std::raise(sig);
+}
+#else
+void OnCrashSignal(int sig, siginfo_t*, void*)
+{
+    int savedErrno = errno;
+    WriteRingsOnCrash();
+    errno = savedErrno;
+    // The previous action runs when the signal is raised again, or when
+    // the faulting instruction is executed again after the return.
+    for (int i = 0; i < NUM_CRASH_SIGNALS; ++i)
+    {
+        if (gCrashSignals[i] == sig)
+        {
+            sigaction(sig, &gPreviousSignals[i], nullptr);
+        }
+    }
+    raise(sig);
+}
+#endif
+
+}  // namespace
+
 //----------------------------------------------------------------------------
 Logger::Logger(char const* file, char const* function, int line,
     std::string const& message)
+    :
+    mFile(file),
+    mFunction(function),
+    mLine(line),
+    mMessage(message)
 {
-    mMessage =
-        "File: " + std::string(file) + "\n" +
-        "Func: " + std::string(function) + "\n" +
-        "Line: " + std::to_string(line) + "\n" +
-        message + "\n\n";
 }
 //----------------------------------------------------------------------------
 void Logger::Assertion()
 {
+    if (Post(TYPE_ASSERTION))
+    {
+        Flush();
+    }
+    else
+    {
+        Notify(TYPE_ASSERTION);
+    }
+}
+//----------------------------------------------------------------------------
+void Logger::Error()
+{
+    if (!Post(TYPE_ERROR))
+    {
+        Notify(TYPE_ERROR);
+    }
+}
+//----------------------------------------------------------------------------
+void Logger::Warning()
+{
+    if (!Post(TYPE_WARNING))
+    {
+        Notify(TYPE_WARNING);
+    }
+}
+//----------------------------------------------------------------------------
+void Logger::Information()
+{
+    if (!Post(TYPE_INFORMATION))
+    {
+        Notify(TYPE_INFORMATION);
+    }
+}
+//----------------------------------------------------------------------------
+void Logger::Notify(int type)
+{
+    std::string message;
+    FormatMessage(message, mFile, mFunction, mLine, mMessage.c_str(),
+        mMessage.size());
+
     msMutex.lock();
     for (auto listener : msListeners)
     {
-        if (listener->GetFlags() & Listener::LISTEN_FOR_ASSERTION)
+        if (listener->GetFlags() & gListenFlags[type])
         {
-            listener->Assertion(mMessage);
+            Dispatch(listener, type, message);
         }
     }
     msMutex.unlock();
 }
 //----------------------------------------------------------------------------
-void Logger::Error()
+bool Logger::Post(int type)
 {
-    msMutex.lock();
-    for (auto listener : msListeners)
+    if (!msAsync.load(std::memory_order_acquire))
     {
-        if (listener->GetFlags() & Listener::LISTEN_FOR_ERROR)
+        return false;
+    }
+
+    Ring* ring = tlsRing.Get();
+    if (!ring)
+    {
+        // The thread is terminating: synchronous report.
+        return false;
+    }
+    size_t tail = ring->tail.load(std::memory_order_relaxed);
+    bool woken = false;
+    while (tail - ring->head.load(std::memory_order_acquire) > ring->mask)
+    {
+        if (gPolicy == OVERFLOW_DROP)
+        {
+            msDropped.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        if (!woken)
+        {
+            // Once: WakeDrain takes the control lock.
+            WakeDrain();
+            woken = true;
+        }
+        std::this_thread::yield();
+        if (!msAsync.load(std::memory_order_acquire))
         {
-            listener->Error(mMessage);
+            return false;
         }
     }
-    msMutex.unlock();
+
+    Record& record = ring->records[tail & ring->mask];
+    record.sequence = gSequence.fetch_add(1, std::memory_order_relaxed);
+    record.file = mFile;
+    record.function = mFunction;
+    record.line = mLine;
+    record.type = type;
+    record.length = std::min(mMessage.size(), (size_t)MAX_PAYLOAD);
+    std::memcpy(record.payload, mMessage.data(), record.length);
+    ring->tail.store(tail + 1, std::memory_order_release);
+    return true;
 }
 //----------------------------------------------------------------------------
-void Logger::Warning()
+bool Logger::DrainRings(bool wait)
 {
-    msMutex.lock();
-    for (auto listener : msListeners)
+    std::unique_lock<std::mutex> drainLock(gDrainMutex, std::defer_lock);
+    if (wait)
+    {
+        drainLock.lock();
+    }
+    else if (!drainLock.try_lock())
     {
-        if (listener->GetFlags() & Listener::LISTEN_FOR_WARNING)
+        return false;
+    }
+
+    // Without wait (crash path) no lock is waited for: the crashing thread
+    // may hold any of them.
+    std::vector<Ring*> rings;
+    {
+        std::unique_lock<std::mutex> lock(gRingMutex, std::defer_lock);
+        if (wait)
         {
-            listener->Warning(mMessage);
+            lock.lock();
         }
+        else if (!lock.try_lock())
+        {
+            return false;
+        }
+        rings = gRings;
     }
-    msMutex.unlock();
+
+    // Collect the available records of every ring, in logging order.
+    std::vector<Record const*> batch;
+    std::vector<size_t> tails(rings.size());
+    for (size_t i = 0; i < rings.size(); ++i)
+    {
+        Ring* ring = rings[i];
+        size_t head = ring->head.load(std::memory_order_relaxed);
+        tails[i] = ring->tail.load(std::memory_order_acquire);
+        for (size_t j = head; j != tails[i]; ++j)
+        {
+            batch.push_back(&ring->records[j & ring->mask]);
+        }
+    }
+
+    if (!batch.empty())
+    {
+        std::sort(batch.begin(), batch.end(),
+            [](Record const* r0, Record const* r1)
+            { return r0->sequence < r1->sequence; });
+
+        std::string message;
+        if (wait)
+        {
+            msMutex.lock();
+        }
+        else if (!msMutex.try_lock())
+        {
+            return false;
+        }
+        for (auto listener : msListeners)
+        {
+            listener->BeginBatch();
+        }
+        for (auto record : batch)
+        {
+            FormatMessage(message, record->file, record->function,
+                record->line, record->payload, record->length);
+            for (auto listener : msListeners)
+            {
+                if (listener->GetFlags() & gListenFlags[record->type])
+                {
+                    Dispatch(listener, record->type, message);
+                }
+            }
+        }
+        for (auto listener : msListeners)
+        {
+            listener->EndBatch();
+        }
+        msMutex.unlock();
+
+        for (size_t i = 0; i < rings.size(); ++i)
+        {
+            rings[i]->head.store(tails[i], std::memory_order_release);
+        }
+    }
+
+    // Release the rings of the terminated threads once drained.
+    if (!wait)
+    {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(gRingMutex);
+    for (size_t i = 0; i < rings.size(); ++i)
+    {
+        Ring* ring = rings[i];
+        if (ring->retired.load(std::memory_order_acquire) &&
+            ring->head.load(std::memory_order_relaxed) ==
+            ring->tail.load(std::memory_order_acquire))
+        {
+            gRings.erase(std::find(gRings.begin(), gRings.end(), ring));
+            for (size_t j = 0; j < MAX_CRASH_RINGS; ++j)
+            {
+                Ring* current = ring;
+                gCrashRings[j].compare_exchange_strong(current, nullptr);
+            }
+            delete ring;
+        }
+    }
+    return true;
 }
 //----------------------------------------------------------------------------
-void Logger::Information()
+void Logger::DrainLoop()
 {
-    msMutex.lock();
-    for (auto listener : msListeners)
+    gDrainThreadId.store(std::this_thread::get_id(), std::memory_order_release);
+    std::unique_lock<std::mutex> lock(gControlMutex);
+    for (;;)
     {
-        if (listener->GetFlags() & Listener::LISTEN_FOR_INFORMATION)
+        gControlCondition.wait_for(lock, std::chrono::milliseconds(10),
+            [] { return gStop || gFlushRequested != gFlushCompleted; });
+        bool stop = gStop;
+        uint64_t requested = gFlushRequested;
+        lock.unlock();
+
+        DrainRings(true);
+
+        lock.lock();
+        gFlushCompleted = requested;
+        gControlCondition.notify_all();
+        if (stop)
         {
-            listener->Information(mMessage);
+            break;
         }
     }
-    msMutex.unlock();
+}
+//----------------------------------------------------------------------------
+void Logger::StartAsync(OverflowPolicy policy, size_t recordsPerThread)
+{
+    std::lock_guard<std::mutex> lock(gControlMutex);
+    if (msAsync.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    size_t capacity = 2;
+    while (capacity < recordsPerThread)
+    {
+        capacity <<= 1;
+    }
+    gRingCapacity = capacity;
+    gPolicy = policy;
+    gStop = false;
+    gDrainThread = std::thread(&Logger::DrainLoop);
+    msAsync.store(true, std::memory_order_release);
+}
+//----------------------------------------------------------------------------
+void Logger::StopAsync()
+{
+    {
+        std::lock_guard<std::mutex> lock(gControlMutex);
+        if (!msAsync.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        msAsync.store(false, std::memory_order_release);
+        gStop = true;
+        gControlCondition.notify_all();
+    }
+    gDrainThread.join();
+    gDrainThreadId.store(std::thread::id(), std::memory_order_release);
+    DrainRings(true);
+}
+//----------------------------------------------------------------------------
+bool Logger::IsAsync()
+{
+    return msAsync.load(std::memory_order_acquire);
+}
+//----------------------------------------------------------------------------
+void Logger::Flush()
+{
+    if (!msAsync.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    if (std::this_thread::get_id() ==
+        gDrainThreadId.load(std::memory_order_acquire))
+    {
+        // Called by a listener (or a crash in a listener).
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(gControlMutex);
+    uint64_t requested = ++gFlushRequested;
+    gControlCondition.notify_all();
+    gControlCondition.wait(lock, [requested]
+        { return gStop || gFlushCompleted >= requested; });
+}
+//----------------------------------------------------------------------------
+size_t Logger::GetNumDropped()
+{
+    return msDropped.load(std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------
+void Logger::FlushOnCrash()
+{
+    // The drain thread or the crashing thread may hold the locks, so they
+    // are only tried (DrainRings without wait).
+    if (!msAsync.load(std::memory_order_acquire) ||
+        std::this_thread::get_id() ==
+        gDrainThreadId.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    for (int i = 0; i < 100 && !DrainRings(false); ++i)
+    {
+        std::this_thread::yield();
+    }
+}
+//----------------------------------------------------------------------------
+void Logger::InstallCrashHandler(int fd)
+{
+    gCrashFd = fd;
+    static bool installed = false;
+    if (installed)
+    {
+        // The previous handlers would be this one.
+        return;
+    }
+    installed = true;
+    for (int i = 0; i < NUM_CRASH_SIGNALS; ++i)
+    {
+#if defined(_WIN32)
+        gPreviousSignals[i] = std::signal(gCrashSignals[i], OnCrashSignal);
+#else
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_sigaction = OnCrashSignal;
+        action.sa_flags = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        sigaction(gCrashSignals[i], &action, &gPreviousSignals[i]);
+#endif
+    }
+    gPreviousTerminate = std::set_terminate([]
+    {
+        FlushOnCrash();
+        if (gPreviousTerminate)
+        {
+            gPreviousTerminate();
+        }
+        std::abort();
+    });
 }
 //----------------------------------------------------------------------------
 void Logger::Subscribe(Listener* listener)
@@ -128,6 +748,16 @@ void Logger::Listener::Information(std::string const& message)
     Report("\nCMNLIB INFORMATION:\n" + message);
 }
 //----------------------------------------------------------------------------
+void Logger::Listener::BeginBatch()
+{
+    // Stub for derived classes.
+}
+//----------------------------------------------------------------------------
+void Logger::Listener::EndBatch()
+{
+    // Stub for derived classes.
+}
+//----------------------------------------------------------------------------
 void Logger::Listener::Report(std::string const&)
 {
     // Stub for derived classes.
@@ -136,6 +766,8 @@ void Logger::Listener::Report(std::string const&)
 
 std::mutex Logger::msMutex;
 std::set<Logger::Listener*> Logger::msListeners;
+std::atomic<bool> Logger::msAsync(false);
+std::atomic<size_t> Logger::msDropped(0);
 
 }  // namespace control
 }  // namespace CmnLib
@@ -32,15 +32,17 @@ namespace control
 // Creates a Logger intance writing messages into STDOUT.
 LoggerMS::LoggerMS(LogLevel level)
 {
-	level_ = level;
+	level_ = static_cast<int>(level);
 	file_ = nullptr;
+	is_kill_fatal_ = false;
 }
 
 // Creates a Logger instance writing messages into both STDOUT and log file.
 LoggerMS::LoggerMS(std::string filename, LogLevel level)
 {
-	level_ = level;
+	level_ = static_cast<int>(level);
 	file_ = nullptr;
+	is_kill_fatal_ = false;
 	ResetLogFile(filename);
 }
 
@@ -66,64 +68,33 @@ int LoggerMS::ResetLogFile(std::string filename)
 
 void LoggerMS::Write(LogLevel level, const char *format, ...)
 {
+	if (!IsEnabled(level)) return;
 	va_list val;
 	va_start(val, format);
 	Write(level, format, val);
 	va_end(val);
 }
 
-void LoggerMS::Debug(const char *format, ...)
-{
-	va_list val;
-	va_start(val, format);
-	Write(LogLevel::Debug, format, val);
-	va_end(val);
-}
-
-void LoggerMS::Info(const char *format, ...)
-{
-	va_list val;
-	va_start(val, format);
-	Write(LogLevel::Info, format, val);
-	va_end(val);
-}
-
-void LoggerMS::Error(const char *format, ...)
-{
-	va_list val;
-	va_start(val, format);
-	Write(LogLevel::Error, format, val);
-	va_end(val);
-}
-
-void LoggerMS::Fatal(const char *format, ...)
-{
-	va_list val;
-	va_start(val, format);
-	Write(LogLevel::Fatal, format, val);
-	va_end(val);
-}
-
 // TODO and DISCUSSION (thread safety issue): Two printing methods are 
 // called for writing a message: one for printing the header information 
 // and the other for printing the content. When multiple threads call the
 // method simultaneously, there may be missed-order problem.
 inline void LoggerMS::Write(LogLevel level, const char *format, va_list &val)
 {
-	if (level >= level_) // omit the message with low level
+	if (IsEnabled(level)) // omit the message with low level
 	{
-		std::string level_str = GetLevelStr(level);
-		std::string time_str = GetSystemTime();
+		const char* level_str = GetLevelStr(level);
+		const char* time_str = GetSystemTime();
 		va_list val_copy;
 		va_copy(val_copy, val);
 		// write to STDOUT
-		printf("[%s] [%s] ", level_str.c_str(), time_str.c_str());
+		printf("[%s] [%s] ", level_str, time_str);
 		vprintf(format, val);
 		fflush(stdout);
 		// write to log file
 		if (file_ != nullptr)
 		{
-			fprintf(file_, "[%s] [%s] ", level_str.c_str(), time_str.c_str());
+			fprintf(file_, "[%s] [%s] ", level_str, time_str);
 			vfprintf(file_, format, val_copy);
 			fflush(file_);
 		}
@@ -147,15 +118,27 @@ void LoggerMS::CloseLogFile()
 	}
 }
 
-std::string LoggerMS::GetSystemTime()
+const char* LoggerMS::GetSystemTime()
 {
+	// localtime/strftime are called only when the second changes
+	thread_local time_t cached_time = 0;
+	thread_local char str[64] = "";
 	time_t t = time(0);
-	char str[64];
-	strftime(str, sizeof(str), "%Y-%m-%d %H:%M:%S", localtime(&t));
+	if (t != cached_time)
+	{
+		struct tm tm_time;
+#if defined(_MSC_VER)
+		localtime_s(&tm_time, &t);
+#else
+		localtime_r(&t, &tm_time);
+#endif
+		strftime(str, sizeof(str), "%Y-%m-%d %H:%M:%S", &tm_time);
+		cached_time = t;
+	}
 	return str;
 }
 
-std::string LoggerMS::GetLevelStr(LogLevel level)
+const char* LoggerMS::GetLevelStr(LogLevel level)
 {
 	switch (level)
 	{
@@ -188,58 +171,28 @@ void LogMS::ResetKillFatal(bool is_kill_fatal)
 
 void LogMS::Write(LogLevel level, const char *format, ...)
 {
+	if (!IsEnabled(level)) return;
 	va_list val;
 	va_start(val, format);
 	logger_.Write(level, format, val);
 	va_end(val);
 }
 
-void LogMS::Debug(const char *format, ...)
-{
-	va_list val;
-	va_start(val, format);
-	logger_.Write(LogLevel::Debug, format, val);
-	va_end(val);
-}
-
 void LogMS::Info(const std::string &s)
 {
-	Info(s.c_str());
-}
-
-void LogMS::Info(const char *format, ...)
-{
-	va_list val;
-	va_start(val, format);
-	logger_.Write(LogLevel::Info, format, val);
-	va_end(val);
+	Info("%s", s.c_str());
 }
 
 void LogMS::Error(const std::string &s)
 {
-	Error(s.c_str());
-}
-
-void LogMS::Error(const char *format, ...)
-{
-	va_list val;
-	va_start(val, format);
-	logger_.Write(LogLevel::Error, format, val);
-	va_end(val);
+	Error("%s", s.c_str());
 }
 
 void LogMS::Fatal(const std::string &s)
 {
-	Fatal(s.c_str());
+	Fatal("%s", s.c_str());
 }
 
-void LogMS::Fatal(const char *format, ...)
-{
-	va_list val;
-	va_start(val, format);
-	logger_.Write(LogLevel::Fatal, format, val);
-	va_end(val);
-}
 // End of Log class rountine ---------------------------------------------/
 
 
@@ -0,0 +1,642 @@
+/**
+* @file NumberConversion.hpp
+* @brief Locale-free conversion between numbers and text.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.0.0
+*
+*/
+
+#ifndef CMNLIB_STRING_NUMBERCONVERSION_HPP__
+#define CMNLIB_STRING_NUMBERCONVERSION_HPP__
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace CmnLib
+{
+namespace text
+{
+
+/** @brief Locale-free conversion between numbers and text.
+
+	The conversions work on [first, last) char ranges, do not allocate and
+	do not depend on the locale (the decimal point is always '.'). They
+	follow std::from_chars/std::to_chars (C++17): no leading whitespace is
+	skipped, the position after the converted chars and an error code are
+	returned. Unlike from_chars, a leading '+' is accepted.
+	@par
+	The floating point numbers with at most 19 significant digits and a
+	decimal exponent in [-22, 22] (the common case in the data files) are
+	converted exactly with one multiplication or division. The others are
+	converted by strtod on a copy with the decimal point of the locale.
+	The floats are rounded once, as strtof: a double halfway between two
+	floats (or out of the normal floats) is converted again by strtof.
+	@par
+	format writes the digits with snprintf, which uses the decimal point
+	of the current locale: the point is found in the text and replaced by
+	'.', so localeconv is not called. Only the strtod fallback of parse
+	reads localeconv, as it must write the point of the locale.
+*/
+class NumberConversion
+{
+public:
+
+	/** @brief Conversion errors.
+	*/
+	enum ConversionError
+	{
+		CONVERSION_OK = 0,
+		CONVERSION_INVALID_ARGUMENT,
+		CONVERSION_OUT_OF_RANGE
+	};
+
+	/** @brief Result of parse: first char not converted and error.
+	*/
+	struct ParseResult
+	{
+		const char* ptr;
+		ConversionError error;
+	};
+
+	/** @brief Result of format: end of the written chars and error.
+	*/
+	struct FormatResult
+	{
+		char* ptr;
+		ConversionError error;
+	};
+
+	/** @brief Parse an integer in base 10.
+	*/
+	template <typename T>
+	static typename std::enable_if<std::is_integral<T>::value, ParseResult>::type
+	parse(const char* first, const char* last, T &value)
+	{
+		const char* p = first;
+		bool negative = false;
+		if (p < last && (*p == '-' || *p == '+')) {
+			negative = *p == '-';
+			++p;
+		}
+		if (p == last || !is_digit(*p) || (negative && !std::is_signed<T>::value)) {
+			return make_result(first, CONVERSION_INVALID_ARGUMENT);
+		}
+		unsigned long long limit = negative ?
+			(unsigned long long)std::numeric_limits<T>::max() + 1 :
+			(unsigned long long)std::numeric_limits<T>::max();
+		unsigned long long v = 0;
+		bool overflow = false;
+		for (; p < last && is_digit(*p); ++p) {
+			unsigned int d = (unsigned int)(*p - '0');
+			if (v > (limit - d) / 10) overflow = true;
+			else v = v * 10 + d;
+		}
+		if (overflow) return make_result(p, CONVERSION_OUT_OF_RANGE);
+		value = negative ? (T)(0 - v) : (T)v;
+		return make_result(p, CONVERSION_OK);
+	}
+
+	/** @brief Parse a floating point number ([sign] digits [. digits]
+		[e [sign] digits], inf or nan).
+	*/
+	template <typename T>
+	static typename std::enable_if<std::is_floating_point<T>::value, ParseResult>::type
+	parse(const char* first, const char* last, T &value)
+	{
+		if (first == last) return make_result(first, CONVERSION_INVALID_ARGUMENT);
+		const char* p = first;
+		bool negative = false;
+		if (p < last && (*p == '-' || *p == '+')) {
+			negative = *p == '-';
+			++p;
+		}
+		unsigned long long mantissa = 0;
+		int num_digits = 0;
+		int exponent = 0;
+		bool any_digit = false;
+		bool truncated = false;
+		for (; p < last && is_digit(*p); ++p) {
+			any_digit = true;
+			add_digit(*p, mantissa, num_digits, exponent, truncated, false);
+		}
+		if (p < last && *p == '.') {
+			const char* q = p + 1;
+			bool fraction_digit = false;
+			for (; q < last && is_digit(*q); ++q) {
+				fraction_digit = true;
+				add_digit(*q, mantissa, num_digits, exponent, truncated, true);
+			}
+			if (any_digit || fraction_digit) p = q;
+			any_digit = any_digit || fraction_digit;
+		}
+		if (!any_digit) {
+			// inf, infinity, nan
+			return parse_fallback(first, first + std::min<ptrdiff_t>(
+				last - first, 32), value);
+		}
+		if (p < last && (*p == 'e' || *p == 'E')) {
+			const char* q = p + 1;
+			bool exp_negative = false;
+			if (q < last && (*q == '-' || *q == '+')) {
+				exp_negative = *q == '-';
+				++q;
+			}
+			if (q < last && is_digit(*q)) {
+				int e = 0;
+				for (; q < last && is_digit(*q); ++q) {
+					if (e < 100000) e = e * 10 + (*q - '0');
+				}
+				exponent += exp_negative ? -e : e;
+				p = q;
+			}
+		}
+		if (mantissa == 0) {
+			value = negative ? -(T)0 : (T)0;
+			return make_result(p, CONVERSION_OK);
+		}
+		if (!truncated && mantissa <= (1ull << 53) &&
+			exponent >= -22 && exponent <= 22) {
+			// both the mantissa and the power of 10 are exact doubles
+			double d = (double)mantissa;
+			d = exponent < 0 ? d / pow10(-exponent) : d * pow10(exponent);
+			if (!std::is_same<T, float>::value || !needs_strtof(d)) {
+				return make_result(p, store(negative ? -d : d, value));
+			}
+		}
+		ParseResult r = parse_fallback(first, p, value);
+		r.ptr = p;
+		return r;
+	}
+
+	/** @brief Parse a whitespace-separated list of numbers.
+
+		@param[in] first Begin of the text.
+		@param[in] last End of the text.
+		@param[out] out The numbers are appended to it.
+		@return The position of the first token which is not a number (last
+		        if all the text is converted) and its error.
+	*/
+	template <typename T>
+	static ParseResult parse_array(const char* first, const char* last,
+		std::vector<T> &out)
+	{
+		const char* p = first;
+		for (;;) {
+			while (p < last && is_space(*p)) ++p;
+			if (p == last) return make_result(p, CONVERSION_OK);
+			T v;
+			ParseResult r = parse(p, last, v);
+			if (r.error != CONVERSION_OK) return make_result(p, r.error);
+			if (r.ptr < last && !is_space(*r.ptr)) {
+				return make_result(p, CONVERSION_INVALID_ARGUMENT);
+			}
+			out.push_back(v);
+			p = r.ptr;
+		}
+	}
+
+	/** @brief Parse a whitespace-separated list of floats.
+	*/
+	static ParseResult parse_floats(const char* first, const char* last,
+		std::vector<float> &out)
+	{
+		return parse_array(first, last, out);
+	}
+
+	/** @brief Write an integer in base 10.
+	*/
+	template <typename T>
+	static typename std::enable_if<std::is_integral<T>::value, FormatResult>::type
+	format(char* first, char* last, T value)
+	{
+		char buffer[24];
+		char* end = buffer + sizeof(buffer);
+		char* p = end;
+		bool negative = value < 0;
+		unsigned long long v = negative ? 0ull - (unsigned long long)value :
+			(unsigned long long)value;
+		do {
+			*--p = (char)('0' + v % 10);
+			v /= 10;
+		} while (v);
+		if (negative) *--p = '-';
+		return copy_result(p, end, first, last);
+	}
+
+	/** @brief Write a floating point number with the %g format.
+		@param[in] precision Significant digits. If negative, the digits
+		           needed to read back the same value (9 for float, 17 for
+		           double).
+	*/
+	template <typename T>
+	static typename std::enable_if<std::is_floating_point<T>::value, FormatResult>::type
+	format(char* first, char* last, T value, int precision = -1)
+	{
+		if (precision < 0) {
+			precision = std::numeric_limits<T>::max_digits10;
+		}
+		char buffer[512];
+		int n = snprintf(buffer, sizeof(buffer), "%.*Lg", precision,
+			(long double)value);
+		if (n < 0 || n >= (int)sizeof(buffer)) {
+			return make_result(last, CONVERSION_OUT_OF_RANGE);
+		}
+		if (std::isfinite(value)) n = replace_point(buffer, n);
+		return copy_result(buffer, buffer + n, first, last);
+	}
+
+	/** @brief Write a floating point number with the fewest significant
+		digits which are read back as the same value, like std::to_chars.
+		@remarks
+			The text is the one of %.<p>g with the smallest p from digits10
+			to max_digits10 which reads back the value (0.1f is "0.1",
+			160.0f is "160"). The floats are converted without snprintf,
+			the doubles with one snprintf whose digits are rounded to every
+			precision, the other types try the precisions with snprintf.
+	*/
+	template <typename T>
+	static typename std::enable_if<std::is_floating_point<T>::value, FormatResult>::type
+	format_shortest(char* first, char* last, T value)
+	{
+		if (value == 0 || !std::isfinite(value)) {
+			return format(first, last, value);
+		}
+		char buffer[64];
+		char* end = nullptr;
+		if (std::is_same<T, float>::value) {
+			end = format_shortest_float((float)value, buffer);
+		} else if (std::is_same<T, double>::value) {
+			end = format_shortest_double((double)value, buffer);
+		}
+		if (!end) {
+			for (int p = std::numeric_limits<T>::digits10;
+				p < std::numeric_limits<T>::max_digits10; ++p) {
+				FormatResult r = format(buffer, buffer + sizeof(buffer), value, p);
+				T v;
+				if (r.error == CONVERSION_OK &&
+					parse(buffer, r.ptr, v).error == CONVERSION_OK && v == value) {
+					end = r.ptr;
+					break;
+				}
+			}
+		}
+		if (!end) return format(first, last, value);
+		return copy_result(buffer, end, first, last);
+	}
+
+	static bool is_space(char c) {
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' ||
+			c == '\f';
+	}
+
+private:
+
+	static bool is_digit(char c) { return (unsigned int)(c - '0') <= 9; }
+
+	static ParseResult make_result(const char* ptr, ConversionError error) {
+		ParseResult r;
+		r.ptr = ptr;
+		r.error = error;
+		return r;
+	}
+
+	static FormatResult make_result(char* ptr, ConversionError error) {
+		FormatResult r;
+		r.ptr = ptr;
+		r.error = error;
+		return r;
+	}
+
+	static FormatResult copy_result(const char* begin, const char* end,
+		char* first, char* last) {
+		if (end - begin > last - first) {
+			return make_result(last, CONVERSION_OUT_OF_RANGE);
+		}
+		memcpy(first, begin, end - begin);
+		return make_result(first + (end - begin), CONVERSION_OK);
+	}
+
+	/** @brief Accumulate a digit in the mantissa (at most 19 digits).
+	*/
+	static void add_digit(char c, unsigned long long &mantissa,
+		int &num_digits, int &exponent, bool &truncated, bool fraction) {
+		unsigned int d = (unsigned int)(c - '0');
+		if (num_digits == 0 && d == 0) {
+			// leading zero
+			if (fraction) --exponent;
+			return;
+		}
+		if (num_digits < 19) {
+			mantissa = mantissa * 10 + d;
+			++num_digits;
+			if (fraction) --exponent;
+		} else {
+			if (d != 0) truncated = true;
+			if (!fraction) ++exponent;
+		}
+	}
+
+	/** @brief Exact powers of 10 in double.
+	*/
+	static double pow10(int e) {
+		static const double kPow10[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+		return kPow10[e];
+	}
+
+	/** @brief d * 10^e, with at most two roundings.
+	*/
+	static double scale10(double d, int e) {
+		while (e > 22) {
+			d *= 1e22;
+			e -= 22;
+		}
+		while (e < -22) {
+			d /= 1e22;
+			e += 22;
+		}
+		return e < 0 ? d / pow10(-e) : d * pow10(e);
+	}
+
+	/** @brief Write the digits of the mantissa m (num_digits digits,
+		d.ddd * 10^exponent) like %.<num_digits>g.
+	*/
+	static char* write_g(char* p, bool negative, unsigned long long m,
+		int num_digits, int exponent) {
+		char digits[24];
+		for (int i = num_digits - 1; i >= 0; --i) {
+			digits[i] = (char)('0' + m % 10);
+			m /= 10;
+		}
+		int n = num_digits;
+		while (n > 1 && digits[n - 1] == '0') --n;
+		if (negative) *p++ = '-';
+		if (exponent < -4 || exponent >= num_digits) {
+			*p++ = digits[0];
+			if (n > 1) {
+				*p++ = '.';
+				memcpy(p, digits + 1, n - 1);
+				p += n - 1;
+			}
+			*p++ = 'e';
+			*p++ = exponent < 0 ? '-' : '+';
+			int e = exponent < 0 ? -exponent : exponent;
+			if (e >= 100) *p++ = (char)('0' + e / 100);
+			*p++ = (char)('0' + e / 10 % 10);
+			*p++ = (char)('0' + e % 10);
+		} else if (exponent >= 0) {
+			for (int i = 0; i <= exponent; ++i) *p++ = i < n ? digits[i] : '0';
+			if (n > exponent + 1) {
+				*p++ = '.';
+				memcpy(p, digits + exponent + 1, n - exponent - 1);
+				p += n - exponent - 1;
+			}
+		} else {
+			*p++ = '0';
+			*p++ = '.';
+			for (int i = 0; i < -exponent - 1; ++i) *p++ = '0';
+			memcpy(p, digits, n);
+			p += n;
+		}
+		return p;
+	}
+
+	/** @brief d >= 0 rounded to an integer, the ties to even like printf.
+	*/
+	static unsigned long long round_even(double d) {
+		unsigned long long m = (unsigned long long)d;
+		double f = d - (double)m;
+		if (f > 0.5 || (f == 0.5 && (m & 1))) ++m;
+		return m;
+	}
+
+	/** @brief Shortest text of a finite, not zero float: the float is exact
+		in double and its scaled digits have 29 bits of margin. Every
+		candidate is read back as parse does.
+		@return The end of the text, null if no candidate is read back.
+	*/
+	static char* format_shortest_float(float value, char* buffer) {
+		float a = std::fabs(value);
+		double d = (double)a;
+		// log10(2) * binary exponent, corrected below
+		int e2 = 0;
+		std::frexp(d, &e2);
+		int estimate = (int)std::floor((e2 - 1) * 0.30102999566398120);
+		for (int p = std::numeric_limits<float>::digits10;
+			p <= std::numeric_limits<float>::max_digits10; ++p) {
+			// the estimate can be one off, and the rounding can carry
+			int exponent = estimate;
+			unsigned long long m = 0;
+			for (int k = 0; k < 3; ++k) {
+				m = round_even(scale10(d, p - 1 - exponent));
+				if (m >= (unsigned long long)pow10(p)) ++exponent;
+				else if (m < (unsigned long long)pow10(p - 1)) --exponent;
+				else break;
+			}
+			if (m < (unsigned long long)pow10(p - 1) ||
+				m >= (unsigned long long)pow10(p)) continue;
+			int e = exponent - p + 1;
+			if (e >= -22 && e <= 22) {
+				// the fast path of parse
+				double v = e < 0 ? (double)m / pow10(-e) : (double)m * pow10(e);
+				if ((float)v == a) {
+					return write_g(buffer, value < 0, m, p, exponent);
+				}
+			} else {
+				char* end = write_g(buffer, value < 0, m, p, exponent);
+				float v;
+				if (parse(buffer, end, v).error == CONVERSION_OK && v == value) {
+					return end;
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	/** @brief Shortest text of a finite, not zero double. The 25 digits of
+		%.24e are rounded to every precision; a tail which reads as a tie
+		may come from the rounding of snprintf, it is left to the caller.
+		@return The end of the text, null if no candidate is read back.
+	*/
+	static char* format_shortest_double(double value, char* buffer) {
+		const int kNumDigits = 25;
+		char text[64];
+		int n = snprintf(text, sizeof(text), "%.*e", kNumDigits - 1,
+			std::fabs(value));
+		if (n < 0 || n >= (int)sizeof(text)) return nullptr;
+		// the digits around the decimal point of the locale
+		char digits[kNumDigits];
+		int num_digits = 0;
+		const char* c = text;
+		for (; *c && *c != 'e'; ++c) {
+			if (is_digit(*c) && num_digits < kNumDigits) {
+				digits[num_digits++] = *c;
+			}
+		}
+		if (num_digits != kNumDigits || *c != 'e') return nullptr;
+		int exponent = atoi(c + 1);
+		for (int p = std::numeric_limits<double>::digits10;
+			p < std::numeric_limits<double>::max_digits10; ++p) {
+			unsigned long long m = 0;
+			for (int i = 0; i < p; ++i) m = m * 10 + (digits[i] - '0');
+			// the tail against one half
+			int tail = digits[p] - '5';
+			for (int i = p + 1; tail == 0 && i < kNumDigits; ++i) {
+				if (digits[i] != '0') tail = 1;
+			}
+			if (tail == 0) return nullptr;
+			int e = exponent;
+			if (tail > 0 && ++m == (unsigned long long)pow10(p)) {
+				m /= 10;
+				++e;
+			}
+			char* end = write_g(buffer, value < 0, m, p, e);
+			double v;
+			if (parse(buffer, end, v).error == CONVERSION_OK && v == value) {
+				return end;
+			}
+		}
+		return nullptr;
+	}
+
+	/** @brief Replace the decimal point written by snprintf (one or more
+		chars which are not digits, signs or the exponent) with '.'.
+		@return The new size of the text.
+	*/
+	static int replace_point(char* s, int n) {
+		int j = 0;
+		bool point = false;
+		for (int i = 0; i < n; ++i) {
+			char c = s[i];
+			if (is_digit(c) || c == '-' || c == '+' || c == 'e' || c == 'E') {
+				s[j++] = c;
+			} else if (!point) {
+				s[j++] = '.';
+				point = true;
+			}
+		}
+		return j;
+	}
+
+	static char decimal_point() {
+		const char* point = localeconv()->decimal_point;
+		return point && point[0] ? point[0] : '.';
+	}
+
+	/** @brief Store d in value, out of range if it overflows T or if it
+		underflows to zero.
+	*/
+	template <typename T>
+	static ConversionError store(double d, T &value) {
+		if (std::isinf(d) ||
+			std::fabs(d) > (double)std::numeric_limits<T>::max() ||
+			(d != 0 && (T)d == 0)) {
+			return CONVERSION_OUT_OF_RANGE;
+		}
+		value = (T)d;
+		return CONVERSION_OK;
+	}
+	static ConversionError store(long double d, long double &value) {
+		if (std::isinf(d)) return CONVERSION_OUT_OF_RANGE;
+		value = d;
+		return CONVERSION_OK;
+	}
+
+	/** @brief The rounding of d (> 0) to float may differ from the
+		rounding of the text: d is halfway between two floats or it is not
+		in the range of the normal floats.
+	*/
+	static bool needs_strtof(double d) {
+		uint64_t bits;
+		memcpy(&bits, &d, sizeof(bits));
+		return d < (double)std::numeric_limits<float>::min() ||
+			d > (double)std::numeric_limits<float>::max() ||
+			(bits & 0x1fffffffull) == 0x10000000ull;
+	}
+
+	static float strto(const char* s, char** end, float) {
+		return strtof(s, end);
+	}
+	static double strto(const char* s, char** end, double) {
+		return strtod(s, end);
+	}
+	static long double strto(const char* s, char** end, long double) {
+		return strtold(s, end);
+	}
+
+	/** @brief Convert [first, end) with strtod (strtof for the floats), on a
+		terminated copy which uses the decimal point of the locale. Out of
+		range as strtod (ERANGE), but for the denormal results.
+	*/
+	template <typename T>
+	static ParseResult parse_fallback(const char* first, const char* end,
+		T &value)
+	{
+		typedef typename std::conditional<std::is_same<T, long double>::value,
+			long double, typename std::conditional<std::is_same<T, float>::value,
+			float, double>::type>::type Wide;
+		char buffer[128];
+		std::string big;
+		size_t n = end - first;
+		char* s = buffer;
+		if (n >= sizeof(buffer)) {
+			big.assign(first, n);
+			s = &big[0];
+		} else {
+			memcpy(buffer, first, n);
+			buffer[n] = 0;
+		}
+		char point = decimal_point();
+		if (point != '.') {
+			char* c = (char*)memchr(s, '.', n);
+			if (c) *c = point;
+		}
+		char* s_end = nullptr;
+		errno = 0;
+		Wide d = strto(s, &s_end, Wide());
+		if (s_end == s) return make_result(first, CONVERSION_INVALID_ARGUMENT);
+		const char* ptr = first + (s_end - s);
+		if (errno == ERANGE && (d == 0 || std::fabs(d) > 1)) {
+			return make_result(ptr, CONVERSION_OUT_OF_RANGE);
+		}
+		if (std::isinf(d)) {
+			// "inf" in the text
+			value = (T)d;
+			return make_result(ptr, CONVERSION_OK);
+		}
+		return make_result(ptr, store(d, value));
+	}
+};
+
+}  // namespace text
+}  // namespace CmnLib
+
+#endif // CMNLIB_STRING_NUMBERCONVERSION_HPP__
@@ -36,6 +36,8 @@
 #include <iterator>
 #include <chrono>
 
+#include "StringViewTokenizer.hpp"
+
 namespace CmnLib
 {
 namespace text
@@ -47,17 +49,14 @@ class STDStringFunc
 {
 public:
 
-	/** @brief It split a string
+	/** @brief It split a string. The empty items are skipped.
 	*/
 	template<typename Out>
 	static void split(const std::string &s, char delim, Out result) {
-		std::stringstream ss;
-		ss.str(s);
-		std::string item;
-		while (std::getline(ss, item, delim)) {
-			if (!item.empty()) {
-				*(result++) = item;
-			}
+		StringViewTokenizer tokenizer(s, StringView(&delim, 1));
+		StringView item;
+		while (tokenizer.next(item)) {
+			*(result++) = item.str();
 		}
 	}
 
@@ -27,6 +27,9 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <type_traits>
+
+#include "NumberConversion.hpp"
 
 namespace CmnLib
 {
@@ -35,6 +38,10 @@ namespace text
 
 
 /** @brief Class to convert string and numbers
+
+	The integer and floating point types are converted by NumberConversion,
+	without streams or locale. The other types (chars included) use the
+	stream operators.
 */
 class StringConversion
 {
@@ -54,16 +61,15 @@ public:
 	template <typename T>
 	static std::string NumberToString(T Number)
 	{
-		std::ostringstream ss;
-		ss << Number;
-		return ss.str();
+		return NumberToString(Number, Category<T>());
 	}
 
 	/** @brief Function to conver string to number.
 
-	Function to conver string to number.
+	Function to conver string to number. The leading whitespaces are
+	skipped and the number must be at the beginning of the string.
 	@param[in] String to convert.
-	@return Return the number.
+	@return Return the number, 0 in case of error.
 	@code
 
 	StringToNumber<Type> ( String )
@@ -73,9 +79,92 @@ public:
 	template <typename T>
 	static T StringToNumber(const std::string &Text)
 	{
-		std::istringstream ss(Text);
 		T result;
-		return ss >> result ? result : 0;
+		return StringToNumber(Text, result) == 
+			NumberConversion::CONVERSION_OK ? result : T(0);
+	}
+
+	/** @brief Function to conver string to number, with the error.
+
+	@param[in] Text String to convert.
+	@param[out] result The number, if the conversion succeded.
+	@return Return the conversion error.
+	*/
+	template <typename T>
+	static NumberConversion::ConversionError StringToNumber(
+		const std::string &Text, T &result)
+	{
+		return StringToNumber(Text, result, Category<T>());
+	}
+
+private:
+
+	/** @brief Conversion used for the type T: numbers (integers and floating
+		point but the chars) or stream.
+	*/
+	template <typename T>
+	struct Category : std::integral_constant<bool,
+		std::is_arithmetic<T>::value &&
+		!std::is_same<typename std::remove_cv<T>::type, char>::value &&
+		!std::is_same<typename std::remove_cv<T>::type, signed char>::value &&
+		!std::is_same<typename std::remove_cv<T>::type, unsigned char>::value &&
+		!std::is_same<typename std::remove_cv<T>::type, wchar_t>::value &&
+		!std::is_same<typename std::remove_cv<T>::type, char16_t>::value &&
+		!std::is_same<typename std::remove_cv<T>::type, char32_t>::value> {};
+
+	template <typename T>
+	static std::string NumberToString(T Number, std::true_type)
+	{
+		char buffer[64];
+		NumberConversion::FormatResult r = format(buffer, buffer + 
+			sizeof(buffer), Number);
+		return std::string(buffer, r.ptr);
+	}
+
+	template <typename T>
+	static std::string NumberToString(T Number, std::false_type)
+	{
+		std::ostringstream ss;
+		ss << Number;
+		return ss.str();
+	}
+
+	template <typename T>
+	static NumberConversion::ConversionError StringToNumber(
+		const std::string &Text, T &result, std::true_type)
+	{
+		const char* first = Text.data();
+		const char* last = first + Text.size();
+		while (first < last && NumberConversion::is_space(*first)) ++first;
+		return NumberConversion::parse(first, last, result).error;
+	}
+
+	template <typename T>
+	static NumberConversion::ConversionError StringToNumber(
+		const std::string &Text, T &result, std::false_type)
+	{
+		std::istringstream ss(Text);
+		return ss >> result ? NumberConversion::CONVERSION_OK :
+			NumberConversion::CONVERSION_INVALID_ARGUMENT;
+	}
+
+	/** @brief Format like the default stream (%g with 6 digits for the
+		floating point numbers).
+	*/
+	template <typename T>
+	static typename std::enable_if<std::is_integral<T>::value,
+		NumberConversion::FormatResult>::type
+	format(char* first, char* last, T Number)
+	{
+		return NumberConversion::format(first, last, Number);
+	}
+
+	template <typename T>
+	static typename std::enable_if<std::is_floating_point<T>::value,
+		NumberConversion::FormatResult>::type
+	format(char* first, char* last, T Number)
+	{
+		return NumberConversion::format(first, last, Number, 6);
 	}
 };
 
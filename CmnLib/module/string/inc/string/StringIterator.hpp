@@ -28,6 +28,8 @@
 #include <iostream>
 #include <vector>
 
+#include "StringViewTokenizer.hpp"
+
 namespace CmnLib
 {
 namespace text
@@ -43,10 +45,11 @@ public:
 
 	template<typename Out>
 	static void split(const std::string &s, char delim, Out result) {
-		std::stringstream ss(s);
-		std::string item;
-		while (std::getline(ss, item, delim)) {
-			*(result++) = item;
+		// empty items are kept, as std::getline does
+		StringViewTokenizer tokenizer(s, StringView(&delim, 1), false);
+		StringView item;
+		while (tokenizer.next(item)) {
+			*(result++) = item.str();
 		}
 	}
 
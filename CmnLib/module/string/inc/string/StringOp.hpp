@@ -27,6 +27,9 @@
 #include <string>
 #include <vector>
 #include <regex>
+#include <stdexcept>
+
+#include "NumberConversion.hpp"
 
 namespace CmnLib
 {
@@ -78,13 +81,25 @@ public:
 		The last character is expected to be a valid one
 	*/
 	static int string_padded2number(const std::string &s, char pad) {
-		std::string tmp = s;
-		while (tmp.size() > 1 &&
-			tmp[0] == pad) {
-			tmp.erase(0, 1);
+		if (s.size() == 0) return 0;
+		// skip the padding, but the last character
+		size_t first = s.find_first_not_of(pad);
+		if (first == std::string::npos || first > s.size() - 1) {
+			first = s.size() - 1;
+		}
+		const char* p = s.data() + first;
+		const char* last = s.data() + s.size();
+		while (p < last && NumberConversion::is_space(*p)) ++p;
+		int value = 0;
+		NumberConversion::ConversionError error =
+			NumberConversion::parse(p, last, value).error;
+		// same errors of std::stoi
+		if (error == NumberConversion::CONVERSION_INVALID_ARGUMENT) {
+			throw std::invalid_argument("string_padded2number");
+		} else if (error == NumberConversion::CONVERSION_OUT_OF_RANGE) {
+			throw std::out_of_range("string_padded2number");
 		}
-                if (tmp.size() == 0) return 0;
-		return std::stoi(tmp);
+		return value;
 	}
 
 private:
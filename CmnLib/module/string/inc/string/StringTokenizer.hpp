@@ -25,6 +25,9 @@ namespace text
 {
 
 /** String tokenizer
+    @remarks
+      The words are returned as copies. StringViewTokenizer returns views
+      of the message instead, without allocating.
 */
 class stringTokenizer 
 {
@@ -60,6 +63,9 @@ class stringTokenizer
   /** @brief Message to split 
   */
   std::string message;
+  /** @brief Position of the next word in the message
+  */
+  size_t pos;
   /** @brief Blank char
   */
   char ch;
@@ -28,6 +28,8 @@
 #include <string>
 #include <vector>
 
+#include "NumberConversion.hpp"
+
 namespace CmnLib
 {
 namespace text
@@ -49,6 +51,10 @@ struct get_index_in_tuple<T, std::tuple<Ts...>> : get_index<T, Ts...> {};
 
 
 /** @brief It converts container of strings in a container of other format
+
+	The empty words are skipped. The words which do not start with a number
+	(after the leading whitespaces) or which are out of the range of _Ty
+	give 0, as the conversion with std::stof/std::stoi did.
 */
 template <typename _Ty>
 class StringTypeConversion
@@ -56,83 +62,22 @@ class StringTypeConversion
 public:
 
 	static std::vector<_Ty> convert(const std::vector<std::string> &words) {
-
-		using types = std::tuple<int, float, double, long double>;
-		auto funcs = std::make_tuple(
-			&StringTypeConversion::to_int,
-			&StringTypeConversion::to_float,
-			&StringTypeConversion::to_double,
-			&StringTypeConversion::to_longdouble);
-
 		std::vector<_Ty> vals;
+		vals.reserve(words.size());
 		for (auto &it : words) {
-			try
-			{
-				if (it.size() > 0) {
-					float v = (std::get<get_index_in_tuple<_Ty, types>::value>(funcs))(it);
-					vals.push_back(v);
-				}
-			}
-			catch (std::exception ex) {
-
+			if (it.empty()) continue;
+			const char* first = it.data();
+			const char* last = first + it.size();
+			while (first < last && NumberConversion::is_space(*first)) ++first;
+			_Ty v = 0;
+			if (NumberConversion::parse(first, last, v).error !=
+				NumberConversion::CONVERSION_OK) {
+				v = 0;
 			}
+			vals.push_back(v);
 		}
 		return vals;
 	}
-
-private:
-
-	/** @brief It converts a container of strings in a container of floats
-	*/
-	static float to_float(const std::string &word) {
-		try
-		{
-			return std::stof(word);
-		}
-		catch (std::exception ex) {
-
-		}
-		return 0;
-	}
-
-	/** @brief It converts a container of strings in a container of floats
-	*/
-	static double to_double(const std::string &word) {
-		try
-		{
-			return std::stod(word);
-		}
-		catch (std::exception ex) {
-
-		}
-		return 0;
-	}
-
-	/** @brief It converts a container of strings in a container of floats
-	*/
-	static long double to_longdouble(const std::string &word) {
-		try
-		{
-			return std::stold(word);
-		}
-		catch (std::exception ex) {
-
-		}
-		return 0;
-	}
-
-	/** @brief It converts a container of strings in a container of floats
-	*/
-	static int to_int(const std::string &word) {
-		try
-		{
-			return std::stoi(word);
-		}
-		catch (std::exception ex) {
-
-		}
-		return 0;
-	}
 };
 
 
@@ -0,0 +1,130 @@
+/**
+* @file StringView.hpp
+* @brief Non-owning view of a sequence of chars.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.0.0
+*
+*/
+
+#ifndef CMNLIB_STRING_STRINGVIEW_HPP__
+#define CMNLIB_STRING_STRINGVIEW_HPP__
+
+#include <cstring>
+#include <ostream>
+#include <string>
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <string_view>
+#endif
+
+namespace CmnLib
+{
+namespace text
+{
+
+/** @brief Non-owning view of a sequence of chars.
+
+	Pointer and length of a part of a string which lives elsewhere (e.g. a
+	line or a file buffer). It does not allocate, and it is valid while the
+	viewed characters are. It is the C++14 counterpart of std::string_view,
+	and it converts to it when the library is compiled with C++17.
+*/
+class StringView
+{
+public:
+
+	static const size_t npos = (size_t)-1;
+
+	StringView() : data_(nullptr), size_(0) {}
+	StringView(const char* data, size_t size) : data_(data), size_(size) {}
+	StringView(const char* s) : data_(s), size_(s ? strlen(s) : 0) {}
+	StringView(const std::string &s) : data_(s.data()), size_(s.size()) {}
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+	StringView(std::string_view s) : data_(s.data()), size_(s.size()) {}
+	operator std::string_view() const { return std::string_view(data_, size_); }
+#endif
+
+	const char* data() const { return data_; }
+	size_t size() const { return size_; }
+	size_t length() const { return size_; }
+	bool empty() const { return size_ == 0; }
+	const char* begin() const { return data_; }
+	const char* end() const { return data_ + size_; }
+	char operator[](size_t i) const { return data_[i]; }
+	char front() const { return data_[0]; }
+	char back() const { return data_[size_ - 1]; }
+
+	/** @brief Copy of the viewed characters.
+	*/
+	std::string str() const { return std::string(data_, size_); }
+
+	/** @brief View of [pos, pos + n), clamped to the size.
+	*/
+	StringView substr(size_t pos, size_t n = npos) const {
+		if (pos > size_) pos = size_;
+		if (n > size_ - pos) n = size_ - pos;
+		return StringView(data_ + pos, n);
+	}
+
+	void remove_prefix(size_t n) {
+		data_ += n;
+		size_ -= n;
+	}
+	void remove_suffix(size_t n) { size_ -= n; }
+
+	/** @brief Position of the first c from pos, npos if not found.
+	*/
+	size_t find(char c, size_t pos = 0) const {
+		if (pos >= size_) return npos;
+		const void* p = memchr(data_ + pos, c, size_ - pos);
+		return p ? (size_t)((const char*)p - data_) : npos;
+	}
+
+	/** @brief View without the leading and trailing chars of chars.
+	*/
+	StringView trim(const char* chars = " \t\r\n") const {
+		size_t first = 0, last = size_;
+		while (first < last && strchr(chars, data_[first])) ++first;
+		while (last > first && strchr(chars, data_[last - 1])) --last;
+		return StringView(data_ + first, last - first);
+	}
+
+	bool starts_with(const StringView &s) const {
+		return size_ >= s.size_ && memcmp(data_, s.data_, s.size_) == 0;
+	}
+
+	bool operator==(const StringView &s) const {
+		return size_ == s.size_ && (size_ == 0 ||
+			memcmp(data_, s.data_, size_) == 0);
+	}
+	bool operator!=(const StringView &s) const { return !(*this == s); }
+
+private:
+
+	const char* data_;
+	size_t size_;
+};
+
+inline std::ostream& operator<<(std::ostream &os, const StringView &s)
+{
+	return os.write(s.data(), (std::streamsize)s.size());
+}
+
+}  // namespace text
+}  // namespace CmnLib
+
+#endif // CMNLIB_STRING_STRINGVIEW_HPP__
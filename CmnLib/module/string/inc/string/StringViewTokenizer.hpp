@@ -0,0 +1,150 @@
+/**
+* @file StringViewTokenizer.hpp
+* @brief Tokenizer which returns views of the input without allocating.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.0.0
+*
+*/
+
+#ifndef CMNLIB_STRING_STRINGVIEWTOKENIZER_HPP__
+#define CMNLIB_STRING_STRINGVIEWTOKENIZER_HPP__
+
+#include <string>
+
+#include "NumberConversion.hpp"
+#include "StringView.hpp"
+
+namespace CmnLib
+{
+namespace text
+{
+
+/** @brief Tokenizer which returns views of the input without allocating.
+
+	The tokenizer keeps a cursor in the input and every token is a
+	StringView of the input, so it must outlive the tokens. Any char of the
+	delimiter set ends a token.
+	@par
+	With skip_empty (default) the consecutive delimiters are collapsed and
+	only non-empty tokens are returned. Otherwise an empty token is returned
+	between two consecutive delimiters, as std::getline does (a trailing
+	delimiter does not produce a last empty token).
+	@code
+	StringViewTokenizer tok(line, " \t,");
+	double x, y, z;
+	if (tok.next_number(x) && tok.next_number(y) && tok.next_number(z)) ...
+	@endcode
+*/
+class StringViewTokenizer
+{
+public:
+
+	/** @brief Tokenize text with the chars of delimiters.
+	*/
+	explicit StringViewTokenizer(const StringView &text,
+		const StringView &delimiters = StringView(" \t\r\n"),
+		bool skip_empty = true) :
+		text_(text), pos_(0), skip_empty_(skip_empty)
+	{
+		set_delimiters(delimiters);
+	}
+
+	/** @brief Restart on a new text, with the same delimiters.
+	*/
+	void reset(const StringView &text) {
+		text_ = text;
+		pos_ = 0;
+	}
+
+	/** @brief Set the delimiter chars.
+	*/
+	void set_delimiters(const StringView &delimiters) {
+		for (int i = 0; i < 256; ++i) delimiter_[i] = false;
+		for (size_t i = 0; i < delimiters.size(); ++i) {
+			delimiter_[(unsigned char)delimiters[i]] = true;
+		}
+	}
+
+	bool is_delimiter(char c) const { return delimiter_[(unsigned char)c]; }
+
+	/** @brief Get the next token.
+		@return FALSE if there are no more tokens.
+	*/
+	bool next(StringView &token) {
+		const char* data = text_.data();
+		size_t size = text_.size();
+		if (skip_empty_) {
+			while (pos_ < size && is_delimiter(data[pos_])) ++pos_;
+		}
+		if (pos_ >= size) return false;
+		size_t first = pos_;
+		while (pos_ < size && !is_delimiter(data[pos_])) ++pos_;
+		token = StringView(data + first, pos_ - first);
+		// consume the delimiter which ends the token
+		if (pos_ < size) ++pos_;
+		return true;
+	}
+
+	/** @brief Get the next token converted to a number.
+		@return FALSE if there are no more tokens or the token is not a
+		        number of type T.
+	*/
+	template <typename T>
+	bool next_number(T &value) {
+		StringView token;
+		return next(token) && parse(token, value);
+	}
+
+	/** @brief Return TRUE if there is another token.
+	*/
+	bool has_next() {
+		if (skip_empty_) {
+			while (pos_ < text_.size() && is_delimiter(text_[pos_])) ++pos_;
+		}
+		return pos_ < text_.size();
+	}
+
+	/** @brief Position of the cursor and the text after it.
+	*/
+	size_t position() const { return pos_; }
+	StringView rest() const { return text_.substr(pos_); }
+
+	/** @brief Convert a token to a number. The whole token must be a
+		number within the range of T.
+	*/
+	template <typename T>
+	static bool parse(const StringView &token, T &value)
+	{
+		NumberConversion::ParseResult r = NumberConversion::parse(
+			token.begin(), token.end(), value);
+		return r.error == NumberConversion::CONVERSION_OK &&
+			r.ptr == token.end();
+	}
+
+private:
+
+	StringView text_;
+	size_t pos_;
+	bool skip_empty_;
+	bool delimiter_[256];
+};
+
+}  // namespace text
+}  // namespace CmnLib
+
+#endif // CMNLIB_STRING_STRINGVIEWTOKENIZER_HPP__
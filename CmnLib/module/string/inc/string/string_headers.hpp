@@ -24,6 +24,7 @@
 #ifndef CMNLIB_STRING_STRINGHEADERS_HPP__
 #define CMNLIB_STRING_STRINGHEADERS_HPP__
 
+#include "NumberConversion.hpp"
 #include "StringConversion.hpp"
 #include "StringFormatConversion.hpp"
 #include "StringTokenizer.hpp"
@@ -31,5 +32,7 @@
 #include "StringIterator.hpp"
 #include "StringOp.hpp"
 #include "StringTypeConversion.hpp"
+#include "StringView.hpp"
+#include "StringViewTokenizer.hpp"
 
 #endif // CMNLIB_STRING_STRINGHEADERS_HPP__
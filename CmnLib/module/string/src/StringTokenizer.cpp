@@ -23,8 +23,8 @@ namespace text
 stringTokenizer::stringTokenizer(std::string myMes, 
 	char myCh, bool retDel) 
 {
-	message.clear();
 	message = myMes;
+	pos = 0;
 	ch = myCh;
 	delRet = retDel;
 }
@@ -32,8 +32,8 @@ stringTokenizer::stringTokenizer(std::string myMes,
 stringTokenizer::stringTokenizer(std::string myMes, 
 	char myCh) 
 {
-	message.clear();
 	message = myMes;
+	pos = 0;
 	ch = myCh;
 	delRet = false;
 }
@@ -41,71 +41,45 @@ stringTokenizer::stringTokenizer(std::string myMes,
 //-----------------------------------------------------------------------------
 stringTokenizer::stringTokenizer(std::string myMes) 
 {
-	message.clear();
 	message = myMes;
+	pos = 0;
 	ch = ' ';
 	delRet = false;
 }
 //-----------------------------------------------------------------------------
 void stringTokenizer::setMessage(std::string newMessage) 
 {
-	message.clear();
 	message = newMessage;
+	pos = 0;
 }
 //-----------------------------------------------------------------------------
 std::string stringTokenizer::next()
 {
-	std::string word;
+	// The cursor moves on the message, which is never copied
 	if (!delRet) 
 	{
 		processBlanks();
-		int pos = (int)message.find(ch);
-		if (pos != (int)std::string::npos) 
-		{
-			word = message.substr(0, pos);
-			message = message.substr(pos);
-		}
-		else 
-		{
-			word = message;
-			message = "";
-		}
 	}
-	else
+	else if (pos < message.length() && message[pos] == ch) 
 	{
-		if (message[0] == ch) 
-		{
-			word = message.substr(0, 1);
-			message = message.substr(1);
-		}
-		else
-		{
-			int pos = (int)message.find(ch);
-			if (pos != (int)std::string::npos) 
-			{
-				word = message.substr(0, pos);
-				message = message.substr(pos);
-			}
-			else 
-			{
-				word = message;
-				message = "";
-			}
-		}
+		++pos;
+		return std::string(1, ch);
 	}
-	return word;
+	size_t first = pos;
+	pos = message.find(ch, pos);
+	if (pos == std::string::npos) pos = message.length();
+	return message.substr(first, pos - first);
 }
 //-----------------------------------------------------------------------------
 bool stringTokenizer::hasNext() const
 {
-	//cout << "lenght: " << message.length() << endl;
-	return message.length() > 0;
+	return pos < message.length();
 }
 //-----------------------------------------------------------------------------
 void stringTokenizer::processBlanks() 
 {
-	while (message.length() > 0 && message[0] == ch)
-		message = message.substr(1);
+	while (pos < message.length() && message[pos] == ch)
+		++pos;
 	return;
 }
 //-----------------------------------------------------------------------------
@@ -0,0 +1,158 @@
+/* @file buffered_file.hpp
+ * @brief Output file with a large user-space buffer.
+ *
+ * @section LICENSE
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+ * @bug No known bugs.
+ * @version 1.1.1.0
+ *
+ */
+
+#ifndef CMNLIB_SYSTEM_BUFFEREDFILE_HPP__
+#define CMNLIB_SYSTEM_BUFFEREDFILE_HPP__
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace CmnLib
+{
+namespace system
+{
+
+/** Output file with a large user-space buffer.
+	@remarks
+		The bytes are collected in a buffer of some MB and written with one
+		call when it is full: nothing is flushed line by line. With
+		background, a thread writes a full buffer while the caller fills the
+		other one (double buffering). With sync, close waits until the data
+		is on the disk (fsync).
+	@par
+		The text can be formatted in place: reserve returns room for n bytes
+		in the buffer and commit moves the end of the data.
+	@par
+		When the file is not open the bytes are written in a scratch buffer
+		and dropped, and good() is false.
+	@code
+		CmnLib::system::BufferedFile file;
+		if (file.open("points.txt")) {
+			file.write("x y z\n", 6);
+			...
+			if (!file.close()) error();
+		}
+	@endcode
+*/
+class BufferedFile
+{
+public:
+
+	BufferedFile();
+
+	/** @brief Close the file.
+	*/
+	~BufferedFile();
+
+	/** @brief Create (or append to) the file.
+		@param buffer_size Bytes written with one call.
+		@param background Write the full buffers in a thread.
+		@param sync Wait for the disk at close.
+		@return False if the file cannot be opened.
+	*/
+	bool open(const std::string &filename, bool append = false,
+		size_t buffer_size = (size_t)4 << 20, bool background = false,
+		bool sync = false);
+
+	/** @brief Write the buffered bytes and close the file.
+		@return False if a write failed (the disk is full, ...).
+	*/
+	bool close();
+
+	bool is_open() const { return file_ != nullptr; }
+
+	/** @brief False after a failed write.
+	*/
+	bool good() const;
+
+	void write(const char* data, size_t size);
+
+	void put(char c) {
+		if (pos_ == end_) flush_buffer();
+		*pos_++ = c;
+	}
+
+	/** @brief Room for n bytes (not more than the buffer size) at the end
+		of the buffered data.
+	*/
+	char* reserve(size_t n) {
+		if ((size_t)(end_ - pos_) < n) {
+			if (file_) flush_buffer();
+			else discard(n);
+		}
+		return pos_;
+	}
+
+	/** @brief The data ends at p (in the room given by reserve).
+	*/
+	void commit(char* p) { pos_ = p; }
+
+	/** @brief Pass the buffered bytes to the OS (not synced).
+	*/
+	void flush();
+
+private:
+
+	/** @brief Write the buffer, or give it to the thread and fill the
+		other one.
+	*/
+	void flush_buffer();
+
+	/** @brief Drop the buffered bytes of a file which is not open and give
+		room for at least n bytes.
+	*/
+	void discard(size_t n);
+	void wait_pending();
+	void write_file(const char* data, size_t size);
+	void writer_loop();
+
+	FILE* file_;
+	std::vector<char> buffers_[2];
+	int current_;
+	char* begin_;
+	char* pos_;
+	char* end_;
+	bool sync_;
+	bool error_;
+
+	// Background writes
+	std::thread thread_;
+	mutable std::mutex mutex_;
+	std::condition_variable cv_;
+	const char* pending_data_;
+	size_t pending_size_;
+	bool stop_;
+
+	// No copying allowed
+	BufferedFile(const BufferedFile&);
+	void operator=(const BufferedFile&);
+};
+
+}   // namespace system
+}	// namespace CmnLib
+
+#endif /* CMNLIB_SYSTEM_BUFFEREDFILE_HPP__ */
@@ -0,0 +1,96 @@
+/* @file mapped_file.hpp
+ * @brief Read-only memory mapping of a file.
+ *
+ * @section LICENSE
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+ * @bug No known bugs.
+ * @version 1.1.1.0
+ *
+ */
+
+#ifndef CMNLIB_SYSTEM_MAPPEDFILE_HPP__
+#define CMNLIB_SYSTEM_MAPPEDFILE_HPP__
+
+#include <cstddef>
+#include <string>
+
+namespace CmnLib
+{
+namespace system
+{
+
+/** Read-only memory mapping of a whole file.
+	@remarks
+		The pages are loaded by the OS when they are read, and shared with
+		the page cache: the parsers read the file in place, without copies
+		or line buffers. The file must not be modified while it is mapped.
+	@code
+		CmnLib::system::MappedFile file;
+		if (file.open("points.txt")) {
+			const char* first = file.data();
+			const char* last = first + file.size();
+			...
+		}
+	@endcode
+*/
+class MappedFile
+{
+public:
+
+	MappedFile();
+
+	/** @brief Unmap the file.
+	*/
+	~MappedFile();
+
+	/** @brief Map the file.
+		@param sequential Hint for a read from the beginning to the end.
+		@return False if the file cannot be opened or mapped.
+	*/
+	bool open(const std::string &filename, bool sequential = true);
+
+	/** @brief Unmap the file.
+	*/
+	void close();
+
+	bool is_open() const { return is_open_; }
+
+	/** @brief The first byte of the file (null for an empty file).
+	*/
+	const char* data() const { return data_; }
+
+	/** @brief The size of the file in bytes.
+	*/
+	size_t size() const { return size_; }
+
+private:
+
+	const char* data_;
+	size_t size_;
+	bool is_open_;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+	void* file_;
+	void* mapping_;
+#endif
+
+	// No copying allowed
+	MappedFile(const MappedFile&);
+	void operator=(const MappedFile&);
+};
+
+}   // namespace system
+}	// namespace CmnLib
+
+#endif /* CMNLIB_SYSTEM_MAPPEDFILE_HPP__ */
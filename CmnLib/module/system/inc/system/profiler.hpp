@@ -0,0 +1,169 @@
+/* @file profiler.hpp
+ * @brief Scoped timers and the aggregation of their measures.
+ *
+ * @section LICENSE
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF 
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ * @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+ * @bug No known bugs.
+ * @version 1.1.1.0
+ * 
+ */
+
+#ifndef CMNLIB_SYSTEM_PROFILER_HPP__
+#define CMNLIB_SYSTEM_PROFILER_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "time.hpp"
+
+namespace CmnLib
+{
+namespace system
+{
+
+/** Measures of all the zones with the same name.
+	The times are in nanoseconds. The self time does not count the zones
+	opened inside the zone (its children).
+*/
+struct ProfileZoneStats
+{
+	std::string name;
+	uint64_t count;
+	uint64_t total_ns;
+	uint64_t self_ns;
+	uint64_t min_ns;
+	uint64_t max_ns;
+	uint64_t p50_ns;
+	uint64_t p90_ns;
+	uint64_t p99_ns;
+};
+
+/** Collector of the zones measured by ScopedTimer.
+	@remarks
+		Every thread keeps the stack of its open zones, so a zone knows its
+		parent, and writes the zones in its own buffer without locks (at
+		most max_events per thread, the others are counted as dropped);
+		the buffers are kept after the end of the thread until Reset. The
+		collection is disabled by default.
+*/
+class Profiler
+{
+public:
+
+	/** @brief Start or stop the collection of the zones.
+	*/
+	static void Enable(bool enable);
+	static bool IsEnabled() {
+		return enabled_.load(std::memory_order_relaxed);
+	}
+
+	/** @brief Maximum number of zones stored per thread.
+		@remarks
+			The buffer of a thread is sized when the thread opens its first
+			zone (at least 2^20 zones), a larger value applies to the
+			threads which start later.
+	*/
+	static void SetMaxEvents(size_t max_events);
+
+	/** @brief Remove the collected zones.
+	*/
+	static void Reset();
+
+	/** @brief Number of zones not stored because a buffer was full.
+	*/
+	static uint64_t DroppedEvents();
+
+	/** @brief Aggregate the zones by name, sorted by total time.
+	*/
+	static std::vector<ProfileZoneStats> GetStats();
+
+	/** @brief Write the aggregated measures as a table.
+	*/
+	static void WriteReport(std::ostream &out);
+
+	/** @brief Write the zones in the Chrome trace event format (to open in
+		chrome://tracing or Perfetto).
+		@return True if the file was written.
+	*/
+	static bool WriteChromeTrace(const std::string &filename);
+	static void WriteChromeTrace(std::ostream &out);
+
+	/** @brief Open a zone of the calling thread and start its time (used
+		by ScopedTimer). The parent is the last zone still open.
+		@return The zone to close with End.
+	*/
+	static uint64_t Begin(const char* name);
+
+	/** @brief Close the last zone opened by the calling thread.
+	*/
+	static void End(uint64_t zone);
+
+private:
+
+	static std::atomic<bool> enabled_;
+};
+
+/** Measure the time between its construction and its destruction.
+	@remarks
+		The name must have a static storage (e.g. a string literal), only
+		its pointer is stored. Nothing is measured if the Profiler is
+		disabled when the zone is opened.
+*/
+class ScopedTimer
+{
+public:
+
+	explicit ScopedTimer(const char* name) : zone_(0), active_(false) {
+		if (Profiler::IsEnabled()) {
+			zone_ = Profiler::Begin(name);
+			active_ = true;
+		}
+	}
+
+	~ScopedTimer() {
+		if (active_) Profiler::End(zone_);
+	}
+
+private:
+
+	uint64_t zone_;
+	bool active_;
+
+	// No copying allowed
+	ScopedTimer(const ScopedTimer&);
+	void operator=(const ScopedTimer&);
+};
+
+}   // namespace system
+}	// namespace CmnLib
+
+#define CL_PROFILE_CONCAT2__(a, b) a##b
+#define CL_PROFILE_CONCAT__(a, b) CL_PROFILE_CONCAT2__(a, b)
+
+/** Measure the enclosing scope as a zone with a static name.
+*/
+#define CL_PROFILE_ZONE(name) \
+	CmnLib::system::ScopedTimer CL_PROFILE_CONCAT__(cl_profile_zone__, \
+		__LINE__)(name)
+
+/** Measure the enclosing function.
+*/
+#define CL_PROFILE_FUNCTION() CL_PROFILE_ZONE(__FUNCTION__)
+
+#endif /* CMNLIB_SYSTEM_PROFILER_HPP__ */
@@ -24,8 +24,12 @@
 #ifndef CMNLIB_SYSTEM_SYSTEMHEADERS_HPP__
 #define CMNLIB_SYSTEM_SYSTEMHEADERS_HPP__
 
+#include "buffered_file.hpp"
 #include "console_text.hpp"
 #include "time.hpp"
 #include "environment.hpp"
+#include "mapped_file.hpp"
+#include "profiler.hpp"
+#include "thread_pool.hpp"
 
 #endif /* CMNLIB_SYSTEM_SYSTEMHEADERS_HPP__ */
@@ -0,0 +1,250 @@
+/* @file thread_pool.hpp
+ * @brief Work-stealing thread pool and parallel loops.
+ *
+ * @section LICENSE
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+ * @bug No known bugs.
+ * @version 1.1.1.0
+ *
+ */
+
+#ifndef CMNLIB_SYSTEM_THREADPOOL_HPP__
+#define CMNLIB_SYSTEM_THREADPOOL_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CmnLib
+{
+namespace system
+{
+
+class TaskGroup;
+
+/** Pool of worker threads with work stealing.
+	@remarks
+		Every worker has its own deque: it pushes and pops its tasks at the
+		back (the most recent, still in cache) and the idle workers steal
+		from the front (the oldest, usually the largest part of a split
+		range). The tasks submitted by the other threads go to a shared
+		queue. A thread waiting for a TaskGroup runs the pending tasks
+		instead of blocking, so the parallel loops can be nested.
+	@par
+		Instance() is the pool shared by all the libraries, with one worker
+		less than the hardware threads (the calling thread works too).
+*/
+class ThreadPool
+{
+public:
+
+	/** @brief Start num_workers threads (hardware threads - 1 if 0).
+	*/
+	explicit ThreadPool(size_t num_workers = 0);
+
+	/** @brief Run the queued tasks and stop the workers.
+	*/
+	~ThreadPool();
+
+	/** @brief The pool shared by all the libraries.
+	*/
+	static ThreadPool& Instance();
+
+	/** @brief Number of worker threads.
+	*/
+	size_t size() const { return workers_.size(); }
+
+	/** @brief Run one queued task in the calling thread.
+		@return False if no task was found.
+	*/
+	bool RunOneTask();
+
+private:
+
+	friend class TaskGroup;
+
+	struct Task
+	{
+		std::function<void()> func;
+		TaskGroup* group;
+	};
+
+	struct Worker
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+		std::thread thread;
+		char pad[64];	// no false sharing between the deques
+	};
+
+	/** @brief Queue a task: in the deque of the calling worker, or in the
+		shared queue.
+	*/
+	void Submit(Task &&task);
+	bool PopTask(Task &task);
+	void Execute(Task &task);
+	void WorkerLoop(size_t index);
+	/** @brief Index of the calling thread in this pool, -1 if it is not a
+		worker.
+	*/
+	ptrdiff_t WorkerIndex() const;
+
+	std::vector<Worker*> workers_;
+	std::mutex shared_mutex_;
+	std::deque<Task> shared_tasks_;
+
+	// Sleeping workers
+	std::atomic<size_t> num_tasks_;
+	std::atomic<int> num_idle_;
+	std::atomic<bool> stop_;
+	std::mutex idle_mutex_;
+	std::condition_variable idle_cv_;
+
+	// No copying allowed
+	ThreadPool(const ThreadPool&);
+	void operator=(const ThreadPool&);
+};
+
+/** Set of tasks to wait for.
+	@remarks
+		The first exception thrown by a task is rethrown by wait.
+	@code
+		CmnLib::system::TaskGroup group;
+		group.run([&]() { left = solve(a); });
+		group.run([&]() { right = solve(b); });
+		group.wait();
+	@endcode
+*/
+class TaskGroup
+{
+public:
+
+	explicit TaskGroup(ThreadPool &pool = ThreadPool::Instance())
+		: pool_(pool), pending_(0) {}
+
+	/** @brief Wait for the tasks still running.
+	*/
+	~TaskGroup();
+
+	/** @brief Queue a task.
+	*/
+	void run(std::function<void()> func);
+
+	/** @brief Run the queued tasks until all the tasks of the group are
+		done.
+	*/
+	void wait();
+
+	ThreadPool& pool() { return pool_; }
+
+private:
+
+	friend class ThreadPool;
+
+	/** @brief Called by the pool when a task is done.
+	*/
+	void Done(std::exception_ptr error);
+
+	ThreadPool &pool_;
+	std::atomic<size_t> pending_;
+	std::mutex mutex_;
+	std::condition_variable done_cv_;
+	std::exception_ptr error_;
+
+	// No copying allowed
+	TaskGroup(const TaskGroup&);
+	void operator=(const TaskGroup&);
+};
+
+namespace detail
+{
+
+/** @brief Split [begin, end) in halves, queue the right halves and run the
+	left one, until the ranges are not larger than grain.
+*/
+template <typename Function>
+void split_range(TaskGroup &group, size_t begin, size_t end, size_t grain,
+	const Function &func) {
+	while (end - begin > grain) {
+		size_t middle = begin + (end - begin) / 2;
+		group.run([&group, middle, end, grain, &func]() {
+			split_range(group, middle, end, grain, func);
+		});
+		end = middle;
+	}
+	func(begin, end);
+}
+
+}  // namespace detail
+
+/** @brief Call func(range_begin, range_end) on subranges of [begin, end) of
+	at most grain elements, in parallel. A grain of 0 gives about 8 ranges
+	per thread.
+*/
+template <typename Function>
+void parallel_for(size_t begin, size_t end, size_t grain, const Function &func,
+	ThreadPool &pool = ThreadPool::Instance()) {
+	if (end <= begin) return;
+	if (grain == 0) {
+		grain = std::max<size_t>(1, (end - begin) / (8 * (pool.size() + 1)));
+	}
+	if (end - begin <= grain || pool.size() == 0) {
+		func(begin, end);
+		return;
+	}
+	TaskGroup group(pool);
+	detail::split_range(group, begin, end, grain, func);
+	group.wait();
+}
+
+/** @brief Reduce [begin, end) in parallel: every range of grain elements
+	is mapped by map(range_begin, range_end, identity) and the results are
+	combined by reduce in the order of the ranges, so the result does not
+	depend on the scheduling.
+*/
+template <typename T, typename Map, typename Reduce>
+T parallel_reduce(size_t begin, size_t end, size_t grain, const T &identity,
+	const Map &map, const Reduce &reduce,
+	ThreadPool &pool = ThreadPool::Instance()) {
+	if (end <= begin) return identity;
+	if (grain == 0) {
+		grain = std::max<size_t>(1, (end - begin) / (8 * (pool.size() + 1)));
+	}
+	size_t num_ranges = (end - begin + grain - 1) / grain;
+	std::vector<T> partial(num_ranges, identity);
+	parallel_for(0, num_ranges, 1, [&](size_t first, size_t last) {
+		for (size_t r = first; r < last; ++r) {
+			size_t b = begin + r * grain;
+			partial[r] = map(b, std::min(end, b + grain), identity);
+		}
+	}, pool);
+	T result = identity;
+	for (size_t r = 0; r < num_ranges; ++r) {
+		result = reduce(result, partial[r]);
+	}
+	return result;
+}
+
+}   // namespace system
+}	// namespace CmnLib
+
+#endif /* CMNLIB_SYSTEM_THREADPOOL_HPP__ */
@@ -23,6 +23,7 @@
 #ifndef CMNLIB_SYSTEM_TIME_HPP__
 #define CMNLIB_SYSTEM_TIME_HPP__
 
+#include <cstdint>
 #include <ctime>
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
@@ -56,6 +57,11 @@ public:
 	@return Return the current time in milliseconds.
 	*/
 	static double gettime();
+
+	/** Get the time of a monotonic clock (std::chrono::steady_clock).
+	@return Return the current time in nanoseconds.
+	*/
+	static uint64_t now_ns();
 };
 
 
@@ -0,0 +1,209 @@
+/* @file buffered_file.cpp
+ * @brief Body of the output file with a large user-space buffer.
+ *
+ * @section LICENSE
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+ * @bug No known bugs.
+ * @version 1.1.1.0
+ *
+ */
+
+#include "system/inc/system/buffered_file.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace CmnLib
+{
+namespace system
+{
+
+//-----------------------------------------------------------------------------
+BufferedFile::BufferedFile()
+	: file_(nullptr), current_(0), begin_(nullptr), pos_(nullptr),
+	end_(nullptr), sync_(false), error_(false), pending_data_(nullptr),
+	pending_size_(0), stop_(false)
+{
+}
+//-----------------------------------------------------------------------------
+BufferedFile::~BufferedFile()
+{
+	close();
+}
+//-----------------------------------------------------------------------------
+bool BufferedFile::open(const std::string &filename, bool append,
+	size_t buffer_size, bool background, bool sync)
+{
+	close();
+	FILE* file = fopen(filename.c_str(), append ? "ab" : "wb");
+	if (!file) return false;
+	// The buffer is ours
+	setvbuf(file, nullptr, _IONBF, 0);
+	file_ = file;
+	buffer_size = std::max<size_t>(buffer_size, 256);
+	buffers_[0].resize(buffer_size);
+	if (background) buffers_[1].resize(buffer_size);
+	current_ = 0;
+	begin_ = pos_ = buffers_[0].data();
+	end_ = begin_ + buffer_size;
+	sync_ = sync;
+	error_ = false;
+	pending_data_ = nullptr;
+	pending_size_ = 0;
+	stop_ = false;
+	if (background) thread_ = std::thread(&BufferedFile::writer_loop, this);
+	return true;
+}
+//-----------------------------------------------------------------------------
+bool BufferedFile::close()
+{
+	if (!file_) return false;
+	flush_buffer();
+	if (thread_.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		cv_.notify_all();
+		thread_.join();
+	}
+	bool ok = !error_ && fflush(file_) == 0;
+	if (ok && sync_)
+	{
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+		ok = _commit(_fileno(file_)) == 0;
+#else
+		ok = fsync(fileno(file_)) == 0;
+#endif
+	}
+	if (fclose(file_) != 0) ok = false;
+	file_ = nullptr;
+	for (int i = 0; i < 2; ++i)
+	{
+		std::vector<char>().swap(buffers_[i]);
+	}
+	begin_ = pos_ = end_ = nullptr;
+	return ok;
+}
+//-----------------------------------------------------------------------------
+bool BufferedFile::good() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return file_ != nullptr && !error_;
+}
+//-----------------------------------------------------------------------------
+void BufferedFile::write(const char* data, size_t size)
+{
+	while (size > 0)
+	{
+		if (pos_ == end_) flush_buffer();
+		size_t n = std::min(size, (size_t)(end_ - pos_));
+		memcpy(pos_, data, n);
+		pos_ += n;
+		data += n;
+		size -= n;
+	}
+}
+//-----------------------------------------------------------------------------
+void BufferedFile::flush()
+{
+	if (!file_) return;
+	flush_buffer();
+	wait_pending();
+	fflush(file_);
+}
+//-----------------------------------------------------------------------------
+void BufferedFile::flush_buffer()
+{
+	if (!file_)
+	{
+		discard(0);
+		return;
+	}
+	size_t size = pos_ - begin_;
+	if (size == 0) return;
+	if (!thread_.joinable())
+	{
+		write_file(begin_, size);
+		pos_ = begin_;
+		return;
+	}
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		cv_.wait(lock, [this]() { return pending_data_ == nullptr; });
+		pending_data_ = begin_;
+		pending_size_ = size;
+	}
+	cv_.notify_all();
+	current_ ^= 1;
+	begin_ = pos_ = buffers_[current_].data();
+	end_ = begin_ + buffers_[current_].size();
+}
+//-----------------------------------------------------------------------------
+void BufferedFile::discard(size_t n)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		error_ = true;
+	}
+	n = std::max<size_t>(n, 256);
+	if (buffers_[0].size() < n) buffers_[0].resize(n);
+	begin_ = pos_ = buffers_[0].data();
+	end_ = begin_ + buffers_[0].size();
+}
+//-----------------------------------------------------------------------------
+void BufferedFile::wait_pending()
+{
+	if (!thread_.joinable()) return;
+	std::unique_lock<std::mutex> lock(mutex_);
+	cv_.wait(lock, [this]() { return pending_data_ == nullptr; });
+}
+//-----------------------------------------------------------------------------
+void BufferedFile::write_file(const char* data, size_t size)
+{
+	if (fwrite(data, 1, size, file_) != size)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		error_ = true;
+	}
+}
+//-----------------------------------------------------------------------------
+void BufferedFile::writer_loop()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	for (;;)
+	{
+		cv_.wait(lock, [this]() { return pending_data_ != nullptr || stop_; });
+		if (!pending_data_) break;
+		const char* data = pending_data_;
+		size_t size = pending_size_;
+		lock.unlock();
+		write_file(data, size);
+		lock.lock();
+		pending_data_ = nullptr;
+		cv_.notify_all();
+	}
+}
+//-----------------------------------------------------------------------------
+
+}   // namespace system
+}	// namespace CmnLib
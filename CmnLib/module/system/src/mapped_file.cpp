@@ -0,0 +1,133 @@
+/* @file mapped_file.cpp
+ * @brief Body of the read-only memory mapping of a file.
+ *
+ * @section LICENSE
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF 
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ * @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+ * @bug No known bugs.
+ * @version 1.1.1.0
+ * 
+ */
+
+#include "system/inc/system/mapped_file.hpp"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace CmnLib
+{
+namespace system
+{
+
+//-----------------------------------------------------------------------------
+MappedFile::MappedFile()
+	: data_(nullptr), size_(0), is_open_(false)
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+	, file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+#endif
+{
+}
+//-----------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+	close();
+}
+//-----------------------------------------------------------------------------
+bool MappedFile::open(const std::string &filename, bool sequential)
+{
+	close();
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+		NULL, OPEN_EXISTING, sequential ? FILE_FLAG_SEQUENTIAL_SCAN :
+		FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER li;
+	if (!GetFileSizeEx(file, &li))
+	{
+		CloseHandle(file);
+		return false;
+	}
+	file_ = file;
+	size_ = (size_t)li.QuadPart;
+	is_open_ = true;
+	// An empty file cannot be mapped
+	if (size_ == 0) return true;
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mapping)
+	{
+		close();
+		return false;
+	}
+	mapping_ = mapping;
+	data_ = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size_);
+	if (!data_)
+	{
+		close();
+		return false;
+	}
+#else
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+	size_ = (size_t)st.st_size;
+	is_open_ = true;
+	if (size_ > 0)
+	{
+		void* data = mmap(0, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED)
+		{
+			::close(fd);
+			size_ = 0;
+			is_open_ = false;
+			return false;
+		}
+		if (sequential) madvise(data, size_, MADV_SEQUENTIAL);
+		data_ = (const char*)data;
+	}
+	// The mapping keeps the file
+	::close(fd);
+#endif
+	return true;
+}
+//-----------------------------------------------------------------------------
+void MappedFile::close()
+{
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__) || defined(_WIN64)
+	if (data_) UnmapViewOfFile(data_);
+	if (mapping_) CloseHandle((HANDLE)mapping_);
+	if (file_ != INVALID_HANDLE_VALUE) CloseHandle((HANDLE)file_);
+	file_ = INVALID_HANDLE_VALUE;
+	mapping_ = nullptr;
+#else
+	if (data_) munmap((void*)data_, size_);
+#endif
+	data_ = nullptr;
+	size_ = 0;
+	is_open_ = false;
+}
+//-----------------------------------------------------------------------------
+
+}   // namespace system
+}	// namespace CmnLib
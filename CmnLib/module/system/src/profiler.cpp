@@ -0,0 +1,413 @@
+/* @file profiler.cpp
+ * @brief Body of the scoped timers and of the aggregation of their measures.
+ *
+ * @section LICENSE
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF 
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ * @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+ * @bug No known bugs.
+ * @version 1.1.1.0
+ * 
+ */
+
+#include "system/inc/system/profiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "string/inc/string/NumberConversion.hpp"
+
+namespace CmnLib
+{
+namespace system
+{
+
+namespace
+{
+
+/** Zone without an event (dropped, or no parent).
+*/
+const uint64_t kNoEvent = ~(uint64_t)0;
+
+/** Duration of a zone still open.
+*/
+const uint64_t kOpen = ~(uint64_t)0;
+
+const size_t kBlockSize = 4096;
+const size_t kDefaultMaxEvents = (size_t)1 << 20;
+
+/** Zone measured by a thread.
+*/
+struct ProfileEvent
+{
+	const char* name;
+	uint64_t start_ns;
+	std::atomic<uint64_t> duration_ns;
+	uint64_t parent;
+};
+
+struct EventBlock
+{
+	ProfileEvent events[kBlockSize];
+};
+
+/** Zones of a thread, in a ring of blocks allocated when first used.
+	The capacity is a power of two, at least the default maximum.
+	@remarks
+		Only the thread writes the events and count, the readers (under
+		the registry mutex) read the events in [begin, count). Reset moves
+		begin to count; a slot is written again only after capacity newer
+		events, so it is never read and written at the same time. When all
+		the events were reset and no zone is open, the thread starts again
+		from the first slot (base), which is still in the cache.
+*/
+struct ThreadEvents
+{
+	uint32_t tid;
+	size_t capacity;
+	std::vector< std::unique_ptr<EventBlock> > blocks;
+	std::atomic<uint64_t> count;
+	std::atomic<uint64_t> begin;
+	std::atomic<uint64_t> base;
+	std::atomic<uint64_t> dropped;
+	// Open zones, used only by the thread
+	std::vector<uint64_t> stack;
+
+	explicit ThreadEvents(size_t max_events) : tid(0),
+		capacity(kDefaultMaxEvents), count(0), begin(0), base(0),
+		dropped(0) {
+		while (capacity < max_events) capacity *= 2;
+		blocks.resize(capacity / kBlockSize);
+		stack.reserve(64);
+	}
+
+	/** Slot of the event index, allocated by the thread if needed.
+	*/
+	ProfileEvent& slot(uint64_t index) {
+		size_t i = (size_t)(index - base.load(std::memory_order_relaxed)) &
+			(capacity - 1);
+		std::unique_ptr<EventBlock> &block = blocks[i / kBlockSize];
+		if (!block) block.reset(new EventBlock());
+		return block->events[i % kBlockSize];
+	}
+
+	/** Event index in [begin, count), for the readers (base read after
+		count).
+	*/
+	const ProfileEvent& at(uint64_t index, uint64_t base_index) const {
+		size_t i = (size_t)(index - base_index) & (capacity - 1);
+		return blocks[i / kBlockSize]->events[i % kBlockSize];
+	}
+};
+
+/** Buffers of all the threads.
+*/
+struct Registry
+{
+	std::mutex mutex;
+	std::vector< std::shared_ptr<ThreadEvents> > threads;
+	std::atomic<size_t> max_events;
+	uint64_t origin_ns;
+
+	Registry() : max_events(kDefaultMaxEvents),
+		origin_ns(TimeManager::now_ns()) {}
+};
+
+Registry& registry() {
+	static Registry r;
+	return r;
+}
+
+ThreadEvents& thread_events() {
+	// The registry owns the buffer, it is kept after the end of the thread
+	thread_local ThreadEvents* events = 0;
+	if (!events) {
+		Registry &r = registry();
+		std::shared_ptr<ThreadEvents> t =
+			std::make_shared<ThreadEvents>(r.max_events.load());
+		std::lock_guard<std::mutex> lock(r.mutex);
+		t->tid = (uint32_t)r.threads.size();
+		r.threads.push_back(t);
+		events = t.get();
+	}
+	return *events;
+}
+
+/** Closed zones of a thread since the last Reset, with the time of their
+	children. Called under the registry mutex.
+*/
+void closed_events(ThreadEvents &t,
+	std::vector<const ProfileEvent*> &events,
+	std::vector<uint64_t> &durations, std::vector<uint64_t> &children_ns) {
+	uint64_t begin = t.begin.load();
+	uint64_t count = t.count.load(std::memory_order_acquire);
+	uint64_t base = t.base.load(std::memory_order_relaxed);
+	size_t n = (size_t)(count - begin);
+	events.assign(n, 0);
+	durations.assign(n, 0);
+	children_ns.assign(n, 0);
+	for (size_t i = 0; i < n; ++i) {
+		const ProfileEvent &e = t.at(begin + i, base);
+		uint64_t d = e.duration_ns.load(std::memory_order_acquire);
+		if (d == kOpen) continue;
+		events[i] = &e;
+		durations[i] = d;
+		if (e.parent != kNoEvent && e.parent >= begin) {
+			children_ns[(size_t)(e.parent - begin)] += d;
+		}
+	}
+}
+
+/** @brief Write ns as microseconds with 3 decimals, without the locale.
+*/
+void write_us(std::ostream &out, uint64_t ns, bool negative) {
+	char buf[32];
+	char* p = buf;
+	if (negative) *p++ = '-';
+	p = text::NumberConversion::format(p, buf + sizeof(buf), ns / 1000).ptr;
+	uint64_t frac = ns % 1000;
+	*p++ = '.';
+	*p++ = (char)('0' + frac / 100);
+	*p++ = (char)('0' + frac / 10 % 10);
+	*p++ = (char)('0' + frac % 10);
+	out.write(buf, p - buf);
+}
+
+/** @brief Value at the percentile p of sorted values (nearest rank).
+*/
+uint64_t percentile(const std::vector<uint64_t> &sorted, double p) {
+	size_t rank = (size_t)(p * (double)sorted.size() + 0.999999);
+	if (rank < 1) rank = 1;
+	if (rank > sorted.size()) rank = sorted.size();
+	return sorted[rank - 1];
+}
+
+/** @brief Write a string as a JSON string.
+*/
+void write_json_string(std::ostream &out, const char* s) {
+	out << '"';
+	for (; *s; ++s) {
+		unsigned char c = (unsigned char)*s;
+		if (c == '"' || c == '\\') {
+			out << '\\' << (char)c;
+		} else if (c < 0x20) {
+			char buf[8];
+			snprintf(buf, sizeof(buf), "\\u%04x", c);
+			out << buf;
+		} else {
+			out << (char)c;
+		}
+	}
+	out << '"';
+}
+
+}  // namespace anonymous
+
+std::atomic<bool> Profiler::enabled_(false);
+
+//-----------------------------------------------------------------------------
+void Profiler::Enable(bool enable)
+{
+	registry();
+	enabled_.store(enable);
+}
+//-----------------------------------------------------------------------------
+void Profiler::SetMaxEvents(size_t max_events)
+{
+	registry().max_events.store(max_events);
+}
+//-----------------------------------------------------------------------------
+void Profiler::Reset()
+{
+	Registry &r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	for (auto &t : r.threads) {
+		t->begin.store(t->count.load(std::memory_order_acquire));
+		t->dropped.store(0);
+	}
+	r.origin_ns = TimeManager::now_ns();
+}
+//-----------------------------------------------------------------------------
+uint64_t Profiler::DroppedEvents()
+{
+	Registry &r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	uint64_t dropped = 0;
+	for (auto &t : r.threads) dropped += t->dropped.load();
+	return dropped;
+}
+//-----------------------------------------------------------------------------
+uint64_t Profiler::Begin(const char* name)
+{
+	ThreadEvents &t = thread_events();
+	uint64_t parent = t.stack.empty() ? kNoEvent : t.stack.back();
+	uint64_t count = t.count.load(std::memory_order_relaxed);
+	size_t max_events = std::min(t.capacity,
+		registry().max_events.load(std::memory_order_relaxed));
+	// acquire: the reads of the reset events happen before the new writes
+	uint64_t begin = t.begin.load(std::memory_order_acquire);
+	if (begin == count && t.stack.empty()) {
+		t.base.store(count, std::memory_order_relaxed);
+	}
+	if (count - begin >= max_events) {
+		t.dropped.fetch_add(1, std::memory_order_relaxed);
+		// the children of a dropped zone belong to its parent
+		t.stack.push_back(parent);
+		return kNoEvent;
+	}
+	ProfileEvent &e = t.slot(count);
+	e.name = name;
+	e.parent = parent;
+	e.duration_ns.store(kOpen, std::memory_order_relaxed);
+	t.stack.push_back(count);
+	e.start_ns = TimeManager::now_ns();
+	t.count.store(count + 1, std::memory_order_release);
+	return count;
+}
+//-----------------------------------------------------------------------------
+void Profiler::End(uint64_t zone)
+{
+	uint64_t end = TimeManager::now_ns();
+	ThreadEvents &t = thread_events();
+	if (!t.stack.empty()) t.stack.pop_back();
+	// the slot is still the one of the zone if it was not written again
+	if (zone == kNoEvent ||
+		t.count.load(std::memory_order_relaxed) - zone > t.capacity) return;
+	ProfileEvent &e = t.slot(zone);
+	e.duration_ns.store(end - e.start_ns, std::memory_order_release);
+}
+//-----------------------------------------------------------------------------
+std::vector<ProfileZoneStats> Profiler::GetStats()
+{
+	// The zones with the same name from different translation units can
+	// have different pointers, they are grouped by string.
+	std::map< std::string, std::vector<uint64_t> > durations;
+	std::map< std::string, uint64_t > self_ns;
+	{
+		Registry &r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		std::vector<const ProfileEvent*> events;
+		std::vector<uint64_t> d, children_ns;
+		for (auto &t : r.threads) {
+			closed_events(*t, events, d, children_ns);
+			const char* last_name = 0;
+			std::vector<uint64_t>* last = 0;
+			uint64_t* last_self = 0;
+			for (size_t i = 0; i < events.size(); ++i) {
+				if (!events[i]) continue;
+				if (events[i]->name != last_name) {
+					last_name = events[i]->name;
+					last = &durations[last_name];
+					last_self = &self_ns[last_name];
+				}
+				last->push_back(d[i]);
+				*last_self += d[i] > children_ns[i] ? d[i] - children_ns[i] : 0;
+			}
+		}
+	}
+
+	std::vector<ProfileZoneStats> stats;
+	stats.reserve(durations.size());
+	for (auto &d : durations) {
+		std::vector<uint64_t> &v = d.second;
+		std::sort(v.begin(), v.end());
+		ProfileZoneStats s;
+		s.name = d.first;
+		s.count = v.size();
+		s.total_ns = 0;
+		for (auto x : v) s.total_ns += x;
+		s.self_ns = self_ns[d.first];
+		s.min_ns = v.front();
+		s.max_ns = v.back();
+		s.p50_ns = percentile(v, 0.50);
+		s.p90_ns = percentile(v, 0.90);
+		s.p99_ns = percentile(v, 0.99);
+		stats.push_back(s);
+	}
+	std::sort(stats.begin(), stats.end(),
+		[](const ProfileZoneStats &a, const ProfileZoneStats &b) {
+		return a.total_ns > b.total_ns;
+	});
+	return stats;
+}
+//-----------------------------------------------------------------------------
+void Profiler::WriteReport(std::ostream &out)
+{
+	std::vector<ProfileZoneStats> stats = GetStats();
+	char line[256];
+	snprintf(line, sizeof(line),
+		"%-32s %10s %12s %12s %10s %10s %10s %10s %10s\n", "zone", "count",
+		"total(ms)", "self(ms)", "min(us)", "p50(us)", "p90(us)", "p99(us)",
+		"max(us)");
+	out << line;
+	for (const auto &s : stats) {
+		snprintf(line, sizeof(line),
+			"%-32.32s %10llu %12.3f %12.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+			s.name.c_str(), (unsigned long long)s.count, s.total_ns * 1e-6,
+			s.self_ns * 1e-6, s.min_ns * 1e-3, s.p50_ns * 1e-3, s.p90_ns * 1e-3,
+			s.p99_ns * 1e-3, s.max_ns * 1e-3);
+		out << line;
+	}
+	uint64_t dropped = DroppedEvents();
+	if (dropped > 0) out << "dropped zones: " << dropped << '\n';
+}
+//-----------------------------------------------------------------------------
+void Profiler::WriteChromeTrace(std::ostream &out)
+{
+	Registry &r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	out << "{\"traceEvents\":[";
+	bool first = true;
+	std::vector<const ProfileEvent*> events;
+	std::vector<uint64_t> d, children_ns;
+	for (auto &t : r.threads) {
+		closed_events(*t, events, d, children_ns);
+		for (size_t i = 0; i < events.size(); ++i) {
+			const ProfileEvent* e = events[i];
+			if (!e) continue;
+			out << (first ? "\n" : ",\n") << "{\"name\":";
+			write_json_string(out, e->name);
+			// Timestamps in microseconds since the last Reset
+			out << ",\"ph\":\"X\",\"ts\":";
+			if (e->start_ns >= r.origin_ns) {
+				write_us(out, e->start_ns - r.origin_ns, false);
+			} else {
+				write_us(out, r.origin_ns - e->start_ns, true);
+			}
+			out << ",\"dur\":";
+			write_us(out, d[i], false);
+			char tid[16];
+			*text::NumberConversion::format(tid, tid + sizeof(tid) - 1,
+				t->tid).ptr = 0;
+			out << ",\"pid\":0,\"tid\":" << tid << '}';
+			first = false;
+		}
+	}
+	out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+//-----------------------------------------------------------------------------
+bool Profiler::WriteChromeTrace(const std::string &filename)
+{
+	std::ofstream f(filename.c_str());
+	if (!f.is_open()) return false;
+	WriteChromeTrace(f);
+	return f.good();
+}
+
+
+}   // namespace system
+}	// namespace CmnLib
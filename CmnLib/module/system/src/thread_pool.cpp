@@ -0,0 +1,230 @@
+/* @file thread_pool.cpp
+ * @brief Body of the work-stealing thread pool.
+ *
+ * @section LICENSE
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF 
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ * @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+ * @bug No known bugs.
+ * @version 1.1.1.0
+ * 
+ */
+
+#include "system/inc/system/thread_pool.hpp"
+
+#include <chrono>
+
+namespace CmnLib
+{
+namespace system
+{
+
+namespace
+{
+
+/** Worker executed by the calling thread (no pool if it is not a worker).
+*/
+thread_local ThreadPool* current_pool = 0;
+thread_local size_t current_index = 0;
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+ThreadPool::ThreadPool(size_t num_workers)
+	: num_tasks_(0), num_idle_(0), stop_(false) {
+	if (num_workers == 0) {
+		size_t hw = std::thread::hardware_concurrency();
+		num_workers = hw > 1 ? hw - 1 : 1;
+	}
+	workers_.resize(num_workers);
+	for (size_t i = 0; i < num_workers; ++i) {
+		workers_[i] = new Worker();
+	}
+	// The workers are started when all the deques exist (they steal)
+	for (size_t i = 0; i < num_workers; ++i) {
+		workers_[i]->thread = std::thread(&ThreadPool::WorkerLoop, this, i);
+	}
+}
+
+//-----------------------------------------------------------------------------
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(idle_mutex_);
+		stop_ = true;
+	}
+	idle_cv_.notify_all();
+	for (size_t i = 0; i < workers_.size(); ++i) {
+		workers_[i]->thread.join();
+	}
+	// Tasks queued while the workers were stopping
+	while (RunOneTask()) {}
+	for (size_t i = 0; i < workers_.size(); ++i) {
+		delete workers_[i];
+	}
+}
+
+//-----------------------------------------------------------------------------
+ThreadPool& ThreadPool::Instance() {
+	static ThreadPool pool;
+	return pool;
+}
+
+//-----------------------------------------------------------------------------
+bool ThreadPool::RunOneTask() {
+	Task task;
+	if (!PopTask(task)) return false;
+	Execute(task);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+ptrdiff_t ThreadPool::WorkerIndex() const {
+	return current_pool == this ? static_cast<ptrdiff_t>(current_index) : -1;
+}
+
+//-----------------------------------------------------------------------------
+void ThreadPool::Submit(Task &&task) {
+	// Counted before it is visible: a worker can only see too many tasks,
+	// never miss one.
+	num_tasks_.fetch_add(1);
+	ptrdiff_t index = WorkerIndex();
+	if (index >= 0) {
+		Worker &worker = *workers_[index];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.tasks.push_back(std::move(task));
+	} else {
+		std::lock_guard<std::mutex> lock(shared_mutex_);
+		shared_tasks_.push_back(std::move(task));
+	}
+	if (num_idle_.load() > 0) {
+		std::lock_guard<std::mutex> lock(idle_mutex_);
+		idle_cv_.notify_one();
+	}
+}
+
+//-----------------------------------------------------------------------------
+bool ThreadPool::PopTask(Task &task) {
+	ptrdiff_t index = WorkerIndex();
+	// Own deque, newest task first
+	if (index >= 0) {
+		Worker &worker = *workers_[index];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if (!worker.tasks.empty()) {
+			task = std::move(worker.tasks.back());
+			worker.tasks.pop_back();
+			num_tasks_.fetch_sub(1);
+			return true;
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(shared_mutex_);
+		if (!shared_tasks_.empty()) {
+			task = std::move(shared_tasks_.front());
+			shared_tasks_.pop_front();
+			num_tasks_.fetch_sub(1);
+			return true;
+		}
+	}
+	// Steal the oldest task of another worker
+	size_t n = workers_.size();
+	size_t start = index >= 0 ? static_cast<size_t>(index) + 1 : 0;
+	for (size_t k = 0; k < n; ++k) {
+		Worker &victim = *workers_[(start + k) % n];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			num_tasks_.fetch_sub(1);
+			return true;
+		}
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+void ThreadPool::Execute(Task &task) {
+	std::exception_ptr error;
+	try {
+		task.func();
+	} catch (...) {
+		error = std::current_exception();
+	}
+	// Release the captures before the group can be destroyed
+	task.func = std::function<void()>();
+	task.group->Done(error);
+}
+
+//-----------------------------------------------------------------------------
+void ThreadPool::WorkerLoop(size_t index) {
+	current_pool = this;
+	current_index = index;
+	for (;;) {
+		if (RunOneTask()) continue;
+		std::unique_lock<std::mutex> lock(idle_mutex_);
+		num_idle_.fetch_add(1);
+		idle_cv_.wait(lock, [this]() {
+			return stop_.load() || num_tasks_.load() > 0;
+		});
+		num_idle_.fetch_sub(1);
+		if (stop_.load() && num_tasks_.load() == 0) break;
+	}
+	current_pool = 0;
+}
+
+//-----------------------------------------------------------------------------
+TaskGroup::~TaskGroup() {
+	try {
+		wait();
+	} catch (...) {
+	}
+}
+
+//-----------------------------------------------------------------------------
+void TaskGroup::run(std::function<void()> func) {
+	pending_.fetch_add(1);
+	ThreadPool::Task task;
+	task.func = std::move(func);
+	task.group = this;
+	pool_.Submit(std::move(task));
+}
+
+//-----------------------------------------------------------------------------
+void TaskGroup::wait() {
+	while (pending_.load() > 0) {
+		// Help instead of blocking, the tasks of this group may be queued
+		// behind the calling thread.
+		if (pool_.RunOneTask()) continue;
+		std::unique_lock<std::mutex> lock(mutex_);
+		done_cv_.wait_for(lock, std::chrono::milliseconds(1), [this]() {
+			return pending_.load() == 0;
+		});
+	}
+	std::exception_ptr error;
+	{
+		// Done releases the mutex after its last access to the group
+		std::lock_guard<std::mutex> lock(mutex_);
+		error = error_;
+		error_ = std::exception_ptr();
+	}
+	if (error) std::rethrow_exception(error);
+}
+
+//-----------------------------------------------------------------------------
+void TaskGroup::Done(std::exception_ptr error) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (error && !error_) error_ = error;
+	if (pending_.fetch_sub(1) == 1) done_cv_.notify_all();
+}
+
+}   // namespace system
+}	// namespace CmnLib
@@ -23,6 +23,8 @@
 
 #include "system/inc/system/time.hpp"
 
+#include <chrono>
+
 namespace CmnLib
 {
 namespace system
@@ -32,21 +34,15 @@ namespace system
 #ifdef WIN32
 double TimeManager::ElapsedMicroseconds()
 {
-	LARGE_INTEGER TicksPerSecond = { 0, 0 }; // Global ticks per second
-	double TicksPerMicrosecond = 0;       // Global ticks/microsecond
+	static LARGE_INTEGER TicksPerSecond = { 0, 0 }; // Global ticks per second
 
 	LARGE_INTEGER StopTime; // ticks of stop time
-	double delta;           // dif as a normalized float
-
 	QueryPerformanceCounter(&StopTime); // read current clock
-	if (TicksPerSecond.LowPart == 0)
+	if (TicksPerSecond.QuadPart == 0)
 	{
 		QueryPerformanceFrequency(&TicksPerSecond);
-		TicksPerMicrosecond = (float)(TicksPerSecond.LowPart / 1E6);
 	}
-	delta = StopTime.QuadPart / TicksPerMicrosecond; // low part 
-
-	return delta;
+	return (double)StopTime.QuadPart * 1E6 / (double)TicksPerSecond.QuadPart;
 };
 #endif
 //-----------------------------------------------------------------------------
@@ -61,6 +57,12 @@ double TimeManager::gettime()
 	return (double)(tv.tv_sec + tv.tv_usec / 1000000.0);
 #endif
 }
+//-----------------------------------------------------------------------------
+uint64_t TimeManager::now_ns()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 
 } // namespace system
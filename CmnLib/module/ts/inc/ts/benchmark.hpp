@@ -0,0 +1,272 @@
+/**
+* @file benchmark.hpp
+* @brief Header of the microbenchmark harness.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#ifndef CMNLIB_TS_BENCHMARK_HPP__
+#define CMNLIB_TS_BENCHMARK_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace CmnLib
+{
+namespace ts
+{
+
+/** @brief Prevent the compiler from removing the computation of value.
+*/
+template <typename T>
+inline void DoNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	const volatile char* p = reinterpret_cast<const volatile char*>(&value);
+	static volatile char sink;
+	sink = *p;
+#endif
+}
+
+/** @brief Force the pending writes to memory (compiler barrier).
+*/
+inline void ClobberMemory() {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : : "memory");
+#else
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+/** State of a running benchmark.
+	@remarks
+		The benchmark repeats its body while KeepRunning returns true; only
+		the time between the first and the last call is measured. The setup
+		done before the loop is excluded.
+	@code
+		CL_BENCHMARK(vector_push_back) {
+			while (state.KeepRunning()) {
+				std::vector<int> v;
+				v.push_back(1);
+				CmnLib::ts::DoNotOptimize(v.data());
+			}
+		}
+	@endcode
+*/
+class BenchmarkState
+{
+public:
+
+	explicit BenchmarkState(uint64_t iterations)
+		: iterations_(iterations), remaining_(iterations), items_(0),
+		  bytes_(0), finished_(false) {}
+
+	/** @brief Return true while the body has to be executed.
+	*/
+	bool KeepRunning() {
+		if (remaining_ == iterations_) {
+			start_ = std::chrono::steady_clock::now();
+		}
+		if (remaining_ > 0) {
+			--remaining_;
+			return true;
+		}
+		end_ = std::chrono::steady_clock::now();
+		finished_ = true;
+		return false;
+	}
+
+	/** @brief Number of executions of the body.
+	*/
+	uint64_t iterations() const { return iterations_; }
+
+	/** @brief True if the body ran KeepRunning until it returned false:
+		only then the time is measured.
+	*/
+	bool finished() const { return finished_; }
+
+	/** @brief Items and bytes processed per iteration (for the throughput).
+	*/
+	void set_items_per_iteration(uint64_t items) { items_ = items; }
+	void set_bytes_per_iteration(uint64_t bytes) { bytes_ = bytes; }
+	uint64_t items_per_iteration() const { return items_; }
+	uint64_t bytes_per_iteration() const { return bytes_; }
+
+	/** @brief Measured time in nanoseconds.
+	*/
+	double elapsed_ns() const {
+		return std::chrono::duration<double, std::nano>(end_ - start_).count();
+	}
+
+private:
+
+	uint64_t iterations_;
+	uint64_t remaining_;
+	uint64_t items_;
+	uint64_t bytes_;
+	bool finished_;
+	std::chrono::steady_clock::time_point start_;
+	std::chrono::steady_clock::time_point end_;
+};
+
+/** Function of a benchmark.
+*/
+typedef void(*BenchmarkFunction)(BenchmarkState&);
+
+/** Statistics of a benchmark, the times are per iteration.
+*/
+struct BenchmarkResult
+{
+	BenchmarkResult()
+		: iterations(0), samples(0), median_ns(0), mad_ns(0), mean_ns(0),
+		  min_ns(0), max_ns(0), p99_ns(0), items_per_second(0),
+		  bytes_per_second(0), baseline_ns(0), regression(false) {}
+
+	std::string name;
+	// Why the benchmark could not be measured (empty if it was)
+	std::string error;
+	uint64_t iterations;	// per sample
+	int samples;
+	double median_ns;
+	double mad_ns;			// median absolute deviation
+	double mean_ns;
+	double min_ns;
+	double max_ns;
+	double p99_ns;
+	double items_per_second;
+	double bytes_per_second;
+	// Comparison with the baseline (0 if the benchmark is not in it)
+	double baseline_ns;
+	bool regression;
+};
+
+/** Options of the benchmark runner.
+*/
+struct BenchmarkOptions
+{
+	BenchmarkOptions()
+		: min_sample_ms(10.0), warmup_ms(50.0), samples(20), threshold(0.1) {}
+
+	/** @brief Run only the benchmarks which name contains filter.
+	*/
+	std::string filter;
+	/** @brief Minimum duration of a sample, the iterations are calibrated.
+	*/
+	double min_sample_ms;
+	/** @brief Duration of the warm-up (not measured).
+	*/
+	double warmup_ms;
+	int samples;
+	/** @brief Files where the results are written (empty: not written).
+	*/
+	std::string json_filename;
+	std::string csv_filename;
+	/** @brief CSV file of a previous run to compare with.
+	*/
+	std::string baseline_filename;
+	/** @brief A benchmark is a regression if its median is slower than the
+		baseline by more than threshold (relative) and more than 3 MAD.
+	*/
+	double threshold;
+};
+
+/** Registered benchmarks and their runner.
+*/
+class Benchmark
+{
+public:
+
+	/** @brief Register a benchmark (see CL_BENCHMARK).
+		@return Always true.
+	*/
+	static bool Register(const char* name, BenchmarkFunction function);
+
+	/** @brief Run a benchmark: warm-up, calibration and samples.
+		@return The statistics, or the error if the body does not run
+		KeepRunning to the end or if a run does not reach min_sample_ms
+		within the calibration rounds.
+	*/
+	static BenchmarkResult Run(const char* name, BenchmarkFunction function,
+		const BenchmarkOptions &options);
+
+	/** @brief Run the registered benchmarks selected by the options, write
+		the results and compare them with the baseline.
+		@return The results.
+	*/
+	static std::vector<BenchmarkResult> RunAll(const BenchmarkOptions &options,
+		std::ostream &out);
+
+	/** @brief Parse the command line options:
+		--filter=text --samples=N --min_sample_ms=T --warmup_ms=T
+		--json=file --csv=file --baseline=file --threshold=R
+		@return False if an option is not valid.
+	*/
+	static bool ParseOptions(int argc, char** argv, BenchmarkOptions &options);
+
+	/** @brief Entry point of a benchmark program (see CL_BENCHMARK_MAIN).
+		@return 0 on success, 1 if a regression is detected, 2 if the
+		options are not valid, 3 if a benchmark cannot be measured.
+	*/
+	static int Main(int argc, char** argv);
+
+	/** @brief Write the results (without the ones with an error).
+	*/
+	static void WriteJSON(const std::vector<BenchmarkResult> &results,
+		std::ostream &out);
+	static void WriteCSV(const std::vector<BenchmarkResult> &results,
+		std::ostream &out);
+
+	/** @brief Read the CSV written by WriteCSV and set the baseline of the
+		results with the same name.
+		@return False if the file cannot be read.
+	*/
+	static bool CompareBaseline(const std::string &filename, double threshold,
+		std::vector<BenchmarkResult> &results);
+};
+
+}	// namespace ts
+}	// namespace CmnLib
+
+#define CL_BENCHMARK_CONCAT2__(a, b) a##b
+#define CL_BENCHMARK_CONCAT__(a, b) CL_BENCHMARK_CONCAT2__(a, b)
+
+/** Define and register a benchmark. The body receives a
+	CmnLib::ts::BenchmarkState& named state.
+*/
+#define CL_BENCHMARK(name) \
+	static void name(CmnLib::ts::BenchmarkState &state); \
+	static const bool CL_BENCHMARK_CONCAT__(cl_benchmark_registered__, name) = \
+		CmnLib::ts::Benchmark::Register(#name, &name); \
+	static void name(CmnLib::ts::BenchmarkState &state)
+
+/** Main function running the registered benchmarks.
+*/
+#define CL_BENCHMARK_MAIN() \
+int main(int argc, char **argv) \
+{ \
+	return CmnLib::ts::Benchmark::Main(argc, argv); \
+}
+
+#endif /* CMNLIB_TS_BENCHMARK_HPP__ */
@@ -61,27 +61,33 @@ class TestSystem
 {
 public:
 
-	TestSystem()	{}
+	TestSystem()	{
+		memory_filename_[0] = 0;
+		memoryc_filename_[0] = 0;
+	}
 
 	DISALLOW_COPY_AND_ASSIGN(TestSystem);
 
+	/** Write the memory statistics report (CmnLib::core::MemoryStats)
+	*/
 	~TestSystem()	{
-#ifdef CL_MEMORY_MANAGER
-		//Memory::getSingletonPtr()->GenerateReport(memory_filename_.c_str());
-		//MemoryLeakTrackerC::getSingletonPtr()->report_mem_leak(memoryc_filename_);
-		Memory::getSingletonPtr()->GenerateReport(memory_filename_);
-		MemoryLeakTrackerC::getSingletonPtr()->report_mem_leak(memoryc_filename_);
+#if CL_MEMORY_STATS
+		if (memory_filename_[0]) {
+			CmnLib::core::MemoryStats::generateReport(memory_filename_);
+		}
 #endif
 	}
 
 	/** Set where to save the result of C memory leak detector
+		@remarks The C allocations are no longer tracked, the file is not
+		         written.
 	*/
 	void set_memoryc_filename(const std::string &filename)	{
 		//memoryc_filename_ = filename;
 		sprintf(memoryc_filename_, "%s", filename.c_str());
 	}
 
-	/** Set where to save the result of C++ memory leak detector
+	/** Set where to save the memory statistics report
 	*/
 	void set_memory_filename(const std::string &filename)	{
 		//memory_filename_ = filename;
@@ -103,16 +109,6 @@ public:
 
 private:
 
-#ifdef CL_MEMORY_MANAGER
-	/** @brief Memorize the leak caused by C++ code
-	*/
-	static Memory memory_;
-
-	/** *brief Memorize the leak caused by C code
-	*/
-	static MemoryLeakTrackerC memoryc_;
-#endif
-
 	/** @brief Filename for the C++ memory leak  tracker
 	*/
 	//std::string memory_filename_;
@@ -125,12 +121,6 @@ private:
 
 };
 
-// Declare static vars
-#ifdef CL_MEMORY_MANAGER
-Memory TestSystem::memory_;
-MemoryLeakTrackerC TestSystem::memoryc_;
-#endif
-
 }	// namespace ts
 }	// namespace CmnLib
 
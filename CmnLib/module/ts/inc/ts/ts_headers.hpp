@@ -1,6 +1,6 @@
 /**
-* @file container_headers.hpp
-* @brief Header to call all the container headers.
+* @file ts_headers.hpp
+* @brief Header to call all the ts headers.
 *
 * @section LICENSE
 *
@@ -21,9 +21,10 @@
 *
 */
 
-#ifndef CMNLIB_CONTROL_CONTROLHEADERS_HPP__
-#define CMNLIB_CONTROL_CONTROLHEADERS_HPP__
+#ifndef CMNLIB_TS_TSHEADERS_HPP__
+#define CMNLIB_TS_TSHEADERS_HPP__
 
-#include "FileLog.hpp"
+#include "ts.hpp"
+#include "benchmark.hpp"
 
-#endif /* CMNLIB_CONTROL_CONTROLHEADERS_HPP__ */
+#endif /* CMNLIB_TS_TSHEADERS_HPP__ */
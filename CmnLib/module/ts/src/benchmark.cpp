@@ -0,0 +1,348 @@
+/**
+* @file benchmark.cpp
+* @brief Body of the microbenchmark harness.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include "ts/inc/ts/benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <utility>
+
+namespace CmnLib
+{
+namespace ts
+{
+
+namespace
+{
+
+typedef std::vector< std::pair<const char*, BenchmarkFunction> > Registry;
+
+/** @brief Maximum number of calibration runs shorter than min_sample_ms.
+	The iterations grow at least by 1.5 per run, 64 runs are more than
+	2^37 iterations.
+*/
+const int kMaxCalibrationRounds = 64;
+
+Registry& registry() {
+	static Registry r;
+	return r;
+}
+
+/** @brief Time per iteration of a run of n iterations.
+*/
+double run_once(BenchmarkFunction function, uint64_t n, BenchmarkState* last) {
+	BenchmarkState state(n);
+	function(state);
+	if (last) *last = state;
+	return state.elapsed_ns();
+}
+
+/** @brief Median of sorted values.
+*/
+double median(const std::vector<double> &sorted) {
+	size_t n = sorted.size();
+	if (n == 0) return 0;
+	return (n & 1) ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+}
+
+/** @brief Value at the percentile p of sorted values (nearest rank).
+*/
+double percentile(const std::vector<double> &sorted, double p) {
+	if (sorted.empty()) return 0;
+	size_t rank = (size_t)std::ceil(p * (double)sorted.size());
+	rank = std::min(std::max(rank, (size_t)1), sorted.size());
+	return sorted[rank - 1];
+}
+
+/** @brief Value of an option --key=value.
+*/
+bool option_value(const char* arg, const char* key, std::string &value) {
+	size_t n = strlen(key);
+	if (strncmp(arg, key, n) != 0 || arg[n] != '=') return false;
+	value = arg + n + 1;
+	return true;
+}
+
+}  // namespace anonymous
+
+//-----------------------------------------------------------------------------
+bool Benchmark::Register(const char* name, BenchmarkFunction function)
+{
+	registry().push_back(std::make_pair(name, function));
+	return true;
+}
+//-----------------------------------------------------------------------------
+BenchmarkResult Benchmark::Run(const char* name, BenchmarkFunction function,
+	const BenchmarkOptions &options)
+{
+	const double min_sample_ns = options.min_sample_ms * 1e6;
+	const double warmup_ns = options.warmup_ms * 1e6;
+
+	BenchmarkResult r;
+	r.name = name;
+
+	// Warm-up and calibration: grow the iterations until a run lasts at
+	// least min_sample_ms, and keep running until the warm-up is over.
+	uint64_t n = 1;
+	double warmup = 0;
+	BenchmarkState last(n);
+	for (int rounds = 0;;) {
+		double elapsed = run_once(function, n, &last);
+		if (!last.finished()) {
+			r.error = "the body does not run KeepRunning to the end";
+			return r;
+		}
+		warmup += elapsed;
+		if (elapsed >= min_sample_ns) {
+			if (warmup >= warmup_ns) break;
+			continue;
+		}
+		if (++rounds == kMaxCalibrationRounds) {
+			r.error = "the calibration does not reach min_sample_ms";
+			return r;
+		}
+		double scale = elapsed > 0 ? min_sample_ns * 1.2 / elapsed : 10.0;
+		scale = std::min(std::max(scale, 1.5), 10.0);
+		n = (uint64_t)std::ceil((double)n * scale);
+	}
+
+	std::vector<double> times;
+	int samples = std::max(1, options.samples);
+	times.reserve(samples);
+	for (int s = 0; s < samples; ++s) {
+		times.push_back(run_once(function, n, &last) / (double)n);
+		if (!last.finished()) {
+			r.error = "the body does not run KeepRunning to the end";
+			return r;
+		}
+	}
+	std::sort(times.begin(), times.end());
+
+	r.iterations = n;
+	r.samples = samples;
+	r.median_ns = median(times);
+	std::vector<double> deviations(times.size());
+	double sum = 0;
+	for (size_t i = 0; i < times.size(); ++i) {
+		deviations[i] = std::fabs(times[i] - r.median_ns);
+		sum += times[i];
+	}
+	std::sort(deviations.begin(), deviations.end());
+	r.mad_ns = median(deviations);
+	r.mean_ns = sum / (double)times.size();
+	r.min_ns = times.front();
+	r.max_ns = times.back();
+	r.p99_ns = percentile(times, 0.99);
+	r.items_per_second = r.median_ns > 0 ?
+		(double)last.items_per_iteration() * 1e9 / r.median_ns : 0;
+	r.bytes_per_second = r.median_ns > 0 ?
+		(double)last.bytes_per_iteration() * 1e9 / r.median_ns : 0;
+	return r;
+}
+//-----------------------------------------------------------------------------
+std::vector<BenchmarkResult> Benchmark::RunAll(
+	const BenchmarkOptions &options, std::ostream &out)
+{
+	std::vector<BenchmarkResult> results;
+	char line[256];
+	snprintf(line, sizeof(line), "%-40s %12s %10s %12s %14s\n", "benchmark",
+		"median(ns)", "mad(ns)", "p99(ns)", "iterations");
+	out << line;
+	for (const auto &b : registry()) {
+		if (!options.filter.empty() &&
+			std::string(b.first).find(options.filter) == std::string::npos) {
+			continue;
+		}
+		BenchmarkResult r = Run(b.first, b.second, options);
+		results.push_back(r);
+		if (!r.error.empty()) {
+			snprintf(line, sizeof(line), "%-40.40s error: %s\n",
+				r.name.c_str(), r.error.c_str());
+			out << line;
+			continue;
+		}
+		snprintf(line, sizeof(line), "%-40.40s %12.2f %10.2f %12.2f %9llux%d",
+			r.name.c_str(), r.median_ns, r.mad_ns, r.p99_ns,
+			(unsigned long long)r.iterations, r.samples);
+		out << line;
+		if (r.items_per_second > 0) {
+			out << " " << r.items_per_second * 1e-6 << " Mitems/s";
+		}
+		if (r.bytes_per_second > 0) {
+			out << " " << r.bytes_per_second / (1024.0 * 1024.0) << " MB/s";
+		}
+		out << std::endl;
+	}
+
+	if (!options.baseline_filename.empty()) {
+		if (!CompareBaseline(options.baseline_filename, options.threshold,
+			results)) {
+			out << "cannot read the baseline " << options.baseline_filename <<
+				std::endl;
+		} else {
+			for (const auto &r : results) {
+				if (r.baseline_ns <= 0) continue;
+				snprintf(line, sizeof(line), "%-40.40s %12.2f -> %12.2f %+7.1f%%%s\n",
+					r.name.c_str(), r.baseline_ns, r.median_ns,
+					(r.median_ns / r.baseline_ns - 1.0) * 100.0,
+					r.regression ? " REGRESSION" : "");
+				out << line;
+			}
+		}
+	}
+	if (!options.json_filename.empty()) {
+		std::ofstream f(options.json_filename.c_str());
+		WriteJSON(results, f);
+	}
+	if (!options.csv_filename.empty()) {
+		std::ofstream f(options.csv_filename.c_str());
+		WriteCSV(results, f);
+	}
+	return results;
+}
+//-----------------------------------------------------------------------------
+bool Benchmark::ParseOptions(int argc, char** argv, BenchmarkOptions &options)
+{
+	for (int i = 1; i < argc; ++i) {
+		std::string value;
+		if (option_value(argv[i], "--filter", value)) {
+			options.filter = value;
+		} else if (option_value(argv[i], "--samples", value)) {
+			options.samples = atoi(value.c_str());
+			if (options.samples < 1) return false;
+		} else if (option_value(argv[i], "--min_sample_ms", value)) {
+			options.min_sample_ms = atof(value.c_str());
+		} else if (option_value(argv[i], "--warmup_ms", value)) {
+			options.warmup_ms = atof(value.c_str());
+		} else if (option_value(argv[i], "--json", value)) {
+			options.json_filename = value;
+		} else if (option_value(argv[i], "--csv", value)) {
+			options.csv_filename = value;
+		} else if (option_value(argv[i], "--baseline", value)) {
+			options.baseline_filename = value;
+		} else if (option_value(argv[i], "--threshold", value)) {
+			options.threshold = atof(value.c_str());
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+//-----------------------------------------------------------------------------
+int Benchmark::Main(int argc, char** argv)
+{
+	BenchmarkOptions options;
+	if (!ParseOptions(argc, argv, options)) {
+		std::cerr << "usage: " << argv[0] << " [--filter=text] [--samples=N]"
+			" [--min_sample_ms=T] [--warmup_ms=T] [--json=file] [--csv=file]"
+			" [--baseline=file] [--threshold=R]" << std::endl;
+		return 2;
+	}
+	std::vector<BenchmarkResult> results = RunAll(options, std::cout);
+	int status = 0;
+	for (const auto &r : results) {
+		if (!r.error.empty()) return 3;
+		if (r.regression) status = 1;
+	}
+	return status;
+}
+//-----------------------------------------------------------------------------
+void Benchmark::WriteJSON(const std::vector<BenchmarkResult> &results,
+	std::ostream &out)
+{
+	char buf[512];
+	out << "{\"benchmarks\":[";
+	bool first = true;
+	for (const auto &r : results) {
+		if (!r.error.empty()) continue;
+		out << (first ? "\n" : ",\n") << "{\"name\":\"";
+		first = false;
+		for (char c : r.name) {
+			if (c == '"' || c == '\\') out << '\\';
+			out << c;
+		}
+		snprintf(buf, sizeof(buf), "\",\"iterations\":%llu,\"samples\":%d,"
+			"\"median_ns\":%.3f,\"mad_ns\":%.3f,\"mean_ns\":%.3f,"
+			"\"min_ns\":%.3f,\"max_ns\":%.3f,\"p99_ns\":%.3f,"
+			"\"items_per_second\":%.3f,\"bytes_per_second\":%.3f}",
+			(unsigned long long)r.iterations, r.samples, r.median_ns,
+			r.mad_ns, r.mean_ns, r.min_ns, r.max_ns, r.p99_ns,
+			r.items_per_second, r.bytes_per_second);
+		out << buf;
+	}
+	out << "\n]}\n";
+}
+//-----------------------------------------------------------------------------
+void Benchmark::WriteCSV(const std::vector<BenchmarkResult> &results,
+	std::ostream &out)
+{
+	char buf[512];
+	out << "name,iterations,samples,median_ns,mad_ns,mean_ns,min_ns,max_ns,"
+		"p99_ns,items_per_second,bytes_per_second\n";
+	for (const auto &r : results) {
+		if (!r.error.empty()) continue;
+		snprintf(buf, sizeof(buf), ",%llu,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,"
+			"%.3f,%.3f\n", (unsigned long long)r.iterations, r.samples,
+			r.median_ns, r.mad_ns, r.mean_ns, r.min_ns, r.max_ns, r.p99_ns,
+			r.items_per_second, r.bytes_per_second);
+		out << r.name << buf;
+	}
+}
+//-----------------------------------------------------------------------------
+bool Benchmark::CompareBaseline(const std::string &filename, double threshold,
+	std::vector<BenchmarkResult> &results)
+{
+	std::ifstream f(filename.c_str());
+	if (!f.is_open()) return false;
+	std::map<std::string, double> baseline;
+	std::string line;
+	std::getline(f, line);	// header
+	while (std::getline(f, line)) {
+		std::stringstream ss(line);
+		std::string name, iterations, samples, median_ns;
+		if (std::getline(ss, name, ',') && std::getline(ss, iterations, ',') &&
+			std::getline(ss, samples, ',') && std::getline(ss, median_ns, ',')) {
+			baseline[name] = atof(median_ns.c_str());
+		}
+	}
+	for (auto &r : results) {
+		if (!r.error.empty()) continue;
+		auto it = baseline.find(r.name);
+		if (it == baseline.end() || it->second <= 0) continue;
+		r.baseline_ns = it->second;
+		r.regression = r.median_ns > r.baseline_ns * (1.0 + threshold) &&
+			r.median_ns - r.baseline_ns > 3.0 * r.mad_ns;
+	}
+	return true;
+}
+
+
+}	// namespace ts
+}	// namespace CmnLib
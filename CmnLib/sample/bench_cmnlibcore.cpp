@@ -0,0 +1,105 @@
+/**
+* @file bench_cmnlibcore.cpp
+* @brief Benchmark of the allocators of cmnlibcore.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include <cstdlib>
+#include <vector>
+
+#include "ts/inc/ts/benchmark.hpp"
+#include "cmnlibcore/inc/cmnlibcore/cmnlibcore_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+const int kNumObjects = 1000;
+
+/** @brief Sizes of the allocated objects, skewed toward the small ones.
+*/
+std::vector<size_t> object_sizes() {
+	std::vector<size_t> sizes(kNumObjects);
+	unsigned int seed = 17u;
+	for (auto &s : sizes) {
+		seed = seed * 1664525u + 1013904223u;
+		unsigned int r = seed >> 16;
+		s = (r & 3) ? 8 + (r % 56) : 8 + (r % 504);
+	}
+	return sizes;
+}
+
+CL_BENCHMARK(malloc_free) {
+	std::vector<size_t> sizes = object_sizes();
+	std::vector<void*> objects(kNumObjects);
+	state.set_items_per_iteration(kNumObjects);
+	while (state.KeepRunning()) {
+		for (int i = 0; i < kNumObjects; ++i) objects[i] = malloc(sizes[i]);
+		CmnLib::ts::DoNotOptimize(objects.data());
+		for (int i = kNumObjects - 1; i >= 0; --i) free(objects[i]);
+	}
+}
+
+CL_BENCHMARK(fastMalloc_fastFree) {
+	std::vector<size_t> sizes = object_sizes();
+	std::vector<void*> objects(kNumObjects);
+	state.set_items_per_iteration(kNumObjects);
+	while (state.KeepRunning()) {
+		for (int i = 0; i < kNumObjects; ++i) {
+			objects[i] = CmnLib::core::MemoryFoundations::fastMalloc(sizes[i]);
+		}
+		CmnLib::ts::DoNotOptimize(objects.data());
+		for (int i = kNumObjects - 1; i >= 0; --i) {
+			CmnLib::core::MemoryFoundations::fastFree(objects[i]);
+		}
+	}
+}
+
+CL_BENCHMARK(NodePool_allocate) {
+	std::vector<size_t> sizes = object_sizes();
+	std::vector<void*> objects(kNumObjects);
+	CmnLib::core::NodePool pool;
+	state.set_items_per_iteration(kNumObjects);
+	while (state.KeepRunning()) {
+		for (int i = 0; i < kNumObjects; ++i) {
+			objects[i] = pool.allocate(sizes[i], 8);
+		}
+		CmnLib::ts::DoNotOptimize(objects.data());
+		for (int i = kNumObjects - 1; i >= 0; --i) {
+			pool.deallocate(objects[i], sizes[i], 8);
+		}
+	}
+}
+
+CL_BENCHMARK(MonotonicArena_allocate) {
+	std::vector<size_t> sizes = object_sizes();
+	CmnLib::core::MonotonicArena arena;
+	state.set_items_per_iteration(kNumObjects);
+	while (state.KeepRunning()) {
+		for (int i = 0; i < kNumObjects; ++i) {
+			CmnLib::ts::DoNotOptimize(arena.allocate(sizes[i], 8));
+		}
+		arena.reset();
+	}
+}
+
+}  // namespace anonymous
+
+CL_BENCHMARK_MAIN();
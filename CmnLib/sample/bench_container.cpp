@@ -0,0 +1,113 @@
+/**
+* @file bench_container.cpp
+* @brief Benchmark of the nearest key lookups and of the splay tree.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include <map>
+#include <vector>
+
+#include "ts/inc/ts/benchmark.hpp"
+#include "container/inc/container/container_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+const int kNumKeys = 100000;
+const int kNumQueries = 1000;
+
+/** @brief Queries in [0, 2 * kNumKeys), the keys are the even numbers.
+*/
+std::vector<int> queries(bool sorted) {
+	std::vector<int> q(kNumQueries);
+	unsigned int seed = 7u;
+	for (int i = 0; i < kNumQueries; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		q[i] = sorted ? i * (2 * kNumKeys / kNumQueries) :
+			(int)((seed >> 8) % (2 * kNumKeys));
+	}
+	return q;
+}
+
+CL_BENCHMARK(NearestKey_map) {
+	std::map<int, int> m;
+	for (int i = 0; i < kNumKeys; ++i) m[2 * i] = i;
+	std::vector<int> q = queries(false);
+	state.set_items_per_iteration(kNumQueries);
+	while (state.KeepRunning()) {
+		int out = 0;
+		for (int k : q) {
+			CmnLib::container::ContainerNearestKey<int, int>::get_value(m, k, 4,
+				out);
+			CmnLib::ts::DoNotOptimize(out);
+		}
+	}
+}
+
+CL_BENCHMARK(NearestKey_flatmap) {
+	CmnLib::container::ContainerFlatMap<int, int> m;
+	for (int i = 0; i < kNumKeys; ++i) m.insert(2 * i, i);
+	std::vector<int> q = queries(false);
+	state.set_items_per_iteration(kNumQueries);
+	while (state.KeepRunning()) {
+		int out = 0;
+		for (int k : q) {
+			m.get_value(k, 4, out);
+			CmnLib::ts::DoNotOptimize(out);
+		}
+	}
+}
+
+CL_BENCHMARK(NearestKey_flatmap_batch) {
+	CmnLib::container::ContainerFlatMap<int, int> m;
+	for (int i = 0; i < kNumKeys; ++i) m.insert(2 * i, i);
+	std::vector<int> q = queries(true);
+	std::vector<int> out;
+	std::vector<bool> found;
+	state.set_items_per_iteration(kNumQueries);
+	while (state.KeepRunning()) {
+		CmnLib::ts::DoNotOptimize(m.get_values(q, 4, out, found));
+	}
+}
+
+CL_BENCHMARK(SplayTree_find) {
+	CmnLib::container::SplayTree<int, int> t;
+	for (int i = 0; i < kNumKeys; ++i) t.insert(std::make_pair(2 * i, i));
+	std::vector<int> q = queries(false);
+	state.set_items_per_iteration(kNumQueries);
+	while (state.KeepRunning()) {
+		for (int k : q) CmnLib::ts::DoNotOptimize(t.find(k) != t.end());
+	}
+}
+
+CL_BENCHMARK(map_find) {
+	std::map<int, int> m;
+	for (int i = 0; i < kNumKeys; ++i) m[2 * i] = i;
+	std::vector<int> q = queries(false);
+	state.set_items_per_iteration(kNumQueries);
+	while (state.KeepRunning()) {
+		for (int k : q) CmnLib::ts::DoNotOptimize(m.find(k) != m.end());
+	}
+}
+
+}  // namespace anonymous
+
+CL_BENCHMARK_MAIN();
@@ -0,0 +1,73 @@
+/**
+* @file bench_control.cpp
+* @brief Benchmark of the binary log sink.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include <cstdio>
+#include <string>
+
+#include "ts/inc/ts/benchmark.hpp"
+#include "control/inc/control/control_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+const char* kBasename = "BenchLogBinary";
+const int kMaxFiles = 2;
+
+/** @brief Remove the files written by a benchmark.
+*/
+void remove_files() {
+	for (int i = 0; i < 1024; ++i) {
+		remove(CmnLib::control::BinaryLog::FileName(kBasename, i).c_str());
+	}
+}
+
+CL_BENCHMARK(BinaryLog_write) {
+	{
+		CmnLib::control::BinaryLog log(kBasename, (size_t)1 << 24, kMaxFiles);
+		int i = 0;
+		while (state.KeepRunning()) {
+			CL_BINLOG(log, CmnLib::control::LogLevel::Info,
+				"frame %d position %f %f name %s", i, 0.5 * i, 1.5, "camera");
+			++i;
+		}
+	}
+	remove_files();
+}
+
+CL_BENCHMARK(BinaryLog_filtered) {
+	{
+		CmnLib::control::BinaryLog log(kBasename, (size_t)1 << 16, kMaxFiles);
+		int i = 0;
+		while (state.KeepRunning()) {
+			CL_BINLOG(log, CmnLib::control::LogLevel::Debug,
+				"frame %d position %f %f name %s", i, 0.5 * i, 1.5, "camera");
+			++i;
+		}
+	}
+	remove_files();
+}
+
+}  // namespace anonymous
+
+CL_BENCHMARK_MAIN();
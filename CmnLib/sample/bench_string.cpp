@@ -0,0 +1,117 @@
+/**
+* @file bench_string.cpp
+* @brief Benchmark of the tokenizer and of the number conversions.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "ts/inc/ts/benchmark.hpp"
+#include "string/inc/string/string_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+const int kNumValues = 1000;
+
+/** @brief Line of numbers separated by spaces.
+*/
+std::string number_line() {
+	std::string s;
+	char buf[32];
+	unsigned int seed = 3u;
+	for (int i = 0; i < kNumValues; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		snprintf(buf, sizeof(buf), "%.6f ", (double)(seed >> 8) * 1e-3);
+		s += buf;
+	}
+	return s;
+}
+
+CL_BENCHMARK(StringViewTokenizer_split) {
+	std::string line = number_line();
+	state.set_bytes_per_iteration(line.size());
+	while (state.KeepRunning()) {
+		CmnLib::text::StringViewTokenizer tok(line);
+		CmnLib::text::StringView token;
+		size_t n = 0;
+		while (tok.next(token)) n += token.size();
+		CmnLib::ts::DoNotOptimize(n);
+	}
+}
+
+CL_BENCHMARK(NumberConversion_parse_double) {
+	std::string line = number_line();
+	std::vector<double> values;
+	state.set_items_per_iteration(kNumValues);
+	while (state.KeepRunning()) {
+		values.clear();
+		CmnLib::text::NumberConversion::parse_array(line.data(),
+			line.data() + line.size(), values);
+		CmnLib::ts::DoNotOptimize(values.data());
+	}
+}
+
+CL_BENCHMARK(strtod_parse_double) {
+	std::string line = number_line();
+	std::vector<double> values;
+	state.set_items_per_iteration(kNumValues);
+	while (state.KeepRunning()) {
+		values.clear();
+		const char* p = line.c_str();
+		char* end = 0;
+		for (;;) {
+			double v = strtod(p, &end);
+			if (end == p) break;
+			values.push_back(v);
+			p = end;
+		}
+		CmnLib::ts::DoNotOptimize(values.data());
+	}
+}
+
+CL_BENCHMARK(NumberConversion_format_int) {
+	char buf[32];
+	state.set_items_per_iteration(kNumValues);
+	while (state.KeepRunning()) {
+		for (int i = 0; i < kNumValues; ++i) {
+			CmnLib::ts::DoNotOptimize(CmnLib::text::NumberConversion::format(
+				buf, buf + sizeof(buf), i * 7919).ptr);
+		}
+	}
+}
+
+CL_BENCHMARK(snprintf_format_int) {
+	char buf[32];
+	state.set_items_per_iteration(kNumValues);
+	while (state.KeepRunning()) {
+		for (int i = 0; i < kNumValues; ++i) {
+			CmnLib::ts::DoNotOptimize(snprintf(buf, sizeof(buf), "%d", i * 7919));
+		}
+	}
+}
+
+}  // namespace anonymous
+
+CL_BENCHMARK_MAIN();
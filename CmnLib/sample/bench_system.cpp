@@ -0,0 +1,56 @@
+/**
+* @file bench_system.cpp
+* @brief Benchmark of the clock and of the profiling zones.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include "ts/inc/ts/benchmark.hpp"
+#include "system/inc/system/system_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+CL_BENCHMARK(TimeManager_now_ns) {
+	while (state.KeepRunning()) {
+		CmnLib::ts::DoNotOptimize(CmnLib::system::TimeManager::now_ns());
+	}
+}
+
+CL_BENCHMARK(ScopedTimer_disabled) {
+	CmnLib::system::Profiler::Enable(false);
+	while (state.KeepRunning()) {
+		CL_PROFILE_ZONE("disabled");
+	}
+}
+
+CL_BENCHMARK(ScopedTimer_enabled) {
+	CmnLib::system::Profiler::Reset();
+	CmnLib::system::Profiler::Enable(true);
+	while (state.KeepRunning()) {
+		CL_PROFILE_ZONE("enabled");
+	}
+	CmnLib::system::Profiler::Enable(false);
+	CmnLib::system::Profiler::Reset();
+}
+
+}  // namespace anonymous
+
+CL_BENCHMARK_MAIN();
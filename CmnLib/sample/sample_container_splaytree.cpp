@@ -0,0 +1,92 @@
+/**
+ * @file sample_container_splaytree.cpp
+ * @brief Example of the generic splay tree.
+ *
+ * @section LICENSE
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF 
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ * @author  Ritecs Inc. - Alessandro Moro <alessandromoro.italy@ritecs.co.jp>
+ * @bug No known bugs.
+ * @version 1.1.0.0
+ * 
+ */
+
+#include <iostream>
+#include <string>
+#include "container/inc/container/container_headers.hpp"
+//#include "ts.hpp"
+
+namespace
+{
+
+typedef CmnLib::container::SplayTree<int, std::string> Tree;
+
+/** @brief Print the tree in key order.
+*/
+void print(const Tree &tree)
+{
+	for (Tree::const_iterator it = tree.begin(); it != tree.end(); ++it) {
+		std::cout << it->first << ":" << it->second << " ";
+	}
+	std::cout << "(size: " << tree.size() << ")" << std::endl;
+}
+
+/** @brief Function to test the splay tree.
+
+	Function to test the splay tree.
+*/
+void test()
+{
+	Tree tree;
+	int keys[10] = { 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 };
+	for (int i = 0; i < 10; i++) {
+		tree[keys[i]] = std::string(1, (char)('a' + keys[i]));
+	}
+	std::cout << "InOrder: ";
+	print(tree);
+
+	tree.erase(4);
+	std::cout << "After Delete 4: ";
+	print(tree);
+
+	Tree::iterator it = tree.find(7);
+	std::cout << "Search 7: " << (it != tree.end() ? it->second : "none") <<
+		std::endl;
+	it = tree.find(4);
+	std::cout << "Search 4: " << (it != tree.end() ? it->second : "none") <<
+		std::endl;
+
+	std::cout << "Range [3, 7): ";
+	std::pair<Tree::iterator, Tree::iterator> r = tree.range(3, 7);
+	for (it = r.first; it != r.second; ++it) std::cout << it->first << " ";
+	std::cout << std::endl;
+}
+
+}	// namespace
+
+#ifdef CMNLIB
+
+CMNLIB_TEST_MAIN(&test, "data\\MemoryLeakCPP.txt", "data\\MemoryLeakC.txt");
+
+#else
+
+/** main
+*/
+int main()
+{
+	std::cout << "Sample container splay tree" << std::endl;
+	test();
+	return 0;
+}
+
+#endif
@@ -0,0 +1,63 @@
+/**
+* @file sample_control_binarylogdecoder.cpp
+* @brief Decode the files written by CmnLib::control::BinaryLog.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include <fstream>
+#include <iostream>
+
+#include "control/inc/control/control_headers.hpp"
+
+/** main
+	Usage: sample_control_binarylogdecoder file.clog [... file.clog] [-o out.txt]
+*/
+int main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		std::cout << "Usage: " << argv[0] <<
+			" file.clog [... file.clog] [-o out.txt]" << std::endl;
+		return 1;
+	}
+	std::ofstream fout;
+	std::ostream* out = &std::cout;
+	for (int i = 1; i + 1 < argc; ++i) {
+		if (std::string(argv[i]) == "-o") {
+			fout.open(argv[i + 1]);
+			if (!fout.is_open()) {
+				std::cerr << "Unable to open " << argv[i + 1] << std::endl;
+				return 1;
+			}
+			out = &fout;
+		}
+	}
+	int result = 0;
+	for (int i = 1; i < argc; ++i) {
+		if (std::string(argv[i]) == "-o") {
+			++i;
+			continue;
+		}
+		if (CmnLib::control::BinaryLogDecoder::Decode(argv[i], *out) < 0) {
+			std::cerr << argv[i] << " is not a binary log" << std::endl;
+			result = 1;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,161 @@
+/**
+* @file test_binarylog.cpp
+* @brief Compare the text and the binary log sinks and decode the binary files.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "ts/inc/ts/ts.hpp"
+#include "cmnlibcore/inc/cmnlibcore/cmnlibcore_headers.hpp"
+#include "control/inc/control/control_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+const int kNumMessages = 200000;
+const int kNumThreads = 4;
+
+/** @brief Time the text log and the binary log with the same messages.
+*/
+void test_speed() {
+	auto start = std::chrono::steady_clock::now();
+	{
+		CmnLib::control::Log log(std::string("SampleLogText.txt"), false);
+		char msg[256];
+		for (int i = 0; i < kNumMessages; ++i) {
+			sprintf(msg, "frame %d point %f name %s", i, i * 0.5, "camera");
+			log + msg;
+		}
+	}
+	double text_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	{
+		CmnLib::control::BinaryLog log("SampleLogBinary", (size_t)1 << 26);
+		for (int i = 0; i < kNumMessages; ++i) {
+			CL_BINLOG(log, CmnLib::control::LogLevel::Info,
+				"frame %d point %f name %s", i, i * 0.5, "camera");
+		}
+	}
+	double binary_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "messages: " << kNumMessages << " text Log: " << text_ms <<
+		" ms BinaryLog: " << binary_ms << " ms" << std::endl;
+	std::remove("SampleLogText.txt");
+	std::remove(CmnLib::control::BinaryLog::FileName("SampleLogBinary", 0).c_str());
+}
+
+/** @brief Write from several threads in small rotated files and decode them.
+*/
+void test_rotation() {
+	const int kMaxFiles = 3;
+	const int kPerThread = 2000;
+	{
+		CmnLib::control::BinaryLog log("SampleLogRotate", 1 << 16, kMaxFiles);
+		log.set_level(CmnLib::control::LogLevel::Debug);
+		std::vector<std::thread> threads;
+		for (int t = 0; t < kNumThreads; ++t) {
+			threads.push_back(std::thread([&log, t]() {
+				for (int i = 0; i < kPerThread; ++i) {
+					CL_BINLOG(log, CmnLib::control::LogLevel::Debug,
+						"thread %d message %u value %.3f", t, (unsigned)i, i / 3.0);
+				}
+			}));
+		}
+		for (auto &th : threads) th.join();
+		CL_BINLOG(log, CmnLib::control::LogLevel::Error, "last %s %p",
+			std::string("message"), (void*)&log);
+	}
+
+	// only the last files are kept, every one can be decoded alone
+	int num_files = 0, num_messages = 0;
+	std::string last;
+	for (int index = 0; ; ++index) {
+		std::string filename =
+			CmnLib::control::BinaryLog::FileName("SampleLogRotate", index);
+		std::ostringstream out;
+		int n = CmnLib::control::BinaryLogDecoder::Decode(filename, out);
+		if (n < 0) {
+			// removed by the rotation
+			if (num_files == 0) continue;
+			break;
+		}
+		++num_files;
+		num_messages += n;
+		last = out.str();
+		std::remove(filename.c_str());
+	}
+	std::cout << "rotated files kept: " << num_files << " (max " << kMaxFiles <<
+		") messages: " << num_messages << std::endl;
+	size_t pos = last.rfind("[ERROR]");
+	if (pos != std::string::npos) std::cout << last.substr(pos);
+
+}
+
+/** @brief Decode the width and precision given as arguments (*) and %c.
+*/
+void test_format() {
+	{
+		CmnLib::control::BinaryLog log("SampleLogFormat", 1 << 16);
+		CL_BINLOG(log, CmnLib::control::LogLevel::Info,
+			"[%*d] [%-*d] [%.*f] [%c] [%.*s]", 5, 42, 4, 7, 2, 3.14159, 'x',
+			3, "abcdef");
+	}
+	std::string filename =
+		CmnLib::control::BinaryLog::FileName("SampleLogFormat", 0);
+	std::ostringstream out;
+	CmnLib::control::BinaryLogDecoder::Decode(filename, out);
+	std::remove(filename.c_str());
+	bool ok = out.str().find("[   42] [7   ] [3.14] [x] [abc]") !=
+		std::string::npos;
+	std::cout << "format with * and %c: " << ok << std::endl;
+}
+
+/** @brief A file which cannot be created is reported and the messages are
+	counted as dropped.
+*/
+void test_open_error() {
+	CmnLib::control::BinaryLog log("nonexistent_dir/SampleLog", 1 << 16);
+	CL_BINLOG(log, CmnLib::control::LogLevel::Info, "lost %d", 1);
+	CL_BINLOG(log, CmnLib::control::LogLevel::Info, "lost %d", 2);
+	std::cout << "open failed: " << !log.is_open() << " dropped: " <<
+		log.dropped() << std::endl;
+}
+
+/** @brief Run the tests
+*/
+void test() {
+	test_speed();
+	test_rotation();
+	test_format();
+	test_open_error();
+}
+
+}  // namespace anonymous
+
+CMNLIB_TEST_MAIN(&test, "MemoryLeakCPP.txt", "MemoryLeakC.txt");
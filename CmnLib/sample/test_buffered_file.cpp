@@ -0,0 +1,123 @@
+/**
+* @file test_buffered_file.cpp
+* @brief Test the buffered output file.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.0.0
+*
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "ts/inc/ts/ts.hpp"
+#include "cmnlibcore/inc/cmnlibcore/cmnlibcore_headers.hpp"
+#include "system/inc/system/system_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+/** @brief Write lines with all the ways to add bytes.
+*/
+bool write(const char* filename, bool background, bool sync,
+	size_t buffer_size, std::string &expected) {
+	CmnLib::system::BufferedFile file;
+	if (!file.open(filename, false, buffer_size, background, sync)) return false;
+	expected.clear();
+	for (int i = 0; i < 20000; ++i) {
+		std::string line = std::to_string(i) + " " + std::to_string(i * 3);
+		switch (i % 3) {
+		case 0:
+			file.write(line.data(), line.size());
+			break;
+		case 1:
+			for (char c : line) file.put(c);
+			break;
+		default:
+			char* p = file.reserve(line.size());
+			memcpy(p, line.data(), line.size());
+			file.commit(p + line.size());
+		}
+		file.put('\n');
+		expected += line + "\n";
+	}
+	return file.close();
+}
+
+/** @brief The file has the same bytes in all the modes.
+*/
+void test_modes() {
+	const char* filename = "test_buffered_file.txt";
+	for (int mode = 0; mode < 4; ++mode) {
+		bool background = (mode & 1) != 0, sync = (mode & 2) != 0;
+		std::string expected;
+		// a small buffer: many writes and swaps
+		bool closed = write(filename, background, sync, 1000, expected);
+		std::ifstream f(filename, std::ios::binary);
+		std::stringstream ss;
+		ss << f.rdbuf();
+		f.close();
+		std::cout << "background: " << background << " sync: " << sync <<
+			" closed: " << closed << " same content: " <<
+			(ss.str() == expected) << std::endl;
+	}
+	remove(filename);
+}
+
+/** @brief Append and errors, the writes to a file not open.
+*/
+void test_append() {
+	const char* filename = "test_buffered_file_append.txt";
+	CmnLib::system::BufferedFile file;
+	file.open(filename);
+	file.write("first\n", 6);
+	file.close();
+	file.open(filename, true);
+	file.write("second\n", 7);
+	file.close();
+	std::ifstream f(filename, std::ios::binary);
+	std::stringstream ss;
+	ss << f.rdbuf();
+	f.close();
+	std::cout << "append: " << (ss.str() == "first\nsecond\n") << std::endl;
+	remove(filename);
+	std::cout << "bad path: " <<
+		!file.open("test_buffered_file_missing/dir/file.txt") << std::endl;
+	// the bytes are dropped
+	file.put('x');
+	file.write("lost\n", 5);
+	char* p = file.reserve(1000);
+	memset(p, ' ', 1000);
+	file.commit(p + 1000);
+	file.flush();
+	std::cout << "write not open: good " << file.good() << std::endl;
+}
+
+/** @brief Run the tests
+*/
+void test() {
+	test_modes();
+	test_append();
+}
+
+}  // namespace anonymous
+
+CMNLIB_TEST_MAIN(&test, "MemoryLeakCPP.txt", "MemoryLeakC.txt");
@@ -21,6 +21,10 @@
 *
 */
 
+#include <chrono>
+#include <map>
+#include <vector>
+
 #include "ts/inc/ts/ts.hpp"
 #include "cmnlibcore/inc/cmnlibcore/cmnlibcore_headers.hpp"
 #include "container/inc/container/container_headers.hpp"
@@ -97,6 +101,93 @@ void test_ContainerNearestKey() {
 	  res << " value: " << value << std::endl;
 }
 
+/** @brief Compare the map, sorted vector and flat map lookups with a
+	linear scan, and time them on a long history of timestamps.
+*/
+void test_ContainerNearestKey_history() {
+  typedef CmnLib::container::ContainerNearestKey<double, int> NearestKey;
+  const int kHistory = 100000;
+  const int kQueries = 10000;
+  const double kTolerance = 0.02;
+
+  std::map<double, int> m_data;
+  std::vector< std::pair<double, int> > v_data;
+  CmnLib::container::ContainerFlatMap<double, int> f_data;
+  f_data.reserve(kHistory);
+  double t = 0;
+  for (int i = 0; i < kHistory; ++i) {
+    t += 0.01 + 0.03 * ((double)std::rand() / RAND_MAX);
+    m_data[t] = i;
+    v_data.push_back(std::make_pair(t, i));
+    f_data.insert(t, i);
+  }
+  std::vector<double> queries;
+  for (int i = 0; i < kQueries; ++i) {
+    queries.push_back(t * i / kQueries);
+  }
+
+  // the results must match the linear scan
+  int mismatches = 0;
+  for (int i = 0; i < kQueries; i += 97) {
+    int v_linear = -1, v_map = -1, v_sorted = -1, v_flat = -1;
+    bool r_linear = NearestKey::get_value(v_data, queries[i], kTolerance,
+      v_linear);
+    bool r_map = NearestKey::get_value(m_data, queries[i], kTolerance, v_map);
+    bool r_sorted = NearestKey::get_value_sorted(v_data, queries[i],
+      kTolerance, v_sorted);
+    bool r_flat = NearestKey::get_value(f_data, queries[i], kTolerance, v_flat);
+    if (r_linear != r_map || r_linear != r_sorted || r_linear != r_flat ||
+      (r_linear && (v_linear != v_map || v_linear != v_sorted ||
+      v_linear != v_flat))) ++mismatches;
+  }
+  std::vector<int> out_map, out_sorted, out_flat;
+  std::vector<bool> found_map, found_sorted, found_flat;
+  int n_map = NearestKey::get_values(m_data, queries, kTolerance, out_map,
+    found_map);
+  int n_sorted = NearestKey::get_values_sorted(v_data, queries, kTolerance,
+    out_sorted, found_sorted);
+  int n_flat = NearestKey::get_values(f_data, queries, kTolerance, out_flat,
+    found_flat);
+  for (int i = 0; i < kQueries; ++i) {
+    int v = -1;
+    bool r = NearestKey::get_value(m_data, queries[i], kTolerance, v);
+    if (r != found_map[i] || r != found_sorted[i] || r != found_flat[i] ||
+      (r && (v != out_map[i] || v != out_sorted[i] || v != out_flat[i])))
+      ++mismatches;
+  }
+  std::cout << "history: " << kHistory << " queries: " << kQueries <<
+    " found: " << n_map << " " << n_sorted << " " << n_flat <<
+    " mismatches: " << mismatches << std::endl;
+
+  // timing
+  int sum = 0, v = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kQueries; i += 100) {
+    if (NearestKey::get_value(v_data, queries[i], kTolerance, v)) sum += v;
+  }
+  double linear_ms = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start).count() * 100;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kQueries; ++i) {
+    if (NearestKey::get_value(m_data, queries[i], kTolerance, v)) sum += v;
+  }
+  double map_ms = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kQueries; ++i) {
+    if (NearestKey::get_value(f_data, queries[i], kTolerance, v)) sum += v;
+  }
+  double flat_ms = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  NearestKey::get_values(f_data, queries, kTolerance, out_flat, found_flat);
+  double batch_ms = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start).count();
+  std::cout << "linear (estimated): " << linear_ms << " ms map: " << map_ms <<
+    " ms flat map: " << flat_ms << " ms flat map batch: " << batch_ms <<
+    " ms (" << sum << ")" << std::endl;
+}
+
 /** @brief Test the ContainerCoreOperations
 */
 void test_ContainerCoreOperations() {
@@ -159,6 +250,7 @@ void test_ContainerCoreOperations() {
 void test()	{
   std::cout << "Container" << std::endl;
   test_ContainerNearestKey();
+  test_ContainerNearestKey_history();
   test_ContainerCoreOperations();
 }
 
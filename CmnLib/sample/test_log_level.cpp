@@ -0,0 +1,105 @@
+/**
+* @file test_log_level.cpp
+* @brief Cost of a suppressed LogMS call (compile time and run time filtering).
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include <chrono>
+#include <cstdio>
+
+#include "ts/inc/ts/ts.hpp"
+#include "cmnlibcore/inc/cmnlibcore/cmnlibcore_headers.hpp"
+#include "control/inc/control/control_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+const int kNumCalls = 10000000;
+
+/** @brief Time (ns) of a call of func.
+*/
+template <typename _Func>
+double time_call(_Func func) {
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < kNumCalls; ++i) func(i);
+	return std::chrono::duration<double, std::nano>(
+		std::chrono::steady_clock::now() - start).count() / kNumCalls;
+}
+
+/** @brief Argument which counts its evaluations.
+*/
+int g_evaluations = 0;
+int evaluate(int i) {
+	++g_evaluations;
+	return i;
+}
+
+/** @brief Measure the suppressed and the enabled log calls.
+*/
+void test() {
+	std::cout << "CMNLIB_LOG_MIN_LEVEL: " << CMNLIB_LOG_MIN_LEVEL << std::endl;
+	CmnLib::control::LogMS::ResetLogLevel(CmnLib::control::LogLevel::Error);
+
+	double debug_ns = time_call([](int i) {
+		CmnLib::control::LogMS::Debug("debug %d %f\n", i, i * 0.5);
+	});
+	double info_ns = time_call([](int i) {
+		CmnLib::control::LogMS::Info("info %d %f\n", i, i * 0.5);
+	});
+	// Reference: the formatting which the old Write did before the check
+	char buf[256];
+	double format_ns = time_call([&buf](int i) {
+		snprintf(buf, sizeof(buf), "info %d %f\n", i, i * 0.5);
+	});
+	std::cout << "suppressed Debug: " << debug_ns << " ns" << std::endl;
+	std::cout << "suppressed Info (run time level): " << info_ns << " ns" <<
+		std::endl;
+	std::cout << "snprintf of the message: " << format_ns << " ns (" <<
+		buf[0] << ")" << std::endl;
+
+	// The macros do not evaluate the arguments of a suppressed message
+	CmnLib::control::LoggerMS logger(CmnLib::control::LogLevel::Error);
+	CMNLIB_LOG_DEBUG("debug %d\n", evaluate(1));
+	CMNLIB_LOG_INFO("info %d\n", evaluate(2));
+	CMNLIB_LOGGER_INFO(logger, "info %d\n", evaluate(3));
+	std::cout << "arguments evaluated by the suppressed macros: " <<
+		g_evaluations << " (expected 0)" << std::endl;
+	double macro_ns = time_call([](int i) {
+		CMNLIB_LOG_INFO("info %d %f\n", evaluate(i), i * 0.5);
+	});
+	std::cout << "suppressed CMNLIB_LOG_INFO: " << macro_ns << " ns" <<
+		std::endl;
+
+	// Enabled messages share the cached timestamp
+	CmnLib::control::LogMS::ResetLogLevel(CmnLib::control::LogLevel::Debug);
+	CmnLib::control::LogMS::Debug("debug is %s\n",
+		CmnLib::control::LogMS::IsEnabled(CmnLib::control::LogLevel::Debug) ?
+		"enabled" : "compiled out");
+	CmnLib::control::LogMS::Error("error %d\n", 1);
+	CmnLib::control::LogMS::Error("error %d\n", 2);
+	CMNLIB_LOG_ERROR("error %d\n", evaluate(3));
+	std::cout << "arguments evaluated by the enabled macro: " <<
+		g_evaluations << " (expected 1)" << std::endl;
+}
+
+}  // namespace anonymous
+
+CMNLIB_TEST_MAIN(&test, "MemoryLeakCPP.txt", "MemoryLeakC.txt");
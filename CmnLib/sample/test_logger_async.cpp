@@ -0,0 +1,207 @@
+/* @file test_logger_async.cpp
+ * @brief Compare the synchronous and the asynchronous Logger with a slow listener.
+ *
+ * @section LICENSE
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @author  Unknwon
+ * @modify Alessandro Moro <alessandromoro.italy@gmail.com>
+ * @bug none
+ * @version 1.1.1.0
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "ts/inc/ts/ts.hpp"
+#include "cmnlibcore/inc/cmnlibcore/cmnlibcore_headers.hpp"
+#include "control/inc/control/control_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+const int kNumThreads = 4;
+const int kNumMessages = 500;
+
+/** @brief Listener which takes some time for every message (as a file on a
+	slow disk).
+*/
+class SlowListener : public CmnLib::control::Logger::Listener
+{
+public:
+
+	SlowListener() : 
+		CmnLib::control::Logger::Listener(LISTEN_FOR_ALL), num_reports_(0),
+		num_batches_(0) {}
+
+	int num_reports() const { return num_reports_; }
+	int num_batches() const { return num_batches_; }
+
+	void EndBatch() { ++num_batches_; }
+
+private:
+
+	void Report(std::string const&) {
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+		++num_reports_;
+	}
+
+	std::atomic<int> num_reports_;
+	std::atomic<int> num_batches_;
+};
+
+/** @brief Log from several threads, return the time spent by the threads
+	(ms).
+*/
+double log_from_threads() {
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (int t = 0; t < kNumThreads; ++t) {
+		threads.push_back(std::thread([t]() {
+			for (int i = 0; i < kNumMessages; ++i) {
+				LogInformation("thread " + std::to_string(t) + " message " +
+					std::to_string(i));
+			}
+		}));
+	}
+	for (auto &th : threads) th.join();
+	return std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+/** @brief Logs in its destructor, which runs after the ring of the thread
+	is retired.
+*/
+struct LogAtExit {
+	~LogAtExit() { LogInformation("thread_local destructor"); }
+};
+
+/** @brief A message logged after the ring of the thread is released is
+	reported synchronously.
+*/
+void test_thread_exit() {
+	SlowListener listener;
+	CmnLib::control::Logger::Subscribe(&listener);
+	CmnLib::control::Logger::StartAsync();
+	std::thread([]() {
+		// constructed before the ring: destroyed after
+		thread_local LogAtExit at_exit;
+		(void)at_exit;
+		LogInformation("thread message");
+	}).join();
+	CmnLib::control::Logger::StopAsync();
+	CmnLib::control::Logger::Unsubscribe(&listener);
+	std::cout << "thread exit reports: " << listener.num_reports() <<
+		"/2" << std::endl;
+}
+
+/** @brief A child process logs and crashes: the crash handler writes the
+	queued record on a pipe and the child still dies of the signal.
+*/
+void test_crash_handler() {
+#if !defined(_WIN32)
+	int fds[2];
+	if (pipe(fds) != 0) return;
+	pid_t pid = fork();
+	if (pid == 0) {
+		close(fds[0]);
+		SlowListener listener;
+		CmnLib::control::Logger::Subscribe(&listener);
+		CmnLib::control::Logger::StartAsync(
+			CmnLib::control::Logger::OVERFLOW_BLOCK, 4096);
+		CmnLib::control::Logger::InstallCrashHandler(fds[1]);
+		for (int i = 0; i < 1000; ++i) {
+			LogError("before the crash " + std::to_string(i));
+		}
+		std::raise(SIGSEGV);
+		_exit(0);
+	}
+	close(fds[1]);
+	std::string output;
+	char buffer[4096];
+	ssize_t n;
+	while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) {
+		output.append(buffer, (size_t)n);
+	}
+	close(fds[0]);
+	int status = 0;
+	waitpid(pid, &status, 0);
+	std::cout << "crash handler: signal " <<
+		(WIFSIGNALED(status) ? WTERMSIG(status) : 0) << " (expected " <<
+		SIGSEGV << ") last record written: " <<
+		(output.find("before the crash 999\n") != std::string::npos) <<
+		std::endl;
+#endif
+}
+
+/** @brief Run the tests
+*/
+void test() {
+	const int kExpected = kNumThreads * kNumMessages;
+	{
+		SlowListener listener;
+		CmnLib::control::Logger::Subscribe(&listener);
+		double ms = log_from_threads();
+		CmnLib::control::Logger::Unsubscribe(&listener);
+		std::cout << "sync: " << ms << " ms reports: " <<
+			listener.num_reports() << "/" << kExpected << std::endl;
+	}
+	{
+		SlowListener listener;
+		CmnLib::control::Logger::Subscribe(&listener);
+		CmnLib::control::Logger::StartAsync(
+			CmnLib::control::Logger::OVERFLOW_BLOCK, 4096);
+		double ms = log_from_threads();
+		auto start = std::chrono::steady_clock::now();
+		CmnLib::control::Logger::Flush();
+		double flush_ms = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+		CmnLib::control::Logger::StopAsync();
+		CmnLib::control::Logger::Unsubscribe(&listener);
+		std::cout << "async (block): " << ms << " ms, flush: " << flush_ms <<
+			" ms reports: " << listener.num_reports() << "/" << kExpected <<
+			" batches: " << listener.num_batches() << std::endl;
+	}
+	{
+		SlowListener listener;
+		CmnLib::control::Logger::Subscribe(&listener);
+		CmnLib::control::Logger::StartAsync(
+			CmnLib::control::Logger::OVERFLOW_DROP, 64);
+		double ms = log_from_threads();
+		CmnLib::control::Logger::StopAsync();
+		CmnLib::control::Logger::Unsubscribe(&listener);
+		std::cout << "async (drop): " << ms << " ms reports: " <<
+			listener.num_reports() << " dropped: " <<
+			CmnLib::control::Logger::GetNumDropped() << " total: " <<
+			listener.num_reports() +
+			CmnLib::control::Logger::GetNumDropped() << "/" << kExpected <<
+			std::endl;
+	}
+	test_thread_exit();
+	test_crash_handler();
+}
+
+}  // namespace anonymous
+
+CMNLIB_TEST_MAIN(&test, "MemoryLeakCPP.txt", "MemoryLeakC.txt");
@@ -0,0 +1,85 @@
+/**
+* @file test_mapped_file.cpp
+* @brief Test the read-only memory mapping of a file.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.0.0
+*
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "ts/inc/ts/ts.hpp"
+#include "cmnlibcore/inc/cmnlibcore/cmnlibcore_headers.hpp"
+#include "system/inc/system/system_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+/** @brief The mapping has the content of the file.
+*/
+void test_content() {
+	const char* filename = "test_mapped_file.txt";
+	std::string content;
+	for (int i = 0; i < 100000; ++i) content += std::to_string(i) + "\n";
+	{
+		std::ofstream f(filename, std::ios::binary);
+		f << content;
+	}
+	CmnLib::system::MappedFile file;
+	bool opened = file.open(filename);
+	std::cout << "open: " << opened << " size: " << file.size() <<
+		" expected: " << content.size() << std::endl;
+	std::cout << "same content: " << (opened && file.size() == content.size() &&
+		memcmp(file.data(), content.data(), content.size()) == 0) << std::endl;
+	file.close();
+	std::cout << "closed: " << !file.is_open() << " " << (file.data() == 0) <<
+		std::endl;
+	remove(filename);
+}
+
+/** @brief Empty and missing files.
+*/
+void test_limits() {
+	const char* filename = "test_mapped_file_empty.txt";
+	{
+		std::ofstream f(filename);
+	}
+	CmnLib::system::MappedFile file;
+	bool opened = file.open(filename);
+	std::cout << "empty file: " << opened << " size: " << file.size() <<
+		" data: " << (file.data() == 0) << std::endl;
+	file.close();
+	remove(filename);
+	std::cout << "missing file: " << !file.open("test_mapped_file_missing.txt") <<
+		std::endl;
+}
+
+/** @brief Run the tests
+*/
+void test() {
+	test_content();
+	test_limits();
+}
+
+}  // namespace anonymous
+
+CMNLIB_TEST_MAIN(&test, "MemoryLeakCPP.txt", "MemoryLeakC.txt");
@@ -0,0 +1,135 @@
+/**
+* @file test_memory_arena.cpp
+* @brief Test the arenas used by CmnLib::core::Allocator with the STL containers.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include <chrono>
+#include <map>
+#include <vector>
+
+#include "ts/inc/ts/ts.hpp"
+#include "cmnlibcore/inc/cmnlibcore/cmnlibcore_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+const int kNumFrames = 100;
+const int kNumNodes = 10000;
+
+typedef CmnLib::core::Allocator< std::pair<const int, float> > MapAllocator;
+typedef std::map<int, float, std::less<int>, MapAllocator> ArenaMap;
+typedef std::vector<float, CmnLib::core::Allocator<float> > ArenaVector;
+
+/** @brief Build a map and a vector as a frame of the pipeline would do.
+*/
+template <typename _Map, typename _Vector>
+float fill_frame(_Map &m, _Vector &v, int frame) {
+	for (int i = 0; i < kNumNodes; ++i) {
+		m[(i * 7919 + frame) % (kNumNodes * 2)] = (float)i;
+		v.push_back((float)i);
+	}
+	float sum = 0;
+	for (auto it = m.begin(); it != m.end(); ++it) sum += it->second;
+	return sum + v.back();
+}
+
+/** @brief Test the arena behavior.
+*/
+void test_arena() {
+	CmnLib::core::MonotonicArena arena(1 << 12);
+	void* a = arena.allocate(100, 16);
+	void* b = arena.allocate(10000, 64);
+	std::cout << "MonotonicArena aligned: " <<
+		(((size_t)a % 16) == 0 && ((size_t)b % 64) == 0) <<
+		" used: " << arena.used() << " capacity: " << arena.capacity() <<
+		std::endl;
+	size_t capacity = arena.capacity();
+	arena.reset();
+	void* c = arena.allocate(100, 16);
+	std::cout << "MonotonicArena reset reuses chunks: " <<
+		(c == a && arena.capacity() == capacity) << std::endl;
+
+	CmnLib::core::NodePool pool;
+	void* n0 = pool.allocate(40, 8);
+	pool.deallocate(n0, 40, 8);
+	void* n1 = pool.allocate(48, 8);
+	std::cout << "NodePool recycles nodes: " << (n0 == n1) << std::endl;
+}
+
+/** @brief Compare the per-frame cost of the system allocator and the arenas.
+*/
+void test_frames() {
+	float check = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int f = 0; f < kNumFrames; ++f) {
+		std::map<int, float> m;
+		std::vector<float> v;
+		check += fill_frame(m, v, f);
+	}
+	double std_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	CmnLib::core::NodePool pool;
+	start = std::chrono::steady_clock::now();
+	for (int f = 0; f < kNumFrames; ++f) {
+		{
+			MapAllocator alloc(&pool);
+			ArenaMap m(std::less<int>(), alloc);
+			ArenaVector v(alloc);
+			check += fill_frame(m, v, f);
+		}
+		pool.reset();
+	}
+	double pool_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	CmnLib::core::MonotonicArena arena;
+	start = std::chrono::steady_clock::now();
+	for (int f = 0; f < kNumFrames; ++f) {
+		{
+			MapAllocator alloc(&arena);
+			ArenaMap m(std::less<int>(), alloc);
+			ArenaVector v(alloc);
+			check += fill_frame(m, v, f);
+		}
+		arena.reset();
+	}
+	double arena_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "frames: " << kNumFrames << " nodes: " << kNumNodes <<
+		" std::allocator: " << std_ms << " ms NodePool: " << pool_ms <<
+		" ms MonotonicArena: " << arena_ms << " ms (" << check << ")" <<
+		std::endl;
+}
+
+/** @brief Run the tests
+*/
+void test() {
+	test_arena();
+	test_frames();
+}
+
+}  // namespace anonymous
+
+CMNLIB_TEST_MAIN(&test, "MemoryLeakCPP.txt", "MemoryLeakC.txt");
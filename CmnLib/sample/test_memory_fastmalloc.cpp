@@ -0,0 +1,157 @@
+/**
+* @file test_memory_fastmalloc.cpp
+* @brief Benchmark of the thread-caching allocator against the system malloc.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "ts/inc/ts/ts.hpp"
+#include "cmnlibcore/inc/cmnlibcore/cmnlibcore_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+const int kNumObjects = 20000;
+const int kNumRounds = 50;
+
+/** @brief Allocator under test.
+*/
+struct AllocatorUnderTest
+{
+	const char* name;
+	void* (*alloc)(size_t);
+	void (*release)(void*);
+};
+
+void* system_malloc(size_t size) { return malloc(size); }
+void system_free(void* ptr) { free(ptr); }
+
+/** @brief Object size in [8, 512] bytes, skewed toward the small sizes.
+*/
+size_t object_size(unsigned int &seed) {
+	seed = seed * 1664525u + 1013904223u;
+	unsigned int r = seed >> 16;
+	return (r & 3) ? 8 + (r % 56) : 8 + (r % 504);
+}
+
+/** @brief Every thread allocates and releases its own objects.
+*/
+double bench_local(const AllocatorUnderTest &a, int num_threads) {
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (int t = 0; t < num_threads; ++t) {
+		threads.push_back(std::thread([&a, t]() {
+			std::vector<void*> objects(kNumObjects);
+			unsigned int seed = 17u + t;
+			for (int r = 0; r < kNumRounds; ++r) {
+				for (int i = 0; i < kNumObjects; ++i) {
+					size_t size = object_size(seed);
+					objects[i] = a.alloc(size);
+					memset(objects[i], i, 8);
+				}
+				for (int i = kNumObjects - 1; i >= 0; --i) {
+					a.release(objects[i]);
+				}
+			}
+		}));
+	}
+	for (auto &th : threads) th.join();
+	return std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+/** @brief Objects are released by a different thread than the one which
+	allocated them (producer/consumer pipeline).
+*/
+double bench_remote(const AllocatorUnderTest &a, int num_threads) {
+	std::vector< std::vector<void*> > objects(num_threads,
+		std::vector<void*>(kNumObjects, NULLPTR));
+	double elapsed = 0;
+	for (int r = 0; r < kNumRounds; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		std::vector<std::thread> threads;
+		for (int t = 0; t < num_threads; ++t) {
+			threads.push_back(std::thread([&a, &objects, t, r, num_threads]() {
+				// Release what the neighbour allocated in the previous round
+				std::vector<void*> &other = objects[(t + 1) % num_threads];
+				if (r > 0) {
+					for (int i = 0; i < kNumObjects; ++i) {
+						a.release(other[i]);
+					}
+				}
+			}));
+		}
+		for (auto &th : threads) th.join();
+		threads.clear();
+		for (int t = 0; t < num_threads; ++t) {
+			threads.push_back(std::thread([&a, &objects, t, r]() {
+				unsigned int seed = 31u + t + r;
+				for (int i = 0; i < kNumObjects; ++i) {
+					objects[t][i] = a.alloc(object_size(seed));
+				}
+			}));
+		}
+		for (auto &th : threads) th.join();
+		elapsed += std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+	}
+	for (auto &v : objects) {
+		for (auto p : v) a.release(p);
+	}
+	return elapsed;
+}
+
+/** @brief Run the benchmark
+*/
+void test() {
+	AllocatorUnderTest allocators[] = {
+		{ "malloc", &system_malloc, &system_free },
+		{ "fastMalloc", &CmnLib::core::MemoryFoundations::fastMalloc,
+		  &CmnLib::core::MemoryFoundations::fastFree },
+		{ "binnedMalloc", &CmnLib::core::MemoryFoundations::binnedMalloc,
+		  &CmnLib::core::MemoryFoundations::binnedFree }
+	};
+
+	std::cout << "fastMalloc uses the " << (CL_USE_SYSTEM_MALLOC ?
+		"system" : "binned") << " allocator" << std::endl;
+	int max_threads = std::max(1, (int)std::thread::hardware_concurrency());
+	for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+		for (const auto &a : allocators) {
+			double local_ms = bench_local(a, num_threads);
+			double remote_ms = bench_remote(a, num_threads);
+			double ops = 2.0 * kNumObjects * kNumRounds * num_threads;
+			std::cout << "threads: " << num_threads << " " << a.name <<
+				" local: " << local_ms << " ms (" <<
+				ops / local_ms / 1000.0 << " Mops/s)" <<
+				" remote: " << remote_ms << " ms (" <<
+				ops / remote_ms / 1000.0 << " Mops/s)" << std::endl;
+		}
+	}
+}
+
+}  // namespace anonymous
+
+CMNLIB_TEST_MAIN(&test, "MemoryLeakCPP.txt", "MemoryLeakC.txt");
@@ -0,0 +1,152 @@
+/**
+* @file test_memory_stats.cpp
+* @brief Test the allocation statistics collected by fastMalloc/fastFree.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ts/inc/ts/ts.hpp"
+#include "cmnlibcore/inc/cmnlibcore/cmnlibcore_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+const int kNumThreads = 4;
+const int kNumObjects = 100000;
+
+/** @brief Blocks allocated by the worker threads and released by main.
+*/
+std::vector<void*>& leftover() {
+	static std::vector<void*> v;
+	return v;
+}
+
+/** @brief Allocate and release from several threads and check the counters.
+*/
+void test_counters() {
+	CmnLib::core::MemoryStats::Snapshot before =
+		CmnLib::core::MemoryStats::snapshot();
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < kNumThreads; ++t) {
+		threads.push_back(std::thread([]() {
+			std::vector<void*> objects(kNumObjects);
+			for (int i = 0; i < kNumObjects; ++i) {
+				objects[i] = CmnLib::core::MemoryFoundations::fastMalloc(
+					16 + (i % 64));
+			}
+			// leave one block to be released by the main thread
+			for (int i = 1; i < kNumObjects; ++i) {
+				CmnLib::core::MemoryFoundations::fastFree(objects[i]);
+			}
+			CmnLib::core::MemoryFoundations::fastFree(
+				CmnLib::core::MemoryFoundations::fastMalloc(1 << 20));
+			static std::mutex m;
+			std::lock_guard<std::mutex> lock(m);
+			leftover().push_back(objects[0]);
+		}));
+	}
+	for (auto &th : threads) th.join();
+
+	CmnLib::core::MemoryStats::Snapshot after =
+		CmnLib::core::MemoryStats::snapshot();
+	std::cout << "allocation calls: " <<
+		after.numAllocCalls - before.numAllocCalls <<
+		" (expected " << kNumThreads * (kNumObjects + 1) << ")" << std::endl;
+	std::cout << "live blocks: " << after.numBlocks - before.numBlocks <<
+		" (expected " << kNumThreads << ")" << std::endl;
+
+	for (auto p : leftover()) CmnLib::core::MemoryFoundations::fastFree(p);
+	leftover().clear();
+	after = CmnLib::core::MemoryStats::snapshot();
+	std::cout << "live blocks after release: " <<
+		after.numBlocks - before.numBlocks << " (expected 0)" << std::endl;
+	std::cout << "largest block: " << after.maxBlockSize << std::endl;
+}
+
+/** @brief Allocates in its destructor, which runs after the statistics of
+	the thread are released.
+*/
+struct AllocateAtExit {
+	~AllocateAtExit() {
+		CmnLib::core::MemoryFoundations::fastFree(
+			CmnLib::core::MemoryFoundations::fastMalloc(64));
+	}
+};
+
+/** @brief The allocations at the exit of a thread are still counted.
+*/
+void test_thread_exit() {
+	CmnLib::core::MemoryStats::Snapshot before =
+		CmnLib::core::MemoryStats::snapshot();
+	const int kNumExits = 100;
+	for (int t = 0; t < kNumExits; ++t) {
+		std::thread([]() {
+			// constructed before the first allocation: destroyed after
+			thread_local AllocateAtExit at_exit;
+			(void)at_exit;
+			CmnLib::core::MemoryFoundations::fastFree(
+				CmnLib::core::MemoryFoundations::fastMalloc(32));
+		}).join();
+	}
+	CmnLib::core::MemoryStats::Snapshot after =
+		CmnLib::core::MemoryStats::snapshot();
+	std::cout << "allocation calls at the exit: " <<
+		after.numAllocCalls - before.numAllocCalls << " (expected " <<
+		2 * kNumExits << ")" << std::endl;
+	std::cout << "live blocks at the exit: " <<
+		after.numBlocks - before.numBlocks << " (expected 0)" << std::endl;
+}
+
+/** @brief Measure the cost of recording an allocation and a release.
+*/
+void test_overhead() {
+	const int kNumCalls = 10000000;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < kNumCalls; ++i) {
+		CmnLib::core::MemoryStats::recordAlloc(32 + (i & 255), &kNumCalls);
+		CmnLib::core::MemoryStats::recordFree(32 + (i & 255));
+	}
+	double ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+	std::cout << "record alloc+free: " << ms * 1e6 / kNumCalls << " ns" <<
+		std::endl;
+}
+
+/** @brief Run the tests
+*/
+void test() {
+	std::cout << "statistics " << (CL_MEMORY_STATS ? "enabled" : "disabled") <<
+		", sampling 1 every " << CmnLib::core::MemoryStats::sampleRate() <<
+		std::endl;
+	test_counters();
+	test_thread_exit();
+	test_overhead();
+	CmnLib::core::MemoryStats::generateReport(std::cout);
+}
+
+}  // namespace anonymous
+
+CMNLIB_TEST_MAIN(&test, "MemoryLeakCPP.txt", "MemoryLeakC.txt");
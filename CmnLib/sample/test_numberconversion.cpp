@@ -0,0 +1,323 @@
+/**
+* @file test_numberconversion.cpp
+* @brief Test the locale-free number conversions and compare them with the streams.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include <cerrno>
+#include <chrono>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ts/inc/ts/ts.hpp"
+#include "cmnlibcore/inc/cmnlibcore/cmnlibcore_headers.hpp"
+#include "string/inc/string/string_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+typedef CmnLib::text::NumberConversion NumberConversion;
+
+const int kNumValues = 1000000;
+
+/** @brief Random double with a magnitude in [1e-max_exp, 1e+max_exp].
+*/
+double random_double(unsigned int &seed, int max_exp) {
+	seed = seed * 1664525u + 1013904223u;
+	double m = (double)(seed >> 8) / (1 << 24);
+	seed = seed * 1664525u + 1013904223u;
+	int e = (int)((seed >> 8) % (2 * max_exp)) - max_exp;
+	return (seed & 1 ? -m : m) * pow(10.0, e);
+}
+
+/** @brief The floating point conversions must give the same bits of strtod
+	(strtof for the floats).
+*/
+int check_floats() {
+	const char* formats[] = { "%.17g", "%.9g", "%.6g", "%e", "%f", "%.3f" };
+	int errors = 0;
+	unsigned int seed = 1;
+	char text[512];
+	for (int i = 0; i < 200000; ++i) {
+		double v = random_double(seed, 40);
+		snprintf(text, sizeof(text), formats[i % 6], v);
+		double expected = strtod(text, nullptr);
+		double d = 0;
+		NumberConversion::ParseResult r = NumberConversion::parse(text,
+			text + strlen(text), d);
+		if (r.error != NumberConversion::CONVERSION_OK ||
+			r.ptr != text + strlen(text) ||
+			memcmp(&d, &expected, sizeof(d)) != 0) ++errors;
+		float f = 0;
+		r = NumberConversion::parse(text, text + strlen(text), f);
+		errno = 0;
+		float expected_f = strtof(text, nullptr);
+		bool float_range = errno == ERANGE &&
+			(expected_f == 0 || fabs(expected_f) > 1);
+		if (float_range ?
+			r.error != NumberConversion::CONVERSION_OUT_OF_RANGE :
+			memcmp(&f, &expected_f, sizeof(f)) != 0) ++errors;
+		// round trip
+		NumberConversion::FormatResult fr = NumberConversion::format(text,
+			text + sizeof(text), v);
+		*fr.ptr = 0;
+		if (strtod(text, nullptr) != v) ++errors;
+		// shortest round trip
+		fr = NumberConversion::format_shortest(text, text + sizeof(text), v);
+		*fr.ptr = 0;
+		if (strtod(text, nullptr) != v) ++errors;
+		float fv = (float)(v * 1e-10);
+		fr = NumberConversion::format_shortest(text, text + sizeof(text), fv);
+		*fr.ptr = 0;
+		if (strtof(text, nullptr) != fv) ++errors;
+	}
+	// the shortest text is the one of %g with the first precision which
+	// reads back the float
+	for (int i = 0; i < 200000; ++i) {
+		float v = (float)random_double(seed, 10);
+		char expected[64];
+		for (int p = std::numeric_limits<float>::digits10;
+			p <= std::numeric_limits<float>::max_digits10; ++p) {
+			snprintf(expected, sizeof(expected), "%.*g", p, v);
+			if (strtof(expected, nullptr) == v) break;
+		}
+		NumberConversion::FormatResult fr = NumberConversion::format_shortest(
+			text, text + sizeof(text), v);
+		*fr.ptr = 0;
+		if (strcmp(text, expected) != 0) ++errors;
+	}
+	const float shortest[] = { 0.1f, 160.0f, 1e-5f, 16777216.0f, 999.9999f };
+	std::cout << "  shortest:";
+	for (size_t i = 0; i < sizeof(shortest) / sizeof(shortest[0]); ++i) {
+		NumberConversion::FormatResult fr = NumberConversion::format_shortest(
+			text, text + sizeof(text), shortest[i]);
+		*fr.ptr = 0;
+		std::cout << " " << text;
+	}
+	std::cout << std::endl;
+	// the double is halfway between two floats, the text is not
+	const char* ties[] = { "1.0000000596046448", "1.0000000596046447",
+		"16777217.000000001", "3.4028235e38" };
+	for (size_t i = 0; i < sizeof(ties) / sizeof(ties[0]); ++i) {
+		float f = 0;
+		if (NumberConversion::parse(ties[i], ties[i] + strlen(ties[i]),
+			f).error != NumberConversion::CONVERSION_OK ||
+			f != strtof(ties[i], nullptr)) ++errors;
+	}
+	// underflow to zero is out of range, the denormals are not
+	const char* tiny[] = { "1e-400", "-1e-400", "1e-310" };
+	for (size_t i = 0; i < 3; ++i) {
+		double d = 0;
+		if (NumberConversion::parse(tiny[i], tiny[i] + strlen(tiny[i]),
+			d).error != (i < 2 ? NumberConversion::CONVERSION_OUT_OF_RANGE :
+			NumberConversion::CONVERSION_OK)) ++errors;
+	}
+	float tiny_float = 0;
+	if (NumberConversion::parse(tiny[2], tiny[2] + strlen(tiny[2]),
+		tiny_float).error != NumberConversion::CONVERSION_OUT_OF_RANGE) {
+		++errors;
+	}
+	const char* special[] = { "1e400", "-1e400", "inf", "-nan", "1e-400",
+		"12345678901234567890123", "0.000000000000000000000000000123",
+		"1.", ".5", "1e", "-", ".", "+7", "0x10" };
+	for (size_t i = 0; i < sizeof(special) / sizeof(special[0]); ++i) {
+		double d = 0;
+		NumberConversion::ParseResult r = NumberConversion::parse(special[i],
+			special[i] + strlen(special[i]), d);
+		std::cout << "  \"" << special[i] << "\" -> " << d << " error: " <<
+			r.error << " used: " << (r.ptr - special[i]) << std::endl;
+	}
+	return errors;
+}
+
+/** @brief Limits and errors of the integer conversions.
+*/
+int check_integers() {
+	int errors = 0;
+	char text[32];
+	long long values[] = { 0, 1, -1, std::numeric_limits<long long>::max(),
+		std::numeric_limits<long long>::min(), 1234567890123LL };
+	for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+		NumberConversion::FormatResult fr = NumberConversion::format(text,
+			text + sizeof(text), values[i]);
+		long long v = 0;
+		NumberConversion::ParseResult r = NumberConversion::parse(text, fr.ptr, v);
+		if (r.error != NumberConversion::CONVERSION_OK || v != values[i]) ++errors;
+	}
+	int i32 = 0;
+	unsigned int u32 = 0;
+	const char* big = "2147483648";
+	if (NumberConversion::parse(big, big + 10, i32).error !=
+		NumberConversion::CONVERSION_OUT_OF_RANGE) ++errors;
+	const char* small = "-2147483648";
+	if (NumberConversion::parse(small, small + 11, i32).error !=
+		NumberConversion::CONVERSION_OK || i32 != -2147483647 - 1) ++errors;
+	if (NumberConversion::parse(small, small + 11, u32).error !=
+		NumberConversion::CONVERSION_INVALID_ARGUMENT) ++errors;
+	if (NumberConversion::format(text, text + 2, 123).error !=
+		NumberConversion::CONVERSION_OUT_OF_RANGE) ++errors;
+	return errors;
+}
+
+/** @brief The StringConversion output is the same of the streams.
+*/
+int check_string_conversion() {
+	int errors = 0;
+	unsigned int seed = 5;
+	for (int i = 0; i < 10000; ++i) {
+		double v = random_double(seed, 40);
+		std::ostringstream ss;
+		ss << v;
+		if (CmnLib::text::StringConversion::NumberToString(v) != ss.str()) {
+			++errors;
+		}
+		std::ostringstream ssi;
+		ssi << (int)(v * 1000);
+		if (CmnLib::text::StringConversion::NumberToString((int)(v * 1000)) !=
+			ssi.str()) ++errors;
+	}
+	if (CmnLib::text::StringConversion::NumberToString('a') != "a") ++errors;
+	if (CmnLib::text::StringConversion::StringToNumber<int>(" 42abc") != 42) {
+		++errors;
+	}
+	if (CmnLib::text::StringConversion::StringToNumber<double>("x") != 0) {
+		++errors;
+	}
+	std::vector<std::string> words = { "1", "abc", "", " 2.5", "1e400" };
+	if (CmnLib::text::StringTypeConversion<double>::convert(words) !=
+		std::vector<double>({ 1.0, 0.0, 2.5, 0.0 })) ++errors;
+	if (CmnLib::text::StringOp::string_padded2number("000014", '0') != 14 ||
+		CmnLib::text::StringOp::string_padded2number("0000", '0') != 0) {
+		++errors;
+	}
+	return errors;
+}
+
+/** @brief Time the stream conversions and NumberConversion.
+*/
+void bench() {
+	std::vector<double> values(kNumValues);
+	unsigned int seed = 9;
+	for (int i = 0; i < kNumValues; ++i) values[i] = random_double(seed, 20);
+	std::vector<std::string> texts(kNumValues);
+	std::string buffer;
+	for (int i = 0; i < kNumValues; ++i) {
+		char text[64];
+		snprintf(text, sizeof(text), "%.7g", values[i]);
+		texts[i] = text;
+		buffer += text;
+		buffer += (i % 3 == 2) ? '\n' : ' ';
+	}
+
+	double sum_stream = 0, sum_new = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < kNumValues; ++i) {
+		std::istringstream ss(texts[i]);
+		double v = 0;
+		ss >> v;
+		sum_stream += v;
+	}
+	double to_number_stream_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < kNumValues; ++i) {
+		sum_new += CmnLib::text::StringConversion::StringToNumber<double>(
+			texts[i]);
+	}
+	double to_number_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	size_t length_stream = 0, length_new = 0;
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < kNumValues; ++i) {
+		std::ostringstream ss;
+		ss << values[i];
+		length_stream += ss.str().size();
+	}
+	double to_string_stream_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < kNumValues; ++i) {
+		length_new += CmnLib::text::StringConversion::NumberToString(
+			values[i]).size();
+	}
+	double to_string_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	std::vector<float> floats_stream, floats_new;
+	start = std::chrono::steady_clock::now();
+	{
+		std::istringstream ss(buffer);
+		float v;
+		while (ss >> v) floats_stream.push_back(v);
+	}
+	double batch_stream_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+	start = std::chrono::steady_clock::now();
+	NumberConversion::ParseResult r = NumberConversion::parse_floats(
+		buffer.data(), buffer.data() + buffer.size(), floats_new);
+	double batch_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "values: " << kNumValues << std::endl;
+	std::cout << "StringToNumber stream: " << to_number_stream_ms <<
+		" ms new: " << to_number_ms << " ms" <<
+		(sum_stream == sum_new ? "" : " MISMATCH") << std::endl;
+	std::cout << "NumberToString stream: " << to_string_stream_ms <<
+		" ms new: " << to_string_ms << " ms" <<
+		(length_stream == length_new ? "" : " MISMATCH") << std::endl;
+	std::cout << "parse_floats (" << buffer.size() / 1024 << " KB) stream: " <<
+		batch_stream_ms << " ms new: " << batch_ms << " ms" <<
+		((floats_stream == floats_new && r.error ==
+		NumberConversion::CONVERSION_OK) ? "" : " MISMATCH") << std::endl;
+}
+
+/** @brief Run the tests
+*/
+void test() {
+	int errors = check_floats() + check_integers() + check_string_conversion();
+	std::cout << "conversion errors: " << errors << std::endl;
+	// the conversions do not depend on the locale
+	if (setlocale(LC_NUMERIC, "de_DE.UTF-8") ||
+		setlocale(LC_NUMERIC, "German")) {
+		double d = 0;
+		const char* text = "1.5e300";
+		char out[32];
+		NumberConversion::parse(text, text + 7, d);
+		NumberConversion::FormatResult fr = NumberConversion::format(out,
+			out + sizeof(out), 0.25);
+		*fr.ptr = 0;
+		std::cout << "with a ',' locale: " << (d == 1.5e300) << " " << out <<
+			std::endl;
+		setlocale(LC_NUMERIC, "C");
+	}
+	bench();
+}
+
+}  // namespace anonymous
+
+CMNLIB_TEST_MAIN(&test, "MemoryLeakCPP.txt", "MemoryLeakC.txt");
@@ -0,0 +1,189 @@
+/**
+* @file test_profiler.cpp
+* @brief Test the scoped timers and the export of the measured zones.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "ts/inc/ts/ts.hpp"
+#include "cmnlibcore/inc/cmnlibcore/cmnlibcore_headers.hpp"
+#include "system/inc/system/system_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+const int kNumThreads = 4;
+const int kNumFrames = 200;
+const int kNumZones = 1000000;
+
+/** @brief Some work to measure.
+*/
+double work(int n) {
+	double s = 0;
+	for (int i = 1; i <= n; ++i) s += std::sqrt((double)i);
+	return s;
+}
+
+/** @brief A frame with nested zones.
+*/
+double frame() {
+	CL_PROFILE_ZONE("frame");
+	double s = 0;
+	{
+		CL_PROFILE_ZONE("update");
+		s += work(2000);
+	}
+	{
+		CL_PROFILE_ZONE("render");
+		for (int i = 0; i < 4; ++i) {
+			CL_PROFILE_ZONE("draw");
+			s += work(500);
+		}
+	}
+	return s;
+}
+
+/** @brief Test the monotonic clock.
+*/
+void test_clock() {
+	uint64_t t0 = CmnLib::system::TimeManager::now_ns();
+	double s0 = CmnLib::system::TimeManager::gettime();
+	bool monotonic = true;
+	uint64_t last = t0;
+	for (int i = 0; i < 100000; ++i) {
+		uint64_t t = CmnLib::system::TimeManager::now_ns();
+		if (t < last) monotonic = false;
+		last = t;
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	double elapsed = CmnLib::system::TimeManager::gettime() - s0;
+	std::cout << "now_ns monotonic: " << monotonic << " sleep 10 ms measured: " <<
+		elapsed * 1000.0 << " ms" << std::endl;
+}
+
+/** @brief Test the aggregation of the zones of several threads.
+*/
+void test_zones() {
+	CmnLib::system::Profiler::Reset();
+	CmnLib::system::Profiler::Enable(true);
+	std::vector<std::thread> threads;
+	std::vector<double> results(kNumThreads, 0);
+	for (int t = 0; t < kNumThreads; ++t) {
+		threads.push_back(std::thread([&results, t]() {
+			for (int f = 0; f < kNumFrames; ++f) results[t] += frame();
+		}));
+	}
+	for (auto &th : threads) th.join();
+	CmnLib::system::Profiler::Enable(false);
+	// Disabled: not measured
+	frame();
+
+	std::vector<CmnLib::system::ProfileZoneStats> stats =
+		CmnLib::system::Profiler::GetStats();
+	bool ok = stats.size() == 4;
+	for (const auto &s : stats) {
+		uint64_t expected = (uint64_t)kNumThreads * kNumFrames *
+			(s.name == "draw" ? 4 : 1);
+		ok = ok && s.count == expected && s.min_ns <= s.p50_ns &&
+			s.p50_ns <= s.p90_ns && s.p90_ns <= s.p99_ns &&
+			s.p99_ns <= s.max_ns;
+	}
+	std::cout << "zones aggregated: " << ok << std::endl;
+	// The self time of a zone does not count its children
+	std::map<std::string, CmnLib::system::ProfileZoneStats> by_name;
+	for (const auto &s : stats) by_name[s.name] = s;
+	std::cout << "zones nested: " << (by_name["frame"].self_ns ==
+		by_name["frame"].total_ns - by_name["update"].total_ns -
+		by_name["render"].total_ns && by_name["render"].self_ns ==
+		by_name["render"].total_ns - by_name["draw"].total_ns &&
+		by_name["draw"].self_ns == by_name["draw"].total_ns) << std::endl;
+	CmnLib::system::Profiler::WriteReport(std::cout);
+
+	std::ostringstream trace;
+	CmnLib::system::Profiler::WriteChromeTrace(trace);
+	std::string json = trace.str();
+	size_t num_events = 0;
+	for (size_t p = json.find("\"ph\":\"X\""); p != std::string::npos;
+		p = json.find("\"ph\":\"X\"", p + 1)) ++num_events;
+	std::cout << "chrome trace events: " << num_events << " expected: " <<
+		kNumThreads * kNumFrames * 7 << std::endl;
+	const char* filename = "test_profiler_trace.json";
+	bool written = CmnLib::system::Profiler::WriteChromeTrace(filename);
+	std::ifstream f(filename);
+	std::cout << "chrome trace file: " << (written && f.is_open()) << std::endl;
+	f.close();
+	remove(filename);
+}
+
+/** @brief Test the limit of the zones per thread.
+*/
+void test_limit() {
+	CmnLib::system::Profiler::Reset();
+	CmnLib::system::Profiler::SetMaxEvents(100);
+	CmnLib::system::Profiler::Enable(true);
+	for (int i = 0; i < 150; ++i) {
+		CL_PROFILE_FUNCTION();
+	}
+	CmnLib::system::Profiler::Enable(false);
+	std::cout << "dropped zones: " <<
+		CmnLib::system::Profiler::DroppedEvents() << " expected: 50" <<
+		std::endl;
+	CmnLib::system::Profiler::SetMaxEvents((size_t)1 << 20);
+	CmnLib::system::Profiler::Reset();
+}
+
+/** @brief Cost of a zone when the profiler is disabled and enabled.
+*/
+void test_overhead() {
+	for (int enabled = 0; enabled < 2; ++enabled) {
+		CmnLib::system::Profiler::Reset();
+		CmnLib::system::Profiler::Enable(enabled != 0);
+		uint64_t start = CmnLib::system::TimeManager::now_ns();
+		for (int i = 0; i < kNumZones; ++i) {
+			CL_PROFILE_ZONE("overhead");
+		}
+		uint64_t elapsed = CmnLib::system::TimeManager::now_ns() - start;
+		CmnLib::system::Profiler::Enable(false);
+		std::cout << "zone cost (" << (enabled ? "enabled" : "disabled") <<
+			"): " << (double)elapsed / kNumZones << " ns" << std::endl;
+	}
+	CmnLib::system::Profiler::Reset();
+}
+
+/** @brief Run the tests
+*/
+void test() {
+	test_clock();
+	test_zones();
+	test_limit();
+	test_overhead();
+}
+
+}  // namespace anonymous
+
+CMNLIB_TEST_MAIN(&test, "MemoryLeakCPP.txt", "MemoryLeakC.txt");
@@ -0,0 +1,190 @@
+/**
+* @file test_splaytree.cpp
+* @brief Benchmark of SplayTree against std::map and ContainerFlatMap.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include "ts/inc/ts/ts.hpp"
+#include "cmnlibcore/inc/cmnlibcore/cmnlibcore_headers.hpp"
+#include "container/inc/container/container_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+const int kNumKeys = 100000;
+const int kNumLookups = 2000000;
+const int kHotKeys = 64;
+
+typedef CmnLib::container::SplayTree<int, int> Tree;
+
+/** @brief Random number in [0, n).
+*/
+int random_int(unsigned int &seed, int n) {
+	seed = seed * 1664525u + 1013904223u;
+	return (int)((seed >> 8) % (unsigned int)n);
+}
+
+/** @brief Lookup workloads.
+*/
+enum Workload { UNIFORM, SKEWED, SEQUENTIAL };
+const char* kWorkloadName[] = { "uniform   ", "skewed    ", "sequential" };
+
+/** @brief Lookup keys. In the skewed workload most of the lookups hit a
+	small set of recent keys, which slowly moves. In the sequential one the
+	keys are visited in order (e.g. frames processed one after the other).
+*/
+std::vector<int> make_lookups(Workload workload) {
+	std::vector<int> lookups(kNumLookups);
+	unsigned int seed = 7;
+	for (int i = 0; i < kNumLookups; ++i) {
+		if (workload == SEQUENTIAL) {
+			lookups[i] = i % kNumKeys * 2;
+		} else if (workload == SKEWED && random_int(seed, 10) != 0) {
+			int base = (i / 1000) * 16 % kNumKeys;
+			lookups[i] = (base + random_int(seed, kHotKeys)) % kNumKeys * 2;
+		} else {
+			lookups[i] = random_int(seed, kNumKeys * 2);
+		}
+	}
+	return lookups;
+}
+
+/** @brief Random inserts and erases checked against std::map.
+*/
+void test_operations() {
+	CmnLib::core::NodePool pool;
+	typedef CmnLib::core::Allocator< std::pair<const int, int> > PoolAllocator;
+	PoolAllocator alloc(&pool);
+	CmnLib::container::SplayTree<int, int, std::less<int>, PoolAllocator> tree(
+		std::less<int>(), alloc);
+	std::map<int, int> reference;
+	unsigned int seed = 3;
+	int errors = 0;
+	for (int i = 0; i < 200000; ++i) {
+		int key = random_int(seed, 5000);
+		switch (random_int(seed, 3)) {
+		case 0:
+			tree[key] = i;
+			reference[key] = i;
+			break;
+		case 1:
+			if (tree.erase(key) != reference.erase(key)) ++errors;
+			break;
+		default:
+		{
+			auto it = tree.lower_bound(key);
+			auto rit = reference.lower_bound(key);
+			if ((it == tree.end()) != (rit == reference.end()) ||
+				(rit != reference.end() && (it->first != rit->first ||
+				it->second != rit->second))) ++errors;
+			break;
+		}
+		}
+	}
+	if (tree.size() != reference.size()) ++errors;
+	auto rit = reference.begin();
+	for (auto it = tree.begin(); it != tree.end(); ++it, ++rit) {
+		if (it->first != rit->first || it->second != rit->second) ++errors;
+	}
+	auto r = tree.range(1000, 2000);
+	size_t n_range = 0;
+	for (auto it = r.first; it != r.second; ++it) ++n_range;
+	if (n_range != (size_t)std::distance(reference.lower_bound(1000),
+		reference.lower_bound(2000))) ++errors;
+	Tree::size_type n_reverse = 0;
+	Tree copy;
+	for (auto it = reference.begin(); it != reference.end(); ++it) {
+		copy.insert(*it);
+	}
+	for (auto it = copy.end(); it != copy.begin(); --it) ++n_reverse;
+	if (n_reverse != reference.size()) ++errors;
+	std::cout << "SplayTree (NodePool) size: " << tree.size() << " errors: " <<
+		errors << std::endl;
+}
+
+/** @brief Time the lookups of the three containers.
+*/
+void bench(Workload workload) {
+	std::vector<int> keys(kNumKeys);
+	for (int i = 0; i < kNumKeys; ++i) keys[i] = i * 2;
+	unsigned int seed = 11;
+	for (int i = kNumKeys - 1; i > 0; --i) {
+		std::swap(keys[i], keys[random_int(seed, i + 1)]);
+	}
+	std::map<int, int> m;
+	CmnLib::container::ContainerFlatMap<int, int> f;
+	Tree t;
+	for (int i = 0; i < kNumKeys; ++i) {
+		m[keys[i]] = i;
+		f.insert(keys[i], i);
+		t[keys[i]] = i;
+	}
+	std::vector<int> lookups = make_lookups(workload);
+
+	long long sum_map = 0, sum_flat = 0, sum_splay = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < kNumLookups; ++i) {
+		auto it = m.find(lookups[i]);
+		if (it != m.end()) sum_map += it->second;
+	}
+	double map_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < kNumLookups; ++i) {
+		size_t idx = f.lower_bound(lookups[i]);
+		if (idx < f.size() && f.key_at(idx) == lookups[i]) {
+			sum_flat += f.value_at(idx);
+		}
+	}
+	double flat_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < kNumLookups; ++i) {
+		auto it = t.find(lookups[i]);
+		if (it != t.end()) sum_splay += it->second;
+	}
+	double splay_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	std::cout << kWorkloadName[workload] << " keys: " << kNumKeys <<
+		" lookups: " << kNumLookups << " std::map: " << map_ms <<
+		" ms ContainerFlatMap: " << flat_ms << " ms SplayTree: " << splay_ms <<
+		" ms" << ((sum_map == sum_flat && sum_map == sum_splay) ? "" :
+		" MISMATCH") << std::endl;
+}
+
+/** @brief Run the tests
+*/
+void test() {
+	test_operations();
+	bench(UNIFORM);
+	bench(SKEWED);
+	bench(SEQUENTIAL);
+}
+
+}  // namespace anonymous
+
+CMNLIB_TEST_MAIN(&test, "MemoryLeakCPP.txt", "MemoryLeakC.txt");
@@ -0,0 +1,176 @@
+/**
+* @file test_stringtokenizer.cpp
+* @brief Test the string tokenizers and time them on a large point file.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ts/inc/ts/ts.hpp"
+#include "cmnlibcore/inc/cmnlibcore/cmnlibcore_headers.hpp"
+#include "string/inc/string/string_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+const int kNumPoints = 500000;
+
+/** @brief Split with std::getline, as the previous implementation did.
+*/
+std::vector<std::string> split_getline(const std::string &s, char delim) {
+	std::vector<std::string> v;
+	std::stringstream ss(s);
+	std::string item;
+	while (std::getline(ss, item, delim)) v.push_back(item);
+	return v;
+}
+
+/** @brief Compare the results with the previous behaviour.
+*/
+void test_split() {
+	const char* cases[] = { "", ",", "a", "a,b", ",a,,b,", "a,,b,,", ",,," };
+	int errors = 0;
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+		std::vector<std::string> expected = split_getline(cases[i], ',');
+		if (CmnLib::text::StringIterator::split(cases[i], ',') != expected) {
+			++errors;
+		}
+		std::vector<std::string> expected_non_empty;
+		for (size_t k = 0; k < expected.size(); ++k) {
+			if (!expected[k].empty()) expected_non_empty.push_back(expected[k]);
+		}
+		if (CmnLib::text::STDStringFunc::split(cases[i], ',') !=
+			expected_non_empty) ++errors;
+	}
+
+	std::vector<std::string> words;
+	CmnLib::text::stringTokenizer tokenizer("  the quick  brown fox ");
+	tokenizer.to_vector(words);
+	if (words.size() != 5 || words[0] != "the" || words[3] != "fox" ||
+		!words[4].empty()) ++errors;
+	words.clear();
+	CmnLib::text::stringTokenizer tokenizer_del("a  b", ' ', true);
+	tokenizer_del.to_vector(words);
+	if (words.size() != 4 || words[1] != " " || words[3] != "b") ++errors;
+
+	// multi-char delimiter set and numbers
+	CmnLib::text::StringViewTokenizer tok("v 1.5,-2e3\t 42 ;-7 x", " ,\t;");
+	CmnLib::text::StringView token;
+	double x = 0, y = 0;
+	int i = 0, j = 0, k = 0;
+	if (!tok.next(token) || token != "v") ++errors;
+	if (!tok.next_number(x) || x != 1.5) ++errors;
+	if (!tok.next_number(y) || y != -2000.0) ++errors;
+	if (!tok.next_number(i) || i != 42) ++errors;
+	if (!tok.next_number(j) || j != -7) ++errors;
+	if (tok.next_number(k)) ++errors;
+	if (tok.has_next()) ++errors;
+
+	unsigned char uc = 0;
+	signed char sc = 0;
+	if (CmnLib::text::StringViewTokenizer::parse("256", uc)) ++errors;
+	if (CmnLib::text::StringViewTokenizer::parse("-1", uc)) ++errors;
+	if (!CmnLib::text::StringViewTokenizer::parse("-128", sc) || sc != -128) {
+		++errors;
+	}
+	if (CmnLib::text::StringViewTokenizer::parse("1.5x", x)) ++errors;
+	std::cout << "split and tokenizers errors: " << errors << std::endl;
+}
+
+/** @brief Time the parsing of a text point cloud (x y z per line).
+*/
+void test_speed() {
+	std::string text;
+	char line[128];
+	for (int i = 0; i < kNumPoints; ++i) {
+		sprintf(line, "%d.25 %d.5 -%d.125\n", i, i * 2, i % 1000);
+		text += line;
+	}
+
+	double sum_stream = 0;
+	auto start = std::chrono::steady_clock::now();
+	{
+		std::stringstream ss(text);
+		double v;
+		while (ss >> v) sum_stream += v;
+	}
+	double stream_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	size_t num_words = 0;
+	start = std::chrono::steady_clock::now();
+	{
+		std::vector<std::string> words =
+			CmnLib::text::STDStringFunc::split(text, ' ');
+		num_words = words.size();
+	}
+	double split_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	double sum_view = 0;
+	start = std::chrono::steady_clock::now();
+	{
+		CmnLib::text::StringViewTokenizer tok(text, " \n");
+		double v;
+		while (tok.next_number(v)) sum_view += v;
+	}
+	double view_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	// a single long line was quadratic with the previous stringTokenizer
+	std::string long_line = text.substr(0, 1 << 20);
+	for (size_t i = 0; i < long_line.size(); ++i) {
+		if (long_line[i] == '\n') long_line[i] = ' ';
+	}
+	size_t num_tokens = 0;
+	start = std::chrono::steady_clock::now();
+	{
+		CmnLib::text::stringTokenizer tok(long_line);
+		while (tok.hasNext()) {
+			if (!tok.next().empty()) ++num_tokens;
+		}
+	}
+	double tokenizer_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "points: " << kNumPoints << " (" << text.size() / 1024 <<
+		" KB) stringstream: " << stream_ms << " ms STDStringFunc::split: " <<
+		split_ms << " ms (" << num_words << " words) StringViewTokenizer: " <<
+		view_ms << " ms" << (sum_stream == sum_view ? "" : " MISMATCH") <<
+		std::endl;
+	std::cout << "stringTokenizer on a 1 MB line: " << tokenizer_ms << " ms (" <<
+		num_tokens << " tokens)" << std::endl;
+}
+
+/** @brief Run the tests
+*/
+void test() {
+	test_split();
+	test_speed();
+}
+
+}  // namespace anonymous
+
+CMNLIB_TEST_MAIN(&test, "MemoryLeakCPP.txt", "MemoryLeakC.txt");
@@ -0,0 +1,225 @@
+/**
+* @file test_thread_pool.cpp
+* @brief Test the work-stealing thread pool and the parallel loops.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 1.0.1.0
+*
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "ts/inc/ts/ts.hpp"
+#include "cmnlibcore/inc/cmnlibcore/cmnlibcore_headers.hpp"
+#include "system/inc/system/system_headers.hpp"
+
+// Unnamed namespace
+namespace
+{
+
+const size_t kNumElements = 1000000;
+const int kNumCalls = 200;
+
+/** @brief Some work to parallelize.
+*/
+double work(size_t i) {
+	return std::sqrt((double)i);
+}
+
+/** @brief Every element is visited exactly once.
+*/
+void test_parallel_for() {
+	CmnLib::system::ThreadPool &pool = CmnLib::system::ThreadPool::Instance();
+	std::vector<int> visited(kNumElements, 0);
+	CmnLib::system::parallel_for(0, kNumElements, 1000,
+		[&visited](size_t b, size_t e) {
+		for (size_t i = b; i < e; ++i) ++visited[i];
+	});
+	bool ok = std::count(visited.begin(), visited.end(), 1) ==
+		(ptrdiff_t)kNumElements;
+	// Automatic grain and empty range
+	std::fill(visited.begin(), visited.end(), 0);
+	CmnLib::system::parallel_for(0, kNumElements, 0,
+		[&visited](size_t b, size_t e) {
+		for (size_t i = b; i < e; ++i) ++visited[i];
+	});
+	CmnLib::system::parallel_for(5, 5, 0, [&visited](size_t, size_t) {
+		visited[0] = 100;
+	});
+	ok = ok && std::count(visited.begin(), visited.end(), 1) ==
+		(ptrdiff_t)kNumElements;
+	std::cout << "workers: " << pool.size() << " parallel_for: " << ok <<
+		std::endl;
+}
+
+/** @brief The reduction does not depend on the scheduling.
+*/
+void test_parallel_reduce() {
+	double expected = 0;
+	for (size_t i = 0; i < kNumElements; ++i) expected += work(i);
+	bool ok = true;
+	for (int k = 0; k < 10; ++k) {
+		double sum = CmnLib::system::parallel_reduce(0, kNumElements, 4096, 0.0,
+			[](size_t b, size_t e, double init) {
+			for (size_t i = b; i < e; ++i) init += work(i);
+			return init;
+		}, [](double a, double b) { return a + b; });
+		double sum2 = CmnLib::system::parallel_reduce(0, kNumElements, 4096, 0.0,
+			[](size_t b, size_t e, double init) {
+			for (size_t i = b; i < e; ++i) init += work(i);
+			return init;
+		}, [](double a, double b) { return a + b; });
+		// Same ranges, same order: bitwise identical
+		ok = ok && sum == sum2 && std::fabs(sum - expected) < 1e-6 * expected;
+	}
+	std::cout << "parallel_reduce: " << ok << std::endl;
+}
+
+/** @brief Parallel loops inside parallel loops and task groups.
+*/
+void test_nested() {
+	std::atomic<size_t> count(0);
+	CmnLib::system::parallel_for(0, 64, 1, [&count](size_t b, size_t e) {
+		for (size_t i = b; i < e; ++i) {
+			CmnLib::system::parallel_for(0, 1000, 10,
+				[&count](size_t b2, size_t e2) {
+				count.fetch_add(e2 - b2);
+			});
+		}
+	});
+	std::atomic<int> tasks(0);
+	CmnLib::system::TaskGroup group;
+	for (int i = 0; i < 100; ++i) {
+		group.run([&tasks]() {
+			CmnLib::system::TaskGroup inner;
+			for (int j = 0; j < 10; ++j) inner.run([&tasks]() { ++tasks; });
+			inner.wait();
+		});
+	}
+	group.wait();
+	std::cout << "nested: " << (count.load() == 64000 && tasks.load() == 1000) <<
+		std::endl;
+}
+
+/** @brief Ranges with very different costs are balanced by the stealing.
+*/
+void test_uneven() {
+	std::vector<double> out(4096, 0);
+	uint64_t start = CmnLib::system::TimeManager::now_ns();
+	CmnLib::system::parallel_for(0, out.size(), 16, [&out](size_t b, size_t e) {
+		for (size_t i = b; i < e; ++i) {
+			// The last elements are much more expensive
+			size_t n = i < 3584 ? 10 : 5000;
+			double s = 0;
+			for (size_t k = 0; k < n; ++k) s += work(k + i);
+			out[i] = s;
+		}
+	});
+	uint64_t elapsed = CmnLib::system::TimeManager::now_ns() - start;
+	std::cout << "uneven work: " << elapsed / 1000 << " us" << std::endl;
+}
+
+/** @brief The first exception of a group is rethrown by wait.
+*/
+void test_exception() {
+	bool caught = false;
+	try {
+		CmnLib::system::parallel_for(0, 1000, 10, [](size_t b, size_t e) {
+			if (b <= 500 && 500 < e) throw std::runtime_error("element 500");
+		});
+	} catch (const std::runtime_error &e) {
+		caught = std::string(e.what()) == "element 500";
+	}
+	// The pool is still usable
+	std::atomic<int> count(0);
+	CmnLib::system::TaskGroup group;
+	for (int i = 0; i < 10; ++i) group.run([&count]() { ++count; });
+	group.wait();
+	std::cout << "exception: " << (caught && count.load() == 10) << std::endl;
+}
+
+/** @brief Private pools and pools without workers.
+*/
+void test_pools() {
+	bool ok = true;
+	for (size_t workers = 1; workers <= 4; workers += 3) {
+		CmnLib::system::ThreadPool pool(workers);
+		std::vector<int> visited(10000, 0);
+		CmnLib::system::parallel_for(0, visited.size(), 10,
+			[&visited](size_t b, size_t e) {
+			for (size_t i = b; i < e; ++i) ++visited[i];
+		}, pool);
+		ok = ok && pool.size() == workers &&
+			std::count(visited.begin(), visited.end(), 1) == 10000;
+	}
+	std::cout << "private pools: " << ok << std::endl;
+}
+
+/** @brief Cost of many small parallel calls: shared pool against threads
+	created at every call.
+*/
+void test_overhead() {
+	const size_t n = 10000;
+	std::vector<double> out(n, 0);
+	size_t num_threads = CmnLib::system::ThreadPool::Instance().size() + 1;
+
+	uint64_t start = CmnLib::system::TimeManager::now_ns();
+	for (int c = 0; c < kNumCalls; ++c) {
+		std::vector<std::thread> threads;
+		for (size_t t = 0; t < num_threads; ++t) {
+			size_t b = t * n / num_threads;
+			size_t e = (t + 1) * n / num_threads;
+			threads.push_back(std::thread([&out, b, e]() {
+				for (size_t i = b; i < e; ++i) out[i] = work(i);
+			}));
+		}
+		for (auto &th : threads) th.join();
+	}
+	uint64_t spawn = CmnLib::system::TimeManager::now_ns() - start;
+
+	start = CmnLib::system::TimeManager::now_ns();
+	for (int c = 0; c < kNumCalls; ++c) {
+		CmnLib::system::parallel_for(0, n, 0, [&out](size_t b, size_t e) {
+			for (size_t i = b; i < e; ++i) out[i] = work(i);
+		});
+	}
+	uint64_t pooled = CmnLib::system::TimeManager::now_ns() - start;
+	std::cout << "call cost, threads per call: " << spawn / kNumCalls / 1000 <<
+		" us pool: " << pooled / kNumCalls / 1000 << " us" << std::endl;
+}
+
+/** @brief Run the tests
+*/
+void test() {
+	test_parallel_for();
+	test_parallel_reduce();
+	test_nested();
+	test_uneven();
+	test_exception();
+	test_pools();
+	test_overhead();
+}
+
+}  // namespace anonymous
+
+CMNLIB_TEST_MAIN(&test, "MemoryLeakCPP.txt", "MemoryLeakC.txt");
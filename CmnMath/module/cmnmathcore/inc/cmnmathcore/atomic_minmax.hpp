@@ -13,7 +13,8 @@
 #include "define.hpp"
 
 // Implementations of atomic minimum and atomic maximum computations.  These
-// are based on std::atomic_compare_exchange_strong.
+// are based on std::atomic::compare_exchange_weak.  For reductions over many
+// values, accumulate per thread instead (see reducers.hpp).
 
 namespace CmnMath
 {
@@ -30,24 +31,26 @@ T AtomicMax(std::atomic<T>& v0, T const& v1);
 template <typename T>
 T AtomicMin(std::atomic<T>& v0, T const& v1)
 {
-    T vInitial, vMin;
-    do
+    // A failed exchange reloads vInitial, and nothing is written when v1
+    // does not change the value.
+    T vInitial = v0.load();
+    while (v1 < vInitial
+        && !v0.compare_exchange_weak(vInitial, v1))
     {
-        vInitial = v0;
-        vMin = std::min(vInitial, v1);
-    } while (!std::atomic_compare_exchange_strong(&v0, &vInitial, vMin));
+    }
     return vInitial;
 }
 //----------------------------------------------------------------------------
 template <typename T>
 T AtomicMax(std::atomic<T>& v0, T const& v1)
 {
-    T vInitial, vMax;
-    do
+    // A failed exchange reloads vInitial, and nothing is written when v1
+    // does not change the value.
+    T vInitial = v0.load();
+    while (vInitial < v1
+        && !v0.compare_exchange_weak(vInitial, v1))
     {
-        vInitial = v0;
-        vMax = std::max(vInitial, v1);
-    } while (!std::atomic_compare_exchange_strong(&v0, &vInitial, vMax));
+    }
     return vInitial;
 }
 //----------------------------------------------------------------------------
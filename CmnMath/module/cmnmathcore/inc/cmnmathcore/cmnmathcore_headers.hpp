@@ -34,9 +34,13 @@
 
 #include "array2.hpp"
 #include "atomic_minmax.hpp"
+#include "concurrent_hash_map.hpp"
 #include "logger.hpp"
 #include "min_heap.hpp"
+#include "mpmc_queue.hpp"
 #include "range_iteration.hpp"
+#include "reducers.hpp"
+#include "simd.hpp"
 #include "threadsafe_map.hpp"
 #include "threadsafe_queue.hpp"
 #include "wrapper.hpp"
@@ -0,0 +1,436 @@
+/**
+* @file concurrent_hash_map.hpp
+* @brief Hash map with lock-striped shards.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef CMNMATH_CMNMATHCORE_CONCURRENTHASHMAP_HPP__
+#define CMNMATH_CMNMATHCORE_CONCURRENTHASHMAP_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "define.hpp"
+
+namespace CmnMath
+{
+namespace core
+{
+
+/** Hash map with lock-striped shards.
+    @remarks
+        The keys are distributed over a power of two of shards, each one
+        with its own mutex and an open-addressing table (linear probing,
+        grown at 3/4 of load). Threads working on different shards do not
+        contend; a shard is locked only for the time of a probe.
+    @par
+        GatherAll and Snapshot copy one shard at a time, they never hold
+        more than one lock: the result is consistent per shard, not for the
+        whole map. Key and Value must be default constructible.
+*/
+template <typename Key, typename Value, typename Hash = std::hash<Key> >
+class ConcurrentHashMap
+{
+public:
+    // Construction and destruction.  If numShards is 0 it is set to four
+    // times the number of hardware threads.
+    ~ConcurrentHashMap();
+    ConcurrentHashMap(size_t numShards = 0, size_t capacityPerShard = 16);
+
+    // All the operations are thread-safe.
+    bool HasElements() const;
+    size_t GetNumElements() const;
+    size_t GetNumShards() const;
+    bool Exists(Key const& key) const;
+    void Insert(Key const& key, Value const& value);  // insert or assign
+    bool Remove(Key const& key, Value& value);
+    void RemoveAll();
+    bool Get(Key const& key, Value& value) const;
+
+    // Return the value of key.  If the key is missing, the value returned
+    // by factory(key) is inserted.  The factory is called once per key,
+    // under the lock of the shard: it must not use the map.
+    template <typename Factory>
+    Value FindOrInsert(Key const& key, Factory factory);
+
+    // Copy the values (or the key-value pairs) shard by shard.
+    void GatherAll(std::vector<Value>& values) const;
+    void Snapshot(std::vector<std::pair<Key, Value> >& elements) const;
+
+private:
+    enum { CACHE_LINE_SIZE = 64 };
+    // Values of a slot hash which is not an element.
+    enum { HASH_EMPTY = 0, HASH_DELETED = 1 };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::vector<size_t> hashes;  // hash of the element or HASH_*
+        std::vector<std::pair<Key, Value> > entries;
+        size_t numElements;
+        size_t numDeleted;
+        char pad[CACHE_LINE_SIZE];  // no false sharing between shards
+
+        // Index of key or -1.
+        ptrdiff_t Find(Key const& key, size_t hash) const;
+        // Index of key, inserted with a default value if missing; inserted
+        // is set to true in that case.
+        size_t FindOrAdd(Key const& key, size_t hash, bool& inserted);
+        void Rehash(size_t capacity);
+    };
+
+    // Mix the bits of the hash: the low bits select the slot, the high
+    // bits the shard.  The result is never HASH_EMPTY or HASH_DELETED.
+    static size_t Mix(size_t h);
+    size_t HashOf(Key const& key) const;
+    Shard& ShardOf(size_t hash) const;
+
+    Shard* mShards;
+    size_t mNumShards;
+    unsigned int mShardShift;
+    Hash mHash;
+
+    // No copying allowed.
+    ConcurrentHashMap(ConcurrentHashMap const&);
+    ConcurrentHashMap& operator=(ConcurrentHashMap const&);
+};
+
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+ConcurrentHashMap<Key, Value, Hash>::~ConcurrentHashMap()
+{
+    delete[] mShards;
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+ConcurrentHashMap<Key, Value, Hash>::ConcurrentHashMap(size_t numShards,
+    size_t capacityPerShard)
+{
+    if (numShards == 0)
+    {
+        numShards = 4 * std::max(1u, std::thread::hardware_concurrency());
+    }
+    mNumShards = 1;
+    unsigned int bits = 0;
+    while (mNumShards < numShards)
+    {
+        mNumShards <<= 1;
+        ++bits;
+    }
+    mShardShift = (unsigned int)(sizeof(size_t) * 8) - bits;
+    size_t capacity = 8;
+    while (capacity < capacityPerShard)
+    {
+        capacity <<= 1;
+    }
+    mShards = new Shard[mNumShards];
+    for (size_t i = 0; i < mNumShards; ++i)
+    {
+        mShards[i].numElements = 0;
+        mShards[i].numDeleted = 0;
+        mShards[i].hashes.assign(capacity, (size_t)HASH_EMPTY);
+        mShards[i].entries.resize(capacity);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+size_t ConcurrentHashMap<Key, Value, Hash>::Mix(size_t h)
+{
+    // Finalizer of MurmurHash3 (std::hash of integers is the identity).
+    uint64_t x = (uint64_t)h;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    size_t r = (size_t)x;
+    return r > HASH_DELETED ? r : r + 2;
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+size_t ConcurrentHashMap<Key, Value, Hash>::HashOf(Key const& key) const
+{
+    return Mix(mHash(key));
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+typename ConcurrentHashMap<Key, Value, Hash>::Shard&
+ConcurrentHashMap<Key, Value, Hash>::ShardOf(size_t hash) const
+{
+    return mShards[mNumShards == 1 ? 0 : hash >> mShardShift];
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+ptrdiff_t ConcurrentHashMap<Key, Value, Hash>::Shard::Find(Key const& key,
+    size_t hash) const
+{
+    size_t mask = hashes.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        size_t h = hashes[i];
+        if (h == HASH_EMPTY)
+        {
+            return -1;
+        }
+        if (h == hash && entries[i].first == key)
+        {
+            return (ptrdiff_t)i;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+size_t ConcurrentHashMap<Key, Value, Hash>::Shard::FindOrAdd(Key const& key,
+    size_t hash, bool& inserted)
+{
+    if ((numElements + numDeleted + 1) * 4 > hashes.size() * 3)
+    {
+        // Grow only if the elements fill the table, otherwise the rehash
+        // just removes the deleted slots.
+        Rehash((numElements + 1) * 2 > hashes.size() ?
+            hashes.size() * 2 : hashes.size());
+    }
+    size_t mask = hashes.size() - 1;
+    ptrdiff_t firstDeleted = -1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        size_t h = hashes[i];
+        if (h > HASH_DELETED)
+        {
+            if (h == hash && entries[i].first == key)
+            {
+                inserted = false;
+                return i;
+            }
+        }
+        else if (h == HASH_DELETED)
+        {
+            if (firstDeleted < 0)
+            {
+                firstDeleted = (ptrdiff_t)i;
+            }
+        }
+        else
+        {
+            if (firstDeleted >= 0)
+            {
+                i = (size_t)firstDeleted;
+                --numDeleted;
+            }
+            hashes[i] = hash;
+            entries[i].first = key;
+            entries[i].second = Value();
+            ++numElements;
+            inserted = true;
+            return i;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashMap<Key, Value, Hash>::Shard::Rehash(size_t capacity)
+{
+    std::vector<size_t> oldHashes(capacity, (size_t)HASH_EMPTY);
+    std::vector<std::pair<Key, Value> > oldEntries(capacity);
+    oldHashes.swap(hashes);
+    oldEntries.swap(entries);
+    size_t mask = capacity - 1;
+    for (size_t j = 0; j < oldHashes.size(); ++j)
+    {
+        size_t hash = oldHashes[j];
+        if (hash <= HASH_DELETED)
+        {
+            continue;
+        }
+        size_t i = hash & mask;
+        while (hashes[i] != HASH_EMPTY)
+        {
+            i = (i + 1) & mask;
+        }
+        hashes[i] = hash;
+        entries[i] = std::move(oldEntries[j]);
+    }
+    numDeleted = 0;
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+bool ConcurrentHashMap<Key, Value, Hash>::HasElements() const
+{
+    return GetNumElements() > 0;
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+size_t ConcurrentHashMap<Key, Value, Hash>::GetNumElements() const
+{
+    size_t numElements = 0;
+    for (size_t i = 0; i < mNumShards; ++i)
+    {
+        std::lock_guard<std::mutex> lock(mShards[i].mutex);
+        numElements += mShards[i].numElements;
+    }
+    return numElements;
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+size_t ConcurrentHashMap<Key, Value, Hash>::GetNumShards() const
+{
+    return mNumShards;
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+bool ConcurrentHashMap<Key, Value, Hash>::Exists(Key const& key) const
+{
+    size_t hash = HashOf(key);
+    Shard& shard = ShardOf(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.Find(key, hash) >= 0;
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashMap<Key, Value, Hash>::Insert(Key const& key,
+    Value const& value)
+{
+    size_t hash = HashOf(key);
+    Shard& shard = ShardOf(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    bool inserted;
+    size_t i = shard.FindOrAdd(key, hash, inserted);
+    shard.entries[i].second = value;
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+bool ConcurrentHashMap<Key, Value, Hash>::Remove(Key const& key,
+    Value& value)
+{
+    size_t hash = HashOf(key);
+    Shard& shard = ShardOf(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    ptrdiff_t i = shard.Find(key, hash);
+    if (i < 0)
+    {
+        return false;
+    }
+    value = std::move(shard.entries[i].second);
+    shard.entries[i] = std::pair<Key, Value>();
+    shard.hashes[i] = HASH_DELETED;
+    --shard.numElements;
+    ++shard.numDeleted;
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashMap<Key, Value, Hash>::RemoveAll()
+{
+    for (size_t i = 0; i < mNumShards; ++i)
+    {
+        Shard& shard = mShards[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t capacity = shard.hashes.size();
+        shard.hashes.assign(capacity, (size_t)HASH_EMPTY);
+        shard.entries.assign(capacity, std::pair<Key, Value>());
+        shard.numElements = 0;
+        shard.numDeleted = 0;
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+bool ConcurrentHashMap<Key, Value, Hash>::Get(Key const& key,
+    Value& value) const
+{
+    size_t hash = HashOf(key);
+    Shard& shard = ShardOf(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    ptrdiff_t i = shard.Find(key, hash);
+    if (i < 0)
+    {
+        return false;
+    }
+    value = shard.entries[i].second;
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+template <typename Factory>
+Value ConcurrentHashMap<Key, Value, Hash>::FindOrInsert(Key const& key,
+    Factory factory)
+{
+    size_t hash = HashOf(key);
+    Shard& shard = ShardOf(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    ptrdiff_t found = shard.Find(key, hash);
+    if (found >= 0)
+    {
+        return shard.entries[found].second;
+    }
+    Value value = factory(key);
+    bool inserted;
+    size_t i = shard.FindOrAdd(key, hash, inserted);
+    shard.entries[i].second = value;
+    return value;
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashMap<Key, Value, Hash>::GatherAll(
+    std::vector<Value>& values) const
+{
+    values.clear();
+    for (size_t s = 0; s < mNumShards; ++s)
+    {
+        Shard const& shard = mShards[s];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (size_t i = 0; i < shard.hashes.size(); ++i)
+        {
+            if (shard.hashes[i] > HASH_DELETED)
+            {
+                values.push_back(shard.entries[i].second);
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash>
+void ConcurrentHashMap<Key, Value, Hash>::Snapshot(
+    std::vector<std::pair<Key, Value> >& elements) const
+{
+    elements.clear();
+    for (size_t s = 0; s < mNumShards; ++s)
+    {
+        Shard const& shard = mShards[s];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (size_t i = 0; i < shard.hashes.size(); ++i)
+        {
+            if (shard.hashes[i] > HASH_DELETED)
+            {
+                elements.push_back(shard.entries[i]);
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+
+} // namespace core
+} // namespace CmnMath
+
+#endif /* CMNMATH_CMNMATHCORE_CONCURRENTHASHMAP_HPP__ */
@@ -0,0 +1,503 @@
+/**
+* @file mpmc_queue.hpp
+* @brief Bounded lock-free multi-producer/multi-consumer queue.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef CMNMATH_CMNMATHCORE_MPMCQUEUE_HPP__
+#define CMNMATH_CMNMATHCORE_MPMCQUEUE_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "define.hpp"
+
+namespace CmnMath
+{
+namespace core
+{
+
+/** Bounded lock-free multi-producer/multi-consumer queue.
+    @remarks
+        Ring buffer of cells with a sequence number each (D. Vyukov's
+        bounded MPMC queue): a producer or a consumer claims a position with
+        a compare-and-swap on its counter and then owns the cell until it
+        publishes the new sequence. The two counters are on separate cache
+        lines. The capacity is rounded up to a power of two.
+    @par
+        The elements are moved in and out, move-only types are supported.
+        TryPush/TryPop never block; WaitPush/WaitPop spin briefly and then
+        sleep on a condition variable, which is only notified when a thread
+        is actually waiting.
+*/
+template <typename Element>
+class MPMCQueue
+{
+public:
+    // Construction and destruction.
+    ~MPMCQueue();
+    MPMCQueue(size_t maxNumElements);
+
+    // All the operations are thread-safe.
+    size_t GetMaxNumElements() const;
+    size_t GetNumElements() const;  // approximate while in use
+
+    // Return false if the queue is full or empty.
+    bool TryPush(Element const& element);
+    bool TryPush(Element&& element);
+    bool TryPop(Element& element);
+
+    // Push or pop up to n contiguous elements with a single claim and
+    // return their number.  The pushed elements are moved from.
+    size_t TryPushBatch(Element* elements, size_t n);
+    size_t TryPopBatch(Element* elements, size_t n);
+
+    // Wait until the operation succeeds or the timeout expires.
+    template <typename Rep, typename Period>
+    bool WaitPush(Element&& element,
+        std::chrono::duration<Rep, Period> const& timeout);
+    template <typename Rep, typename Period>
+    bool WaitPop(Element& element,
+        std::chrono::duration<Rep, Period> const& timeout);
+
+    // Wait without timeout.
+    void WaitPush(Element&& element);
+    void WaitPop(Element& element);
+
+private:
+    enum { CACHE_LINE_SIZE = 64, SPIN_COUNT = 64 };
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(Element),
+            std::alignment_of<Element>::value>::type storage;
+
+        Element* Get() { return reinterpret_cast<Element*>(&storage); }
+    };
+
+    // Claim up to n cells; return the first position and set n to the
+    // number of claimed cells (0 if none).
+    size_t ClaimPush(size_t& n);
+    size_t ClaimPop(size_t& n);
+
+    // Push and pop without waking up the waiting threads.
+    template <typename Arg>
+    bool PushNoNotify(Arg&& element);
+    bool PopNoNotify(Element& element);
+
+    // Wake up the threads waiting for an element or for a free cell.
+    void NotifyNotEmpty();
+    void NotifyNotFull();
+
+    Cell* mCells;
+    size_t mMask;
+
+    // Each counter on its own cache line.
+    char mPad0[CACHE_LINE_SIZE];
+    std::atomic<size_t> mEnqueuePos;
+    char mPad1[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> mDequeuePos;
+    char mPad2[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+
+    // Blocking support.
+    std::atomic<int> mPopWaiters;
+    std::atomic<int> mPushWaiters;
+    std::mutex mMutex;
+    std::condition_variable mNotEmpty;
+    std::condition_variable mNotFull;
+
+    // No copying allowed.
+    MPMCQueue(MPMCQueue const&);
+    MPMCQueue& operator=(MPMCQueue const&);
+};
+
+//----------------------------------------------------------------------------
+template <typename Element>
+MPMCQueue<Element>::~MPMCQueue()
+{
+    size_t end = mEnqueuePos.load(std::memory_order_relaxed);
+    for (size_t pos = mDequeuePos.load(std::memory_order_relaxed); pos != end;
+        ++pos)
+    {
+        mCells[pos & mMask].Get()->~Element();
+    }
+    delete[] mCells;
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+MPMCQueue<Element>::MPMCQueue(size_t maxNumElements)
+    :
+    mEnqueuePos(0),
+    mDequeuePos(0),
+    mPopWaiters(0),
+    mPushWaiters(0)
+{
+    size_t capacity = 2;
+    while (capacity < maxNumElements)
+    {
+        capacity <<= 1;
+    }
+    mCells = new Cell[capacity];
+    mMask = capacity - 1;
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        mCells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+size_t MPMCQueue<Element>::GetMaxNumElements() const
+{
+    return mMask + 1;
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+size_t MPMCQueue<Element>::GetNumElements() const
+{
+    size_t dequeuePos = mDequeuePos.load(std::memory_order_acquire);
+    size_t enqueuePos = mEnqueuePos.load(std::memory_order_acquire);
+    return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+size_t MPMCQueue<Element>::ClaimPush(size_t& n)
+{
+    size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        // A cell is free for the position pos when its sequence is pos.
+        // It cannot change before the position is claimed.
+        size_t k = 0;
+        for (; k < n; ++k)
+        {
+            size_t seq = mCells[(pos + k) & mMask].sequence.load(
+                std::memory_order_acquire);
+            if (seq != pos + k)
+            {
+                break;
+            }
+        }
+        if (k == 0)
+        {
+            size_t seq = mCells[pos & mMask].sequence.load(
+                std::memory_order_acquire);
+            if ((ptrdiff_t)(seq - pos) < 0)
+            {
+                n = 0;  // full
+                return pos;
+            }
+            pos = mEnqueuePos.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (mEnqueuePos.compare_exchange_weak(pos, pos + k,
+            std::memory_order_relaxed))
+        {
+            n = k;
+            return pos;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+size_t MPMCQueue<Element>::ClaimPop(size_t& n)
+{
+    size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        // A cell holds the element of the position pos when its sequence
+        // is pos + 1.
+        size_t k = 0;
+        for (; k < n; ++k)
+        {
+            size_t seq = mCells[(pos + k) & mMask].sequence.load(
+                std::memory_order_acquire);
+            if (seq != pos + k + 1)
+            {
+                break;
+            }
+        }
+        if (k == 0)
+        {
+            size_t seq = mCells[pos & mMask].sequence.load(
+                std::memory_order_acquire);
+            if ((ptrdiff_t)(seq - (pos + 1)) < 0)
+            {
+                n = 0;  // empty
+                return pos;
+            }
+            pos = mDequeuePos.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (mDequeuePos.compare_exchange_weak(pos, pos + k,
+            std::memory_order_relaxed))
+        {
+            n = k;
+            return pos;
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+template <typename Arg>
+bool MPMCQueue<Element>::PushNoNotify(Arg&& element)
+{
+    size_t n = 1;
+    size_t pos = ClaimPush(n);
+    if (n == 0)
+    {
+        return false;
+    }
+    Cell& cell = mCells[pos & mMask];
+    new (cell.Get()) Element(std::forward<Arg>(element));
+    cell.sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+bool MPMCQueue<Element>::PopNoNotify(Element& element)
+{
+    size_t n = 1;
+    size_t pos = ClaimPop(n);
+    if (n == 0)
+    {
+        return false;
+    }
+    Cell& cell = mCells[pos & mMask];
+    element = std::move(*cell.Get());
+    cell.Get()->~Element();
+    cell.sequence.store(pos + mMask + 1, std::memory_order_release);
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+bool MPMCQueue<Element>::TryPush(Element const& element)
+{
+    if (!PushNoNotify(element))
+    {
+        return false;
+    }
+    NotifyNotEmpty();
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+bool MPMCQueue<Element>::TryPush(Element&& element)
+{
+    if (!PushNoNotify(std::move(element)))
+    {
+        return false;
+    }
+    NotifyNotEmpty();
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+bool MPMCQueue<Element>::TryPop(Element& element)
+{
+    if (!PopNoNotify(element))
+    {
+        return false;
+    }
+    NotifyNotFull();
+    return true;
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+size_t MPMCQueue<Element>::TryPushBatch(Element* elements, size_t n)
+{
+    if (n == 0)
+    {
+        return 0;
+    }
+    size_t pos = ClaimPush(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        Cell& cell = mCells[(pos + i) & mMask];
+        new (cell.Get()) Element(std::move(elements[i]));
+        cell.sequence.store(pos + i + 1, std::memory_order_release);
+    }
+    if (n > 0)
+    {
+        NotifyNotEmpty();
+    }
+    return n;
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+size_t MPMCQueue<Element>::TryPopBatch(Element* elements, size_t n)
+{
+    if (n == 0)
+    {
+        return 0;
+    }
+    size_t pos = ClaimPop(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        Cell& cell = mCells[(pos + i) & mMask];
+        elements[i] = std::move(*cell.Get());
+        cell.Get()->~Element();
+        cell.sequence.store(pos + i + mMask + 1, std::memory_order_release);
+    }
+    if (n > 0)
+    {
+        NotifyNotFull();
+    }
+    return n;
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+void MPMCQueue<Element>::NotifyNotEmpty()
+{
+    // Pairs with the increment of mPopWaiters: either the waiter sees the
+    // published element or this thread sees the waiter.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mPopWaiters.load(std::memory_order_relaxed) > 0)
+    {
+        mMutex.lock();
+        mMutex.unlock();
+        mNotEmpty.notify_all();
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+void MPMCQueue<Element>::NotifyNotFull()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mPushWaiters.load(std::memory_order_relaxed) > 0)
+    {
+        mMutex.lock();
+        mMutex.unlock();
+        mNotFull.notify_all();
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+template <typename Rep, typename Period>
+bool MPMCQueue<Element>::WaitPush(Element&& element,
+    std::chrono::duration<Rep, Period> const& timeout)
+{
+    for (int i = 0; i < SPIN_COUNT; ++i)
+    {
+        if (TryPush(std::move(element)))
+        {
+            return true;
+        }
+    }
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + timeout;
+    bool pushed = false;
+    {
+        // The mutex is held from the check to the wait, a notification
+        // cannot be lost.
+        std::unique_lock<std::mutex> lock(mMutex);
+        mPushWaiters.fetch_add(1);
+        for (;;)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (PushNoNotify(std::move(element)))
+            {
+                pushed = true;
+                break;
+            }
+            if (mNotFull.wait_until(lock, deadline) ==
+                std::cv_status::timeout)
+            {
+                pushed = PushNoNotify(std::move(element));
+                break;
+            }
+        }
+        mPushWaiters.fetch_sub(1);
+    }
+    if (pushed)
+    {
+        NotifyNotEmpty();
+    }
+    return pushed;
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+template <typename Rep, typename Period>
+bool MPMCQueue<Element>::WaitPop(Element& element,
+    std::chrono::duration<Rep, Period> const& timeout)
+{
+    for (int i = 0; i < SPIN_COUNT; ++i)
+    {
+        if (TryPop(element))
+        {
+            return true;
+        }
+    }
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + timeout;
+    bool popped = false;
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mPopWaiters.fetch_add(1);
+        for (;;)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (PopNoNotify(element))
+            {
+                popped = true;
+                break;
+            }
+            if (mNotEmpty.wait_until(lock, deadline) ==
+                std::cv_status::timeout)
+            {
+                popped = PopNoNotify(element);
+                break;
+            }
+        }
+        mPopWaiters.fetch_sub(1);
+    }
+    if (popped)
+    {
+        NotifyNotFull();
+    }
+    return popped;
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+void MPMCQueue<Element>::WaitPush(Element&& element)
+{
+    while (!WaitPush(std::move(element), std::chrono::seconds(1)))
+    {
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Element>
+void MPMCQueue<Element>::WaitPop(Element& element)
+{
+    while (!WaitPop(element, std::chrono::seconds(1)))
+    {
+    }
+}
+//----------------------------------------------------------------------------
+
+} // namespace core
+} // namespace CmnMath
+
+#endif /* CMNMATH_CMNMATHCORE_MPMCQUEUE_HPP__ */
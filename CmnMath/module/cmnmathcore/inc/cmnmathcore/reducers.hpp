@@ -0,0 +1,381 @@
+/**
+* @file reducers.hpp
+* @brief Per-thread accumulators combined after the parallel work.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef CMNMATH_CMNMATHCORE_REDUCERS_HPP__
+#define CMNMATH_CMNMATHCORE_REDUCERS_HPP__
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "define.hpp"
+
+namespace CmnMath
+{
+namespace core
+{
+
+/** Accumulators of a parallel reduction.
+    @remarks
+        Each worker accumulates in its own slot of a PerThreadReducer, the
+        slots are merged once at the end.  An accumulator is copyable, its
+        default value is the identity of the reduction and it has a
+        Merge(other) method.
+*/
+
+// Sum of values.
+template <typename T>
+class SumAccumulator
+{
+public:
+    SumAccumulator() : mSum(0) {}
+
+    inline void Add(T const& value) { mSum += value; }
+    inline void Merge(SumAccumulator const& other) { mSum += other.mSum; }
+    inline T GetSum() const { return mSum; }
+
+private:
+    T mSum;
+};
+
+// Minimum and maximum of values.  When empty, the minimum is the largest
+// value of T and the maximum the lowest.
+template <typename T>
+class MinMaxAccumulator
+{
+public:
+    MinMaxAccumulator()
+        : mMin(std::numeric_limits<T>::max()),
+          mMax(std::numeric_limits<T>::lowest())
+    {
+    }
+
+    inline void Add(T const& value)
+    {
+        mMin = std::min(mMin, value);
+        mMax = std::max(mMax, value);
+    }
+
+    inline void Merge(MinMaxAccumulator const& other)
+    {
+        mMin = std::min(mMin, other.mMin);
+        mMax = std::max(mMax, other.mMax);
+    }
+
+    inline bool IsEmpty() const { return mMax < mMin; }
+    inline T GetMin() const { return mMin; }
+    inline T GetMax() const { return mMax; }
+
+private:
+    T mMin, mMax;
+};
+
+// Axis-aligned bounding box of N-dimensional points.
+template <int N, typename T>
+class AABBAccumulator
+{
+public:
+    AABBAccumulator()
+    {
+        mMin.fill(std::numeric_limits<T>::max());
+        mMax.fill(std::numeric_limits<T>::lowest());
+    }
+
+    // The point has N coordinates.
+    inline void Add(T const* point)
+    {
+        for (int d = 0; d < N; ++d)
+        {
+            mMin[d] = std::min(mMin[d], point[d]);
+            mMax[d] = std::max(mMax[d], point[d]);
+        }
+    }
+
+    inline void Merge(AABBAccumulator const& other)
+    {
+        for (int d = 0; d < N; ++d)
+        {
+            mMin[d] = std::min(mMin[d], other.mMin[d]);
+            mMax[d] = std::max(mMax[d], other.mMax[d]);
+        }
+    }
+
+    inline bool IsEmpty() const { return mMax[0] < mMin[0]; }
+    inline std::array<T, N> const& GetMin() const { return mMin; }
+    inline std::array<T, N> const& GetMax() const { return mMax; }
+
+private:
+    std::array<T, N> mMin, mMax;
+};
+
+// Mean and variance with the update of Welford.  The partial results are
+// merged with the pairwise formula of Chan et al., which is as stable as
+// the sequential update.
+template <typename T>
+class WelfordAccumulator
+{
+public:
+    WelfordAccumulator() : mCount(0), mMean(0), mM2(0) {}
+
+    inline void Add(T const& value)
+    {
+        ++mCount;
+        T delta = value - mMean;
+        mMean += delta / static_cast<T>(mCount);
+        mM2 += delta * (value - mMean);
+    }
+
+    inline void Merge(WelfordAccumulator const& other)
+    {
+        if (other.mCount == 0)
+        {
+            return;
+        }
+        if (mCount == 0)
+        {
+            *this = other;
+            return;
+        }
+        uint64_t count = mCount + other.mCount;
+        T delta = other.mMean - mMean;
+        T weight = static_cast<T>(other.mCount) / static_cast<T>(count);
+        mMean += delta * weight;
+        mM2 += other.mM2 + delta * delta * static_cast<T>(mCount) * weight;
+        mCount = count;
+    }
+
+    inline uint64_t GetCount() const { return mCount; }
+    inline T GetMean() const { return mMean; }
+
+    // Population variance (divided by n) and sample variance (n - 1).
+    inline T GetVariance() const
+    {
+        return mCount > 0 ? mM2 / static_cast<T>(mCount) : static_cast<T>(0);
+    }
+
+    inline T GetSampleVariance() const
+    {
+        return mCount > 1 ? mM2 / static_cast<T>(mCount - 1) :
+            static_cast<T>(0);
+    }
+
+private:
+    uint64_t mCount;
+    T mMean, mM2;
+};
+
+// Histogram with fixed bins of equal width in [min, max).  The values out of
+// the range are counted apart, NaN is ignored.  Only histograms with the
+// same bins can be merged.  The bin is computed in double, so integral
+// types get the same bins as the floating point ones.
+template <typename T>
+class HistogramAccumulator
+{
+public:
+    HistogramAccumulator()
+        : mMin(0), mMax(0), mScale(0), mUnderflow(0), mOverflow(0)
+    {
+    }
+
+    // Without bins or with max <= min all the values are out of the range.
+    HistogramAccumulator(T const& min, T const& max, size_t numBins)
+        : mMin(min),
+          mMax(numBins > 0 && max > min ? max : min),
+          mScale(numBins > 0 && max > min ?
+            static_cast<double>(numBins) /
+            (static_cast<double>(max) - static_cast<double>(min)) : 0.0),
+          mBins(numBins, 0),
+          mUnderflow(0),
+          mOverflow(0)
+    {
+    }
+
+    inline void Add(T const& value)
+    {
+        if (value < mMin)
+        {
+            ++mUnderflow;
+        }
+        else if (value >= mMax)
+        {
+            ++mOverflow;
+        }
+        else if (value == value)
+        {
+            // The rounding may give numBins just below max.
+            size_t bin = static_cast<size_t>((static_cast<double>(value) -
+                static_cast<double>(mMin)) * mScale);
+            ++mBins[std::min(bin, mBins.size() - 1)];
+        }
+    }
+
+    // Return false, without changes, if the bins are not the same.  A
+    // default histogram without values takes the bins of other.
+    inline bool Merge(HistogramAccumulator const& other)
+    {
+        if (IsDefault())
+        {
+            *this = other;
+            return true;
+        }
+        if (other.IsDefault())
+        {
+            return true;
+        }
+        if (!(mMin == other.mMin && mMax == other.mMax &&
+            mBins.size() == other.mBins.size()))
+        {
+            return false;
+        }
+        for (size_t i = 0; i < mBins.size(); ++i)
+        {
+            mBins[i] += other.mBins[i];
+        }
+        mUnderflow += other.mUnderflow;
+        mOverflow += other.mOverflow;
+        return true;
+    }
+
+    inline std::vector<uint64_t> const& GetBins() const { return mBins; }
+    inline uint64_t GetUnderflow() const { return mUnderflow; }
+    inline uint64_t GetOverflow() const { return mOverflow; }
+
+private:
+    inline bool IsDefault() const
+    {
+        return mBins.empty() && mMin == mMax && mUnderflow == 0 &&
+            mOverflow == 0;
+    }
+
+    T mMin, mMax;
+    double mScale;
+    std::vector<uint64_t> mBins;
+    uint64_t mUnderflow, mOverflow;
+};
+
+/** One accumulator per thread, combined at the end.
+    @remarks
+        The slots are padded to separate cache lines, so the threads never
+        write a shared line in the hot loop.  The caller chooses the slot
+        of a thread (its index in the parallel loop); a slot must not be
+        used by two threads at the same time.  Combine merges the slots in
+        index order, the result does not depend on the scheduling.
+    @code
+        PerThreadReducer<WelfordAccumulator<double>> stats(numThreads);
+        // thread t:
+        for (...) stats.Local(t).Add(x);
+        // after the join:
+        double variance = stats.Combine().GetVariance();
+    @endcode
+*/
+template <typename Accumulator>
+class PerThreadReducer
+{
+public:
+    // Construction.  All the slots are copies of identity.
+    PerThreadReducer(size_t numSlots,
+        Accumulator const& identity = Accumulator());
+
+    inline size_t GetNumSlots() const;
+
+    // The accumulator of a slot, for the thread that owns it.
+    inline Accumulator& Local(size_t slot);
+    inline Accumulator const& Local(size_t slot) const;
+
+    // Merge all the slots.  Call it when the threads are done.
+    Accumulator Combine() const;
+
+    // Set all the slots to the identity.
+    void Reset();
+
+private:
+    enum { CACHE_LINE_SIZE = 64 };
+
+    struct Slot
+    {
+        char pad[CACHE_LINE_SIZE];  // no false sharing between the slots
+        Accumulator value;
+    };
+
+    std::vector<Slot> mSlots;
+    Accumulator mIdentity;
+    char mPad[CACHE_LINE_SIZE];
+};
+
+//----------------------------------------------------------------------------
+template <typename Accumulator>
+PerThreadReducer<Accumulator>::PerThreadReducer(size_t numSlots,
+    Accumulator const& identity)
+    :
+    mSlots(std::max<size_t>(1, numSlots)),
+    mIdentity(identity)
+{
+    Reset();
+}
+//----------------------------------------------------------------------------
+template <typename Accumulator>
+inline size_t PerThreadReducer<Accumulator>::GetNumSlots() const
+{
+    return mSlots.size();
+}
+//----------------------------------------------------------------------------
+template <typename Accumulator>
+inline Accumulator& PerThreadReducer<Accumulator>::Local(size_t slot)
+{
+    return mSlots[slot].value;
+}
+//----------------------------------------------------------------------------
+template <typename Accumulator>
+inline Accumulator const& PerThreadReducer<Accumulator>::Local(size_t slot)
+    const
+{
+    return mSlots[slot].value;
+}
+//----------------------------------------------------------------------------
+template <typename Accumulator>
+Accumulator PerThreadReducer<Accumulator>::Combine() const
+{
+    Accumulator result = mIdentity;
+    for (auto const& slot : mSlots)
+    {
+        result.Merge(slot.value);
+    }
+    return result;
+}
+//----------------------------------------------------------------------------
+template <typename Accumulator>
+void PerThreadReducer<Accumulator>::Reset()
+{
+    for (auto& slot : mSlots)
+    {
+        slot.value = mIdentity;
+    }
+}
+//----------------------------------------------------------------------------
+
+} // namespace core
+} // namespace CmnMath
+
+#endif /* CMNMATH_CMNMATHCORE_REDUCERS_HPP__ */
@@ -0,0 +1,388 @@
+/**
+* @file simd.hpp
+* @brief Portable SIMD registers (AVX, SSE2, NEON or scalar).
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef CMNMATH_CMNMATHCORE_SIMD_HPP__
+#define CMNMATH_CMNMATHCORE_SIMD_HPP__
+
+// The instruction set is selected at compile time from the flags of the
+// compiler (-mavx, -mfma, /arch:AVX2, ...).  Without flags the x86-64
+// builds use SSE2 and the AArch64 builds use NEON.
+#if defined(__AVX__)
+#define CMNMATH_SIMD_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CMNMATH_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define CMNMATH_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace CmnMath
+{
+namespace core
+{
+
+/** Register of WIDTH doubles.
+    @remarks
+        The loads and the stores are unaligned.  Floats are converted to
+        doubles while loaded, so the computations on float arrays keep the
+        precision of double.
+    @code
+        SimdDouble sum = SimdDouble::Zero();
+        size_t i = 0;
+        for (; i + SimdDouble::WIDTH <= n; i += SimdDouble::WIDTH)
+        {
+            sum = sum + SimdDouble::Load(data + i);
+        }
+        double s = sum.HorizontalSum();
+        for (; i < n; ++i) s += data[i];
+    @endcode
+*/
+class SimdDouble
+{
+public:
+#if defined(CMNMATH_SIMD_AVX)
+    typedef __m256d Register;
+    enum { WIDTH = 4 };
+#elif defined(CMNMATH_SIMD_SSE2)
+    typedef __m128d Register;
+    enum { WIDTH = 2 };
+#elif defined(CMNMATH_SIMD_NEON)
+    typedef float64x2_t Register;
+    enum { WIDTH = 2 };
+#else
+    typedef double Register;
+    enum { WIDTH = 1 };
+#endif
+
+    SimdDouble() {}
+    SimdDouble(Register v) : mV(v) {}
+
+    // Name of the instruction set.
+    static inline char const* Name();
+
+    static inline SimdDouble Zero();
+    static inline SimdDouble Set(double value);
+    static inline SimdDouble Load(double const* data);
+    static inline SimdDouble Load(float const* data);
+    inline void Store(double* data) const;
+
+    // a * b + c, fused when the target has FMA.
+    static inline SimdDouble MulAdd(SimdDouble const& a, SimdDouble const& b,
+        SimdDouble const& c);
+    static inline SimdDouble Min(SimdDouble const& a, SimdDouble const& b);
+    static inline SimdDouble Max(SimdDouble const& a, SimdDouble const& b);
+
+    // Rounding to the nearest integer (ties to even) and absolute value.
+    // Round is exact for |a| < 2^51.
+    static inline SimdDouble Round(SimdDouble const& a);
+    static inline SimdDouble Abs(SimdDouble const& a);
+
+    // Lane-wise a < b.  The mask can only be used by Select, which returns
+    // the lanes of a where the mask is set and the lanes of b elsewhere.
+    static inline SimdDouble LessThan(SimdDouble const& a, SimdDouble const& b);
+    static inline SimdDouble Select(SimdDouble const& mask, SimdDouble const& a,
+        SimdDouble const& b);
+
+    // Sum, minimum and maximum of the lanes.
+    inline double HorizontalSum() const;
+    inline double HorizontalMin() const;
+    inline double HorizontalMax() const;
+
+    inline Register Get() const { return mV; }
+
+private:
+    Register mV;
+};
+
+inline SimdDouble operator+(SimdDouble const& a, SimdDouble const& b);
+inline SimdDouble operator-(SimdDouble const& a, SimdDouble const& b);
+inline SimdDouble operator*(SimdDouble const& a, SimdDouble const& b);
+inline SimdDouble operator/(SimdDouble const& a, SimdDouble const& b);
+
+//----------------------------------------------------------------------------
+inline char const* SimdDouble::Name()
+{
+#if defined(CMNMATH_SIMD_AVX)
+#if defined(__FMA__)
+    return "AVX+FMA";
+#else
+    return "AVX";
+#endif
+#elif defined(CMNMATH_SIMD_SSE2)
+    return "SSE2";
+#elif defined(CMNMATH_SIMD_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+//----------------------------------------------------------------------------
+inline SimdDouble SimdDouble::Zero()
+{
+#if defined(CMNMATH_SIMD_AVX)
+    return _mm256_setzero_pd();
+#elif defined(CMNMATH_SIMD_SSE2)
+    return _mm_setzero_pd();
+#elif defined(CMNMATH_SIMD_NEON)
+    return vdupq_n_f64(0.0);
+#else
+    return 0.0;
+#endif
+}
+//----------------------------------------------------------------------------
+inline SimdDouble SimdDouble::Set(double value)
+{
+#if defined(CMNMATH_SIMD_AVX)
+    return _mm256_set1_pd(value);
+#elif defined(CMNMATH_SIMD_SSE2)
+    return _mm_set1_pd(value);
+#elif defined(CMNMATH_SIMD_NEON)
+    return vdupq_n_f64(value);
+#else
+    return value;
+#endif
+}
+//----------------------------------------------------------------------------
+inline SimdDouble SimdDouble::Load(double const* data)
+{
+#if defined(CMNMATH_SIMD_AVX)
+    return _mm256_loadu_pd(data);
+#elif defined(CMNMATH_SIMD_SSE2)
+    return _mm_loadu_pd(data);
+#elif defined(CMNMATH_SIMD_NEON)
+    return vld1q_f64(data);
+#else
+    return *data;
+#endif
+}
+//----------------------------------------------------------------------------
+inline SimdDouble SimdDouble::Load(float const* data)
+{
+#if defined(CMNMATH_SIMD_AVX)
+    return _mm256_cvtps_pd(_mm_loadu_ps(data));
+#elif defined(CMNMATH_SIMD_SSE2)
+    return _mm_cvtps_pd(_mm_castsi128_ps(
+        _mm_loadl_epi64(reinterpret_cast<__m128i const*>(data))));
+#elif defined(CMNMATH_SIMD_NEON)
+    return vcvt_f64_f32(vld1_f32(data));
+#else
+    return static_cast<double>(*data);
+#endif
+}
+//----------------------------------------------------------------------------
+inline void SimdDouble::Store(double* data) const
+{
+#if defined(CMNMATH_SIMD_AVX)
+    _mm256_storeu_pd(data, mV);
+#elif defined(CMNMATH_SIMD_SSE2)
+    _mm_storeu_pd(data, mV);
+#elif defined(CMNMATH_SIMD_NEON)
+    vst1q_f64(data, mV);
+#else
+    *data = mV;
+#endif
+}
+//----------------------------------------------------------------------------
+inline SimdDouble SimdDouble::MulAdd(SimdDouble const& a, SimdDouble const& b,
+    SimdDouble const& c)
+{
+#if defined(CMNMATH_SIMD_AVX) && defined(__FMA__)
+    return _mm256_fmadd_pd(a.mV, b.mV, c.mV);
+#elif defined(CMNMATH_SIMD_NEON)
+    return vfmaq_f64(c.mV, a.mV, b.mV);
+#else
+    return a * b + c;
+#endif
+}
+//----------------------------------------------------------------------------
+inline SimdDouble SimdDouble::Min(SimdDouble const& a, SimdDouble const& b)
+{
+#if defined(CMNMATH_SIMD_AVX)
+    return _mm256_min_pd(a.mV, b.mV);
+#elif defined(CMNMATH_SIMD_SSE2)
+    return _mm_min_pd(a.mV, b.mV);
+#elif defined(CMNMATH_SIMD_NEON)
+    return vminq_f64(a.mV, b.mV);
+#else
+    return std::min(a.mV, b.mV);
+#endif
+}
+//----------------------------------------------------------------------------
+inline SimdDouble SimdDouble::Max(SimdDouble const& a, SimdDouble const& b)
+{
+#if defined(CMNMATH_SIMD_AVX)
+    return _mm256_max_pd(a.mV, b.mV);
+#elif defined(CMNMATH_SIMD_SSE2)
+    return _mm_max_pd(a.mV, b.mV);
+#elif defined(CMNMATH_SIMD_NEON)
+    return vmaxq_f64(a.mV, b.mV);
+#else
+    return std::max(a.mV, b.mV);
+#endif
+}
+//----------------------------------------------------------------------------
+inline SimdDouble SimdDouble::Round(SimdDouble const& a)
+{
+#if defined(CMNMATH_SIMD_AVX)
+    return _mm256_round_pd(a.mV, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#elif defined(CMNMATH_SIMD_SSE2)
+    // Adding and subtracting 1.5 * 2^52 drops the fraction bits.
+    __m128d magic = _mm_set1_pd(6755399441055744.0);
+    return _mm_sub_pd(_mm_add_pd(a.mV, magic), magic);
+#elif defined(CMNMATH_SIMD_NEON)
+    return vrndnq_f64(a.mV);
+#else
+    return std::nearbyint(a.mV);
+#endif
+}
+//----------------------------------------------------------------------------
+inline SimdDouble SimdDouble::Abs(SimdDouble const& a)
+{
+#if defined(CMNMATH_SIMD_AVX)
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a.mV);
+#elif defined(CMNMATH_SIMD_SSE2)
+    return _mm_andnot_pd(_mm_set1_pd(-0.0), a.mV);
+#elif defined(CMNMATH_SIMD_NEON)
+    return vabsq_f64(a.mV);
+#else
+    return std::fabs(a.mV);
+#endif
+}
+//----------------------------------------------------------------------------
+inline SimdDouble SimdDouble::LessThan(SimdDouble const& a, SimdDouble const& b)
+{
+#if defined(CMNMATH_SIMD_AVX)
+    return _mm256_cmp_pd(a.mV, b.mV, _CMP_LT_OQ);
+#elif defined(CMNMATH_SIMD_SSE2)
+    return _mm_cmplt_pd(a.mV, b.mV);
+#elif defined(CMNMATH_SIMD_NEON)
+    return vreinterpretq_f64_u64(vcltq_f64(a.mV, b.mV));
+#else
+    return a.mV < b.mV ? 1.0 : 0.0;
+#endif
+}
+//----------------------------------------------------------------------------
+inline SimdDouble SimdDouble::Select(SimdDouble const& mask,
+    SimdDouble const& a, SimdDouble const& b)
+{
+#if defined(CMNMATH_SIMD_AVX)
+    return _mm256_blendv_pd(b.mV, a.mV, mask.mV);
+#elif defined(CMNMATH_SIMD_SSE2)
+    return _mm_or_pd(_mm_and_pd(mask.mV, a.mV), _mm_andnot_pd(mask.mV, b.mV));
+#elif defined(CMNMATH_SIMD_NEON)
+    return vbslq_f64(vreinterpretq_u64_f64(mask.mV), a.mV, b.mV);
+#else
+    return mask.mV != 0.0 ? a.mV : b.mV;
+#endif
+}
+//----------------------------------------------------------------------------
+inline double SimdDouble::HorizontalSum() const
+{
+    double lanes[WIDTH];
+    Store(lanes);
+    double sum = lanes[0];
+    for (int i = 1; i < WIDTH; ++i)
+    {
+        sum += lanes[i];
+    }
+    return sum;
+}
+//----------------------------------------------------------------------------
+inline double SimdDouble::HorizontalMin() const
+{
+    double lanes[WIDTH];
+    Store(lanes);
+    return *std::min_element(lanes, lanes + WIDTH);
+}
+//----------------------------------------------------------------------------
+inline double SimdDouble::HorizontalMax() const
+{
+    double lanes[WIDTH];
+    Store(lanes);
+    return *std::max_element(lanes, lanes + WIDTH);
+}
+//----------------------------------------------------------------------------
+inline SimdDouble operator+(SimdDouble const& a, SimdDouble const& b)
+{
+#if defined(CMNMATH_SIMD_AVX)
+    return _mm256_add_pd(a.Get(), b.Get());
+#elif defined(CMNMATH_SIMD_SSE2)
+    return _mm_add_pd(a.Get(), b.Get());
+#elif defined(CMNMATH_SIMD_NEON)
+    return vaddq_f64(a.Get(), b.Get());
+#else
+    return a.Get() + b.Get();
+#endif
+}
+//----------------------------------------------------------------------------
+inline SimdDouble operator-(SimdDouble const& a, SimdDouble const& b)
+{
+#if defined(CMNMATH_SIMD_AVX)
+    return _mm256_sub_pd(a.Get(), b.Get());
+#elif defined(CMNMATH_SIMD_SSE2)
+    return _mm_sub_pd(a.Get(), b.Get());
+#elif defined(CMNMATH_SIMD_NEON)
+    return vsubq_f64(a.Get(), b.Get());
+#else
+    return a.Get() - b.Get();
+#endif
+}
+//----------------------------------------------------------------------------
+inline SimdDouble operator*(SimdDouble const& a, SimdDouble const& b)
+{
+#if defined(CMNMATH_SIMD_AVX)
+    return _mm256_mul_pd(a.Get(), b.Get());
+#elif defined(CMNMATH_SIMD_SSE2)
+    return _mm_mul_pd(a.Get(), b.Get());
+#elif defined(CMNMATH_SIMD_NEON)
+    return vmulq_f64(a.Get(), b.Get());
+#else
+    return a.Get() * b.Get();
+#endif
+}
+//----------------------------------------------------------------------------
+inline SimdDouble operator/(SimdDouble const& a, SimdDouble const& b)
+{
+#if defined(CMNMATH_SIMD_AVX)
+    return _mm256_div_pd(a.Get(), b.Get());
+#elif defined(CMNMATH_SIMD_SSE2)
+    return _mm_div_pd(a.Get(), b.Get());
+#elif defined(CMNMATH_SIMD_NEON)
+    return vdivq_f64(a.Get(), b.Get());
+#else
+    return a.Get() / b.Get();
+#endif
+}
+//----------------------------------------------------------------------------
+
+} // namespace core
+} // namespace CmnMath
+
+#endif /* CMNMATH_CMNMATHCORE_SIMD_HPP__ */
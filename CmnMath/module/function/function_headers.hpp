@@ -28,6 +28,7 @@
 #include "inc/function/ACosEstimate.hpp"
 #include "inc/function/ASinEstimate.hpp"
 #include "inc/function/ATanEstimate.hpp"
+#include "inc/function/BatchEstimate.hpp"
 #include "inc/function/ChebyshevRatio.hpp"
 #include "inc/function/CosEstimate.hpp"
 #include "inc/function/Exp2Estimate.hpp"
@@ -36,6 +37,7 @@
 #include "inc/function/InvSqrtEstimate.hpp"
 #include "inc/function/Log2Estimate.hpp"
 #include "inc/function/LogEstimate.hpp"
+#include "inc/function/QuaternionBatch.hpp"
 #include "inc/function/SinEstimate.hpp"
 #include "inc/function/SlerpEstimate.hpp"
 #include "inc/function/SqrtEstimate.hpp"
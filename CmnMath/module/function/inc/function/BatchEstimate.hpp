@@ -0,0 +1,88 @@
+/**
+* @file BatchEstimate.hpp
+* @brief Batched SIMD evaluation of the function estimates.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef CMNMATH_FUNCTION_BATCHESTIMATE_HPP__
+#define CMNMATH_FUNCTION_BATCHESTIMATE_HPP__
+
+#include <cstddef>
+
+namespace CmnMath
+{
+namespace function
+{
+
+/** Batched evaluation of the polynomial estimates on arrays of floats.
+    @remarks
+        The kernels are compiled for SSE2, AVX2+FMA and AVX-512F in their
+        own translation units; the instruction set is chosen at run time
+        from the CPU (the best one supported), or forced with SetISA.  The
+        kernels apply the same range reduction as DegreeRR<D> of float, and
+        give the values out of their domain (zero, denormals, infinities
+        and NaN of Log2, Sqrt and InvSqrt, the exponents out of
+        [-126, 128] of Exp2) to DegreeRR<D> itself: the results are the
+        scalar ones, up to a few ulps for the fused multiply-add of AVX2
+        and AVX-512.
+    @par
+        The estimates use them through their Evaluate<D>(in, out, n)
+        member; in and out may be the same array.
+    @code
+        std::vector<float> x(n), y(n);
+        SinEstimate<float>::Evaluate<11>(x.data(), y.data(), n);
+    @endcode
+*/
+class BatchEstimate
+{
+public:
+    enum Function { SIN, COS, ATAN, EXP2, LOG2, SQRT, INVSQRT };
+    enum ISA { ISA_SCALAR, ISA_SSE2, ISA_AVX2, ISA_AVX512 };
+
+    // The best instruction set supported by the CPU among the compiled
+    // ones.  It is detected once.
+    static ISA GetSupportedISA();
+
+    // The instruction set used by Evaluate, GetSupportedISA() by default.
+    // SetISA fails if the CPU does not support isa.  ISA_SCALAR disables
+    // the batched kernels.
+    static ISA GetISA();
+    static bool SetISA(ISA isa);
+    static char const* GetName(ISA isa);
+
+    // Evaluate the range-reduced estimate of the given degree on n floats.
+    // Return false, without writing out, if there is no kernel for the
+    // current instruction set or for the degree: the caller evaluates the
+    // scalar estimate instead.
+    static bool Evaluate(Function function, int degree, float const* in,
+        float* out, size_t n);
+
+    // Only float arrays have kernels.
+    template <typename Real>
+    static bool Evaluate(Function, int, Real const*, Real*, size_t)
+    {
+        return false;
+    }
+};
+
+} // namespace function
+} // namespace CmnMath
+
+#endif /* CMNMATH_FUNCTION_BATCHESTIMATE_HPP__ */
@@ -15,6 +15,7 @@
 #define CMNMATH_FUNCTION_COSESTIMATE_HPP__
 
 #include "cmnmathcore/inc/cmnmathcore/define_constants.hpp"
+#include "BatchEstimate.hpp"
 
 namespace CmnMath
 {
@@ -39,6 +40,11 @@ public:
     template <int D>
     inline static Real DegreeRR(Real x);
 
+    // Evaluate DegreeRR<D> on the n values of in (out may be in).  The
+    // float arrays use the SIMD kernels of BatchEstimate.
+    template <int D>
+    static void Evaluate(Real const* in, Real* out, size_t n);
+
 private:
     // Metaprogramming and private implementation to allow specialization of
     // a template member function.
@@ -72,6 +78,19 @@ inline Real CosEstimate<Real>::DegreeRR(Real x)
 }
 //----------------------------------------------------------------------------
 template <typename Real>
+template <int D>
+void CosEstimate<Real>::Evaluate(Real const* in, Real* out, size_t n)
+{
+    if (!BatchEstimate::Evaluate(BatchEstimate::COS, D, in, out, n))
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            out[i] = DegreeRR<D>(in[i]);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
 inline Real CosEstimate<Real>::Evaluate(degree<2>, Real x)
 {
     Real xsqr = x * x;
@@ -14,6 +14,7 @@
 
 #include <cmath>
 #include "cmnmathcore/inc/cmnmathcore/define_constants.hpp"
+#include "BatchEstimate.hpp"
 
 namespace CmnMath
 {
@@ -38,6 +39,11 @@ public:
     template <int D>
     inline static Real DegreeRR(Real x);
 
+    // Evaluate DegreeRR<D> on the n values of in (out may be in).  The
+    // float arrays use the SIMD kernels of BatchEstimate.
+    template <int D>
+    static void Evaluate(Real const* in, Real* out, size_t n);
+
 private:
     // Metaprogramming and private implementation to allow specialization of
     // a template member function.
@@ -75,6 +81,19 @@ inline Real Log2Estimate<Real>::DegreeRR(Real x)
 }
 //----------------------------------------------------------------------------
 template <typename Real>
+template <int D>
+void Log2Estimate<Real>::Evaluate(Real const* in, Real* out, size_t n)
+{
+    if (!BatchEstimate::Evaluate(BatchEstimate::LOG2, D, in, out, n))
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            out[i] = DegreeRR<D>(in[i]);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
 inline Real Log2Estimate<Real>::Evaluate(degree<1>, Real t)
 {
     Real poly;
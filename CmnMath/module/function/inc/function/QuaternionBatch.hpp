@@ -0,0 +1,133 @@
+/**
+* @file QuaternionBatch.hpp
+* @brief Quaternions stored as a structure of arrays.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef CMNMATH_FUNCTION_QUATERNIONBATCH_HPP__
+#define CMNMATH_FUNCTION_QUATERNIONBATCH_HPP__
+
+#include <cstddef>
+#include <vector>
+
+#include "algebra/inc/algebra/quaternion.hpp"
+
+namespace CmnMath
+{
+namespace function
+{
+
+/** Array of quaternions stored as a structure of arrays.
+    @remarks
+        The components x, y, z and w (the order of the tuple of Quaternion)
+        are in four separate arrays, so a loop over the quaternions reads
+        consecutive values of each component and is vectorized by the
+        compiler.  Used by the batched functions of SLERP.
+    @code
+        QuaternionBatch<float> q0(n), q1(n), q(n);
+        std::vector<float> t(n);
+        ...
+        SLERP<float>::EstimateR<8>(t.data(), q0, q1, q);
+    @endcode
+*/
+template <typename Real>
+class QuaternionBatch
+{
+public:
+    // Construction.  The components are initialized to zero.
+    QuaternionBatch();
+    explicit QuaternionBatch(size_t size);
+
+    // The number of quaternions.  Resize keeps the first quaternions.
+    inline size_t GetSize() const;
+    void Resize(size_t size);
+
+    // Access to the quaternion i.
+    algebra::Quaternion<Real> Get(size_t i) const;
+    void Set(size_t i, algebra::Quaternion<Real> const& q);
+
+    // The array of the component j in {0,1,2,3} (x, y, z or w).
+    inline Real* Data(int j);
+    inline Real const* Data(int j) const;
+
+private:
+    std::vector<Real> mComponent[4];
+};
+
+//----------------------------------------------------------------------------
+template <typename Real>
+QuaternionBatch<Real>::QuaternionBatch()
+{
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+QuaternionBatch<Real>::QuaternionBatch(size_t size)
+{
+    Resize(size);
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+size_t QuaternionBatch<Real>::GetSize() const
+{
+    return mComponent[0].size();
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void QuaternionBatch<Real>::Resize(size_t size)
+{
+    for (int j = 0; j < 4; ++j)
+    {
+        mComponent[j].resize(size, (Real)0);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+algebra::Quaternion<Real> QuaternionBatch<Real>::Get(size_t i) const
+{
+    return algebra::Quaternion<Real>(mComponent[0][i], mComponent[1][i],
+        mComponent[2][i], mComponent[3][i]);
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void QuaternionBatch<Real>::Set(size_t i, algebra::Quaternion<Real> const& q)
+{
+    for (int j = 0; j < 4; ++j)
+    {
+        mComponent[j][i] = q[j];
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+Real* QuaternionBatch<Real>::Data(int j)
+{
+    return mComponent[j].data();
+}
+//----------------------------------------------------------------------------
+template <typename Real> inline
+Real const* QuaternionBatch<Real>::Data(int j) const
+{
+    return mComponent[j].data();
+}
+//----------------------------------------------------------------------------
+
+} // namespace function
+} // namespace CmnMath
+
+#endif /* CMNMATH_FUNCTION_QUATERNIONBATCH_HPP__ */
@@ -15,6 +15,7 @@
 #define CMNMATH_FUNCTION_SINESTIMATE_HPP__
 
 #include "Log2Estimate.hpp"
+#include "BatchEstimate.hpp"
 
 namespace CmnMath
 {
@@ -39,6 +40,11 @@ public:
     template <int D>
     inline static Real DegreeRR(Real x);
 
+    // Evaluate DegreeRR<D> on the n values of in (out may be in).  The
+    // float arrays use the SIMD kernels of BatchEstimate.
+    template <int D>
+    static void Evaluate(Real const* in, Real* out, size_t n);
+
 private:
     // Metaprogramming and private implementation to allow specialization of
     // a template member function.
@@ -69,6 +75,19 @@ inline Real SinEstimate<Real>::DegreeRR(Real x)
 }
 //----------------------------------------------------------------------------
 template <typename Real>
+template <int D>
+void SinEstimate<Real>::Evaluate(Real const* in, Real* out, size_t n)
+{
+    if (!BatchEstimate::Evaluate(BatchEstimate::SIN, D, in, out, n))
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            out[i] = DegreeRR<D>(in[i]);
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
 inline Real SinEstimate<Real>::Evaluate(degree<3>, Real x)
 {
     Real xsqr = x * x;
@@ -25,7 +25,13 @@
 #ifndef CMNMATH_FUNCTION_SLERPESTIMATE_HPP__
 #define CMNMATH_FUNCTION_SLERPESTIMATE_HPP__
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "algebra/inc/algebra/quaternion.hpp"
+#include "ChebyshevRatio.hpp"
+#include "QuaternionBatch.hpp"
 
 namespace CmnMath
 {
@@ -102,6 +108,59 @@ public:
 	inline static algebra::Quaternion<Real> EstimateRPH(Real t,
 		algebra::Quaternion<Real> const& q0, algebra::Quaternion<Real> const& q1,
 		algebra::Quaternion<Real> const& qh, Real omcosAH);
+
+	// Batched versions for the pairs (q0[i],q1[i]) of QuaternionBatch, with
+	// the parameter t[i].  The result q may be q0 or q1 and is resized to
+	// the size of q0.  The loops have no branches and are vectorized by the
+	// compiler across the quaternions, which for GCC requires -O3 (or
+	// -ftree-vectorize) in the translation unit that calls them; at -O2
+	// they run at the speed of the scalar functions.  The coefficients of
+	// q0 and q1 have the errors of ChebyshevRatio<Real>::GetEstimate<N>:
+	// the first table of GteChebyshevRatio.h for Estimate and EstimateR,
+	// the second one (angles in [0,pi/4]) for EstimateRPH.
+	template <int N>
+	static void Estimate(Real const* t, QuaternionBatch<Real> const& q0,
+		QuaternionBatch<Real> const& q1, QuaternionBatch<Real>& q);
+
+	template <int N>
+	static void EstimateR(Real const* t, QuaternionBatch<Real> const& q0,
+		QuaternionBatch<Real> const& q1, QuaternionBatch<Real>& q);
+
+	// Preprocessing for the batched EstimateRPH: q1[i] is negated when
+	// Dot(q0[i],q1[i]) < 0, qh[i] = slerp(1/2,q0[i],q1[i]) and
+	// omcosAH[i] = 1 - cos(A/2).
+	static void PreprocessRPH(QuaternionBatch<Real> const& q0,
+		QuaternionBatch<Real>& q1, QuaternionBatch<Real>& qh,
+		std::vector<Real>& omcosAH);
+
+	template <int N>
+	static void EstimateRPH(Real const* t, QuaternionBatch<Real> const& q0,
+		QuaternionBatch<Real> const& q1, QuaternionBatch<Real> const& qh,
+		Real const* omcosAH, QuaternionBatch<Real>& q);
+
+	// Normalized linear interpolation: ((1-t)*q0 + t*q1)/|(1-t)*q0 + t*q1|,
+	// with q1 negated when Dot(q0,q1) < 0.  Faster than the estimates, but
+	// the speed is not constant: the angle between the result and
+	// slerp(t,q0,q1) is at most 0.0711 radians (for A = pi/2), and zero for
+	// t in {0,1/2,1}.
+	static void Nlerp(Real const* t, QuaternionBatch<Real> const& q0,
+		QuaternionBatch<Real> const& q1, QuaternionBatch<Real>& q);
+
+private:
+	// The batches are processed in blocks, with the temporary values on the
+	// stack.
+	enum { BLOCK_SIZE = 64 };
+
+	// dot[i] = Dot(a[i0+i],b[i0+i]) for i < m.
+	static void DotBlock(size_t i0, size_t m,
+		QuaternionBatch<Real> const& a, QuaternionBatch<Real> const& b,
+		Real* dot);
+
+	// q[i0+i] = f0[i]*a[i0+i] + f1[i]*b[i0+i] for i < m.
+	static void CombineBlock(size_t i0, size_t m,
+		QuaternionBatch<Real> const& a, Real const* f0,
+		QuaternionBatch<Real> const& b, Real const* f1,
+		QuaternionBatch<Real>& q);
 };
 
 //----------------------------------------------------------------------------
@@ -176,6 +235,207 @@ algebra::Quaternion<Real> const& qh, Real omcosAH)
     }
 }
 //----------------------------------------------------------------------------
+template <typename Real> template <int N>
+void SLERP<Real>::Estimate(Real const* t, QuaternionBatch<Real> const& q0,
+    QuaternionBatch<Real> const& q1, QuaternionBatch<Real>& q)
+{
+    static_assert(1 <= N && N <= 16, "Invalid degree.");
+
+    size_t const n = q0.GetSize();
+    q.Resize(n);
+    Real cs[BLOCK_SIZE], y[BLOCK_SIZE], f0[BLOCK_SIZE], f1[BLOCK_SIZE];
+    for (size_t i0 = 0; i0 < n; i0 += BLOCK_SIZE)
+    {
+        size_t const m = std::min<size_t>(BLOCK_SIZE, n - i0);
+        DotBlock(i0, m, q0, q1, cs);
+        for (size_t i = 0; i < m; ++i)
+        {
+            y[i] = (Real)1 - std::abs(cs[i]);
+        }
+        ChebyshevRatio<Real>::template GetEstimate<N>(m, t + i0, y, f0, f1);
+        for (size_t i = 0; i < m; ++i)
+        {
+            f1[i] = (cs[i] >= (Real)0 ? f1[i] : -f1[i]);
+        }
+        CombineBlock(i0, m, q0, f0, q1, f1, q);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real> template <int N>
+void SLERP<Real>::EstimateR(Real const* t, QuaternionBatch<Real> const& q0,
+    QuaternionBatch<Real> const& q1, QuaternionBatch<Real>& q)
+{
+    static_assert(1 <= N && N <= 16, "Invalid degree.");
+
+    size_t const n = q0.GetSize();
+    q.Resize(n);
+    Real y[BLOCK_SIZE], f0[BLOCK_SIZE], f1[BLOCK_SIZE];
+    for (size_t i0 = 0; i0 < n; i0 += BLOCK_SIZE)
+    {
+        size_t const m = std::min<size_t>(BLOCK_SIZE, n - i0);
+        DotBlock(i0, m, q0, q1, y);
+        for (size_t i = 0; i < m; ++i)
+        {
+            y[i] = (Real)1 - y[i];
+        }
+        ChebyshevRatio<Real>::template GetEstimate<N>(m, t + i0, y, f0, f1);
+        CombineBlock(i0, m, q0, f0, q1, f1, q);
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void SLERP<Real>::PreprocessRPH(QuaternionBatch<Real> const& q0,
+    QuaternionBatch<Real>& q1, QuaternionBatch<Real>& qh,
+    std::vector<Real>& omcosAH)
+{
+    size_t const n = q0.GetSize();
+    qh.Resize(n);
+    omcosAH.resize(n);
+    Real cs[BLOCK_SIZE];
+    for (size_t i0 = 0; i0 < n; i0 += BLOCK_SIZE)
+    {
+        size_t const m = std::min<size_t>(BLOCK_SIZE, n - i0);
+        DotBlock(i0, m, q0, q1, cs);
+        for (int j = 0; j < 4; ++j)
+        {
+            Real const* a = q0.Data(j) + i0;
+            Real* b = q1.Data(j) + i0;
+            Real* h = qh.Data(j) + i0;
+            for (size_t i = 0; i < m; ++i)
+            {
+                b[i] = (cs[i] >= (Real)0 ? b[i] : -b[i]);
+                h[i] = a[i] + b[i];
+            }
+        }
+        for (size_t i = 0; i < m; ++i)
+        {
+            Real cosAH = std::sqrt(((Real)1 + std::abs(cs[i])) / (Real)2);
+            omcosAH[i0 + i] = (Real)1 - cosAH;
+            cs[i] = (Real)1 / ((Real)2 * cosAH);
+        }
+        for (int j = 0; j < 4; ++j)
+        {
+            Real* h = qh.Data(j) + i0;
+            for (size_t i = 0; i < m; ++i)
+            {
+                h[i] *= cs[i];
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real> template <int N>
+void SLERP<Real>::EstimateRPH(Real const* t, QuaternionBatch<Real> const& q0,
+    QuaternionBatch<Real> const& q1, QuaternionBatch<Real> const& qh,
+    Real const* omcosAH, QuaternionBatch<Real>& q)
+{
+    static_assert(1 <= N && N <= 16, "Invalid degree.");
+
+    size_t const n = q0.GetSize();
+    q.Resize(n);
+    Real s[BLOCK_SIZE], f0[BLOCK_SIZE], f1[BLOCK_SIZE];
+    Real c0[BLOCK_SIZE], ch[BLOCK_SIZE], c1[BLOCK_SIZE];
+    for (size_t i0 = 0; i0 < n; i0 += BLOCK_SIZE)
+    {
+        size_t const m = std::min<size_t>(BLOCK_SIZE, n - i0);
+        for (size_t i = 0; i < m; ++i)
+        {
+            Real twoT = t[i0 + i] * (Real)2;
+            s[i] = (twoT <= (Real)1 ? twoT : twoT - (Real)1);
+        }
+        ChebyshevRatio<Real>::template GetEstimate<N>(m, s, omcosAH + i0,
+            f0, f1);
+        // slerp(2*t,q0,qh) for t <= 1/2, slerp(2*t-1,qh,q1) otherwise.
+        for (size_t i = 0; i < m; ++i)
+        {
+            bool lower = (t[i0 + i] * (Real)2 <= (Real)1);
+            c0[i] = (lower ? f0[i] : (Real)0);
+            ch[i] = (lower ? f1[i] : f0[i]);
+            c1[i] = (lower ? (Real)0 : f1[i]);
+        }
+        for (int j = 0; j < 4; ++j)
+        {
+            Real const* a = q0.Data(j) + i0;
+            Real const* h = qh.Data(j) + i0;
+            Real const* b = q1.Data(j) + i0;
+            Real* r = q.Data(j) + i0;
+            for (size_t i = 0; i < m; ++i)
+            {
+                r[i] = c0[i] * a[i] + ch[i] * h[i] + c1[i] * b[i];
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void SLERP<Real>::Nlerp(Real const* t, QuaternionBatch<Real> const& q0,
+    QuaternionBatch<Real> const& q1, QuaternionBatch<Real>& q)
+{
+    size_t const n = q0.GetSize();
+    q.Resize(n);
+    Real f0[BLOCK_SIZE], f1[BLOCK_SIZE];
+    for (size_t i0 = 0; i0 < n; i0 += BLOCK_SIZE)
+    {
+        size_t const m = std::min<size_t>(BLOCK_SIZE, n - i0);
+        DotBlock(i0, m, q0, q1, f1);
+        for (size_t i = 0; i < m; ++i)
+        {
+            f0[i] = (Real)1 - t[i0 + i];
+            f1[i] = (f1[i] >= (Real)0 ? t[i0 + i] : -t[i0 + i]);
+        }
+        CombineBlock(i0, m, q0, f0, q1, f1, q);
+        DotBlock(i0, m, q, q, f0);
+        for (size_t i = 0; i < m; ++i)
+        {
+            f0[i] = (Real)1 / std::sqrt(f0[i]);
+        }
+        for (int j = 0; j < 4; ++j)
+        {
+            Real* r = q.Data(j) + i0;
+            for (size_t i = 0; i < m; ++i)
+            {
+                r[i] *= f0[i];
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void SLERP<Real>::DotBlock(size_t i0, size_t m,
+    QuaternionBatch<Real> const& a, QuaternionBatch<Real> const& b, Real* dot)
+{
+    for (size_t i = 0; i < m; ++i)
+    {
+        dot[i] = (Real)0;
+    }
+    for (int j = 0; j < 4; ++j)
+    {
+        Real const* aj = a.Data(j) + i0;
+        Real const* bj = b.Data(j) + i0;
+        for (size_t i = 0; i < m; ++i)
+        {
+            dot[i] += aj[i] * bj[i];
+        }
+    }
+}
+//----------------------------------------------------------------------------
+template <typename Real>
+void SLERP<Real>::CombineBlock(size_t i0, size_t m,
+    QuaternionBatch<Real> const& a, Real const* f0,
+    QuaternionBatch<Real> const& b, Real const* f1, QuaternionBatch<Real>& q)
+{
+    for (int j = 0; j < 4; ++j)
+    {
+        Real const* aj = a.Data(j) + i0;
+        Real const* bj = b.Data(j) + i0;
+        Real* qj = q.Data(j) + i0;
+        for (size_t i = 0; i < m; ++i)
+        {
+            qj[i] = f0[i] * aj[i] + f1[i] * bj[i];
+        }
+    }
+}
+//----------------------------------------------------------------------------
 
 } // namespace function
 } // namespace CmnMath
@@ -0,0 +1,273 @@
+/* @file BatchEstimate.cpp
+ * @brief Selection of the instruction set of the batched estimates.
+ *
+ * @section LICENSE
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @author Alessandro Moro <alessandromoro.italy@gmail.com>
+ * @bug No known bugs.
+ * @version 0.1.0.0
+ *
+ */
+
+#include <atomic>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#include "function/inc/function/BatchEstimate.hpp"
+#include "function/inc/function/Exp2Estimate.hpp"
+#include "function/inc/function/InvSqrtEstimate.hpp"
+#include "function/inc/function/Log2Estimate.hpp"
+#include "function/inc/function/SqrtEstimate.hpp"
+
+namespace CmnMath
+{
+namespace function
+{
+namespace detail
+{
+
+// Defined in BatchEstimate<ISA>.cpp, compiled with the flags of the
+// instruction set.  scalar is the DegreeRR of the function, for the values
+// out of the domain of the kernel.
+bool HasBatchSSE2();
+bool HasBatchAVX2();
+bool HasBatchAVX512();
+bool EvaluateBatchSSE2(int function, int degree, float (*scalar)(float),
+    float const* in, float* out, size_t n);
+bool EvaluateBatchAVX2(int function, int degree, float (*scalar)(float),
+    float const* in, float* out, size_t n);
+bool EvaluateBatchAVX512(int function, int degree, float (*scalar)(float),
+    float const* in, float* out, size_t n);
+
+} // namespace detail
+
+namespace
+{
+
+// Instruction sets supported by the CPU (the OS must save the registers).
+bool CPUHasAVX2()
+{
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    if (!osxsave || !fma || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+bool CPUHasAVX512()
+{
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("avx512f");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0xe6) != 0xe6)
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 16)) != 0;
+#else
+    return false;
+#endif
+}
+
+bool Supports(BatchEstimate::ISA isa)
+{
+    switch (isa)
+    {
+    case BatchEstimate::ISA_SCALAR:
+        return true;
+    case BatchEstimate::ISA_SSE2:
+        // Part of x86-64, the unit is not compiled on other CPUs.
+        return detail::HasBatchSSE2();
+    case BatchEstimate::ISA_AVX2:
+        return detail::HasBatchAVX2() && CPUHasAVX2();
+    case BatchEstimate::ISA_AVX512:
+        return detail::HasBatchAVX512() && CPUHasAVX512();
+    }
+    return false;
+}
+
+BatchEstimate::ISA DetectISA()
+{
+    BatchEstimate::ISA const order[] =
+    {
+        BatchEstimate::ISA_AVX512,
+        BatchEstimate::ISA_AVX2,
+        BatchEstimate::ISA_SSE2
+    };
+    for (auto isa : order)
+    {
+        if (Supports(isa))
+        {
+            return isa;
+        }
+    }
+    return BatchEstimate::ISA_SCALAR;
+}
+
+typedef float (*Scalar)(float);
+
+// DegreeRR of the functions with a limited domain in the kernels, compiled
+// here without the flags of the instruction sets.  Sin, Cos and ATan do not
+// need it.
+Scalar GetScalar(BatchEstimate::Function function, int degree)
+{
+    switch (function)
+    {
+    case BatchEstimate::EXP2:
+        switch (degree)
+        {
+        case 1: return &Exp2Estimate<float>::DegreeRR<1>;
+        case 2: return &Exp2Estimate<float>::DegreeRR<2>;
+        case 3: return &Exp2Estimate<float>::DegreeRR<3>;
+        case 4: return &Exp2Estimate<float>::DegreeRR<4>;
+        case 5: return &Exp2Estimate<float>::DegreeRR<5>;
+        case 6: return &Exp2Estimate<float>::DegreeRR<6>;
+        case 7: return &Exp2Estimate<float>::DegreeRR<7>;
+        }
+        break;
+    case BatchEstimate::LOG2:
+        switch (degree)
+        {
+        case 1: return &Log2Estimate<float>::DegreeRR<1>;
+        case 2: return &Log2Estimate<float>::DegreeRR<2>;
+        case 3: return &Log2Estimate<float>::DegreeRR<3>;
+        case 4: return &Log2Estimate<float>::DegreeRR<4>;
+        case 5: return &Log2Estimate<float>::DegreeRR<5>;
+        case 6: return &Log2Estimate<float>::DegreeRR<6>;
+        case 7: return &Log2Estimate<float>::DegreeRR<7>;
+        case 8: return &Log2Estimate<float>::DegreeRR<8>;
+        }
+        break;
+    case BatchEstimate::SQRT:
+        switch (degree)
+        {
+        case 1: return &SqrtEstimate<float>::DegreeRR<1>;
+        case 2: return &SqrtEstimate<float>::DegreeRR<2>;
+        case 3: return &SqrtEstimate<float>::DegreeRR<3>;
+        case 4: return &SqrtEstimate<float>::DegreeRR<4>;
+        case 5: return &SqrtEstimate<float>::DegreeRR<5>;
+        case 6: return &SqrtEstimate<float>::DegreeRR<6>;
+        case 7: return &SqrtEstimate<float>::DegreeRR<7>;
+        case 8: return &SqrtEstimate<float>::DegreeRR<8>;
+        }
+        break;
+    case BatchEstimate::INVSQRT:
+        switch (degree)
+        {
+        case 1: return &InvSqrtEstimate<float>::DegreeRR<1>;
+        case 2: return &InvSqrtEstimate<float>::DegreeRR<2>;
+        case 3: return &InvSqrtEstimate<float>::DegreeRR<3>;
+        case 4: return &InvSqrtEstimate<float>::DegreeRR<4>;
+        case 5: return &InvSqrtEstimate<float>::DegreeRR<5>;
+        case 6: return &InvSqrtEstimate<float>::DegreeRR<6>;
+        case 7: return &InvSqrtEstimate<float>::DegreeRR<7>;
+        case 8: return &InvSqrtEstimate<float>::DegreeRR<8>;
+        }
+        break;
+    default:
+        break;
+    }
+    return nullptr;
+}
+
+// -1 until the first call.
+std::atomic<int> gCurrentISA(-1);
+
+} // namespace
+
+BatchEstimate::ISA BatchEstimate::GetSupportedISA()
+{
+    static ISA const supported = DetectISA();
+    return supported;
+}
+
+BatchEstimate::ISA BatchEstimate::GetISA()
+{
+    int isa = gCurrentISA.load(std::memory_order_relaxed);
+    if (isa < 0)
+    {
+        isa = static_cast<int>(GetSupportedISA());
+        gCurrentISA.store(isa, std::memory_order_relaxed);
+    }
+    return static_cast<ISA>(isa);
+}
+
+bool BatchEstimate::SetISA(ISA isa)
+{
+    if (!Supports(isa))
+    {
+        return false;
+    }
+    gCurrentISA.store(static_cast<int>(isa), std::memory_order_relaxed);
+    return true;
+}
+
+char const* BatchEstimate::GetName(ISA isa)
+{
+    switch (isa)
+    {
+    case ISA_SCALAR: return "scalar";
+    case ISA_SSE2: return "SSE2";
+    case ISA_AVX2: return "AVX2";
+    case ISA_AVX512: return "AVX-512";
+    }
+    return "unknown";
+}
+
+bool BatchEstimate::Evaluate(Function function, int degree, float const* in,
+    float* out, size_t n)
+{
+    Scalar scalar = GetScalar(function, degree);
+    if (scalar == nullptr && function != SIN && function != COS &&
+        function != ATAN)
+    {
+        return false;
+    }
+
+    switch (GetISA())
+    {
+    case ISA_SSE2:
+        return detail::EvaluateBatchSSE2(function, degree, scalar, in, out,
+            n);
+    case ISA_AVX2:
+        return detail::EvaluateBatchAVX2(function, degree, scalar, in, out,
+            n);
+    case ISA_AVX512:
+        return detail::EvaluateBatchAVX512(function, degree, scalar, in, out,
+            n);
+    default:
+        return false;
+    }
+}
+
+} // namespace function
+} // namespace CmnMath
@@ -0,0 +1,150 @@
+/* @file BatchEstimateAVX512.cpp
+ * @brief Batched estimates on AVX-512F, 16 floats per register.
+ *
+ * @section LICENSE
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @author Alessandro Moro <alessandromoro.italy@gmail.com>
+ * @bug No known bugs.
+ * @version 0.1.0.0
+ *
+ */
+
+#include <cstddef>
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+
+namespace CmnMath
+{
+namespace function
+{
+namespace
+{
+
+size_t const WIDTH = 16;
+
+struct F
+{
+    F() {}
+    explicit F(__m512 v_) : v(v_) {}
+    __m512 v;
+};
+typedef __m512i I;
+typedef __mmask16 M;
+
+inline F operator+(F a, F b) { return F(_mm512_add_ps(a.v, b.v)); }
+inline F operator-(F a, F b) { return F(_mm512_sub_ps(a.v, b.v)); }
+inline F operator*(F a, F b) { return F(_mm512_mul_ps(a.v, b.v)); }
+inline F operator/(F a, F b) { return F(_mm512_div_ps(a.v, b.v)); }
+inline F Load(float const* p) { return F(_mm512_loadu_ps(p)); }
+inline void Store(float* p, F a) { _mm512_storeu_ps(p, a.v); }
+inline F Set(float a) { return F(_mm512_set1_ps(a)); }
+
+inline F MulAdd(F a, F b, F c) { return F(_mm512_fmadd_ps(a.v, b.v, c.v)); }
+
+inline F Abs(F a)
+{
+    return F(_mm512_castsi512_ps(_mm512_and_epi32(
+        _mm512_castps_si512(a.v), _mm512_set1_epi32(0x7fffffff))));
+}
+
+inline F Floor(F a)
+{
+    return F(_mm512_roundscale_ps(a.v, _MM_FROUND_TO_NEG_INF |
+        _MM_FROUND_NO_EXC));
+}
+
+inline M Less(F a, F b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ); }
+
+inline bool InRange(F a, F lo, F hi)
+{
+    return (_mm512_cmp_ps_mask(a.v, lo.v, _CMP_GE_OQ) &
+        _mm512_cmp_ps_mask(a.v, hi.v, _CMP_LE_OQ)) == 0xffff;
+}
+
+inline F Select(M m, F a, F b) { return F(_mm512_mask_blend_ps(m, b.v, a.v)); }
+
+inline I AsInt(F a) { return _mm512_castps_si512(a.v); }
+inline F AsFloat(I a) { return F(_mm512_castsi512_ps(a)); }
+inline I ToInt(F a) { return _mm512_cvttps_epi32(a.v); }
+inline F ToFloat(I a) { return F(_mm512_cvtepi32_ps(a)); }
+inline I SetInt(int a) { return _mm512_set1_epi32(a); }
+inline I AddInt(I a, I b) { return _mm512_add_epi32(a, b); }
+inline I SubInt(I a, I b) { return _mm512_sub_epi32(a, b); }
+inline I AndInt(I a, I b) { return _mm512_and_epi32(a, b); }
+inline I OrInt(I a, I b) { return _mm512_or_epi32(a, b); }
+template <int N> inline I ShiftLeft(I a) { return _mm512_slli_epi32(a, N); }
+template <int N> inline I ShiftRightLogical(I a)
+{
+    return _mm512_srli_epi32(a, N);
+}
+template <int N> inline I ShiftRightArith(I a)
+{
+    return _mm512_srai_epi32(a, N);
+}
+
+} // namespace
+} // namespace function
+} // namespace CmnMath
+
+#include "BatchEstimateKernels.hpp"
+
+namespace CmnMath
+{
+namespace function
+{
+namespace detail
+{
+
+bool HasBatchAVX512()
+{
+    return true;
+}
+
+bool EvaluateBatchAVX512(int function, int degree, float (*scalar)(float),
+    float const* in, float* out, size_t n)
+{
+    return EvaluateKernel(function, degree, scalar, in, out, n);
+}
+
+} // namespace detail
+} // namespace function
+} // namespace CmnMath
+
+#else
+
+namespace CmnMath
+{
+namespace function
+{
+namespace detail
+{
+
+// Not compiled for AVX-512F.
+bool HasBatchAVX512()
+{
+    return false;
+}
+
+bool EvaluateBatchAVX512(int, int, float (*)(float), float const*, float*,
+    size_t)
+{
+    return false;
+}
+
+} // namespace detail
+} // namespace function
+} // namespace CmnMath
+
+#endif
@@ -0,0 +1,747 @@
+/**
+* @file BatchEstimateKernels.hpp
+* @brief Kernels of the batched estimates, compiled once per instruction set.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+// Included by the translation unit of an instruction set, after the
+// definition of its registers in an unnamed namespace:
+//   F           float register, WIDTH lanes
+//   I           int32 register
+//   M           mask returned by Less
+//   Load, Store, Set, +, -, *, /, MulAdd, Abs, Floor, Less, InRange,
+//   Select, AsInt, AsFloat, SetInt, ToInt, ToFloat, AddInt, SubInt, AndInt,
+//   OrInt, ShiftLeft<N>, ShiftRightLogical<N>, ShiftRightArith<N>
+// Everything here has internal linkage: the code compiled with the flags
+// of an instruction set is never shared with the other units.  The units
+// are compiled without contraction of a*b+c: the only fused operations are
+// the explicit MulAdd of Horner, so the results differ from DegreeRR by a
+// few ulps at most.
+
+#ifndef CMNMATH_FUNCTION_BATCHESTIMATEKERNELS_HPP__
+#define CMNMATH_FUNCTION_BATCHESTIMATEKERNELS_HPP__
+
+#include <cfloat>
+
+#include "cmnmathcore/inc/cmnmathcore/define_constants.hpp"
+#include "function/inc/function/BatchEstimate.hpp"
+
+namespace CmnMath
+{
+namespace function
+{
+namespace
+{
+
+// Sin, lowest power first.
+float const kSinDeg3[] =
+{
+    (float)GTE_C_SIN_DEG3_C0, (float)GTE_C_SIN_DEG3_C1
+};
+float const kSinDeg5[] =
+{
+    (float)GTE_C_SIN_DEG5_C0, (float)GTE_C_SIN_DEG5_C1,
+    (float)GTE_C_SIN_DEG5_C2
+};
+float const kSinDeg7[] =
+{
+    (float)GTE_C_SIN_DEG7_C0, (float)GTE_C_SIN_DEG7_C1,
+    (float)GTE_C_SIN_DEG7_C2, (float)GTE_C_SIN_DEG7_C3
+};
+float const kSinDeg9[] =
+{
+    (float)GTE_C_SIN_DEG9_C0, (float)GTE_C_SIN_DEG9_C1,
+    (float)GTE_C_SIN_DEG9_C2, (float)GTE_C_SIN_DEG9_C3,
+    (float)GTE_C_SIN_DEG9_C4
+};
+float const kSinDeg11[] =
+{
+    (float)GTE_C_SIN_DEG11_C0, (float)GTE_C_SIN_DEG11_C1,
+    (float)GTE_C_SIN_DEG11_C2, (float)GTE_C_SIN_DEG11_C3,
+    (float)GTE_C_SIN_DEG11_C4, (float)GTE_C_SIN_DEG11_C5
+};
+
+// Cos, lowest power first.
+float const kCosDeg2[] =
+{
+    (float)GTE_C_COS_DEG2_C0, (float)GTE_C_COS_DEG2_C1
+};
+float const kCosDeg4[] =
+{
+    (float)GTE_C_COS_DEG4_C0, (float)GTE_C_COS_DEG4_C1,
+    (float)GTE_C_COS_DEG4_C2
+};
+float const kCosDeg6[] =
+{
+    (float)GTE_C_COS_DEG6_C0, (float)GTE_C_COS_DEG6_C1,
+    (float)GTE_C_COS_DEG6_C2, (float)GTE_C_COS_DEG6_C3
+};
+float const kCosDeg8[] =
+{
+    (float)GTE_C_COS_DEG8_C0, (float)GTE_C_COS_DEG8_C1,
+    (float)GTE_C_COS_DEG8_C2, (float)GTE_C_COS_DEG8_C3,
+    (float)GTE_C_COS_DEG8_C4
+};
+float const kCosDeg10[] =
+{
+    (float)GTE_C_COS_DEG10_C0, (float)GTE_C_COS_DEG10_C1,
+    (float)GTE_C_COS_DEG10_C2, (float)GTE_C_COS_DEG10_C3,
+    (float)GTE_C_COS_DEG10_C4, (float)GTE_C_COS_DEG10_C5
+};
+
+// ATan, lowest power first.
+float const kATanDeg3[] =
+{
+    (float)GTE_C_ATAN_DEG3_C0, (float)GTE_C_ATAN_DEG3_C1
+};
+float const kATanDeg5[] =
+{
+    (float)GTE_C_ATAN_DEG5_C0, (float)GTE_C_ATAN_DEG5_C1,
+    (float)GTE_C_ATAN_DEG5_C2
+};
+float const kATanDeg7[] =
+{
+    (float)GTE_C_ATAN_DEG7_C0, (float)GTE_C_ATAN_DEG7_C1,
+    (float)GTE_C_ATAN_DEG7_C2, (float)GTE_C_ATAN_DEG7_C3
+};
+float const kATanDeg9[] =
+{
+    (float)GTE_C_ATAN_DEG9_C0, (float)GTE_C_ATAN_DEG9_C1,
+    (float)GTE_C_ATAN_DEG9_C2, (float)GTE_C_ATAN_DEG9_C3,
+    (float)GTE_C_ATAN_DEG9_C4
+};
+float const kATanDeg11[] =
+{
+    (float)GTE_C_ATAN_DEG11_C0, (float)GTE_C_ATAN_DEG11_C1,
+    (float)GTE_C_ATAN_DEG11_C2, (float)GTE_C_ATAN_DEG11_C3,
+    (float)GTE_C_ATAN_DEG11_C4, (float)GTE_C_ATAN_DEG11_C5
+};
+float const kATanDeg13[] =
+{
+    (float)GTE_C_ATAN_DEG13_C0, (float)GTE_C_ATAN_DEG13_C1,
+    (float)GTE_C_ATAN_DEG13_C2, (float)GTE_C_ATAN_DEG13_C3,
+    (float)GTE_C_ATAN_DEG13_C4, (float)GTE_C_ATAN_DEG13_C5,
+    (float)GTE_C_ATAN_DEG13_C6
+};
+
+// Exp2, lowest power first.
+float const kExp2Deg1[] =
+{
+    (float)GTE_C_EXP2_DEG1_C0, (float)GTE_C_EXP2_DEG1_C1
+};
+float const kExp2Deg2[] =
+{
+    (float)GTE_C_EXP2_DEG2_C0, (float)GTE_C_EXP2_DEG2_C1,
+    (float)GTE_C_EXP2_DEG2_C2
+};
+float const kExp2Deg3[] =
+{
+    (float)GTE_C_EXP2_DEG3_C0, (float)GTE_C_EXP2_DEG3_C1,
+    (float)GTE_C_EXP2_DEG3_C2, (float)GTE_C_EXP2_DEG3_C3
+};
+float const kExp2Deg4[] =
+{
+    (float)GTE_C_EXP2_DEG4_C0, (float)GTE_C_EXP2_DEG4_C1,
+    (float)GTE_C_EXP2_DEG4_C2, (float)GTE_C_EXP2_DEG4_C3,
+    (float)GTE_C_EXP2_DEG4_C4
+};
+float const kExp2Deg5[] =
+{
+    (float)GTE_C_EXP2_DEG5_C0, (float)GTE_C_EXP2_DEG5_C1,
+    (float)GTE_C_EXP2_DEG5_C2, (float)GTE_C_EXP2_DEG5_C3,
+    (float)GTE_C_EXP2_DEG5_C4, (float)GTE_C_EXP2_DEG5_C5
+};
+float const kExp2Deg6[] =
+{
+    (float)GTE_C_EXP2_DEG6_C0, (float)GTE_C_EXP2_DEG6_C1,
+    (float)GTE_C_EXP2_DEG6_C2, (float)GTE_C_EXP2_DEG6_C3,
+    (float)GTE_C_EXP2_DEG6_C4, (float)GTE_C_EXP2_DEG6_C5,
+    (float)GTE_C_EXP2_DEG6_C6
+};
+float const kExp2Deg7[] =
+{
+    (float)GTE_C_EXP2_DEG7_C0, (float)GTE_C_EXP2_DEG7_C1,
+    (float)GTE_C_EXP2_DEG7_C2, (float)GTE_C_EXP2_DEG7_C3,
+    (float)GTE_C_EXP2_DEG7_C4, (float)GTE_C_EXP2_DEG7_C5,
+    (float)GTE_C_EXP2_DEG7_C6, (float)GTE_C_EXP2_DEG7_C7
+};
+
+// Log2, lowest power first.
+float const kLog2Deg1[] =
+{
+    (float)GTE_C_LOG2_DEG1_C1
+};
+float const kLog2Deg2[] =
+{
+    (float)GTE_C_LOG2_DEG2_C1, (float)GTE_C_LOG2_DEG2_C2
+};
+float const kLog2Deg3[] =
+{
+    (float)GTE_C_LOG2_DEG3_C1, (float)GTE_C_LOG2_DEG3_C2,
+    (float)GTE_C_LOG2_DEG3_C3
+};
+float const kLog2Deg4[] =
+{
+    (float)GTE_C_LOG2_DEG4_C1, (float)GTE_C_LOG2_DEG4_C2,
+    (float)GTE_C_LOG2_DEG4_C3, (float)GTE_C_LOG2_DEG4_C4
+};
+float const kLog2Deg5[] =
+{
+    (float)GTE_C_LOG2_DEG5_C1, (float)GTE_C_LOG2_DEG5_C2,
+    (float)GTE_C_LOG2_DEG5_C3, (float)GTE_C_LOG2_DEG5_C4,
+    (float)GTE_C_LOG2_DEG5_C5
+};
+float const kLog2Deg6[] =
+{
+    (float)GTE_C_LOG2_DEG6_C1, (float)GTE_C_LOG2_DEG6_C2,
+    (float)GTE_C_LOG2_DEG6_C3, (float)GTE_C_LOG2_DEG6_C4,
+    (float)GTE_C_LOG2_DEG6_C5, (float)GTE_C_LOG2_DEG6_C6
+};
+float const kLog2Deg7[] =
+{
+    (float)GTE_C_LOG2_DEG7_C1, (float)GTE_C_LOG2_DEG7_C2,
+    (float)GTE_C_LOG2_DEG7_C3, (float)GTE_C_LOG2_DEG7_C4,
+    (float)GTE_C_LOG2_DEG7_C5, (float)GTE_C_LOG2_DEG7_C6,
+    (float)GTE_C_LOG2_DEG7_C7
+};
+float const kLog2Deg8[] =
+{
+    (float)GTE_C_LOG2_DEG8_C1, (float)GTE_C_LOG2_DEG8_C2,
+    (float)GTE_C_LOG2_DEG8_C3, (float)GTE_C_LOG2_DEG8_C4,
+    (float)GTE_C_LOG2_DEG8_C5, (float)GTE_C_LOG2_DEG8_C6,
+    (float)GTE_C_LOG2_DEG8_C7, (float)GTE_C_LOG2_DEG8_C8
+};
+
+// Sqrt, lowest power first.
+float const kSqrtDeg1[] =
+{
+    (float)GTE_C_SQRT_DEG1_C0, (float)GTE_C_SQRT_DEG1_C1
+};
+float const kSqrtDeg2[] =
+{
+    (float)GTE_C_SQRT_DEG2_C0, (float)GTE_C_SQRT_DEG2_C1,
+    (float)GTE_C_SQRT_DEG2_C2
+};
+float const kSqrtDeg3[] =
+{
+    (float)GTE_C_SQRT_DEG3_C0, (float)GTE_C_SQRT_DEG3_C1,
+    (float)GTE_C_SQRT_DEG3_C2, (float)GTE_C_SQRT_DEG3_C3
+};
+float const kSqrtDeg4[] =
+{
+    (float)GTE_C_SQRT_DEG4_C0, (float)GTE_C_SQRT_DEG4_C1,
+    (float)GTE_C_SQRT_DEG4_C2, (float)GTE_C_SQRT_DEG4_C3,
+    (float)GTE_C_SQRT_DEG4_C4
+};
+float const kSqrtDeg5[] =
+{
+    (float)GTE_C_SQRT_DEG5_C0, (float)GTE_C_SQRT_DEG5_C1,
+    (float)GTE_C_SQRT_DEG5_C2, (float)GTE_C_SQRT_DEG5_C3,
+    (float)GTE_C_SQRT_DEG5_C4, (float)GTE_C_SQRT_DEG5_C5
+};
+float const kSqrtDeg6[] =
+{
+    (float)GTE_C_SQRT_DEG6_C0, (float)GTE_C_SQRT_DEG6_C1,
+    (float)GTE_C_SQRT_DEG6_C2, (float)GTE_C_SQRT_DEG6_C3,
+    (float)GTE_C_SQRT_DEG6_C4, (float)GTE_C_SQRT_DEG6_C5,
+    (float)GTE_C_SQRT_DEG6_C6
+};
+float const kSqrtDeg7[] =
+{
+    (float)GTE_C_SQRT_DEG7_C0, (float)GTE_C_SQRT_DEG7_C1,
+    (float)GTE_C_SQRT_DEG7_C2, (float)GTE_C_SQRT_DEG7_C3,
+    (float)GTE_C_SQRT_DEG7_C4, (float)GTE_C_SQRT_DEG7_C5,
+    (float)GTE_C_SQRT_DEG7_C6, (float)GTE_C_SQRT_DEG7_C7
+};
+float const kSqrtDeg8[] =
+{
+    (float)GTE_C_SQRT_DEG8_C0, (float)GTE_C_SQRT_DEG8_C1,
+    (float)GTE_C_SQRT_DEG8_C2, (float)GTE_C_SQRT_DEG8_C3,
+    (float)GTE_C_SQRT_DEG8_C4, (float)GTE_C_SQRT_DEG8_C5,
+    (float)GTE_C_SQRT_DEG8_C6, (float)GTE_C_SQRT_DEG8_C7,
+    (float)GTE_C_SQRT_DEG8_C8
+};
+
+// InvSqrt, lowest power first.
+float const kInvSqrtDeg1[] =
+{
+    (float)GTE_C_INVSQRT_DEG1_C0, (float)GTE_C_INVSQRT_DEG1_C1
+};
+float const kInvSqrtDeg2[] =
+{
+    (float)GTE_C_INVSQRT_DEG2_C0, (float)GTE_C_INVSQRT_DEG2_C1,
+    (float)GTE_C_INVSQRT_DEG2_C2
+};
+float const kInvSqrtDeg3[] =
+{
+    (float)GTE_C_INVSQRT_DEG3_C0, (float)GTE_C_INVSQRT_DEG3_C1,
+    (float)GTE_C_INVSQRT_DEG3_C2, (float)GTE_C_INVSQRT_DEG3_C3
+};
+float const kInvSqrtDeg4[] =
+{
+    (float)GTE_C_INVSQRT_DEG4_C0, (float)GTE_C_INVSQRT_DEG4_C1,
+    (float)GTE_C_INVSQRT_DEG4_C2, (float)GTE_C_INVSQRT_DEG4_C3,
+    (float)GTE_C_INVSQRT_DEG4_C4
+};
+float const kInvSqrtDeg5[] =
+{
+    (float)GTE_C_INVSQRT_DEG5_C0, (float)GTE_C_INVSQRT_DEG5_C1,
+    (float)GTE_C_INVSQRT_DEG5_C2, (float)GTE_C_INVSQRT_DEG5_C3,
+    (float)GTE_C_INVSQRT_DEG5_C4, (float)GTE_C_INVSQRT_DEG5_C5
+};
+float const kInvSqrtDeg6[] =
+{
+    (float)GTE_C_INVSQRT_DEG6_C0, (float)GTE_C_INVSQRT_DEG6_C1,
+    (float)GTE_C_INVSQRT_DEG6_C2, (float)GTE_C_INVSQRT_DEG6_C3,
+    (float)GTE_C_INVSQRT_DEG6_C4, (float)GTE_C_INVSQRT_DEG6_C5,
+    (float)GTE_C_INVSQRT_DEG6_C6
+};
+float const kInvSqrtDeg7[] =
+{
+    (float)GTE_C_INVSQRT_DEG7_C0, (float)GTE_C_INVSQRT_DEG7_C1,
+    (float)GTE_C_INVSQRT_DEG7_C2, (float)GTE_C_INVSQRT_DEG7_C3,
+    (float)GTE_C_INVSQRT_DEG7_C4, (float)GTE_C_INVSQRT_DEG7_C5,
+    (float)GTE_C_INVSQRT_DEG7_C6, (float)GTE_C_INVSQRT_DEG7_C7
+};
+float const kInvSqrtDeg8[] =
+{
+    (float)GTE_C_INVSQRT_DEG8_C0, (float)GTE_C_INVSQRT_DEG8_C1,
+    (float)GTE_C_INVSQRT_DEG8_C2, (float)GTE_C_INVSQRT_DEG8_C3,
+    (float)GTE_C_INVSQRT_DEG8_C4, (float)GTE_C_INVSQRT_DEG8_C5,
+    (float)GTE_C_INVSQRT_DEG8_C6, (float)GTE_C_INVSQRT_DEG8_C7,
+    (float)GTE_C_INVSQRT_DEG8_C8
+};
+//----------------------------------------------------------------------------
+template <int N>
+inline F Horner(float const (&c)[N], F x)
+{
+    F poly = Set(c[N - 1]);
+    for (int k = N - 2; k >= 0; --k)
+    {
+        poly = MulAdd(poly, x, Set(c[k]));
+    }
+    return poly;
+}
+//----------------------------------------------------------------------------
+// 2^p for integer p in [-126, 128] (128 gives infinity).
+inline F Pow2(I p)
+{
+    return AsFloat(ShiftLeft<23>(AddInt(p, SetInt(127))));
+}
+//----------------------------------------------------------------------------
+// x = y * 2^p with y in [1,2), for normal positive x (the other values are
+// given to the scalar estimate).
+inline void Split(F x, F& y, I& p)
+{
+    I bits = AsInt(x);
+    p = SubInt(ShiftRightLogical<23>(bits), SetInt(127));
+    y = AsFloat(OrInt(AndInt(bits, SetInt(0x007fffff)), SetInt(0x3f800000)));
+}
+//----------------------------------------------------------------------------
+// x - 2*pi*q in [-pi,pi], with q = x/(2*pi) rounded as the Reduce of the
+// scalar estimates: +-0.5 and the truncating conversion to int, which
+// gives the same quotient for the huge and the infinite angles.
+inline F ReduceAngle(F x)
+{
+    F q = x * Set((float)GTE_C_INV_TWO_PI);
+    q = q + Select(Less(x, Set(0.0f)), Set(-0.5f), Set(0.5f));
+    return x - Set((float)GTE_C_TWO_PI) * ToFloat(ToInt(q));
+}
+//----------------------------------------------------------------------------
+template <int N>
+struct SinOp
+{
+    explicit SinOp(float const (&c_)[N]) : c(c_) {}
+    float const (&c)[N];
+
+    inline F operator()(F x) const
+    {
+        // Map y to [-pi/2,pi/2] with sin(y) = sin(x).
+        F y = ReduceAngle(x);
+        F pi = Set((float)GTE_C_PI);
+        M flip = Less(Set((float)GTE_C_HALF_PI), Abs(y));
+        F pis = Select(Less(y, Set(0.0f)), Set(-(float)GTE_C_PI), pi);
+        y = Select(flip, pis - y, y);
+        return Horner(c, y * y) * y;
+    }
+};
+//----------------------------------------------------------------------------
+template <int N>
+struct CosOp
+{
+    explicit CosOp(float const (&c_)[N]) : c(c_) {}
+    float const (&c)[N];
+
+    inline F operator()(F x) const
+    {
+        // Map |y| to [0,pi/2] with cos(y) = sign*cos(x).
+        F a = Abs(ReduceAngle(x));
+        M flip = Less(Set((float)GTE_C_HALF_PI), a);
+        F y = Select(flip, Set((float)GTE_C_PI) - a, a);
+        F sign = Select(flip, Set(-1.0f), Set(1.0f));
+        return Horner(c, y * y) * sign;
+    }
+};
+//----------------------------------------------------------------------------
+template <int N>
+struct ATanOp
+{
+    explicit ATanOp(float const (&c_)[N]) : c(c_) {}
+    float const (&c)[N];
+
+    inline F operator()(F x) const
+    {
+        // atan(x) = +-pi/2 - atan(1/x) for |x| > 1.
+        M big = Less(Set(1.0f), Abs(x));
+        F y = Select(big, Set(1.0f) / x, x);
+        F poly = Horner(c, y * y) * y;
+        F halfPi = Select(Less(x, Set(0.0f)), Set(-(float)GTE_C_HALF_PI),
+            Set((float)GTE_C_HALF_PI));
+        return Select(big, halfPi - poly, poly);
+    }
+};
+//----------------------------------------------------------------------------
+template <int N>
+struct Exp2Op
+{
+    explicit Exp2Op(float const (&c_)[N]) : c(c_) {}
+    float const (&c)[N];
+
+    // Below 2^-126 the result is denormal, above 2^128 infinite.
+    static float Lowest() { return -126.0f; }
+    static float Highest() { return 128.0f; }
+
+    inline F operator()(F x) const
+    {
+        x = Select(Less(x, Set(-126.0f)), Set(-126.0f), x);
+        x = Select(Less(Set(128.0f), x), Set(128.0f), x);
+        F p = Floor(x);
+        return Horner(c, x - p) * Pow2(ToInt(p));
+    }
+};
+//----------------------------------------------------------------------------
+template <int N>
+struct Log2Op
+{
+    explicit Log2Op(float const (&c_)[N]) : c(c_) {}
+    float const (&c)[N];
+
+    static float Lowest() { return FLT_MIN; }
+    static float Highest() { return FLT_MAX; }
+
+    inline F operator()(F x) const
+    {
+        F y;
+        I p;
+        Split(x, y, p);
+        F t = y - Set(1.0f);
+        return Horner(c, t) * t + ToFloat(p);
+    }
+};
+//----------------------------------------------------------------------------
+template <int N>
+struct SqrtOp
+{
+    explicit SqrtOp(float const (&c_)[N]) : c(c_) {}
+    float const (&c)[N];
+
+    static float Lowest() { return FLT_MIN; }
+    static float Highest() { return FLT_MAX; }
+
+    inline F operator()(F x) const
+    {
+        // sqrt(y*2^p) = adj*sqrt(y)*2^floor(p/2), adj = sqrt(2) if p odd.
+        F y;
+        I p;
+        Split(x, y, p);
+        M odd = Less(Set(0.5f), ToFloat(AndInt(p, SetInt(1))));
+        F adj = Select(odd, Set((float)GTE_C_SQRT_2), Set(1.0f));
+        return adj * Horner(c, y - Set(1.0f)) *
+            Pow2(ShiftRightArith<1>(p));
+    }
+};
+//----------------------------------------------------------------------------
+template <int N>
+struct InvSqrtOp
+{
+    explicit InvSqrtOp(float const (&c_)[N]) : c(c_) {}
+    float const (&c)[N];
+
+    static float Lowest() { return FLT_MIN; }
+    static float Highest() { return FLT_MAX; }
+
+    inline F operator()(F x) const
+    {
+        // 1/sqrt(y*2^p) = adj/sqrt(y)*2^-floor(p/2), adj = 1/sqrt(2) if p
+        // odd.
+        F y;
+        I p;
+        Split(x, y, p);
+        M odd = Less(Set(0.5f), ToFloat(AndInt(p, SetInt(1))));
+        F adj = Select(odd, Set((float)GTE_C_INV_SQRT_2), Set(1.0f));
+        return adj * Horner(c, y - Set(1.0f)) *
+            Pow2(SubInt(SetInt(0), ShiftRightArith<1>(p)));
+    }
+};
+//----------------------------------------------------------------------------
+template <typename Op>
+void Run(Op const& op, float const* in, float* out, size_t n)
+{
+    size_t i = 0;
+    for (; i + WIDTH <= n; i += WIDTH)
+    {
+        Store(out + i, op(Load(in + i)));
+    }
+    if (i < n)
+    {
+        // The last values are padded with 1, valid for all the functions.
+        float tmpIn[WIDTH], tmpOut[WIDTH];
+        size_t k = 0;
+        for (; k < n - i; ++k)
+        {
+            tmpIn[k] = in[i + k];
+        }
+        for (; k < WIDTH; ++k)
+        {
+            tmpIn[k] = 1.0f;
+        }
+        Store(tmpOut, op(Load(tmpIn)));
+        for (k = 0; k < n - i; ++k)
+        {
+            out[i + k] = tmpOut[k];
+        }
+    }
+}
+//----------------------------------------------------------------------------
+// Run for the functions with a domain [Op::Lowest(), Op::Highest()]: the
+// values out of it (zero, denormals, infinities, NaN, ...) are given to the
+// scalar estimate, to have the same results in all the instruction sets.
+template <typename Op>
+inline F RunChecked(Op const& op, float (*scalar)(float), F x)
+{
+    F y = op(x);
+    if (!InRange(x, Set(Op::Lowest()), Set(Op::Highest())))
+    {
+        float tmpIn[WIDTH], tmpOut[WIDTH];
+        Store(tmpIn, x);
+        Store(tmpOut, y);
+        for (size_t k = 0; k < WIDTH; ++k)
+        {
+            if (!(tmpIn[k] >= Op::Lowest() && tmpIn[k] <= Op::Highest()))
+            {
+                tmpOut[k] = scalar(tmpIn[k]);
+            }
+        }
+        y = Load(tmpOut);
+    }
+    return y;
+}
+
+template <typename Op>
+void RunChecked(Op const& op, float (*scalar)(float), float const* in,
+    float* out, size_t n)
+{
+    size_t i = 0;
+    for (; i + WIDTH <= n; i += WIDTH)
+    {
+        Store(out + i, RunChecked(op, scalar, Load(in + i)));
+    }
+    if (i < n)
+    {
+        // The last values are padded with 1, in all the domains.
+        float tmpIn[WIDTH], tmpOut[WIDTH];
+        size_t k = 0;
+        for (; k < n - i; ++k)
+        {
+            tmpIn[k] = in[i + k];
+        }
+        for (; k < WIDTH; ++k)
+        {
+            tmpIn[k] = 1.0f;
+        }
+        Store(tmpOut, RunChecked(op, scalar, Load(tmpIn)));
+        for (k = 0; k < n - i; ++k)
+        {
+            out[i + k] = tmpOut[k];
+        }
+    }
+}
+//----------------------------------------------------------------------------
+// scalar is DegreeRR<degree> of the function, for the values out of the
+// domain of the kernels of Exp2, Log2, Sqrt and InvSqrt.
+bool EvaluateKernel(int function, int degree, float (*scalar)(float),
+    float const* in, float* out, size_t n)
+{
+    switch (function)
+    {
+    case BatchEstimate::SIN:
+        switch (degree)
+        {
+        case 3: Run(SinOp<2>(kSinDeg3), in, out, n); return true;
+        case 5: Run(SinOp<3>(kSinDeg5), in, out, n); return true;
+        case 7: Run(SinOp<4>(kSinDeg7), in, out, n); return true;
+        case 9: Run(SinOp<5>(kSinDeg9), in, out, n); return true;
+        case 11: Run(SinOp<6>(kSinDeg11), in, out, n); return true;
+        }
+        break;
+    case BatchEstimate::COS:
+        switch (degree)
+        {
+        case 2: Run(CosOp<2>(kCosDeg2), in, out, n); return true;
+        case 4: Run(CosOp<3>(kCosDeg4), in, out, n); return true;
+        case 6: Run(CosOp<4>(kCosDeg6), in, out, n); return true;
+        case 8: Run(CosOp<5>(kCosDeg8), in, out, n); return true;
+        case 10: Run(CosOp<6>(kCosDeg10), in, out, n); return true;
+        }
+        break;
+    case BatchEstimate::ATAN:
+        switch (degree)
+        {
+        case 3: Run(ATanOp<2>(kATanDeg3), in, out, n); return true;
+        case 5: Run(ATanOp<3>(kATanDeg5), in, out, n); return true;
+        case 7: Run(ATanOp<4>(kATanDeg7), in, out, n); return true;
+        case 9: Run(ATanOp<5>(kATanDeg9), in, out, n); return true;
+        case 11: Run(ATanOp<6>(kATanDeg11), in, out, n); return true;
+        case 13: Run(ATanOp<7>(kATanDeg13), in, out, n); return true;
+        }
+        break;
+    case BatchEstimate::EXP2:
+        switch (degree)
+        {
+        case 1:
+            RunChecked(Exp2Op<2>(kExp2Deg1), scalar, in, out, n);
+            return true;
+        case 2:
+            RunChecked(Exp2Op<3>(kExp2Deg2), scalar, in, out, n);
+            return true;
+        case 3:
+            RunChecked(Exp2Op<4>(kExp2Deg3), scalar, in, out, n);
+            return true;
+        case 4:
+            RunChecked(Exp2Op<5>(kExp2Deg4), scalar, in, out, n);
+            return true;
+        case 5:
+            RunChecked(Exp2Op<6>(kExp2Deg5), scalar, in, out, n);
+            return true;
+        case 6:
+            RunChecked(Exp2Op<7>(kExp2Deg6), scalar, in, out, n);
+            return true;
+        case 7:
+            RunChecked(Exp2Op<8>(kExp2Deg7), scalar, in, out, n);
+            return true;
+        }
+        break;
+    case BatchEstimate::LOG2:
+        switch (degree)
+        {
+        case 1:
+            RunChecked(Log2Op<1>(kLog2Deg1), scalar, in, out, n);
+            return true;
+        case 2:
+            RunChecked(Log2Op<2>(kLog2Deg2), scalar, in, out, n);
+            return true;
+        case 3:
+            RunChecked(Log2Op<3>(kLog2Deg3), scalar, in, out, n);
+            return true;
+        case 4:
+            RunChecked(Log2Op<4>(kLog2Deg4), scalar, in, out, n);
+            return true;
+        case 5:
+            RunChecked(Log2Op<5>(kLog2Deg5), scalar, in, out, n);
+            return true;
+        case 6:
+            RunChecked(Log2Op<6>(kLog2Deg6), scalar, in, out, n);
+            return true;
+        case 7:
+            RunChecked(Log2Op<7>(kLog2Deg7), scalar, in, out, n);
+            return true;
+        case 8:
+            RunChecked(Log2Op<8>(kLog2Deg8), scalar, in, out, n);
+            return true;
+        }
+        break;
+    case BatchEstimate::SQRT:
+        switch (degree)
+        {
+        case 1:
+            RunChecked(SqrtOp<2>(kSqrtDeg1), scalar, in, out, n);
+            return true;
+        case 2:
+            RunChecked(SqrtOp<3>(kSqrtDeg2), scalar, in, out, n);
+            return true;
+        case 3:
+            RunChecked(SqrtOp<4>(kSqrtDeg3), scalar, in, out, n);
+            return true;
+        case 4:
+            RunChecked(SqrtOp<5>(kSqrtDeg4), scalar, in, out, n);
+            return true;
+        case 5:
+            RunChecked(SqrtOp<6>(kSqrtDeg5), scalar, in, out, n);
+            return true;
+        case 6:
+            RunChecked(SqrtOp<7>(kSqrtDeg6), scalar, in, out, n);
+            return true;
+        case 7:
+            RunChecked(SqrtOp<8>(kSqrtDeg7), scalar, in, out, n);
+            return true;
+        case 8:
+            RunChecked(SqrtOp<9>(kSqrtDeg8), scalar, in, out, n);
+            return true;
+        }
+        break;
+    case BatchEstimate::INVSQRT:
+        switch (degree)
+        {
+        case 1:
+            RunChecked(InvSqrtOp<2>(kInvSqrtDeg1), scalar, in, out, n);
+            return true;
+        case 2:
+            RunChecked(InvSqrtOp<3>(kInvSqrtDeg2), scalar, in, out, n);
+            return true;
+        case 3:
+            RunChecked(InvSqrtOp<4>(kInvSqrtDeg3), scalar, in, out, n);
+            return true;
+        case 4:
+            RunChecked(InvSqrtOp<5>(kInvSqrtDeg4), scalar, in, out, n);
+            return true;
+        case 5:
+            RunChecked(InvSqrtOp<6>(kInvSqrtDeg5), scalar, in, out, n);
+            return true;
+        case 6:
+            RunChecked(InvSqrtOp<7>(kInvSqrtDeg6), scalar, in, out, n);
+            return true;
+        case 7:
+            RunChecked(InvSqrtOp<8>(kInvSqrtDeg7), scalar, in, out, n);
+            return true;
+        case 8:
+            RunChecked(InvSqrtOp<9>(kInvSqrtDeg8), scalar, in, out, n);
+            return true;
+        }
+        break;
+    }
+    return false;
+}
+//----------------------------------------------------------------------------
+
+} // namespace
+} // namespace function
+} // namespace CmnMath
+
+#endif /* CMNMATH_FUNCTION_BATCHESTIMATEKERNELS_HPP__ */
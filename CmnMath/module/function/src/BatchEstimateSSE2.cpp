@@ -0,0 +1,154 @@
+/* @file BatchEstimateSSE2.cpp
+ * @brief Batched estimates on SSE2, 4 floats per register.
+ *
+ * @section LICENSE
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @author Alessandro Moro <alessandromoro.italy@gmail.com>
+ * @bug No known bugs.
+ * @version 0.1.0.0
+ *
+ */
+
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+
+namespace CmnMath
+{
+namespace function
+{
+namespace
+{
+
+size_t const WIDTH = 4;
+
+struct F
+{
+    F() {}
+    explicit F(__m128 v_) : v(v_) {}
+    __m128 v;
+};
+typedef __m128i I;
+typedef __m128 M;
+
+inline F operator+(F a, F b) { return F(_mm_add_ps(a.v, b.v)); }
+inline F operator-(F a, F b) { return F(_mm_sub_ps(a.v, b.v)); }
+inline F operator*(F a, F b) { return F(_mm_mul_ps(a.v, b.v)); }
+inline F operator/(F a, F b) { return F(_mm_div_ps(a.v, b.v)); }
+inline F Load(float const* p) { return F(_mm_loadu_ps(p)); }
+inline void Store(float* p, F a) { _mm_storeu_ps(p, a.v); }
+inline F Set(float a) { return F(_mm_set1_ps(a)); }
+
+inline F MulAdd(F a, F b, F c) { return a * b + c; }
+
+inline F Abs(F a)
+{
+    return F(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v));
+}
+
+inline F Floor(F a)
+{
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+    return F(_mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a.v),
+        _mm_set1_ps(1.0f))));
+}
+
+inline M Less(F a, F b) { return _mm_cmplt_ps(a.v, b.v); }
+
+inline bool InRange(F a, F lo, F hi)
+{
+    return _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(a.v, lo.v),
+        _mm_cmple_ps(a.v, hi.v))) == 0xf;
+}
+
+inline F Select(M m, F a, F b)
+{
+    return F(_mm_or_ps(_mm_and_ps(m, a.v), _mm_andnot_ps(m, b.v)));
+}
+
+inline I AsInt(F a) { return _mm_castps_si128(a.v); }
+inline F AsFloat(I a) { return F(_mm_castsi128_ps(a)); }
+inline I ToInt(F a) { return _mm_cvttps_epi32(a.v); }
+inline F ToFloat(I a) { return F(_mm_cvtepi32_ps(a)); }
+inline I SetInt(int a) { return _mm_set1_epi32(a); }
+inline I AddInt(I a, I b) { return _mm_add_epi32(a, b); }
+inline I SubInt(I a, I b) { return _mm_sub_epi32(a, b); }
+inline I AndInt(I a, I b) { return _mm_and_si128(a, b); }
+inline I OrInt(I a, I b) { return _mm_or_si128(a, b); }
+template <int N> inline I ShiftLeft(I a) { return _mm_slli_epi32(a, N); }
+template <int N> inline I ShiftRightLogical(I a)
+{
+    return _mm_srli_epi32(a, N);
+}
+template <int N> inline I ShiftRightArith(I a)
+{
+    return _mm_srai_epi32(a, N);
+}
+
+} // namespace
+} // namespace function
+} // namespace CmnMath
+
+#include "BatchEstimateKernels.hpp"
+
+namespace CmnMath
+{
+namespace function
+{
+namespace detail
+{
+
+bool HasBatchSSE2()
+{
+    return true;
+}
+
+bool EvaluateBatchSSE2(int function, int degree, float (*scalar)(float),
+    float const* in, float* out, size_t n)
+{
+    return EvaluateKernel(function, degree, scalar, in, out, n);
+}
+
+} // namespace detail
+} // namespace function
+} // namespace CmnMath
+
+#else
+
+namespace CmnMath
+{
+namespace function
+{
+namespace detail
+{
+
+// Not compiled for SSE2.
+bool HasBatchSSE2()
+{
+    return false;
+}
+
+bool EvaluateBatchSSE2(int, int, float (*)(float), float const*, float*,
+    size_t)
+{
+    return false;
+}
+
+} // namespace detail
+} // namespace function
+} // namespace CmnMath
+
+#endif
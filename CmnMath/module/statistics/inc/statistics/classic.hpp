@@ -24,10 +24,16 @@
 #ifndef CMNMATH_STATISTICS_CLASSIC_HPP__ 
 #define CMNMATH_STATISTICS_CLASSIC_HPP__ 
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
 #include <vector>
 #include <numeric>
 #include <functional>
 
+#include "cmnmathcore/inc/cmnmathcore/simd.hpp"
+
 namespace CmnMath
 {
 namespace statistics
@@ -116,6 +122,285 @@ namespace classic
 //};
 
 
+namespace detail
+{
+
+/** @brief Number of elements reduced by the kernels at once. Larger series
+	are split in halves down to this size and the halves are summed
+	pairwise: the rounding error grows with log(n) instead of n.
+*/
+const size_t kBlockSize = 1024;
+
+/** @brief Kernels on a block: sum, sum of the squared deviations from
+	mean, minimum and maximum. Generic version.
+*/
+template<typename _Ty>
+CMN_64F block_sum(const _Ty *data, size_t n)
+{
+	CMN_64F s = 0;
+	for (size_t i = 0; i < n; ++i) s += static_cast<CMN_64F>(data[i]);
+	return s;
+}
+
+template<typename _Ty>
+CMN_64F block_squared_deviation(const _Ty *data, size_t n, CMN_64F mean)
+{
+	CMN_64F s = 0;
+	for (size_t i = 0; i < n; ++i) {
+		CMN_64F d = static_cast<CMN_64F>(data[i]) - mean;
+		s += d * d;
+	}
+	return s;
+}
+
+template<typename _Ty>
+void block_min_max(const _Ty *data, size_t n, CMN_64F &min, CMN_64F &max)
+{
+	for (size_t i = 0; i < n; ++i) {
+		CMN_64F v = static_cast<CMN_64F>(data[i]);
+		min = std::min(min, v);
+		max = std::max(max, v);
+	}
+}
+
+/** @brief SIMD kernels for float and double. Two registers are used to
+	hide the latency of the additions.
+*/
+template<typename _Ty>
+CMN_64F simd_block_sum(const _Ty *data, size_t n)
+{
+	typedef CmnMath::core::SimdDouble Simd;
+	Simd s0 = Simd::Zero(), s1 = Simd::Zero();
+	size_t i = 0;
+	for (; i + 2 * Simd::WIDTH <= n; i += 2 * Simd::WIDTH) {
+		s0 = s0 + Simd::Load(data + i);
+		s1 = s1 + Simd::Load(data + i + Simd::WIDTH);
+	}
+	CMN_64F s = (s0 + s1).HorizontalSum();
+	for (; i < n; ++i) s += static_cast<CMN_64F>(data[i]);
+	return s;
+}
+
+template<typename _Ty>
+CMN_64F simd_block_squared_deviation(const _Ty *data, size_t n, CMN_64F mean)
+{
+	typedef CmnMath::core::SimdDouble Simd;
+	Simd m = Simd::Set(mean);
+	Simd s0 = Simd::Zero(), s1 = Simd::Zero();
+	size_t i = 0;
+	for (; i + 2 * Simd::WIDTH <= n; i += 2 * Simd::WIDTH) {
+		Simd d0 = Simd::Load(data + i) - m;
+		Simd d1 = Simd::Load(data + i + Simd::WIDTH) - m;
+		s0 = Simd::MulAdd(d0, d0, s0);
+		s1 = Simd::MulAdd(d1, d1, s1);
+	}
+	CMN_64F s = (s0 + s1).HorizontalSum();
+	for (; i < n; ++i) {
+		CMN_64F d = static_cast<CMN_64F>(data[i]) - mean;
+		s += d * d;
+	}
+	return s;
+}
+
+template<typename _Ty>
+void simd_block_min_max(const _Ty *data, size_t n, CMN_64F &min, CMN_64F &max)
+{
+	typedef CmnMath::core::SimdDouble Simd;
+	size_t i = 0;
+	if (n >= Simd::WIDTH) {
+		Simd vmin = Simd::Set(min), vmax = Simd::Set(max);
+		for (; i + Simd::WIDTH <= n; i += Simd::WIDTH) {
+			Simd v = Simd::Load(data + i);
+			vmin = Simd::Min(vmin, v);
+			vmax = Simd::Max(vmax, v);
+		}
+		min = vmin.HorizontalMin();
+		max = vmax.HorizontalMax();
+	}
+	block_min_max(data + i, n - i, min, max);
+}
+
+inline CMN_64F block_sum(const float *data, size_t n) {
+	return simd_block_sum(data, n);
+}
+inline CMN_64F block_sum(const double *data, size_t n) {
+	return simd_block_sum(data, n);
+}
+inline CMN_64F block_squared_deviation(const float *data, size_t n,
+	CMN_64F mean) {
+	return simd_block_squared_deviation(data, n, mean);
+}
+inline CMN_64F block_squared_deviation(const double *data, size_t n,
+	CMN_64F mean) {
+	return simd_block_squared_deviation(data, n, mean);
+}
+inline void block_min_max(const float *data, size_t n, CMN_64F &min,
+	CMN_64F &max) {
+	simd_block_min_max(data, n, min, max);
+}
+inline void block_min_max(const double *data, size_t n, CMN_64F &min,
+	CMN_64F &max) {
+	simd_block_min_max(data, n, min, max);
+}
+
+/** @brief Pairwise sum of a series.
+*/
+template<typename _Ty>
+CMN_64F pairwise_sum(const _Ty *data, size_t n)
+{
+	if (n <= kBlockSize) return block_sum(data, n);
+	size_t half = (n / 2 + kBlockSize - 1) / kBlockSize * kBlockSize;
+	return pairwise_sum(data, half) + pairwise_sum(data + half, n - half);
+}
+
+/** @brief Pairwise sum of the squared deviations from mean.
+*/
+template<typename _Ty>
+CMN_64F pairwise_squared_deviation(const _Ty *data, size_t n, CMN_64F mean)
+{
+	if (n <= kBlockSize) return block_squared_deviation(data, n, mean);
+	size_t half = (n / 2 + kBlockSize - 1) / kBlockSize * kBlockSize;
+	return pairwise_squared_deviation(data, half, mean) +
+		pairwise_squared_deviation(data + half, n - half, mean);
+}
+
+} // namespace detail
+
+
+/** @brief Single pass mean, variance, minimum and maximum of a stream.
+	@remarks
+		The values can be added one by one (Welford update) or as arrays:
+		an array is processed in blocks, the moments of a block are
+		computed with the SIMD kernels (two passes on data in cache) and
+		merged with the formula of Chan et al. The statistics computed by
+		different threads on different parts of a series are combined with
+		merge.
+	@code
+		RunningStatistics<> stats;
+		stats.add(depth.data(), depth.size());
+		double m = stats.mean(), v = stats.variance();
+	@endcode
+*/
+template<typename REAL = CMN_64F>
+class RunningStatistics
+{
+public:
+
+	RunningStatistics()
+	{
+		reset();
+	}
+
+	/** @brief Remove all the values.
+	*/
+	void reset()
+	{
+		count_ = 0;
+		mean_ = 0;
+		m2_ = 0;
+		min_ = std::numeric_limits<CMN_64F>::max();
+		max_ = std::numeric_limits<CMN_64F>::lowest();
+	}
+
+	/** @brief Add a value.
+	*/
+	void add(REAL value)
+	{
+		CMN_64F x = static_cast<CMN_64F>(value);
+		++count_;
+		CMN_64F delta = x - mean_;
+		mean_ += delta / static_cast<CMN_64F>(count_);
+		m2_ += delta * (x - mean_);
+		min_ = std::min(min_, x);
+		max_ = std::max(max_, x);
+	}
+
+	/** @brief Add n contiguous values.
+	*/
+	template<typename _Ty>
+	void add(const _Ty *data, size_t n)
+	{
+		for (size_t i = 0; i < n; i += detail::kBlockSize) {
+			size_t nb = std::min(detail::kBlockSize, n - i);
+			CMN_64F mean = detail::block_sum(data + i, nb) /
+				static_cast<CMN_64F>(nb);
+			CMN_64F m2 = detail::block_squared_deviation(data + i, nb, mean);
+			CMN_64F min = std::numeric_limits<CMN_64F>::max();
+			CMN_64F max = std::numeric_limits<CMN_64F>::lowest();
+			detail::block_min_max(data + i, nb, min, max);
+			merge(nb, mean, m2, min, max);
+		}
+	}
+
+	template<typename _Ty>
+	void add(const std::vector<_Ty> &container)
+	{
+		if (!container.empty()) add(&container[0], container.size());
+	}
+
+	/** @brief Add the values of other.
+	*/
+	void merge(const RunningStatistics &other)
+	{
+		merge(other.count_, other.mean_, other.m2_, other.min_, other.max_);
+	}
+
+	size_t count() const { return count_; }
+	REAL mean() const { return static_cast<REAL>(mean_); }
+	REAL min() const { return static_cast<REAL>(min_); }
+	REAL max() const { return static_cast<REAL>(max_); }
+
+	/** @brief Variance of the population (divided by n).
+	*/
+	REAL variance() const
+	{
+		return count_ > 0 ? static_cast<REAL>(m2_ / count_) : 0;
+	}
+
+	/** @brief Variance of the sample (divided by n - 1).
+	*/
+	REAL sample_variance() const
+	{
+		return count_ > 1 ? static_cast<REAL>(m2_ / (count_ - 1)) : 0;
+	}
+
+	REAL stdev() const
+	{
+		return static_cast<REAL>(std::sqrt(static_cast<CMN_64F>(variance())));
+	}
+
+private:
+
+	/** @brief Merge the moments of count values.
+	*/
+	void merge(size_t count, CMN_64F mean, CMN_64F m2, CMN_64F min,
+		CMN_64F max)
+	{
+		if (count == 0) return;
+		min_ = std::min(min_, min);
+		max_ = std::max(max_, max);
+		if (count_ == 0) {
+			count_ = count;
+			mean_ = mean;
+			m2_ = m2;
+			return;
+		}
+		size_t n = count_ + count;
+		CMN_64F delta = mean - mean_;
+		CMN_64F weight = static_cast<CMN_64F>(count) / static_cast<CMN_64F>(n);
+		mean_ += delta * weight;
+		m2_ += m2 + delta * delta * static_cast<CMN_64F>(count_) * weight;
+		count_ = n;
+	}
+
+	size_t count_;
+	CMN_64F mean_;
+	CMN_64F m2_;
+	CMN_64F min_;
+	CMN_64F max_;
+};
+
+
 	/** @brief Class to perform
 */
 template<typename _Ty, typename REAL = CMN_64F>
@@ -123,40 +408,85 @@ class SeriesAnalysis
 {
 public:
 
-	/** @brief Calculate the mean of a series.
+	/** @brief Calculate the mean of a series (pairwise summation).
 	*/
-	static bool mean(std::vector< _Ty > &container, REAL &result)
+	static bool mean(const std::vector< _Ty > &container, REAL &result)
 	{
 		if (container.size() == 0) return false;
 		size_t s = container.size();
-		result = 0;
-		//for (std::vector< _Ty >::const_iterator it = container.begin();
-		//	it != container.end(); it++)
-		for (auto &it : container)
-		{
-			result += it;
-		}
-		result /= static_cast<REAL>(s);
+		result = static_cast<REAL>(detail::pairwise_sum(&container[0], s) /
+			static_cast<CMN_64F>(s));
 		return true;
 	}
 
 	/** @brief Calculate the variance of a series.
 	*/
-	static bool variance(std::vector< _Ty > &container, REAL mean, REAL &result)
+	static bool variance(const std::vector< _Ty > &container, REAL mean,
+		REAL &result)
 	{
 		if (container.size() == 0) return false;
 		size_t s = container.size();
-		result = 0;
-		//for (std::vector< _Ty >::const_iterator it = container.begin();
-		//	it != container.end(); it++)
-		for (auto &it : container)
-		{
-			result += std::pow(it - mean, 2);
+		result = static_cast<REAL>(detail::pairwise_squared_deviation(
+			&container[0], s, static_cast<CMN_64F>(mean)) /
+			static_cast<CMN_64F>(s));
+		return true;
+	}
+
+	/** @brief Calculate the mean and the variance of a series in a single
+		pass.
+	*/
+	static bool mean_variance(const std::vector< _Ty > &container,
+		REAL &mean, REAL &variance)
+	{
+		if (container.size() == 0) return false;
+		RunningStatistics<REAL> stats;
+		stats.add(container);
+		mean = stats.mean();
+		variance = stats.variance();
+		return true;
+	}
+
+	/** @brief Calculate the percentile p (in [0, 1]) of a series, with the
+		linear interpolation between the closest ranks. The container is
+		reordered (selection, not sort).
+	*/
+	static bool percentile_inplace(std::vector< _Ty > &container, REAL p,
+		REAL &result)
+	{
+		if (container.size() == 0) return false;
+		p = std::min(std::max(p, static_cast<REAL>(0)), static_cast<REAL>(1));
+		CMN_64F rank = static_cast<CMN_64F>(p) * (container.size() - 1);
+		size_t lo = static_cast<size_t>(rank);
+		typename std::vector< _Ty >::iterator it = container.begin() + lo;
+		std::nth_element(container.begin(), it, container.end());
+		CMN_64F value = static_cast<CMN_64F>(*it);
+		CMN_64F frac = rank - static_cast<CMN_64F>(lo);
+		if (frac > 0) {
+			// The next rank is the minimum of the upper partition
+			CMN_64F next = static_cast<CMN_64F>(*std::min_element(it + 1,
+				container.end()));
+			value += frac * (next - value);
 		}
-		result /= s;
+		result = static_cast<REAL>(value);
 		return true;
 	}
 
+	/** @brief Calculate the percentile p (in [0, 1]) of a series.
+	*/
+	static bool percentile(const std::vector< _Ty > &container, REAL p,
+		REAL &result)
+	{
+		std::vector< _Ty > tmp(container);
+		return percentile_inplace(tmp, p, result);
+	}
+
+	/** @brief Calculate the median of a series.
+	*/
+	static bool median(const std::vector< _Ty > &container, REAL &result)
+	{
+		return percentile(container, static_cast<REAL>(0.5), result);
+	}
+
 	// @brief Calculate the variance of a series.
 	// http://en.wikipedia.org/wiki/Algorithms_for_calculating_variance
 	// Simple test
@@ -24,9 +24,16 @@
 #ifndef CMNMATH_STATISTICS_DIRECTIONAL_HPP__ 
 #define CMNMATH_STATISTICS_DIRECTIONAL_HPP__ 
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <vector>
 #include <complex>
 
+#include "cmnmathcore/inc/cmnmathcore/simd.hpp"
+#include "function/inc/function/SinEstimate.hpp"
+#include "function/inc/function/CosEstimate.hpp"
+
 namespace CmnMath
 {
 namespace statistics
@@ -34,6 +41,353 @@ namespace statistics
 namespace directional
 {
 
+namespace detail
+{
+
+/** @brief Number of angles converted at once by the accumulators.
+*/
+const size_t kBatchSize = 256;
+
+/** @brief Sine and cosine of n angles with the minimax polynomials of
+	SinEstimate (degree 11) and CosEstimate (degree 10), maximum error about
+	1e-9 after the range reduction. Generic version.
+*/
+template<typename _Ty>
+void sin_cos_estimate(const _Ty *angles, size_t n, CMN_64F *s, CMN_64F *c)
+{
+	for (size_t i = 0; i < n; ++i) {
+		CMN_64F x = static_cast<CMN_64F>(angles[i]);
+		s[i] = CmnMath::function::SinEstimate<CMN_64F>::DegreeRR<11>(x);
+		c[i] = CmnMath::function::CosEstimate<CMN_64F>::DegreeRR<10>(x);
+	}
+}
+
+/** @brief SIMD version for float and double. The angle is reduced to
+	[-pi, pi], then the sine is mapped to [-pi/2, pi/2] by the symmetry
+	around pi/2 and the cosine by the symmetry around pi/2 with a change of
+	sign.
+*/
+template<typename _Ty>
+void simd_sin_cos_estimate(const _Ty *angles, size_t n, CMN_64F *s,
+	CMN_64F *c)
+{
+	typedef CmnMath::core::SimdDouble Simd;
+	const Simd inv_two_pi = Simd::Set(GTE_C_INV_TWO_PI);
+	const Simd two_pi = Simd::Set(GTE_C_TWO_PI);
+	const Simd pi = Simd::Set(GTE_C_PI);
+	const Simd minus_pi = Simd::Set(-GTE_C_PI);
+	const Simd half_pi = Simd::Set(GTE_C_HALF_PI);
+	const Simd one = Simd::Set(1.0);
+	const Simd minus_one = Simd::Set(-1.0);
+	const Simd zero = Simd::Zero();
+	size_t i = 0;
+	for (; i + Simd::WIDTH <= n; i += Simd::WIDTH) {
+		Simd x = Simd::Load(angles + i);
+		Simd y = x - two_pi * Simd::Round(x * inv_two_pi);
+		Simd a = Simd::Abs(y);
+		Simd flip = Simd::LessThan(half_pi, a);
+		Simd ysin = Simd::Select(flip,
+			Simd::Select(Simd::LessThan(y, zero), minus_pi, pi) - y, y);
+		Simd ycos = Simd::Select(flip, pi - a, a);
+		Simd sign = Simd::Select(flip, minus_one, one);
+
+		Simd x2 = ysin * ysin;
+		Simd p = Simd::Set(GTE_C_SIN_DEG11_C5);
+		p = Simd::MulAdd(p, x2, Simd::Set(GTE_C_SIN_DEG11_C4));
+		p = Simd::MulAdd(p, x2, Simd::Set(GTE_C_SIN_DEG11_C3));
+		p = Simd::MulAdd(p, x2, Simd::Set(GTE_C_SIN_DEG11_C2));
+		p = Simd::MulAdd(p, x2, Simd::Set(GTE_C_SIN_DEG11_C1));
+		p = Simd::MulAdd(p, x2, Simd::Set(GTE_C_SIN_DEG11_C0));
+		(p * ysin).Store(s + i);
+
+		x2 = ycos * ycos;
+		p = Simd::Set(GTE_C_COS_DEG10_C5);
+		p = Simd::MulAdd(p, x2, Simd::Set(GTE_C_COS_DEG10_C4));
+		p = Simd::MulAdd(p, x2, Simd::Set(GTE_C_COS_DEG10_C3));
+		p = Simd::MulAdd(p, x2, Simd::Set(GTE_C_COS_DEG10_C2));
+		p = Simd::MulAdd(p, x2, Simd::Set(GTE_C_COS_DEG10_C1));
+		p = Simd::MulAdd(p, x2, Simd::Set(GTE_C_COS_DEG10_C0));
+		(p * sign).Store(c + i);
+	}
+	sin_cos_estimate(angles + i, n - i, s + i, c + i);
+}
+
+inline void sin_cos_estimate(const float *angles, size_t n, CMN_64F *s,
+	CMN_64F *c) {
+	simd_sin_cos_estimate(angles, n, s, c);
+}
+inline void sin_cos_estimate(const double *angles, size_t n, CMN_64F *s,
+	CMN_64F *c) {
+	simd_sin_cos_estimate(angles, n, s, c);
+}
+
+/** @brief Sum of n values.
+*/
+inline CMN_64F sum(const CMN_64F *v, size_t n)
+{
+	typedef CmnMath::core::SimdDouble Simd;
+	Simd acc = Simd::Zero();
+	size_t i = 0;
+	for (; i + Simd::WIDTH <= n; i += Simd::WIDTH) acc = acc + Simd::Load(v + i);
+	CMN_64F r = acc.HorizontalSum();
+	for (; i < n; ++i) r += v[i];
+	return r;
+}
+
+} // namespace detail
+
+
+/** @brief Incremental circular mean and variance of a stream of angles.
+	@remarks
+		The accumulator keeps the (weighted) sums of the sines and of the
+		cosines. With a forgetting factor lambda < 1 the old angles decay
+		exponentially: every new angle multiplies the sums by lambda, so the
+		effective window is about 1 / (1 - lambda) angles.
+	@par
+		The single angles and the arrays of angles use the same polynomial
+		estimates (see detail::sin_cos_estimate), so adding the angles one
+		at a time or in an array gives the same statistics within the
+		error of the estimates. Different threads can accumulate consecutive
+		parts of a series and merge them in order.
+	@code
+		RunningStatistics<double> heading(0.99);
+		heading.add(angle);
+		double theta = heading.mean(), R = heading.resultant_length();
+	@endcode
+*/
+template<typename _Ty>
+class RunningStatistics
+{
+public:
+
+	explicit RunningStatistics(_Ty forgetting = 1)
+		: forgetting_(static_cast<CMN_64F>(forgetting))
+	{
+		reset();
+	}
+
+	/** @brief Remove all the angles.
+	*/
+	void reset()
+	{
+		count_ = 0;
+		s_ = 0;
+		c_ = 0;
+		w_ = 0;
+	}
+
+	/** @brief Add an angle (radians).
+	*/
+	void add(_Ty angle, _Ty weight = 1)
+	{
+		CMN_64F w = static_cast<CMN_64F>(weight);
+		CMN_64F s, c;
+		detail::sin_cos_estimate(&angle, 1, &s, &c);
+		s_ = forgetting_ * s_ + w * s;
+		c_ = forgetting_ * c_ + w * c;
+		w_ = forgetting_ * w_ + w;
+		++count_;
+	}
+
+	/** @brief Add n angles, in order.
+	*/
+	template<typename T>
+	void add(const T *angles, size_t n)
+	{
+		CMN_64F s[detail::kBatchSize], c[detail::kBatchSize];
+		for (size_t i = 0; i < n; i += detail::kBatchSize) {
+			size_t nb = std::min(detail::kBatchSize, n - i);
+			detail::sin_cos_estimate(angles + i, nb, s, c);
+			if (forgetting_ == 1) {
+				s_ += detail::sum(s, nb);
+				c_ += detail::sum(c, nb);
+				w_ += static_cast<CMN_64F>(nb);
+			} else {
+				for (size_t k = 0; k < nb; ++k) {
+					s_ = forgetting_ * s_ + s[k];
+					c_ = forgetting_ * c_ + c[k];
+					w_ = forgetting_ * w_ + 1;
+				}
+			}
+			count_ += nb;
+		}
+	}
+
+	template<typename T>
+	void add(const std::vector<T> &angles)
+	{
+		if (!angles.empty()) add(&angles[0], angles.size());
+	}
+
+	/** @brief Add the angles of later, which follow the angles of this
+		accumulator in the series (the order matters only if forgetting is
+		less than 1). Both must have the same forgetting factor.
+	*/
+	void merge(const RunningStatistics &later)
+	{
+		CMN_64F decay = forgetting_ == 1 ? 1 :
+			std::pow(forgetting_, static_cast<CMN_64F>(later.count_));
+		s_ = decay * s_ + later.s_;
+		c_ = decay * c_ + later.c_;
+		w_ = decay * w_ + later.w_;
+		count_ += later.count_;
+	}
+
+	size_t count() const { return count_; }
+
+	/** @brief Circular mean in [-pi, pi].
+	*/
+	_Ty mean() const
+	{
+		return static_cast<_Ty>(std::atan2(s_, c_));
+	}
+
+	/** @brief Length of the mean resultant vector R, in [0, 1].
+	*/
+	_Ty resultant_length() const
+	{
+		if (w_ <= 0) return 0;
+		return static_cast<_Ty>(std::min<CMN_64F>(1,
+			std::sqrt(s_ * s_ + c_ * c_) / w_));
+	}
+
+	/** @brief Circular variance 1 - R and standard deviation
+		sqrt(-2 ln R).
+	*/
+	_Ty variance() const
+	{
+		return 1 - resultant_length();
+	}
+
+	_Ty standard_deviation() const
+	{
+		return static_cast<_Ty>(std::sqrt(-2 * std::log(
+			static_cast<CMN_64F>(resultant_length()))));
+	}
+
+private:
+
+	CMN_64F forgetting_;
+	size_t count_;
+	CMN_64F s_, c_, w_;
+};
+
+
+/** @brief Circular mean and variance of the last angles of a stream.
+	@remarks
+		The sines and the cosines of the window are kept in a ring buffer,
+		the sums are updated when an angle enters and leaves the window and
+		recomputed once per window to remove the rounding drift. The sines
+		and the cosines are the estimates of detail::sin_cos_estimate.
+*/
+template<typename _Ty>
+class SlidingWindowStatistics
+{
+public:
+
+	explicit SlidingWindowStatistics(size_t window)
+		: s_buffer_(std::max<size_t>(1, window)),
+		  c_buffer_(std::max<size_t>(1, window))
+	{
+		reset();
+	}
+
+	void reset()
+	{
+		count_ = 0;
+		next_ = 0;
+		since_refresh_ = 0;
+		s_ = 0;
+		c_ = 0;
+	}
+
+	/** @brief Add an angle (radians), the oldest one leaves the window when
+		it is full.
+	*/
+	void add(_Ty angle)
+	{
+		CMN_64F s, c;
+		detail::sin_cos_estimate(&angle, 1, &s, &c);
+		push(s, c);
+	}
+
+	/** @brief Add n angles, in order.
+	*/
+	template<typename T>
+	void add(const T *angles, size_t n)
+	{
+		CMN_64F s[detail::kBatchSize], c[detail::kBatchSize];
+		// Only the last angles can stay in the window
+		if (n > s_buffer_.size()) {
+			angles += n - s_buffer_.size();
+			n = s_buffer_.size();
+		}
+		for (size_t i = 0; i < n; i += detail::kBatchSize) {
+			size_t nb = std::min(detail::kBatchSize, n - i);
+			detail::sin_cos_estimate(angles + i, nb, s, c);
+			for (size_t k = 0; k < nb; ++k) push(s[k], c[k]);
+		}
+	}
+
+	/** @brief Number of angles in the window and size of the window.
+	*/
+	size_t count() const { return count_; }
+	size_t window() const { return s_buffer_.size(); }
+
+	_Ty mean() const
+	{
+		return static_cast<_Ty>(std::atan2(s_, c_));
+	}
+
+	_Ty resultant_length() const
+	{
+		if (count_ == 0) return 0;
+		return static_cast<_Ty>(std::min<CMN_64F>(1,
+			std::sqrt(s_ * s_ + c_ * c_) / static_cast<CMN_64F>(count_)));
+	}
+
+	_Ty variance() const
+	{
+		return 1 - resultant_length();
+	}
+
+	_Ty standard_deviation() const
+	{
+		return static_cast<_Ty>(std::sqrt(-2 * std::log(
+			static_cast<CMN_64F>(resultant_length()))));
+	}
+
+private:
+
+	void push(CMN_64F s, CMN_64F c)
+	{
+		size_t window = s_buffer_.size();
+		if (count_ == window) {
+			s_ -= s_buffer_[next_];
+			c_ -= c_buffer_[next_];
+		} else {
+			++count_;
+		}
+		s_buffer_[next_] = s;
+		c_buffer_[next_] = c;
+		s_ += s;
+		c_ += c;
+		next_ = next_ + 1 == window ? 0 : next_ + 1;
+		if (++since_refresh_ == window) {
+			since_refresh_ = 0;
+			s_ = detail::sum(&s_buffer_[0], count_);
+			c_ = detail::sum(&c_buffer_[0], count_);
+		}
+	}
+
+	std::vector<CMN_64F> s_buffer_, c_buffer_;
+	size_t count_;
+	size_t next_;
+	size_t since_refresh_;
+	CMN_64F s_, c_;
+};
+
+
 /** @brief Class to perform
 */
 template<typename _Ty>
@@ -0,0 +1,203 @@
+/**
+* @file sample_cmnmathcore_concurrenthashmap.cpp
+* @brief Test of the sharded hash map and read-mostly benchmark against ThreadSafeMap.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cmnmathcore/inc/cmnmathcore/threadsafe_map.hpp"
+#include "cmnmathcore/inc/cmnmathcore/concurrent_hash_map.hpp"
+
+namespace
+{
+
+const int kNumKeys = 100000;
+const int kNumOperations = 400000;
+
+
+/** @brief Adapters to run the same benchmark on both maps.
+*/
+struct LockedMap
+{
+	void Insert(int key, double value) { map.Insert(key, value); }
+	bool Get(int key, double &value) { return map.Get(key, value); }
+	CmnMath::core::ThreadSafeMap<int, double> map;
+};
+
+struct ShardedMap
+{
+	void Insert(int key, double value) { map.Insert(key, value); }
+	bool Get(int key, double &value) { return map.Get(key, value); }
+	CmnMath::core::ConcurrentHashMap<int, double> map;
+};
+
+
+/** @brief Every thread does kNumOperations lookups, write_percent of them
+	are inserts. Return the time in ms.
+*/
+template <typename Map>
+double read_mostly(int num_threads, int write_percent, long long &hits)
+{
+	Map m;
+	for (int k = 0; k < kNumKeys; k += 2) m.Insert(k, (double)k);
+	std::atomic<long long> total(0);
+	std::vector<std::thread> threads;
+	auto start = std::chrono::steady_clock::now();
+	for (int t = 0; t < num_threads; ++t) {
+		threads.push_back(std::thread([&m, &total, t, write_percent]() {
+			unsigned int seed = 12345u + t;
+			long long local = 0;
+			double v = 0;
+			for (int i = 0; i < kNumOperations; ++i) {
+				seed = seed * 1664525u + 1013904223u;
+				int key = (int)((seed >> 8) % kNumKeys);
+				if ((int)((seed >> 4) % 100) < write_percent) {
+					m.Insert(key, (double)key);
+				} else if (m.Get(key, v)) {
+					++local;
+				}
+			}
+			total += local;
+		}));
+	}
+	for (auto &th : threads) th.join();
+	hits = total;
+	return std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+
+/** @brief Compare the operations with std::map.
+*/
+void test_operations()
+{
+	CmnMath::core::ConcurrentHashMap<int, std::string> m(4, 8);
+	std::map<int, std::string> reference;
+	unsigned int seed = 1u;
+	bool ok = true;
+	for (int i = 0; i < 200000; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		int key = (int)((seed >> 8) % 5000);
+		int op = (int)((seed >> 4) % 4);
+		std::string value = std::to_string(i);
+		std::string out;
+		if (op == 0) {
+			m.Insert(key, value);
+			reference[key] = value;
+		} else if (op == 1) {
+			bool removed = m.Remove(key, out);
+			auto it = reference.find(key);
+			ok = ok && removed == (it != reference.end()) &&
+				(!removed || out == it->second);
+			if (it != reference.end()) reference.erase(it);
+		} else if (op == 2) {
+			bool found = m.Get(key, out);
+			auto it = reference.find(key);
+			ok = ok && found == (it != reference.end()) &&
+				(!found || out == it->second);
+		} else {
+			out = m.FindOrInsert(key, [&value](int) { return value; });
+			auto it = reference.find(key);
+			if (it == reference.end()) {
+				reference[key] = value;
+				ok = ok && out == value;
+			} else {
+				ok = ok && out == it->second;
+			}
+		}
+	}
+	std::vector<std::pair<int, std::string> > snapshot;
+	m.Snapshot(snapshot);
+	std::sort(snapshot.begin(), snapshot.end());
+	std::vector<std::pair<int, std::string> > expected(reference.begin(),
+		reference.end());
+	ok = ok && m.GetNumElements() == reference.size() && snapshot == expected;
+	std::cout << "shards: " << m.GetNumShards() << " elements: " <<
+		m.GetNumElements() << " same as std::map: " << ok << std::endl;
+	m.RemoveAll();
+	std::cout << "RemoveAll: " << !m.HasElements() << std::endl;
+}
+
+
+/** @brief The factory is called once per key by concurrent threads.
+*/
+void test_find_or_insert()
+{
+	CmnMath::core::ConcurrentHashMap<int, int> m;
+	std::atomic<int> calls(0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t) {
+		threads.push_back(std::thread([&m, &calls]() {
+			for (int k = 0; k < 10000; ++k) {
+				m.FindOrInsert(k, [&calls](int key) {
+					++calls;
+					return key * 2;
+				});
+			}
+		}));
+	}
+	for (auto &th : threads) th.join();
+	std::cout << "factory calls: " << calls << " expected: 10000" << std::endl;
+}
+
+
+/** @brief Read-mostly benchmark.
+*/
+void test_read_mostly()
+{
+	int max_threads = std::max(8, (int)std::thread::hardware_concurrency());
+	const int write_percent = 5;
+	for (int threads = 1; threads <= max_threads; threads *= 2) {
+		long long hits_locked = 0, hits_sharded = 0;
+		double locked_ms = read_mostly<LockedMap>(threads, write_percent,
+			hits_locked);
+		double sharded_ms = read_mostly<ShardedMap>(threads, write_percent,
+			hits_sharded);
+		double ops = (double)kNumOperations * threads;
+		std::cout << "threads: " << threads << " writes: " << write_percent <<
+			"% ThreadSafeMap: " << locked_ms << " ms (" <<
+			ops / locked_ms / 1000.0 << " Mops/s) ConcurrentHashMap: " <<
+			sharded_ms << " ms (" << ops / sharded_ms / 1000.0 << " Mops/s)" <<
+			std::endl;
+	}
+}
+
+
+}  // namespace anonymous
+
+
+/** main
+*/
+int main()
+{
+	std::cout << "Test ConcurrentHashMap" << std::endl;
+	test_operations();
+	test_find_or_insert();
+	test_read_mostly();
+	return 0;
+}
@@ -0,0 +1,209 @@
+/**
+* @file sample_cmnmathcore_mpmcqueue.cpp
+* @brief Test of the lock-free queue and contention benchmark against ThreadSafeQueue.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "cmnmathcore/inc/cmnmathcore/threadsafe_queue.hpp"
+#include "cmnmathcore/inc/cmnmathcore/mpmc_queue.hpp"
+
+namespace
+{
+
+const int kNumItems = 200000;
+const size_t kCapacity = 1024;
+
+
+/** @brief Adapter to run the same benchmark on both queues.
+*/
+struct LockedQueue
+{
+	explicit LockedQueue(size_t capacity) : queue(capacity) {}
+	bool TryPush(int v) { return queue.Push(v); }
+	bool TryPop(int &v) { return queue.Pop(v); }
+	CmnMath::core::ThreadSafeQueue<int> queue;
+};
+
+struct LockFreeQueue
+{
+	explicit LockFreeQueue(size_t capacity) : queue(capacity) {}
+	bool TryPush(int v) { return queue.TryPush(v); }
+	bool TryPop(int &v) { return queue.TryPop(v); }
+	CmnMath::core::MPMCQueue<int> queue;
+};
+
+
+/** @brief Every producer pushes kNumItems values, the consumers pop them
+	all. Return the time in ms; sum is the sum of the popped values.
+*/
+template <typename Queue>
+double contention(int num_producers, int num_consumers, long long &sum)
+{
+	Queue q(kCapacity);
+	std::atomic<long long> total(0);
+	std::atomic<int> remaining(num_producers * kNumItems);
+	std::vector<std::thread> threads;
+	auto start = std::chrono::steady_clock::now();
+	for (int p = 0; p < num_producers; ++p) {
+		threads.push_back(std::thread([&q]() {
+			for (int i = 1; i <= kNumItems; ++i) {
+				while (!q.TryPush(i)) std::this_thread::yield();
+			}
+		}));
+	}
+	for (int c = 0; c < num_consumers; ++c) {
+		threads.push_back(std::thread([&q, &total, &remaining]() {
+			long long local = 0;
+			int v = 0;
+			while (remaining.load(std::memory_order_relaxed) > 0) {
+				if (q.TryPop(v)) {
+					local += v;
+					remaining.fetch_sub(1, std::memory_order_relaxed);
+				} else {
+					std::this_thread::yield();
+				}
+			}
+			total += local;
+		}));
+	}
+	for (auto &t : threads) t.join();
+	sum = total;
+	return std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+
+/** @brief Move-only elements, batches and blocking pop.
+*/
+void test_semantics()
+{
+	CmnMath::core::MPMCQueue< std::unique_ptr<int> > q(5);
+	std::cout << "capacity: " << q.GetMaxNumElements() << std::endl;
+	for (int i = 0; i < 8; ++i) {
+		q.TryPush(std::unique_ptr<int>(new int(i)));
+	}
+	std::unique_ptr<int> extra(new int(8));
+	bool rejected = !q.TryPush(std::move(extra)) && extra;
+	std::cout << "full queue rejects and keeps the element: " << rejected <<
+		std::endl;
+	std::unique_ptr<int> out[8];
+	size_t n = q.TryPopBatch(out, 8);
+	bool ordered = n == 8;
+	for (size_t i = 0; i < n; ++i) ordered = ordered && *out[i] == (int)i;
+	std::cout << "batch pop in order: " << ordered << std::endl;
+
+	std::unique_ptr<int> in[3];
+	for (int i = 0; i < 3; ++i) in[i].reset(new int(10 + i));
+	std::cout << "batch push: " << q.TryPushBatch(in, 3) << " elements: " <<
+		q.GetNumElements() << std::endl;
+
+	// The remaining elements are destroyed by the queue
+	auto start = std::chrono::steady_clock::now();
+	CmnMath::core::MPMCQueue<int> empty(4);
+	int x = 0;
+	bool popped = empty.WaitPop(x, std::chrono::milliseconds(20));
+	double waited = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+	std::cout << "WaitPop timeout: " << !popped << " after " << waited <<
+		" ms" << std::endl;
+
+	std::thread producer([&empty]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		empty.TryPush(42);
+	});
+	popped = empty.WaitPop(x, std::chrono::seconds(5));
+	producer.join();
+	std::cout << "WaitPop wakes up: " << (popped && x == 42) << std::endl;
+}
+
+
+/** @brief Blocking producers and consumers on a small queue.
+*/
+void test_blocking()
+{
+	CmnMath::core::MPMCQueue<int> q(8);
+	const int num_threads = 4;
+	std::atomic<long long> total(0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < num_threads; ++t) {
+		threads.push_back(std::thread([&q]() {
+			for (int i = 1; i <= kNumItems / 10; ++i) q.WaitPush(int(i));
+		}));
+		threads.push_back(std::thread([&q, &total]() {
+			long long local = 0;
+			int v = 0;
+			for (int i = 0; i < kNumItems / 10; ++i) {
+				q.WaitPop(v);
+				local += v;
+			}
+			total += local;
+		}));
+	}
+	for (auto &t : threads) t.join();
+	long long n = kNumItems / 10;
+	std::cout << "blocking sum: " << (total == num_threads * n * (n + 1) / 2) <<
+		std::endl;
+}
+
+
+/** @brief Contention benchmark.
+*/
+void test_contention()
+{
+	int max_threads = std::max(8, (int)std::thread::hardware_concurrency());
+	long long expected_one = (long long)kNumItems * (kNumItems + 1) / 2;
+	for (int threads = 1; threads * 2 <= max_threads; threads *= 2) {
+		long long sum_locked = 0, sum_lockfree = 0;
+		double locked_ms = contention<LockedQueue>(threads, threads,
+			sum_locked);
+		double lockfree_ms = contention<LockFreeQueue>(threads, threads,
+			sum_lockfree);
+		double ops = 2.0 * kNumItems * threads;
+		std::cout << "producers/consumers: " << threads << "/" << threads <<
+			" ThreadSafeQueue: " << locked_ms << " ms (" <<
+			ops / locked_ms / 1000.0 << " Mops/s) MPMCQueue: " <<
+			lockfree_ms << " ms (" << ops / lockfree_ms / 1000.0 <<
+			" Mops/s) sums ok: " << (sum_locked == expected_one * threads &&
+			sum_lockfree == expected_one * threads) << std::endl;
+	}
+}
+
+
+}  // namespace anonymous
+
+
+/** main
+*/
+int main()
+{
+	std::cout << "Test MPMCQueue" << std::endl;
+	test_semantics();
+	test_blocking();
+	test_contention();
+	return 0;
+}
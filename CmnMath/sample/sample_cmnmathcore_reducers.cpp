@@ -0,0 +1,218 @@
+/**
+* @file sample_cmnmathcore_reducers.cpp
+* @brief Test of the per-thread reducers against shared atomics.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "cmnmathcore/inc/cmnmathcore/atomic_minmax.hpp"
+#include "cmnmathcore/inc/cmnmathcore/reducers.hpp"
+
+namespace
+{
+
+const size_t kNumValues = 4000000;
+
+
+/** @brief Pseudo-random values in [0, 1000).
+*/
+std::vector<double> make_values(size_t n)
+{
+	std::vector<double> values(n);
+	unsigned int seed = 7u;
+	for (size_t i = 0; i < n; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		values[i] = (double)(seed >> 8) / (double)(1u << 24) * 1000.0;
+	}
+	return values;
+}
+
+
+/** @brief Run func(thread, begin, end) on num_threads threads.
+*/
+template <typename Function>
+void run_threads(int num_threads, size_t n, Function func)
+{
+	std::vector<std::thread> threads;
+	for (int t = 0; t < num_threads; ++t) {
+		size_t b = t * n / num_threads, e = (t + 1) * n / num_threads;
+		threads.push_back(std::thread([&func, t, b, e]() { func(t, b, e); }));
+	}
+	for (auto &th : threads) th.join();
+}
+
+
+/** @brief The parallel results are the same as the sequential ones.
+*/
+void test_accumulators()
+{
+	const int num_threads = 4;
+	std::vector<double> values = make_values(kNumValues);
+
+	CmnMath::core::SumAccumulator<double> sum;
+	CmnMath::core::MinMaxAccumulator<double> minmax;
+	CmnMath::core::AABBAccumulator<2, double> aabb;
+	CmnMath::core::WelfordAccumulator<double> welford;
+	CmnMath::core::HistogramAccumulator<double> histogram(0.0, 500.0, 10);
+	for (size_t i = 0; i < kNumValues; ++i) {
+		sum.Add(values[i]);
+		minmax.Add(values[i]);
+		welford.Add(values[i]);
+		histogram.Add(values[i]);
+		if (i + 1 < kNumValues) aabb.Add(&values[i]);
+	}
+
+	CmnMath::core::PerThreadReducer<CmnMath::core::SumAccumulator<double> >
+		psum(num_threads);
+	CmnMath::core::PerThreadReducer<CmnMath::core::MinMaxAccumulator<double> >
+		pminmax(num_threads);
+	CmnMath::core::PerThreadReducer<CmnMath::core::AABBAccumulator<2, double> >
+		paabb(num_threads);
+	CmnMath::core::PerThreadReducer<CmnMath::core::WelfordAccumulator<double> >
+		pwelford(num_threads);
+	CmnMath::core::PerThreadReducer<CmnMath::core::HistogramAccumulator<double> >
+		phistogram(num_threads,
+		CmnMath::core::HistogramAccumulator<double>(0.0, 500.0, 10));
+	run_threads(num_threads, kNumValues, [&](int t, size_t b, size_t e) {
+		for (size_t i = b; i < e; ++i) {
+			psum.Local(t).Add(values[i]);
+			pminmax.Local(t).Add(values[i]);
+			pwelford.Local(t).Add(values[i]);
+			phistogram.Local(t).Add(values[i]);
+			if (i + 1 < kNumValues) paabb.Local(t).Add(&values[i]);
+		}
+	});
+
+	double s = psum.Combine().GetSum();
+	CmnMath::core::MinMaxAccumulator<double> mm = pminmax.Combine();
+	CmnMath::core::AABBAccumulator<2, double> bb = paabb.Combine();
+	CmnMath::core::WelfordAccumulator<double> w = pwelford.Combine();
+	CmnMath::core::HistogramAccumulator<double> h = phistogram.Combine();
+	std::cout << "sum: " << (std::fabs(s - sum.GetSum()) < 1e-9 * s) <<
+		" min/max: " << (mm.GetMin() == minmax.GetMin() &&
+		mm.GetMax() == minmax.GetMax()) <<
+		" aabb: " << (bb.GetMin() == aabb.GetMin() &&
+		bb.GetMax() == aabb.GetMax()) <<
+		" mean: " << w.GetMean() << " (" << welford.GetMean() << ")" <<
+		" variance: " << w.GetVariance() << " (" << welford.GetVariance() <<
+		")" << " histogram: " << (h.GetBins() == histogram.GetBins() &&
+		h.GetOverflow() == histogram.GetOverflow() &&
+		h.GetUnderflow() == 0) << std::endl;
+
+	// Empty reducers return the identity
+	CmnMath::core::PerThreadReducer<CmnMath::core::WelfordAccumulator<double> >
+		empty(num_threads);
+	CmnMath::core::PerThreadReducer<CmnMath::core::MinMaxAccumulator<double> >
+		empty_minmax(num_threads);
+	std::cout << "empty: " << (empty.Combine().GetCount() == 0 &&
+		empty.Combine().GetVariance() == 0 &&
+		empty_minmax.Combine().IsEmpty()) << std::endl;
+}
+
+
+/** @brief Values out of the range of a histogram, and merge of different
+	bins.
+*/
+void test_histogram()
+{
+	typedef CmnMath::core::HistogramAccumulator<double> Histogram;
+	const double inf = std::numeric_limits<double>::infinity();
+	Histogram h(0.0, 1.0, 3);
+	const double values[] = { -1.0, -inf, 1e300, inf, 1.0, 0.0,
+		std::nextafter(1.0, 0.0), std::numeric_limits<double>::quiet_NaN() };
+	for (double v : values) h.Add(v);
+	std::cout << "histogram out of range: " << (h.GetUnderflow() == 2 &&
+		h.GetOverflow() == 3 && h.GetBins()[0] == 1 && h.GetBins()[2] == 1) <<
+		std::endl;
+
+	Histogram other(0.0, 1.0, 4), empty;
+	other.Add(0.5);
+	bool merged = empty.Merge(h) && h.Merge(Histogram());
+	std::cout << "histogram merge: " << (merged && !h.Merge(other) &&
+		h.GetBins().size() == 3 && h.GetBins()[1] == 0 &&
+		empty.GetBins() == h.GetBins()) << std::endl;
+
+	// Integer values: 10 bins of width 2.5 in [0, 25)
+	CmnMath::core::HistogramAccumulator<int> hi(0, 25, 10);
+	for (int v = -1; v <= 25; ++v) hi.Add(v);
+	const uint64_t expected[] = { 3, 2, 3, 2, 3, 2, 3, 2, 3, 2 };
+	std::cout << "histogram int: " << (hi.GetUnderflow() == 1 &&
+		hi.GetOverflow() == 1 && std::equal(hi.GetBins().begin(),
+		hi.GetBins().end(), expected)) << std::endl;
+}
+
+
+/** @brief Per-thread accumulation against shared atomics.
+*/
+void test_contention()
+{
+	std::vector<double> values = make_values(kNumValues);
+	int max_threads = std::max(4, (int)std::thread::hardware_concurrency());
+	for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+		std::atomic<double> amin(1e300), amax(-1e300);
+		auto start = std::chrono::steady_clock::now();
+		run_threads(num_threads, kNumValues, [&](int, size_t b, size_t e) {
+			for (size_t i = b; i < e; ++i) {
+				CmnMath::core::AtomicMin(amin, values[i]);
+				CmnMath::core::AtomicMax(amax, values[i]);
+			}
+		});
+		double atomic_ms = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+
+		CmnMath::core::PerThreadReducer<
+			CmnMath::core::MinMaxAccumulator<double> > reducer(num_threads);
+		start = std::chrono::steady_clock::now();
+		run_threads(num_threads, kNumValues, [&](int t, size_t b, size_t e) {
+			CmnMath::core::MinMaxAccumulator<double> &local = reducer.Local(t);
+			for (size_t i = b; i < e; ++i) local.Add(values[i]);
+		});
+		CmnMath::core::MinMaxAccumulator<double> mm = reducer.Combine();
+		double reducer_ms = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+		std::cout << "threads: " << num_threads << " atomics: " << atomic_ms <<
+			" ms per-thread: " << reducer_ms << " ms same result: " <<
+			(mm.GetMin() == amin.load() && mm.GetMax() == amax.load()) <<
+			std::endl;
+	}
+}
+
+
+}  // namespace anonymous
+
+
+/** main
+*/
+int main()
+{
+	std::cout << "Test reducers" << std::endl;
+	test_accumulators();
+	test_histogram();
+	test_contention();
+	return 0;
+}
@@ -0,0 +1,325 @@
+/**
+* @file sample_function_batchestimate.cpp
+* @brief Accuracy and throughput of the batched function estimates.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "function/inc/function/ATanEstimate.hpp"
+#include "function/inc/function/CosEstimate.hpp"
+#include "function/inc/function/Exp2Estimate.hpp"
+#include "function/inc/function/InvSqrtEstimate.hpp"
+#include "function/inc/function/Log2Estimate.hpp"
+#include "function/inc/function/SinEstimate.hpp"
+#include "function/inc/function/SqrtEstimate.hpp"
+
+namespace
+{
+
+using CmnMath::function::BatchEstimate;
+using CmnMath::function::ATanEstimate;
+using CmnMath::function::CosEstimate;
+using CmnMath::function::Exp2Estimate;
+using CmnMath::function::InvSqrtEstimate;
+using CmnMath::function::Log2Estimate;
+using CmnMath::function::SinEstimate;
+using CmnMath::function::SqrtEstimate;
+
+// Not a multiple of the width of the registers: the tail is tested too.
+const size_t kNumValues = (1 << 20) + 3;
+const int kNumRepeats = 10;
+// Distance from the scalar estimate, in float ulps: the fused multiply-add
+// of AVX2 and AVX-512 rounds differently.
+const double kMaxUlps = 4.0;
+
+
+/** @brief Values and reference of a function.
+*/
+struct Case
+{
+	const char* name;
+	std::vector<float> x;
+	double (*reference)(double);
+	// Relative error for the functions with exponent scaling.
+	bool relative;
+};
+
+
+double invsqrt(double x) { return 1.0 / std::sqrt(x); }
+double exp2_ref(double x) { return std::pow(2.0, x); }
+double log2_ref(double x) { return std::log(x) / std::log(2.0); }
+
+
+/** @brief kNumValues pseudo-random values in [a, b).
+*/
+std::vector<float> make_values(double a, double b)
+{
+	std::vector<float> values(kNumValues);
+	unsigned int seed = 7u;
+	for (size_t i = 0; i < kNumValues; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		values[i] = (float)(a + (b - a) * (double)(seed >> 8) /
+			(double)(1u << 24));
+	}
+	return values;
+}
+
+
+/** @brief Distance of a from the scalar estimate s in float ulps, of s
+	for the relative errors or of max(|s|, 1). The infinities and NaN must
+	be the same.
+*/
+double ulps(float a, float s, bool relative)
+{
+	if (std::isnan(s) || std::isinf(s)) {
+		return (std::isnan(s) ? std::isnan(a) : a == s) ? 0.0 :
+			std::numeric_limits<double>::infinity();
+	}
+	if (a == s) return 0.0;
+	double scale = relative ? std::abs(s) : std::max(std::abs(s), 1.0f);
+	return std::abs((double)a - s) / (FLT_EPSILON * scale);
+}
+
+
+/** @brief Error against the reference, distance from the scalar
+	DegreeRR<D> of float and time per value for every instruction set. The
+	bound is the error of the estimate evaluated in double.
+*/
+template <template <typename> class Estimate, int D>
+void check(const Case &c, double max_error)
+{
+	std::vector<float> y(c.x.size()), scalar(c.x.size());
+	for (size_t i = 0; i < y.size(); ++i) {
+		double expected = c.reference(c.x[i]);
+		double e = std::abs(Estimate<double>::template DegreeRR<D>(c.x[i]) -
+			expected);
+		if (c.relative) e /= std::abs(expected);
+		max_error = std::max(max_error, e);
+		scalar[i] = Estimate<float>::template DegreeRR<D>(c.x[i]);
+	}
+	for (int isa = BatchEstimate::ISA_SCALAR; isa <= BatchEstimate::ISA_AVX512;
+		++isa) {
+		if (!BatchEstimate::SetISA((BatchEstimate::ISA)isa)) continue;
+		auto start = std::chrono::steady_clock::now();
+		for (int r = 0; r < kNumRepeats; ++r) {
+			Estimate<float>::template Evaluate<D>(c.x.data(), y.data(),
+				y.size());
+		}
+		double ns = std::chrono::duration<double, std::nano>(
+			std::chrono::steady_clock::now() - start).count() /
+			(kNumRepeats * (double)y.size());
+		double error = 0, max_ulps = 0;
+		for (size_t i = 0; i < y.size(); ++i) {
+			double expected = c.reference(c.x[i]);
+			double e = std::abs(y[i] - expected);
+			if (c.relative) e /= std::abs(expected);
+			error = std::max(error, e);
+			max_ulps = std::max(max_ulps, ulps(y[i], scalar[i], c.relative));
+		}
+		std::cout << c.name << " deg " << D << " " <<
+			BatchEstimate::GetName((BatchEstimate::ISA)isa) << ": error " <<
+			error << " bound " << max_error << " ulps " << max_ulps <<
+			" ok " << (max_ulps <= kMaxUlps) << " time " << ns <<
+			" ns/value" << std::endl;
+	}
+	BatchEstimate::SetISA(BatchEstimate::GetSupportedISA());
+}
+
+
+/** @brief In place evaluation, and no kernel for the double arrays.
+*/
+void test_inplace()
+{
+	std::vector<float> x = make_values(-10.0, 10.0);
+	std::vector<float> y(x.size());
+	SinEstimate<float>::Evaluate<11>(x.data(), y.data(),
+		x.size());
+	SinEstimate<float>::Evaluate<11>(x.data(), x.data(),
+		x.size());
+	std::cout << "in place: " << (x == y) << std::endl;
+
+	double in[5] = { -1.0, 0.0, 0.5, 1.0, 3.0 }, out[5];
+	SinEstimate<double>::Evaluate<11>(in, out, 5);
+	bool same = true;
+	for (int i = 0; i < 5; ++i) {
+		same = same && out[i] ==
+			SinEstimate<double>::DegreeRR<11>(in[i]);
+	}
+	std::cout << "double arrays (scalar): " << same << std::endl;
+}
+
+
+/** @brief Values out of the domain of the kernels and angles beyond the
+	range of the float quotient: same results as the scalar estimate.
+*/
+template <template <typename> class Estimate, int D>
+void check_special(const char* name, bool relative)
+{
+	const float inf = std::numeric_limits<float>::infinity();
+	const float values[] = { 0.0f, -0.0f, FLT_MIN / 4, FLT_MIN, FLT_MAX,
+		inf, -inf, std::numeric_limits<float>::quiet_NaN(), -1.0f, 1e6f,
+		-1e6f, 1e10f, -1e10f, 127.5f, 200.0f, -130.0f, -200.0f, 0.5f };
+	const size_t n = sizeof(values) / sizeof(values[0]);
+	for (int isa = BatchEstimate::ISA_SSE2; isa <= BatchEstimate::ISA_AVX512;
+		++isa) {
+		if (!BatchEstimate::SetISA((BatchEstimate::ISA)isa)) continue;
+		float y[n];
+		Estimate<float>::template Evaluate<D>(values, y, n);
+		double max_ulps = 0;
+		for (size_t i = 0; i < n; ++i) {
+			max_ulps = std::max(max_ulps, ulps(y[i],
+				Estimate<float>::template DegreeRR<D>(values[i]), relative));
+		}
+		std::cout << name << " special values " <<
+			BatchEstimate::GetName((BatchEstimate::ISA)isa) << ": ulps " <<
+			max_ulps << " ok " << (max_ulps <= kMaxUlps) << std::endl;
+	}
+	BatchEstimate::SetISA(BatchEstimate::GetSupportedISA());
+}
+
+
+void test_special()
+{
+	check_special<SinEstimate, 11>("sin", false);
+	check_special<CosEstimate, 10>("cos", false);
+	check_special<ATanEstimate, 13>("atan", false);
+	check_special<Exp2Estimate, 7>("exp2", true);
+	check_special<Log2Estimate, 8>("log2", false);
+	check_special<SqrtEstimate, 8>("sqrt", true);
+	check_special<InvSqrtEstimate, 8>("invsqrt", true);
+}
+
+
+void test_sin()
+{
+	Case c = { "sin", make_values(-4.0 * GTE_C_PI, 4.0 * GTE_C_PI),
+		std::sin, false };
+	check<SinEstimate, 3>(c, GTE_C_SIN_DEG3_MAX_ERROR);
+	check<SinEstimate, 5>(c, GTE_C_SIN_DEG5_MAX_ERROR);
+	check<SinEstimate, 7>(c, GTE_C_SIN_DEG7_MAX_ERROR);
+	check<SinEstimate, 9>(c, GTE_C_SIN_DEG9_MAX_ERROR);
+	check<SinEstimate, 11>(c, GTE_C_SIN_DEG11_MAX_ERROR);
+}
+
+
+void test_cos()
+{
+	Case c = { "cos", make_values(-4.0 * GTE_C_PI, 4.0 * GTE_C_PI),
+		std::cos, false };
+	check<CosEstimate, 2>(c, GTE_C_COS_DEG2_MAX_ERROR);
+	check<CosEstimate, 4>(c, GTE_C_COS_DEG4_MAX_ERROR);
+	check<CosEstimate, 6>(c, GTE_C_COS_DEG6_MAX_ERROR);
+	check<CosEstimate, 8>(c, GTE_C_COS_DEG8_MAX_ERROR);
+	check<CosEstimate, 10>(c, GTE_C_COS_DEG10_MAX_ERROR);
+}
+
+
+void test_atan()
+{
+	Case c = { "atan", make_values(-20.0, 20.0), std::atan, false };
+	check<ATanEstimate, 3>(c, GTE_C_ATAN_DEG3_MAX_ERROR);
+	check<ATanEstimate, 5>(c, GTE_C_ATAN_DEG5_MAX_ERROR);
+	check<ATanEstimate, 7>(c, GTE_C_ATAN_DEG7_MAX_ERROR);
+	check<ATanEstimate, 9>(c, GTE_C_ATAN_DEG9_MAX_ERROR);
+	check<ATanEstimate, 11>(c, GTE_C_ATAN_DEG11_MAX_ERROR);
+	check<ATanEstimate, 13>(c, GTE_C_ATAN_DEG13_MAX_ERROR);
+}
+
+
+void test_exp2()
+{
+	Case c = { "exp2", make_values(-20.0, 20.0), exp2_ref, true };
+	check<Exp2Estimate, 1>(c, GTE_C_EXP2_DEG1_MAX_ERROR);
+	check<Exp2Estimate, 2>(c, GTE_C_EXP2_DEG2_MAX_ERROR);
+	check<Exp2Estimate, 3>(c, GTE_C_EXP2_DEG3_MAX_ERROR);
+	check<Exp2Estimate, 4>(c, GTE_C_EXP2_DEG4_MAX_ERROR);
+	check<Exp2Estimate, 5>(c, GTE_C_EXP2_DEG5_MAX_ERROR);
+	check<Exp2Estimate, 6>(c, GTE_C_EXP2_DEG6_MAX_ERROR);
+	check<Exp2Estimate, 7>(c, GTE_C_EXP2_DEG7_MAX_ERROR);
+}
+
+
+void test_log2()
+{
+	Case c = { "log2", make_values(1e-3, 1e3), log2_ref, false };
+	check<Log2Estimate, 1>(c, GTE_C_LOG2_DEG1_MAX_ERROR);
+	check<Log2Estimate, 2>(c, GTE_C_LOG2_DEG2_MAX_ERROR);
+	check<Log2Estimate, 3>(c, GTE_C_LOG2_DEG3_MAX_ERROR);
+	check<Log2Estimate, 4>(c, GTE_C_LOG2_DEG4_MAX_ERROR);
+	check<Log2Estimate, 5>(c, GTE_C_LOG2_DEG5_MAX_ERROR);
+	check<Log2Estimate, 6>(c, GTE_C_LOG2_DEG6_MAX_ERROR);
+	check<Log2Estimate, 7>(c, GTE_C_LOG2_DEG7_MAX_ERROR);
+	check<Log2Estimate, 8>(c, GTE_C_LOG2_DEG8_MAX_ERROR);
+}
+
+
+void test_sqrt()
+{
+	Case c = { "sqrt", make_values(1e-3, 1e3), std::sqrt, true };
+	check<SqrtEstimate, 1>(c, GTE_C_SQRT_DEG1_MAX_ERROR);
+	check<SqrtEstimate, 2>(c, GTE_C_SQRT_DEG2_MAX_ERROR);
+	check<SqrtEstimate, 3>(c, GTE_C_SQRT_DEG3_MAX_ERROR);
+	check<SqrtEstimate, 4>(c, GTE_C_SQRT_DEG4_MAX_ERROR);
+	check<SqrtEstimate, 5>(c, GTE_C_SQRT_DEG5_MAX_ERROR);
+	check<SqrtEstimate, 6>(c, GTE_C_SQRT_DEG6_MAX_ERROR);
+	check<SqrtEstimate, 7>(c, GTE_C_SQRT_DEG7_MAX_ERROR);
+	check<SqrtEstimate, 8>(c, GTE_C_SQRT_DEG8_MAX_ERROR);
+}
+
+
+void test_invsqrt()
+{
+	Case c = { "invsqrt", make_values(1e-3, 1e3), invsqrt, true };
+	check<InvSqrtEstimate, 1>(c, GTE_C_INVSQRT_DEG1_MAX_ERROR);
+	check<InvSqrtEstimate, 2>(c, GTE_C_INVSQRT_DEG2_MAX_ERROR);
+	check<InvSqrtEstimate, 3>(c, GTE_C_INVSQRT_DEG3_MAX_ERROR);
+	check<InvSqrtEstimate, 4>(c, GTE_C_INVSQRT_DEG4_MAX_ERROR);
+	check<InvSqrtEstimate, 5>(c, GTE_C_INVSQRT_DEG5_MAX_ERROR);
+	check<InvSqrtEstimate, 6>(c, GTE_C_INVSQRT_DEG6_MAX_ERROR);
+	check<InvSqrtEstimate, 7>(c, GTE_C_INVSQRT_DEG7_MAX_ERROR);
+	check<InvSqrtEstimate, 8>(c, GTE_C_INVSQRT_DEG8_MAX_ERROR);
+}
+
+
+}  // namespace anonymous
+
+
+int main()
+{
+	std::cout << std::setprecision(3) << "instruction set: " <<
+		BatchEstimate::GetName(BatchEstimate::GetSupportedISA()) << std::endl;
+	test_inplace();
+	test_special();
+	test_sin();
+	test_cos();
+	test_atan();
+	test_exp2();
+	test_log2();
+	test_sqrt();
+	test_invsqrt();
+	return 0;
+}
@@ -0,0 +1,280 @@
+/**
+* @file sample_function_slerp.cpp
+* @brief Batched slerp of quaternion arrays against the scalar estimates.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author  Alessandro Moro <alessandromoro.italy@gmail.com>
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "function/inc/function/SlerpEstimate.hpp"
+
+namespace
+{
+
+using CmnMath::algebra::Quaternion;
+using CmnMath::function::QuaternionBatch;
+using CmnMath::function::SLERP;
+
+const size_t kNumPairs = 100003;
+const int kNumRepeats = 20;
+
+// Errors of ChebyshevRatio::GetEstimate<N>, angles in [0,pi/2] and in
+// [0,pi/4] (GteChebyshevRatio.h).
+const double kError[17] = { 0, 2.60602e-2, 7.43321e-3, 2.51798e-3,
+	9.30819e-4, 3.63188e-4, 1.47056e-4, 6.11808e-5, 2.59880e-5, 1.12223e-5,
+	4.91138e-6, 2.17345e-6, 9.70876e-7, 4.37180e-7, 1.98230e-7, 9.04302e-8,
+	4.03665e-8 };
+const double kErrorHalf[17] = { 0, 1.90648e-2, 2.43581e-3, 3.20235e-4,
+	4.29242e-5, 5.83197e-6, 8.00278e-6, 1.10649e-7, 1.53828e-7, 6.80465e-10,
+	9.12477e-11, 4.24608e-11, 5.93392e-12, 3.39728e-13, 4.70735e-14,
+	1.55431e-15, 1.11022e-16 };
+// Distance of the batched results from the scalar ones, in float ulps of
+// the components (at most 1 in magnitude).
+const double kMaxUlps = 4.0;
+
+
+/** @brief Pairs of random unit quaternions, and the parameters.
+*/
+struct Data
+{
+	std::vector<Quaternion<float> > q0, q1;
+	QuaternionBatch<float> b0, b1;
+	std::vector<float> t;
+};
+
+
+float random_value(unsigned int &seed)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return (float)(seed >> 8) / (float)(1u << 24);
+}
+
+
+Quaternion<float> random_quaternion(unsigned int &seed)
+{
+	Quaternion<float> q;
+	float length;
+	do {
+		for (int j = 0; j < 4; ++j) q[j] = 2.0f * random_value(seed) - 1.0f;
+		length = std::sqrt(Dot(q, q));
+	} while (length < 0.1f || length > 1.0f);
+	return q / length;
+}
+
+
+/** @brief Random pairs. If restricted, the angle is in [0,pi/2].
+*/
+Data make_data(bool restricted)
+{
+	Data d;
+	unsigned int seed = 11u;
+	d.b0.Resize(kNumPairs);
+	d.b1.Resize(kNumPairs);
+	for (size_t i = 0; i < kNumPairs; ++i) {
+		Quaternion<float> q0 = random_quaternion(seed);
+		Quaternion<float> q1 = random_quaternion(seed);
+		if (restricted && Dot(q0, q1) < 0.0f) q1 = -q1;
+		d.q0.push_back(q0);
+		d.q1.push_back(q1);
+		d.b0.Set(i, q0);
+		d.b1.Set(i, q1);
+		d.t.push_back(random_value(seed));
+	}
+	return d;
+}
+
+
+/** @brief Maximum component error of q[i] against the exact slerp.
+*/
+double max_error(const Data &d, const QuaternionBatch<float> &q)
+{
+	double error = 0;
+	for (size_t i = 0; i < kNumPairs; ++i) {
+		Quaternion<double> q0, q1;
+		for (int j = 0; j < 4; ++j) {
+			q0[j] = d.q0[i][j];
+			q1[j] = d.q1[i][j];
+		}
+		Quaternion<double> exact = CmnMath::algebra::Slerp((double)d.t[i], q0,
+			q1);
+		Quaternion<float> r = q.Get(i);
+		for (int j = 0; j < 4; ++j) {
+			error = std::max(error, std::abs(r[j] - exact[j]));
+		}
+	}
+	return error;
+}
+
+
+/** @brief Maximum component distance of q[i] from the scalar result s[i],
+	in float ulps of 1.
+*/
+double max_ulps(const QuaternionBatch<float> &q,
+	const QuaternionBatch<float> &s)
+{
+	double ulps = 0;
+	for (size_t i = 0; i < kNumPairs; ++i) {
+		Quaternion<float> a = q.Get(i), b = s.Get(i);
+		for (int j = 0; j < 4; ++j) {
+			ulps = std::max(ulps, std::abs((double)a[j] - b[j]) / FLT_EPSILON);
+		}
+	}
+	return ulps;
+}
+
+
+/** @brief Time per quaternion of func, in ns.
+*/
+template <typename Function>
+double measure(Function func)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int r = 0; r < kNumRepeats; ++r) func();
+	return std::chrono::duration<double, std::nano>(
+		std::chrono::steady_clock::now() - start).count() /
+		(kNumRepeats * (double)kNumPairs);
+}
+
+
+/** @brief The error against the exact slerp, for reference, and the
+	distance from the scalar path, which must be a few ulps.
+*/
+void report(const char* name, int degree, double error, double bound,
+	double ulps, double ns_scalar, double ns_batch)
+{
+	std::cout << name << " deg " << degree << ": error " << error <<
+		" bound " << bound << " ulps " << ulps << " ok " <<
+		(ulps <= kMaxUlps) << " scalar " << ns_scalar << " ns batch " <<
+		ns_batch << " ns" << std::endl;
+}
+
+
+/** @brief Any angle, and restricted angle.
+*/
+template <int N>
+void test_estimate()
+{
+	Data d = make_data(false);
+	QuaternionBatch<float> q(kNumPairs), s(kNumPairs);
+	double ns_scalar = measure([&]() {
+		for (size_t i = 0; i < kNumPairs; ++i) {
+			s.Set(i, SLERP<float>::Estimate<N>(d.t[i], d.q0[i], d.q1[i]));
+		}
+	});
+	double ns_batch = measure([&]() {
+		SLERP<float>::Estimate<N>(d.t.data(), d.b0, d.b1, q);
+	});
+	// The coefficients of q0 and q1 have error kError[N] each.
+	report("Estimate", N, max_error(d, q), 2.0 * kError[N], max_ulps(q, s),
+		ns_scalar, ns_batch);
+
+	d = make_data(true);
+	ns_scalar = measure([&]() {
+		for (size_t i = 0; i < kNumPairs; ++i) {
+			s.Set(i, SLERP<float>::EstimateR<N>(d.t[i], d.q0[i], d.q1[i]));
+		}
+	});
+	ns_batch = measure([&]() {
+		SLERP<float>::EstimateR<N>(d.t.data(), d.b0, d.b1, q);
+	});
+	report("EstimateR", N, max_error(d, q), 2.0 * kError[N], max_ulps(q, s),
+		ns_scalar, ns_batch);
+}
+
+
+/** @brief Preprocessed pairs, with the half angle.
+*/
+template <int N>
+void test_estimate_rph()
+{
+	Data d = make_data(false);
+	QuaternionBatch<float> qh, q(kNumPairs), s(kNumPairs);
+	std::vector<float> omcosAH;
+	SLERP<float>::PreprocessRPH(d.b0, d.b1, qh, omcosAH);
+	for (size_t i = 0; i < kNumPairs; ++i) d.q1[i] = d.b1.Get(i);
+	std::vector<Quaternion<float> > h(kNumPairs);
+	for (size_t i = 0; i < kNumPairs; ++i) h[i] = qh.Get(i);
+	double ns_scalar = measure([&]() {
+		for (size_t i = 0; i < kNumPairs; ++i) {
+			s.Set(i, SLERP<float>::EstimateRPH<N>(d.t[i], d.q0[i], d.q1[i],
+				h[i], omcosAH[i]));
+		}
+	});
+	double ns_batch = measure([&]() {
+		SLERP<float>::EstimateRPH<N>(d.t.data(), d.b0, d.b1, qh,
+			omcosAH.data(), q);
+	});
+	report("EstimateRPH", N, max_error(d, q), 2.0 * kErrorHalf[N],
+		max_ulps(q, s), ns_scalar, ns_batch);
+}
+
+
+/** @brief Normalized linear interpolation, and in place evaluation.
+*/
+void test_nlerp()
+{
+	Data d = make_data(false);
+	QuaternionBatch<float> q(kNumPairs), s(kNumPairs);
+	double ns_scalar = measure([&]() {
+		for (size_t i = 0; i < kNumPairs; ++i) {
+			float t = d.t[i];
+			float t1 = Dot(d.q0[i], d.q1[i]) >= 0.0f ? t : -t;
+			Quaternion<float> r = d.q0[i] * (1.0f - t) + d.q1[i] * t1;
+			s.Set(i, r / std::sqrt(Dot(r, r)));
+		}
+	});
+	double ns_batch = measure([&]() {
+		SLERP<float>::Nlerp(d.t.data(), d.b0, d.b1, q);
+	});
+	report("Nlerp", 1, max_error(d, q), 0.0711, max_ulps(q, s), ns_scalar,
+		ns_batch);
+
+	SLERP<float>::EstimateR<8>(d.t.data(), d.b0, d.b1, q);
+	QuaternionBatch<float> b0 = d.b0;
+	SLERP<float>::EstimateR<8>(d.t.data(), b0, d.b1, b0);
+	bool same = true;
+	for (size_t i = 0; i < kNumPairs; ++i) {
+		for (int j = 0; j < 4; ++j) same = same && b0.Get(i)[j] == q.Get(i)[j];
+	}
+	std::cout << "in place: " << same << std::endl;
+}
+
+}  // namespace anonymous
+
+
+int main()
+{
+	std::cout << std::setprecision(3);
+	test_estimate<2>();
+	test_estimate<4>();
+	test_estimate<8>();
+	test_estimate<16>();
+	test_estimate_rph<2>();
+	test_estimate_rph<4>();
+	test_estimate_rph<8>();
+	test_estimate_rph<16>();
+	test_nlerp();
+	return 0;
+}
@@ -21,8 +21,13 @@
 *
 */
 
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <cmath>
+#include <thread>
+#include <vector>
 
 #include "cmnmathcore/inc/cmnmathcore/cmnmathcore_headers.hpp"
 #include "algebralinear/inc/algebralinear/algebralinear_headers.hpp"
@@ -103,6 +108,168 @@ void test3()
 }
 
 
+
+/** @brief Streaming statistics against the two-pass functions and the
+	selection against the sort.
+*/
+void test_streaming()
+{
+	typedef CmnMath::statistics::classic::SeriesAnalysis<float> Analysis;
+	// Depth-like samples with a large offset (hard for the naive formula)
+	const size_t n = 3000017;
+	std::vector<float> depth(n);
+	unsigned int seed = 3u;
+	for (size_t i = 0; i < n; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		depth[i] = 10000.0f + (float)(seed >> 8) / (float)(1u << 24) * 50.0f;
+	}
+
+	// Reference in long double
+	long double ref_sum = 0, ref_sq = 0;
+	for (size_t i = 0; i < n; ++i) ref_sum += depth[i];
+	long double ref_mean = ref_sum / n;
+	for (size_t i = 0; i < n; ++i) {
+		ref_sq += (depth[i] - ref_mean) * (depth[i] - ref_mean);
+	}
+	long double ref_variance = ref_sq / n;
+
+	CmnMath::CMN_64F mean = 0, variance = 0, naive = 0;
+	auto start = std::chrono::steady_clock::now();
+	Analysis::mean(depth, mean);
+	Analysis::variance(depth, mean, variance);
+	double two_pass_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+	Analysis::naive_variance(depth, naive);
+
+	start = std::chrono::steady_clock::now();
+	CmnMath::statistics::classic::RunningStatistics<> stats;
+	stats.add(depth);
+	double streaming_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	// The same series split between threads and merged
+	const int num_threads = 4;
+	std::vector< CmnMath::statistics::classic::RunningStatistics<> >
+		partial(num_threads);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < num_threads; ++t) {
+		threads.push_back(std::thread([&depth, &partial, t, n]() {
+			size_t b = t * n / num_threads, e = (t + 1) * n / num_threads;
+			for (size_t i = b; i < e; ++i) partial[t].add(depth[i]);
+		}));
+	}
+	for (auto &th : threads) th.join();
+	CmnMath::statistics::classic::RunningStatistics<> merged;
+	for (int t = 0; t < num_threads; ++t) merged.merge(partial[t]);
+
+	std::cout << std::setprecision(12);
+	std::cout << "simd: " << CmnMath::core::SimdDouble::Name() << std::endl;
+	std::cout << "reference mean: " << (double)ref_mean << " variance: " <<
+		(double)ref_variance << std::endl;
+	std::cout << "two-pass mean: " << mean << " variance: " << variance <<
+		" (" << two_pass_ms << " ms)" << std::endl;
+	std::cout << "streaming mean: " << stats.mean() << " variance: " <<
+		stats.variance() << " min: " << stats.min() << " max: " <<
+		stats.max() << " (" << streaming_ms << " ms)" << std::endl;
+	std::cout << "merged mean: " << merged.mean() << " variance: " <<
+		merged.variance() << " count: " << merged.count() << std::endl;
+	std::cout << "naive variance: " << naive << std::endl;
+
+	// Percentiles
+	std::vector<float> sorted(depth);
+	start = std::chrono::steady_clock::now();
+	std::sort(sorted.begin(), sorted.end());
+	double sort_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+	CmnMath::CMN_64F median = 0, p90 = 0;
+	start = std::chrono::steady_clock::now();
+	Analysis::median(depth, median);
+	double select_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+	Analysis::percentile(depth, 0.9, p90);
+	double rank = 0.9 * (n - 1);
+	size_t lo = (size_t)rank;
+	double expected_p90 = sorted[lo] + (rank - lo) * (sorted[lo + 1] -
+		sorted[lo]);
+	std::cout << "median: " << median << " expected: " << sorted[n / 2] <<
+		" p90: " << p90 << " expected: " << expected_p90 << " select: " <<
+		select_ms << " ms sort: " << sort_ms << " ms" << std::endl;
+	std::cout << std::setprecision(6);
+}
+
+
+/** @brief Streaming directional statistics against the full recomputation.
+*/
+void test_directional()
+{
+	typedef CmnMath::statistics::directional::SeriesAnalysis<CmnMath::CMN_64F>
+		Analysis;
+	// Headings around 3 rad (crossing pi), wrapped in [-pi, pi)
+	const size_t n = 1000003;
+	std::vector<CmnMath::CMN_64F> angles(n);
+	unsigned int seed = 5u;
+	for (size_t i = 0; i < n; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		double a = 3.0 + ((double)(seed >> 8) / (double)(1u << 24) - 0.5);
+		angles[i] = std::atan2(std::sin(a), std::cos(a));
+	}
+
+	CmnMath::CMN_64F theta = 0, R = 0;
+	auto start = std::chrono::steady_clock::now();
+	Analysis::mean(angles, theta, R);
+	double full_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	CmnMath::statistics::directional::RunningStatistics<CmnMath::CMN_64F>
+		stats;
+	stats.add(angles);
+	double batch_ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	// Two threads on the two halves, merged in order
+	CmnMath::statistics::directional::RunningStatistics<CmnMath::CMN_64F>
+		first, second;
+	std::thread t0([&]() { first.add(&angles[0], n / 2); });
+	std::thread t1([&]() { second.add(&angles[n / 2], n - n / 2); });
+	t0.join();
+	t1.join();
+	first.merge(second);
+
+	std::cout << std::setprecision(12);
+	std::cout << "circular mean: " << theta << " R: " << R << " (" <<
+		full_ms << " ms)" << std::endl;
+	std::cout << "batched mean: " << stats.mean() << " R: " <<
+		stats.resultant_length() << " (" << batch_ms << " ms)" << std::endl;
+	std::cout << "merged mean: " << first.mean() << " R: " <<
+		first.resultant_length() << " count: " << first.count() << std::endl;
+
+	// Forgetting: the merge of consecutive parts equals the sequence
+	CmnMath::statistics::directional::RunningStatistics<CmnMath::CMN_64F>
+		seq(0.999), part0(0.999), part1(0.999);
+	for (size_t i = 0; i < 20000; ++i) seq.add(angles[i]);
+	part0.add(&angles[0], 12345);
+	part1.add(&angles[12345], 20000 - 12345);
+	part0.merge(part1);
+	std::cout << "forgetting mean: " << seq.mean() << " merged: " <<
+		part0.mean() << " R: " << seq.resultant_length() << " merged: " <<
+		part0.resultant_length() << std::endl;
+
+	// Sliding window against the mean of the last angles
+	const size_t window = 1000;
+	CmnMath::statistics::directional::SlidingWindowStatistics<
+		CmnMath::CMN_64F> sliding(window);
+	for (size_t i = 0; i < 100000; ++i) sliding.add(angles[i]);
+	sliding.add(&angles[100000], 2500);
+	std::vector<CmnMath::CMN_64F> last(angles.begin() + 102500 - window,
+		angles.begin() + 102500);
+	Analysis::mean(last, theta, R);
+	std::cout << "window mean: " << sliding.mean() << " expected: " << theta <<
+		" R: " << sliding.resultant_length() << " expected: " << R <<
+		std::endl;
+	std::cout << std::setprecision(6);
+}
+
 /** main
 */
 int main(int argc, char *argv[])
@@ -111,5 +278,7 @@ int main(int argc, char *argv[])
 	test();
 	test2();
 	test3();
+	test_streaming();
+	test_directional();
 	return 0;
 }
\ No newline at end of file